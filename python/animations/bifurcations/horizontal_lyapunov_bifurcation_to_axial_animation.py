@@ -138,19 +138,19 @@ class HorizontalLyapunovBifurcationToAxialAnimation:
             if i <= self.orbitIdBifurcationsFromHorizontalLyapunov[1]:
                 jacobi_energy = self.jacobiEnergyHorizontalLyapunov[i]
                 self.jacobiEnergyText.set_text('Horizontal Lyapunov family \n $C \\approx$ {:.4f}'.format(round(jacobi_energy, 4)))
-                orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_horizontal_' + str(i) + '.txt')
+                orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_horizontal_' + str(i) + '.txt', level='medium')
 
             elif self.orbitIdBifurcationsFromHorizontalLyapunov[1] < i <= self.orbitIdBifurcationsFromHorizontalLyapunov[1] + self.numberOfAxialOrbits:
                 index_for_axial = i - self.orbitIdBifurcationsFromHorizontalLyapunov[1] - 1
                 jacobi_energy = self.jacobiEnergyAxial[index_for_axial]
                 self.jacobiEnergyText.set_text('Axial family \n $C \\approx$ {:.4f}'.format(round(jacobi_energy, 4)))
-                orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_axial_' + str(index_for_axial) + '.txt')
+                orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_axial_' + str(index_for_axial) + '.txt', level='medium')
                 line.set_color(self.orbitColors['halo'])
             else:
                 index_for_vertical = self.verticalLyapunovIndices[i - self.orbitIdBifurcationsFromHorizontalLyapunov[1] - self.numberOfAxialOrbits - 1]
                 jacobi_energy = self.jacobiEnergyVerticalLyapunov[index_for_vertical]
                 self.jacobiEnergyText.set_text('Vertical Lyapunov family \n $C \\approx$ {:.4f}'.format(round(jacobi_energy, 4)))
-                orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_vertical_' + str(index_for_vertical) + '.txt')
+                orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_vertical_' + str(index_for_vertical) + '.txt', level='medium')
                 line.set_color(self.orbitColors['vertical'])
 
             if i in self.orbitIdBifurcationsFromHorizontalLyapunov and i <= self.orbitIdBifurcationsFromHorizontalLyapunov[1]:
@@ -207,7 +207,7 @@ class HorizontalLyapunovBifurcationToAxialAnimation:
             round(self.jacobiEnergyHorizontalLyapunov[0], 4)), transform=self.ax.transAxes, size=self.timeTextSize)
 
         # Plot the first orbit
-        orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_horizontal_' + str(0) + '.txt')
+        orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_horizontal_' + str(0) + '.txt', level='medium')
         self.ax.plot(orbit_df['x'], orbit_df['y'], orbit_df['z'], color=self.orbitColors['horizontal'], alpha=self.orbitAlpha, linewidth=self.orbitLinewidth)
 
         # Plot the Moon
@@ -112,19 +112,19 @@ class HorizontalLyapunovBifurcationToHaloAnimation:
         if i <= self.orbitIdBifurcations[0]:
             jacobi_energy = self.jacobiEnergyHorizontalLyapunov[i]
             self.jacobiEnergyText.set_text('Horizontal Lyapunov family \n $C \\approx$ {:.4f}'.format(round(jacobi_energy, 4)))
-            orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_horizontal_' + str(i) + '.txt')
+            orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_horizontal_' + str(i) + '.txt', level='medium')
         elif self.orbitIdBifurcations[0] < i <= self.orbitIdBifurcations[0] + self.numberOfHaloExtensionOrbits:
             index_for_halo = self.numberOfHaloExtensionOrbits - (i - self.orbitIdBifurcations[0])
             jacobi_energy = self.jacobiEnergyHaloN[(i - self.orbitIdBifurcations[0] - 1)]
             self.jacobiEnergyText.set_text('Southern halo family \n $C \\approx$ {:.4f}'.format(round(jacobi_energy, 4)))
-            orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_halo_n_' + str(index_for_halo) + '.txt')
+            orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_halo_n_' + str(index_for_halo) + '.txt', level='medium')
             self.lines[0].set_color(self.orbitColors['halo'])
             pass
         else:
             index_for_halo = i - self.orbitIdBifurcations[0] - self.numberOfHaloExtensionOrbits + 1
             jacobi_energy = self.jacobiEnergyHalo[index_for_halo]
             self.jacobiEnergyText.set_text('Southern halo family \n $C \\approx$ {:.4f}'.format(round(jacobi_energy, 4)))
-            orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_halo_' + str(index_for_halo) + '.txt')
+            orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_halo_' + str(index_for_halo) + '.txt', level='medium')
             self.lines[0].set_color(self.orbitColors['halo'])
             pass
 
@@ -176,7 +176,7 @@ class HorizontalLyapunovBifurcationToHaloAnimation:
                                                transform=self.ax.transAxes, size=self.timeTextSize)
 
         # Plot the first orbit
-        orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_horizontal_' + str(0) + '.txt')
+        orbit_df = load_orbit('../../../data/raw/orbits/L' + str(self.librationPointNr) + '_horizontal_' + str(0) + '.txt', level='medium')
         self.ax.plot(orbit_df['x'], orbit_df['y'], orbit_df['z'], color=self.orbitColors['horizontal'], alpha=self.orbitAlpha, linewidth=self.orbitLinewidth)
 
         # Plot the Moon
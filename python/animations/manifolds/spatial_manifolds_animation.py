@@ -148,14 +148,14 @@ class SpatialManifoldsAnimation:
         return self.lines
 
     def animate(self):
-        self.W_S_plus = [load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(1) + '_' + self.orbitType + '_' + str(self.orbitIds[0]) + '_W_S_plus.txt'),
-                         load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(2) + '_' + self.orbitType + '_' + str(self.orbitIds[1]) + '_W_S_plus.txt')]
-        self.W_S_min = [load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(1) + '_' + self.orbitType + '_' + str(self.orbitIds[0]) + '_W_S_min.txt'),
-                        load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(2) + '_' + self.orbitType + '_' + str(self.orbitIds[1]) + '_W_S_min.txt')]
-        self.W_U_plus = [load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(1) + '_' + self.orbitType + '_' + str(self.orbitIds[0]) + '_W_U_plus.txt'),
-                         load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(2) + '_' + self.orbitType + '_' + str(self.orbitIds[1]) + '_W_U_plus.txt')]
-        self.W_U_min = [load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(1) + '_' + self.orbitType + '_' + str(self.orbitIds[0]) + '_W_U_min.txt'),
-                        load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(2) + '_' + self.orbitType + '_' + str(self.orbitIds[1]) + '_W_U_min.txt')]
+        self.W_S_plus = [load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(1) + '_' + self.orbitType + '_' + str(self.orbitIds[0]) + '_W_S_plus.txt', level='medium'),
+                         load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(2) + '_' + self.orbitType + '_' + str(self.orbitIds[1]) + '_W_S_plus.txt', level='medium')]
+        self.W_S_min = [load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(1) + '_' + self.orbitType + '_' + str(self.orbitIds[0]) + '_W_S_min.txt', level='medium'),
+                        load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(2) + '_' + self.orbitType + '_' + str(self.orbitIds[1]) + '_W_S_min.txt', level='medium')]
+        self.W_U_plus = [load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(1) + '_' + self.orbitType + '_' + str(self.orbitIds[0]) + '_W_U_plus.txt', level='medium'),
+                         load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(2) + '_' + self.orbitType + '_' + str(self.orbitIds[1]) + '_W_U_plus.txt', level='medium')]
+        self.W_U_min = [load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(1) + '_' + self.orbitType + '_' + str(self.orbitIds[0]) + '_W_U_min.txt', level='medium'),
+                        load_manifold_refactored('../../../data/raw/manifolds/refined_for_c/L' + str(2) + '_' + self.orbitType + '_' + str(self.orbitIds[1]) + '_W_U_min.txt', level='medium')]
 
         self.numberOfOrbitsPerManifold = len(set(self.W_S_plus[0].index.get_level_values(0)))
         color_palette_green = sns.dark_palette('green', n_colors=self.numberOfOrbitsPerManifold)
@@ -184,7 +184,7 @@ class SpatialManifoldsAnimation:
 
         # Plot both orbits
         for k in range(2):
-            orbit_df = load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(k+1) + '_' + self.orbitType + '_' + str(self.orbitIds[k]) + '.txt')
+            orbit_df = load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(k+1) + '_' + self.orbitType + '_' + str(self.orbitIds[k]) + '.txt', level='medium')
             self.ax.plot(orbit_df['x'], orbit_df['y'], orbit_df['z'], color=self.orbitColor, alpha=self.orbitAlpha, linewidth=self.orbitLinewidth)
 
         # Plot both primaries
@@ -68,11 +68,11 @@ class SpatialHeteroclinicAnimation:
 
         self.W_S_min = load_manifold_refactored('../../../data/raw/poincare_sections/' + str(
             self.numberOfOrbitsPerManifold) + '/L2_' + self.orbitType + '_W_S_min_3.1_' + str(
-            int(theta)) + '_full.txt').xs(index_near_heteroclinic_s)
+            int(theta)) + '_full.txt', level='medium').xs(index_near_heteroclinic_s)
 
         self.W_U_plus = load_manifold_refactored('../../../data/raw/poincare_sections/' + str(
             self.numberOfOrbitsPerManifold) + '/L1_' + self.orbitType + '_W_U_plus_3.1_' + str(
-            int(theta)) + '_full.txt').xs(index_near_heteroclinic_u)
+            int(theta)) + '_full.txt', level='medium').xs(index_near_heteroclinic_u)
         self.firstTimeStable = True
         pass
 
@@ -135,7 +135,7 @@ class SpatialHeteroclinicAnimation:
 
         # Plot both orbits
         for k in range(2):
-            orbit_df = load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(k+1) + '_' + self.orbitType + '_' + str(self.orbitIds[self.orbitType][k+1][self.cLevel]) + '.txt')
+            orbit_df = load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(k+1) + '_' + self.orbitType + '_' + str(self.orbitIds[self.orbitType][k+1][self.cLevel]) + '.txt', level='medium')
             self.ax.plot(orbit_df['x'], orbit_df['y'], orbit_df['z'], color=self.orbitColor, alpha=self.orbitAlpha, linewidth=2, linestyle=':')
 
         # Plot both primaries
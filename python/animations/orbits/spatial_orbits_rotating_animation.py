@@ -85,14 +85,14 @@ class SpatialOrbitsRotatingAnimation:
         fig = plt.figure()
         self.ax = fig.add_subplot(111, projection='3d')
 
-        self.horizontalLyapunov = [load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(1) + '_horizontal_' + str(self.orbitIds['horizontal'][1][self.cLevel]) + '_100.txt'),
-                                   load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(2) + '_horizontal_' + str(self.orbitIds['horizontal'][2][self.cLevel]) + '_100.txt')]
+        self.horizontalLyapunov = [load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(1) + '_horizontal_' + str(self.orbitIds['horizontal'][1][self.cLevel]) + '_100.txt', level='medium'),
+                                   load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(2) + '_horizontal_' + str(self.orbitIds['horizontal'][2][self.cLevel]) + '_100.txt', level='medium')]
 
-        self.verticalLyapunov = [load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(1) + '_vertical_' + str(self.orbitIds['vertical'][1][self.cLevel]) + '_100.txt'),
-                                 load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(2) + '_vertical_' + str(self.orbitIds['vertical'][2][self.cLevel]) + '_100.txt')]
+        self.verticalLyapunov = [load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(1) + '_vertical_' + str(self.orbitIds['vertical'][1][self.cLevel]) + '_100.txt', level='medium'),
+                                 load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(2) + '_vertical_' + str(self.orbitIds['vertical'][2][self.cLevel]) + '_100.txt', level='medium')]
 
-        self.halo = [load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(1) + '_halo_' + str(self.orbitIds['halo'][1][self.cLevel]) + '_100.txt'),
-                     load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(2) + '_halo_' + str(self.orbitIds['halo'][2][self.cLevel]) + '_100.txt')]
+        self.halo = [load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(1) + '_halo_' + str(self.orbitIds['halo'][1][self.cLevel]) + '_100.txt', level='medium'),
+                     load_orbit('../../../data/raw/orbits/refined_for_c/L' + str(2) + '_halo_' + str(self.orbitIds['halo'][2][self.cLevel]) + '_100.txt', level='medium')]
 
         self.lines = [plt.plot([], [], color=self.orbitColors['horizontal'], linewidth=self.orbitLinewidth, alpha=self.orbitAlpha, marker='o', markevery=[-1])[0],
                       plt.plot([], [], color=self.orbitColors['horizontal'], linewidth=self.orbitLinewidth, alpha=self.orbitAlpha, marker='o', markevery=[-1])[0],
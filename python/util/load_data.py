@@ -1,8 +1,47 @@
+import os
+
 import pandas as pd
 import numpy as np
 
 
-def load_manifold(file_path):
+state_columns = ['time', 'x', 'y', 'z', 'xdot', 'ydot', 'zdot']
+
+
+def numpy_counterpart(file_path, extension):
+    # Path of the .npy/.npz file written instead of file_path by a run with numpy output, None if there is none
+    numpy_file_path = os.path.splitext(file_path)[0] + extension
+    if os.path.splitext(file_path)[1] == extension or os.path.exists(numpy_file_path):
+        return numpy_file_path
+    return None
+
+
+def decimated_counterpart(file_path, level):
+    # Path of the decimated file of the given level ('coarse', 'medium') written next to file_path, file_path itself if
+    # there is none or level is None or 'full'
+    if level is None or level == 'full':
+        return file_path
+    decimated_file_path = os.path.splitext(file_path)[0] + '_' + level + os.path.splitext(file_path)[1]
+    if os.path.exists(decimated_file_path) or numpy_counterpart(decimated_file_path, '.npy') \
+            or numpy_counterpart(decimated_file_path, '.npz'):
+        return decimated_file_path
+    return file_path
+
+
+def load_trajectories_npz(file_path):
+    # Trajectory i is states[offsets[i]:offsets[i + 1]]; empty trajectories keep their number
+    with np.load(file_path) as archive:
+        states = archive['states']
+        offsets = archive['offsets']
+    data = pd.DataFrame(states[:, :7], columns=state_columns)
+    data['orbitNumber'] = np.repeat(np.arange(len(offsets) - 1), np.diff(offsets))
+    return data.set_index(['orbitNumber', 'time'])
+
+
+def load_manifold(file_path, level=None):
+    file_path = decimated_counterpart(file_path, level)
+    if numpy_counterpart(file_path, '.npz'):
+        return load_trajectories_npz(numpy_counterpart(file_path, '.npz'))
+
     pd.options.mode.chained_assignment = None  # Turn off SettingWithCopyWarning
 
     input_data = pd.read_table(file_path, delim_whitespace=True, header=None).filter(list(range(7)))
@@ -25,7 +64,11 @@ def load_manifold(file_path):
     output_data = pd.concat(output_data).reset_index(drop=True).set_index(['orbitNumber', 'time'])
     return output_data
 
-def load_manifold_refactored(file_path):
+def load_manifold_refactored(file_path, level=None):
+    file_path = decimated_counterpart(file_path, level)
+    if numpy_counterpart(file_path, '.npz'):
+        return load_trajectories_npz(numpy_counterpart(file_path, '.npz'))
+
     pd.options.mode.chained_assignment = None  # Turn off SettingWithCopyWarning
 
     input_data = pd.read_table(file_path, delim_whitespace=True, header=None).filter(list(range(7)))
@@ -84,12 +127,60 @@ def load_manifold_incl_stm(file_path):
     return output_data
 
 
-def load_orbit(file_path):
+def load_orbit(file_path, level=None):
+    file_path = decimated_counterpart(file_path, level)
+    if numpy_counterpart(file_path, '.npy'):
+        return pd.DataFrame(np.load(numpy_counterpart(file_path, '.npy')), columns=state_columns)
+
     data = pd.read_table(file_path, delim_whitespace=True, header=None).filter(list(range(7)))
     data.columns = ['time', 'x', 'y', 'z', 'xdot', 'ydot', 'zdot']
     return data
 
 
+def load_manifold_termination(file_path):
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    data.columns = ['orbitNumber', 'reason', 'reasonName']
+    return data.set_index('orbitNumber')
+
+
+def load_manifold_connection_front(file_path):
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    data.columns = ['kind', 'rank', 'deltaR', 'deltaV', 'stablePhase', 'stableTime', 'unstablePhase', 'unstableTime']
+    return data
+
+
+def load_manifold_curve_intersections(file_path):
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    data.columns = ['stablePhase', 'unstablePhase', 'deltaR', 'deltaV',
+                    'stableX', 'stableY', 'stableZ', 'stableXdot', 'stableYdot', 'stableZdot',
+                    'unstableX', 'unstableY', 'unstableZ', 'unstableXdot', 'unstableYdot', 'unstableZdot']
+    return data
+
+
+def load_heteroclinic_connection(file_path):
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    data.columns = ['converged', 'numberOfIterations', 'unstableOrbitTime', 'unstableIntegrationTime',
+                    'stableOrbitTime', 'stableIntegrationTime', 'deltaR', 'deltaV', 'x', 'y', 'z', 'xdot', 'ydot', 'zdot']
+    return data
+
+
+def load_heteroclinic_connection_family(file_path):
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    data.columns = ['C', 'converged', 'numberOfIterations', 'unstableOrbitTime', 'unstableIntegrationTime',
+                    'stableOrbitTime', 'stableIntegrationTime', 'deltaR', 'deltaV', 'x', 'y', 'z', 'xdot', 'ydot', 'zdot']
+    return data
+
+
+def load_manifold_connection_matrix(file_path):
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    state_columns = ['phase', 'time', 'x', 'y', 'z', 'xdot', 'ydot', 'zdot']
+    data.columns = (['unstableLibrationPointNr', 'unstableOrbitType', 'unstableC', 'unstableDisplacementSign',
+                     'stableLibrationPointNr', 'stableOrbitType', 'stableC', 'stableDisplacementSign',
+                     'numberOfUnstableCrossings', 'numberOfStableCrossings', 'deltaR', 'deltaV'] +
+                    ['stable_' + column for column in state_columns] + ['unstable_' + column for column in state_columns])
+    return data
+
+
 def load_initial_conditions(file_path):
     data = pd.read_table(file_path, delim_whitespace=True, header=None)
     data.columns = ['orbitId', 'C', 'T', 'x', 'y', 'z', 'xdot', 'ydot', 'zdot',
@@ -99,17 +190,52 @@ def load_initial_conditions(file_path):
 
 
 def load_initial_conditions_incl_M(file_path):
+    if numpy_counterpart(file_path, '.npy'):
+        return pd.DataFrame(np.load(numpy_counterpart(file_path, '.npy')))
+
     data = pd.read_table(file_path, delim_whitespace=True, header=None)
     # data.columns = ['orbitId', 'C', 'T', 'x', 'y', 'z', 'xdot', 'ydot', 'zdot']
     return data
 
 
 def load_differential_corrections(file_path):
+    if numpy_counterpart(file_path, '.npy'):
+        return pd.DataFrame(np.load(numpy_counterpart(file_path, '.npy')))
+
     data = pd.read_table(file_path, delim_whitespace=True, header=None)
     # data.columns = ['numberOfIterations', 'C', 'T', 'x', 'y', 'z', 'xdot', 'ydot', 'zdot']
     return data
 
 
+def load_eigenvectors(file_path):
+    if numpy_counterpart(file_path, '.npy'):
+        return pd.DataFrame(np.load(numpy_counterpart(file_path, '.npy')), columns=state_columns[1:])
+
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    data.columns = state_columns[1:]
+    return data
+
+
+def load_poincare_section(file_path):
+    if numpy_counterpart(file_path, '.npy'):
+        return pd.DataFrame(np.load(numpy_counterpart(file_path, '.npy')), columns=['phase'] + state_columns)
+
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    data.columns = ['phase'] + state_columns
+    return data
+
+
+def load_minimum_impulse_connections(file_path):
+    columns = (['theta'] + ['stable_' + column for column in ['phase'] + state_columns] +
+               ['unstable_' + column for column in ['phase'] + state_columns])
+    if numpy_counterpart(file_path, '.npy'):
+        return pd.DataFrame(np.load(numpy_counterpart(file_path, '.npy')), columns=columns)
+
+    data = pd.read_table(file_path, delim_whitespace=True, header=None)
+    data.columns = columns
+    return data
+
+
 def load_lagrange_points_location():
     location_lagrange_points = {'L1': [0.8369151483688, 0, 0],
                                 'L2': [1.1556821477825, 0, 0],
@@ -0,0 +1,40 @@
+import math
+import struct
+import unittest
+
+from xor_float_codec import XorFloatDecoder, decode_xor_float_columns
+
+
+# Two columns of five values as encoded by XorFloatEncoder, the same bytes as in src/unitTests/unitTestXorFloatCodec.cpp
+encoded_columns = bytes([
+    0x9f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x95, 0xff, 0xcc, 0xd0, 0x71, 0xfd, 0xcc, 0xcc,
+    0xcc, 0xcc, 0xcc, 0xcc, 0xd3, 0x03, 0xeb, 0xfb, 0x99, 0x99, 0x99, 0x99, 0x99, 0x99, 0xb7, 0xff, 0x80,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0f, 0xff, 0x92, 0xb2, 0x69, 0xec, 0xed, 0xcc, 0x0b, 0xc0])
+column_one = [1.0, 2.0, 3.0, 4.0, 4.5]
+column_two = [0.1, 0.1, -0.0, math.inf, -2.5e-300]
+
+
+def get_bits(value):
+    return struct.unpack('<Q', struct.pack('<d', value))[0]
+
+
+class TestXorFloatCodec(unittest.TestCase):
+    def test_decode_columns(self):
+        values = decode_xor_float_columns(encoded_columns, 5, 2)
+        self.assertEqual(values.shape, (5, 2))
+        for column_number, column in enumerate([column_one, column_two]):
+            self.assertEqual([get_bits(value) for value in values[:, column_number]],
+                             [get_bits(value) for value in column])
+
+    def test_decode_value_by_value(self):
+        decoder = XorFloatDecoder(encoded_columns)
+        self.assertEqual([get_bits(value) for value in decoder.column(5)], [get_bits(value) for value in column_one])
+        self.assertEqual([get_bits(value) for value in decoder.column(5)], [get_bits(value) for value in column_two])
+
+    def test_truncated_data(self):
+        with self.assertRaises(ValueError):
+            decode_xor_float_columns(encoded_columns[:-2], 5, 2)
+
+
+if __name__ == '__main__':
+    unittest.main()
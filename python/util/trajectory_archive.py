@@ -0,0 +1,113 @@
+import os
+
+import numpy as np
+import pandas as pd
+
+from xor_float_codec import decode_xor_float_columns
+
+
+# Reader of the trajectory archives written by src/trajectoryArchive.cpp (layout in src/trajectoryArchive.h). The file is
+# memory mapped, so opening an archive only reads its index and every trajectory is a view into the mapped file.
+class TrajectoryArchive:
+    file_header_magic = b'CR3BPTA\x00'
+    footer_magic = b'CR3BPIDX'
+    record_magic = 0x52435254
+
+    def __init__(self, file_path):
+        self.file_path = file_path
+        self.data = np.memmap(file_path, dtype=np.uint8, mode='r') if os.path.getsize(file_path) > 0 \
+            else np.zeros(0, dtype=np.uint8)
+        if len(self.data) < 16 or self.data[:8].tobytes() != self.file_header_magic:
+            raise ValueError(file_path + ' is not a trajectory archive')
+
+        self.entries = self.read_index() if len(self.data) >= 40 and self.data[-8:].tobytes() == self.footer_magic \
+            else None
+        if self.entries is None:
+            self.entries = self.scan_records()
+        # A trajectory appended again under the same kind and id replaces the earlier one
+        self.entry_numbers = {(entry['kind'], entry['id']): entry_number for entry_number, entry in enumerate(self.entries)}
+
+    def read_uint(self, position, number_of_bytes):
+        return int.from_bytes(self.data[position:position + number_of_bytes].tobytes(), 'little')
+
+    def read_index(self):
+        # None if the footer or an index entry points outside the file (an overwritten or truncated archive), in which
+        # case the record headers are read instead
+        index_end = len(self.data) - 24
+        index_offset = self.read_uint(index_end, 8)
+        number_of_records = self.read_uint(index_end + 8, 8)
+        if index_offset < 16 or index_offset > index_end or number_of_records > (index_end - index_offset) // 48:
+            return None
+        entries = []
+        position = index_offset
+        for _ in range(number_of_records):
+            if position + 48 > index_end:
+                return None
+            kind_length = self.read_uint(position, 4)
+            if position + 48 + kind_length > index_end:
+                return None
+            entry = {'kind': self.data[position + 48:position + 48 + kind_length].tobytes().decode(),
+                     'stateDimension': self.read_uint(position + 4, 4),
+                     'id': int(np.int64(np.uint64(self.read_uint(position + 8, 8)))),
+                     'dataOffset': self.read_uint(position + 16, 8),
+                     'numberOfStates': self.read_uint(position + 24, 8),
+                     'dataLength': self.read_uint(position + 32, 8),
+                     'encoding': self.read_uint(position + 40, 4)}
+            if entry['dataOffset'] < 16 or entry['dataOffset'] + entry['dataLength'] > index_offset:
+                return None
+            entries.append(entry)
+            position += 48 + (kind_length + 7) // 8 * 8
+        return entries
+
+    def scan_records(self):
+        # Archive of a run that did not close it: the record headers are read instead of the index
+        entries = []
+        position = 16
+        while position + 40 <= len(self.data) and self.read_uint(position, 4) == self.record_magic:
+            kind_length = self.read_uint(position + 4, 4)
+            entry = {'kind': self.data[position + 40:position + 40 + kind_length].tobytes().decode(),
+                     'id': int(np.int64(np.uint64(self.read_uint(position + 8, 8)))),
+                     'numberOfStates': self.read_uint(position + 16, 8),
+                     'stateDimension': self.read_uint(position + 24, 4),
+                     'encoding': self.read_uint(position + 28, 4),
+                     'dataLength': self.read_uint(position + 32, 8),
+                     'dataOffset': position + 40 + (kind_length + 7) // 8 * 8}
+            if entry['dataOffset'] + entry['dataLength'] > len(self.data):
+                break
+            entries.append(entry)
+            position = entry['dataOffset'] + (entry['dataLength'] + 7) // 8 * 8
+        return entries
+
+    def kinds(self):
+        return sorted(set(kind for kind, _ in self.entry_numbers))
+
+    def ids(self, kind):
+        return sorted(trajectory_id for entry_kind, trajectory_id in self.entry_numbers if entry_kind == kind)
+
+    def get_trajectory(self, kind, trajectory_id):
+        # Returns (times, states) with states of shape (numberOfStates, stateDimension); views into the file for
+        # uncompressed records, decoded copies for compressed records
+        entry = self.entries[self.entry_numbers[(kind, trajectory_id)]]
+        number_of_states = entry['numberOfStates']
+        if entry['encoding'] == 1:
+            columns = decode_xor_float_columns(self.data[entry['dataOffset']:entry['dataOffset'] + entry['dataLength']],
+                                               number_of_states, 1 + entry['stateDimension'])
+            return columns[:, 0], columns[:, 1:]
+        if entry['encoding'] != 0:
+            raise ValueError('unknown encoding of ' + kind + ' ' + str(trajectory_id))
+        values = np.frombuffer(self.data, dtype='<f8', count=number_of_states * (1 + entry['stateDimension']),
+                               offset=entry['dataOffset'])
+        return values[:number_of_states], values[number_of_states:].reshape(number_of_states, entry['stateDimension'])
+
+
+def load_archived_trajectories(file_path, kind):
+    # All trajectories of a kind, indexed like load_manifold: orbitNumber is the id within the kind
+    archive = TrajectoryArchive(file_path)
+    output_data = []
+    for trajectory_id in archive.ids(kind):
+        times, states = archive.get_trajectory(kind, trajectory_id)
+        data_per_orbit = pd.DataFrame(states[:, :6], columns=['x', 'y', 'z', 'xdot', 'ydot', 'zdot'])
+        data_per_orbit.insert(0, 'time', times)
+        data_per_orbit['orbitNumber'] = trajectory_id
+        output_data.append(data_per_orbit)
+    return pd.concat(output_data).reset_index(drop=True).set_index(['orbitNumber', 'time'])
@@ -0,0 +1,61 @@
+import struct
+
+import numpy as np
+
+
+# Decoder of the columns written by XorFloatEncoder (src/xorFloatCodec.h, where the bit layout is described)
+class XorFloatDecoder:
+    def __init__(self, data):
+        self.data = bytes(data)
+        self.byte_position = 0
+        self.bit_buffer = 0
+        self.number_of_buffered_bits = 0
+
+    def read_bits(self, number_of_bits):
+        while self.number_of_buffered_bits < number_of_bits:
+            if self.byte_position >= len(self.data):
+                raise ValueError('encoded data ends within a value')
+            # Eight bytes at a time, the buffer stays well within a few machine words
+            chunk = self.data[self.byte_position:self.byte_position + 8]
+            self.bit_buffer = (self.bit_buffer << (8 * len(chunk))) | int.from_bytes(chunk, 'big')
+            self.number_of_buffered_bits += 8 * len(chunk)
+            self.byte_position += len(chunk)
+        self.number_of_buffered_bits -= number_of_bits
+        bits = self.bit_buffer >> self.number_of_buffered_bits
+        self.bit_buffer &= (1 << self.number_of_buffered_bits) - 1
+        return bits
+
+    def column(self, number_of_values):
+        # Yields the values of the next column one at a time
+        prediction_order = self.read_bits(1)
+        window_leading_zeros = 0
+        window_length = 0
+        previous_value = 0.0
+        second_previous_value = 0.0
+        for value_number in range(number_of_values):
+            if value_number == 0:
+                value_bits = self.read_bits(64)
+            else:
+                if prediction_order == 1 and value_number >= 2:
+                    prediction = 2.0 * previous_value - second_previous_value
+                else:
+                    prediction = previous_value
+                value_bits = struct.unpack('<Q', struct.pack('<d', prediction))[0]
+                if self.read_bits(1) == 1:
+                    if self.read_bits(1) == 1:
+                        window_leading_zeros = self.read_bits(6)
+                        window_length = self.read_bits(6) + 1
+                    value_bits ^= self.read_bits(window_length) << (64 - window_leading_zeros - window_length)
+            value = struct.unpack('<d', struct.pack('<Q', value_bits))[0]
+            second_previous_value = previous_value
+            previous_value = value
+            yield value
+
+
+def decode_xor_float_columns(data, number_of_values, number_of_columns):
+    # Array of shape (number_of_values, number_of_columns) from number_of_columns consecutive encoded columns
+    decoder = XorFloatDecoder(data)
+    columns = np.empty((number_of_columns, number_of_values))
+    for column_number in range(number_of_columns):
+        columns[column_number] = np.fromiter(decoder.column(number_of_values), dtype=float, count=number_of_values)
+    return columns.T
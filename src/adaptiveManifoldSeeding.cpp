@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
+#include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
+
+#include "adaptiveManifoldSeeding.h"
+#include "computeManifolds.h"
+#include "connectManifoldsAtTheta.h"
+#include "manifoldConnectionFront.h"
+
+namespace
+{
+
+// Interval between two neighbouring seeds on the (periodic) orbit, candidate for a new seed in its middle
+struct SeedInterval
+{
+    int lowerIndexOnOrbit;
+    int upperIndexOnOrbit;
+    bool nearOptimum;
+    double sectionStateSeparation;
+
+    bool operator<( const SeedInterval& other ) const
+    {
+        if ( nearOptimum != other.nearOptimum ) {
+            return nearOptimum;
+        }
+        return sectionStateSeparation > other.sectionStateSeparation;
+    }
+};
+
+double computeDistanceToSegment( const Eigen::Vector3d& point, const Eigen::Vector3d& segmentStart, const Eigen::Vector3d& segmentEnd )
+{
+    const Eigen::Vector3d segment = segmentEnd - segmentStart;
+    double fractionAlongSegment = 0.0;
+    if ( segment.squaredNorm( ) > 0.0 ) {
+        fractionAlongSegment = std::min( 1.0, std::max( 0.0, ( point - segmentStart ).dot( segment ) / segment.squaredNorm( ) ) );
+    }
+    return ( point - segmentStart - fractionAlongSegment * segment ).norm( );
+}
+
+// Seeds that were propagated before (among which those that did not reach the section) are not selected again
+std::vector< int > selectNewSeeds( const ManifoldStatesAtSection& manifoldStatesAtTheta, const ManifoldStatesAtSection& partnerStatesAtTheta,
+                                   const std::set< int >& propagatedSeeds,
+                                   const int numberOfPointsOnPeriodicOrbit, const double nearOptimumDeltaPosition,
+                                   const double sectionStateSeparationTolerance, const double maximumVelocityDiscrepancy,
+                                   const int maximumNumberOfNewSeeds )
+{
+    std::vector< SeedInterval > seedIntervals;
+    for ( auto it = manifoldStatesAtTheta.begin( ); it != manifoldStatesAtTheta.end( ); ++it ) {
+        // The last seed is a neighbour of the first one, one period further along the orbit
+        auto next = std::next( it );
+        const bool wrapsAround = ( next == manifoldStatesAtTheta.end( ) );
+        if ( wrapsAround ) {
+            next = manifoldStatesAtTheta.begin( );
+        }
+        const int upperIndexOnOrbit = next->first + ( wrapsAround ? numberOfPointsOnPeriodicOrbit : 0 );
+        if ( upperIndexOnOrbit - it->first < 2 ||
+             propagatedSeeds.count( ( ( it->first + upperIndexOnOrbit ) / 2 ) % numberOfPointsOnPeriodicOrbit ) > 0 ) {
+            continue;
+        }
+
+        SeedInterval seedInterval;
+        seedInterval.lowerIndexOnOrbit      = it->first;
+        seedInterval.upperIndexOnOrbit      = upperIndexOnOrbit;
+        seedInterval.sectionStateSeparation = ( it->second.second - next->second.second ).norm( );
+
+        // Near the optimum if the section curve, interpolated linearly between both seeds, passes a partner crossing
+        // (within the velocity discrepancy) at least as closely as the current optimum
+        seedInterval.nearOptimum = false;
+        const Eigen::Vector3d lowerPosition = it->second.second.segment( 0, 3 );
+        const Eigen::Vector3d upperPosition = next->second.second.segment( 0, 3 );
+        for ( auto const& partnerState : partnerStatesAtTheta ) {
+            if ( ( partnerState.second.second.segment( 3, 3 ) - it->second.second.segment( 3, 3 ) ).norm( ) >= maximumVelocityDiscrepancy &&
+                 ( partnerState.second.second.segment( 3, 3 ) - next->second.second.segment( 3, 3 ) ).norm( ) >= maximumVelocityDiscrepancy ) {
+                continue;
+            }
+            if ( computeDistanceToSegment( partnerState.second.second.segment( 0, 3 ), lowerPosition, upperPosition ) <= nearOptimumDeltaPosition ) {
+                seedInterval.nearOptimum = true;
+                break;
+            }
+        }
+
+        if ( seedInterval.nearOptimum || seedInterval.sectionStateSeparation > sectionStateSeparationTolerance ) {
+            seedIntervals.push_back( seedInterval );
+        }
+    }
+
+    // Refine around the optimum first, then where the section is resolved most coarsely
+    std::sort( seedIntervals.begin( ), seedIntervals.end( ) );
+
+    std::vector< int > newSeeds;
+    for ( unsigned int i = 0; i < seedIntervals.size( ) && static_cast< int >( newSeeds.size( ) ) < maximumNumberOfNewSeeds; i++ ) {
+        newSeeds.push_back( ( ( seedIntervals.at( i ).lowerIndexOnOrbit + seedIntervals.at( i ).upperIndexOnOrbit ) / 2 ) %
+                            numberOfPointsOnPeriodicOrbit );
+    }
+    return newSeeds;
+}
+
+std::vector< int > getUniformSeeds( const int numberOfTrajectoriesPerManifold, const int numberOfPointsOnPeriodicOrbit )
+{
+    std::vector< int > uniformSeeds;
+    for ( int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < numberOfTrajectoriesPerManifold; trajectoryOnManifoldNumber++ ) {
+        uniformSeeds.push_back( static_cast< int >( std::floor( static_cast< double >( trajectoryOnManifoldNumber ) * numberOfPointsOnPeriodicOrbit /
+                                                                numberOfTrajectoriesPerManifold ) ) );
+    }
+    return uniformSeeds;
+}
+
+}
+
+void computeManifoldStatesAtThetaForSeeds( ManifoldStatesAtSection& manifoldStatesAtTheta, const RefinedPeriodicOrbit& periodicOrbit,
+                                           const std::vector< int >& indicesOnOrbit, const double massParameter,
+                                           const double displacementFromOrbitSign, const double integrationTimeDirection,
+                                           const double thetaStoppingAngle, const double eigenvectorDisplacementFromOrbit,
+                                           const double maximumIntegrationTimeManifoldTrajectories,
+                                           const double maxEigenvalueDeviation,
+                                           const ManifoldTerminationSettings& terminationSettings )
+{
+    computeManifoldStatesAtSectionForSeeds( manifoldStatesAtTheta, periodicOrbit, indicesOnOrbit, massParameter, displacementFromOrbitSign,
+                                            integrationTimeDirection, getThetaSection( thetaStoppingAngle, massParameter ),
+                                            eigenvectorDisplacementFromOrbit, maximumIntegrationTimeManifoldTrajectories,
+                                            maxEigenvalueDeviation, terminationSettings );
+}
+
+void computeManifoldStatesAtSectionForSeeds( ManifoldStatesAtSection& manifoldStatesAtSection, const RefinedPeriodicOrbit& periodicOrbit,
+                                             const std::vector< int >& indicesOnOrbit, const double massParameter,
+                                             const double displacementFromOrbitSign, const double integrationTimeDirection,
+                                             const PoincareSection& poincareSection, const double eigenvectorDisplacementFromOrbit,
+                                             const double maximumIntegrationTimeManifoldTrajectories,
+                                             const double maxEigenvalueDeviation,
+                                             const ManifoldTerminationSettings& terminationSettings )
+{
+    double offsetSign;
+    Eigen::VectorXd monodromyMatrixEigenvector;
+    if ( !determineManifoldEigenvectorAtTheta( periodicOrbit, displacementFromOrbitSign, integrationTimeDirection,
+                                               monodromyMatrixEigenvector, offsetSign, maxEigenvalueDeviation ) ) {
+        throw std::runtime_error( "No real stable/unstable eigenvalue pair of the monodromy matrix at C = " +
+                                  std::to_string( periodicOrbit.jacobiEnergy ) );
+    }
+
+    TrajectorySetBuilder trajectoryStateHistoryBuilder( indicesOnOrbit.size( ) );
+
+    std::vector< ManifoldTerminationReason > terminationReasons( indicesOnOrbit.size( ) );
+
+    // Only the initial and final state of each trajectory are stored
+    runManifoldTrajectoryTasks( indicesOnOrbit.size( ), [&]( const int seedNumber ) {
+        trajectoryStateHistoryBuilder.computeTrajectory( seedNumber, [&]( TrajectoryBuffer& trajectoryStateHistory ) {
+            terminationReasons.at( seedNumber ) = computeManifoldTrajectoryAtSection(
+                        trajectoryStateHistory,
+                        periodicOrbit.stateTransitionMatrixHistory.getStateVectorInclSTM( indicesOnOrbit.at( seedNumber ) ),
+                        monodromyMatrixEigenvector, offsetSign, integrationTimeDirection, poincareSection,
+                        periodicOrbit.jacobiEnergy, massParameter, eigenvectorDisplacementFromOrbit,
+                        std::numeric_limits< int >::max( ), maximumIntegrationTimeManifoldTrajectories,
+                        terminationSettings );
+        } );
+    } );
+
+    // The state at the section is the last state in integration direction; seeds that did not reach it are left out
+    for ( unsigned int seedNumber = 0; seedNumber < indicesOnOrbit.size( ); seedNumber++ ) {
+        if ( terminationReasons.at( seedNumber ) != poincare_section_termination ) {
+            continue;
+        }
+        const TrajectoryView trajectoryStateHistory = trajectoryStateHistoryBuilder.getTrajectory( seedNumber );
+        if ( integrationTimeDirection > 0.0 ) {
+            manifoldStatesAtSection[ indicesOnOrbit.at( seedNumber ) ] = std::make_pair( trajectoryStateHistory.getFinalTime( ),
+                                                                                       trajectoryStateHistory.getFinalState( ) );
+        } else {
+            manifoldStatesAtSection[ indicesOnOrbit.at( seedNumber ) ] = std::make_pair( trajectoryStateHistory.getTime( 0 ),
+                                                                                       trajectoryStateHistory.getState( 0 ) );
+        }
+    }
+}
+
+Eigen::MatrixXd findMinimumImpulseManifoldConnectionAdaptively( const RefinedPeriodicOrbit& periodicOrbitL1,
+                                                                const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                                const double thetaStoppingAngle, const double massParameter,
+                                                                const int initialNumberOfTrajectoriesPerManifold,
+                                                                const double minimumImpulseTolerance,
+                                                                const int maximumNumberOfTrajectoriesPerManifold,
+                                                                const double sectionStateSeparationTolerance,
+                                                                const double maximumVelocityDiscrepancy,
+                                                                const double eigenvectorDisplacementFromOrbit,
+                                                                const double maximumIntegrationTimeManifoldTrajectories,
+                                                                const double maxEigenvalueDeviation,
+                                                                const ManifoldTerminationSettings& terminationSettings )
+{
+    const int numberOfPointsOnOrbitL1 = periodicOrbitL1.stateTransitionMatrixHistory.size( );
+    const int numberOfPointsOnOrbitL2 = periodicOrbitL2.stateTransitionMatrixHistory.size( );
+
+    ManifoldStatesAtSection unstableManifoldStatesAtTheta;
+    ManifoldStatesAtSection stableManifoldStatesAtTheta;
+    std::vector< int > newUnstableSeeds = getUniformSeeds( initialNumberOfTrajectoriesPerManifold, numberOfPointsOnOrbitL1 );
+    std::vector< int > newStableSeeds   = getUniformSeeds( initialNumberOfTrajectoriesPerManifold, numberOfPointsOnOrbitL2 );
+    std::set< int > propagatedUnstableSeeds;
+    std::set< int > propagatedStableSeeds;
+
+    Eigen::MatrixXd minimumImpulseStateVectorsAtPoincare = Eigen::MatrixXd::Zero(2, 8);
+    double previousMinimumDeltaPosition = std::numeric_limits< double >::infinity( );
+    double previousMinimumDeltaVelocity = std::numeric_limits< double >::infinity( );
+    bool previousConnectionFound        = false;
+    int refinementNumber = 0;
+    int numberOfStableRefinements = 0;
+
+    while ( !newUnstableSeeds.empty( ) || !newStableSeeds.empty( ) ) {
+        propagatedUnstableSeeds.insert( newUnstableSeeds.begin( ), newUnstableSeeds.end( ) );
+        propagatedStableSeeds.insert( newStableSeeds.begin( ), newStableSeeds.end( ) );
+
+        // Exterior unstable manifold departing from L1, interior stable manifold arriving at L2
+        computeManifoldStatesAtThetaForSeeds( unstableManifoldStatesAtTheta, periodicOrbitL1, newUnstableSeeds, massParameter,
+                                              1.0, 1.0, thetaStoppingAngle, eigenvectorDisplacementFromOrbit,
+                                              maximumIntegrationTimeManifoldTrajectories, maxEigenvalueDeviation, terminationSettings );
+        computeManifoldStatesAtThetaForSeeds( stableManifoldStatesAtTheta, periodicOrbitL2, newStableSeeds, massParameter,
+                                              -1.0, -1.0, thetaStoppingAngle, eigenvectorDisplacementFromOrbit,
+                                              maximumIntegrationTimeManifoldTrajectories, maxEigenvalueDeviation, terminationSettings );
+
+        // Minimum position discrepancy over all pairs within the velocity discrepancy, from the same search as the front
+        std::vector< double > unstableStatesAtTheta;
+        std::vector< ManifoldStatesAtSection::const_iterator > unstableStateIterators;
+        for ( auto it = unstableManifoldStatesAtTheta.begin( ); it != unstableManifoldStatesAtTheta.end( ); ++it ) {
+            unstableStatesAtTheta.insert( unstableStatesAtTheta.end( ), it->second.second.data( ), it->second.second.data( ) + 6 );
+            unstableStateIterators.push_back( it );
+        }
+        std::vector< double > stableStatesAtTheta;
+        std::vector< ManifoldStatesAtSection::const_iterator > stableStateIterators;
+        for ( auto it = stableManifoldStatesAtTheta.begin( ); it != stableManifoldStatesAtTheta.end( ); ++it ) {
+            stableStatesAtTheta.insert( stableStatesAtTheta.end( ), it->second.second.data( ), it->second.second.data( ) + 6 );
+            stableStateIterators.push_back( it );
+        }
+        const ManifoldConnectionFront connectionFront = computeManifoldConnectionFront( stableStatesAtTheta, unstableStatesAtTheta, 1,
+                                                                                        maximumVelocityDiscrepancy );
+
+        // Without any pair within the velocity discrepancy, every interval is refined on its section state separation only
+        const bool connectionFound  = !connectionFront.topCandidates.empty( );
+        double minimumDeltaPosition = std::numeric_limits< double >::infinity( );
+        double minimumDeltaVelocity = std::numeric_limits< double >::infinity( );
+        if ( connectionFound ) {
+            const ManifoldConnectionCandidate& minimumImpulseConnection = connectionFront.topCandidates.front( );
+            const ManifoldStatesAtSection::const_iterator stableState   = stableStateIterators.at( minimumImpulseConnection.stableTrajectoryNumber );
+            const ManifoldStatesAtSection::const_iterator unstableState = unstableStateIterators.at( minimumImpulseConnection.unstableTrajectoryNumber );
+            minimumDeltaPosition = minimumImpulseConnection.deltaPosition;
+            minimumDeltaVelocity = minimumImpulseConnection.deltaVelocity;
+
+            minimumImpulseStateVectorsAtPoincare( 0, 0 ) = static_cast< double >( stableState->first ) / numberOfPointsOnOrbitL2;
+            minimumImpulseStateVectorsAtPoincare( 0, 1 ) = stableState->second.first;
+            minimumImpulseStateVectorsAtPoincare.block( 0, 2, 1, 6 ) = stableState->second.second.transpose( );
+            minimumImpulseStateVectorsAtPoincare( 1, 0 ) = static_cast< double >( unstableState->first ) / numberOfPointsOnOrbitL1;
+            minimumImpulseStateVectorsAtPoincare( 1, 1 ) = unstableState->second.first;
+            minimumImpulseStateVectorsAtPoincare.block( 1, 2, 1, 6 ) = unstableState->second.second.transpose( );
+        }
+
+        std::cout << "Adaptive seeding at theta = " << thetaStoppingAngle << ", refinement " << refinementNumber << ": "
+                  << unstableManifoldStatesAtTheta.size( ) << " (W_U) and " << stableManifoldStatesAtTheta.size( ) << " (W_S) trajectories, "
+                  << "deltaR = " << minimumDeltaPosition << ", deltaV = " << minimumDeltaVelocity << std::endl;
+
+        // Converged when the optimum (or the absence of one) no longer changes over two consecutive refinements of the seeds
+        const bool optimumUnchanged = refinementNumber > 0 && connectionFound == previousConnectionFound &&
+                ( !connectionFound || ( std::abs( minimumDeltaPosition - previousMinimumDeltaPosition ) < minimumImpulseTolerance &&
+                                        std::abs( minimumDeltaVelocity - previousMinimumDeltaVelocity ) < minimumImpulseTolerance ) );
+        if ( optimumUnchanged ) {
+            numberOfStableRefinements++;
+            if ( numberOfStableRefinements >= 2 ) {
+                break;
+            }
+        } else {
+            numberOfStableRefinements = 0;
+        }
+        previousConnectionFound      = connectionFound;
+        previousMinimumDeltaPosition = minimumDeltaPosition;
+        previousMinimumDeltaVelocity = minimumDeltaVelocity;
+        refinementNumber++;
+
+        newUnstableSeeds = selectNewSeeds( unstableManifoldStatesAtTheta, stableManifoldStatesAtTheta, propagatedUnstableSeeds, numberOfPointsOnOrbitL1,
+                                           minimumDeltaPosition, sectionStateSeparationTolerance, maximumVelocityDiscrepancy,
+                                           maximumNumberOfTrajectoriesPerManifold - static_cast< int >( propagatedUnstableSeeds.size( ) ) );
+        newStableSeeds   = selectNewSeeds( stableManifoldStatesAtTheta, unstableManifoldStatesAtTheta, propagatedStableSeeds, numberOfPointsOnOrbitL2,
+                                           minimumDeltaPosition, sectionStateSeparationTolerance, maximumVelocityDiscrepancy,
+                                           maximumNumberOfTrajectoriesPerManifold - static_cast< int >( propagatedStableSeeds.size( ) ) );
+    }
+
+    std::cout << "Minimum impulse connection at theta = " << thetaStoppingAngle << ":\n" << minimumImpulseStateVectorsAtPoincare << std::endl;
+    return minimumImpulseStateVectorsAtPoincare;
+}
+
+Eigen::MatrixXd connectManifoldsAtThetaAdaptively( const std::string orbitType, const double thetaStoppingAngle,
+                                                   const double desiredJacobiEnergy, const double massParameter,
+                                                   const int initialNumberOfTrajectoriesPerManifold,
+                                                   const double minimumImpulseTolerance,
+                                                   const int maximumNumberOfTrajectoriesPerManifold,
+                                                   const double sectionStateSeparationTolerance,
+                                                   const double maximumVelocityDiscrepancy,
+                                                   const double eigenvectorDisplacementFromOrbit,
+                                                   const double maximumIntegrationTimeManifoldTrajectories,
+                                                   const double maxEigenvalueDeviation,
+                                                   const ManifoldTerminationSettings& terminationSettings )
+{
+    // Set output maximum precision
+    std::cout.precision(std::numeric_limits<double>::digits10);
+
+    int orbitOneL1;
+    int orbitTwoL1;
+    int orbitOneL2;
+    int orbitTwoL2;
+    getOrbitIdsForConnectionAtTheta( orbitType, orbitOneL1, orbitTwoL1, orbitOneL2, orbitTwoL2 );
+
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbitL1 = getRefinedPeriodicOrbit( 1, orbitType, desiredJacobiEnergy,
+                                                                                             orbitOneL1, orbitTwoL1, massParameter );
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbitL2 = getRefinedPeriodicOrbit( 2, orbitType, desiredJacobiEnergy,
+                                                                                             orbitOneL2, orbitTwoL2, massParameter );
+
+    return findMinimumImpulseManifoldConnectionAdaptively( *periodicOrbitL1, *periodicOrbitL2, thetaStoppingAngle, massParameter,
+                                                           initialNumberOfTrajectoriesPerManifold, minimumImpulseTolerance,
+                                                           maximumNumberOfTrajectoriesPerManifold, sectionStateSeparationTolerance,
+                                                           maximumVelocityDiscrepancy, eigenvectorDisplacementFromOrbit,
+                                                           maximumIntegrationTimeManifoldTrajectories, maxEigenvalueDeviation,
+                                                           terminationSettings );
+}
@@ -0,0 +1,74 @@
+#ifndef TUDATBUNDLE_ADAPTIVEMANIFOLDSEEDING_H
+#define TUDATBUNDLE_ADAPTIVEMANIFOLDSEEDING_H
+
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+#include "manifoldTermination.h"
+#include "poincareSection.h"
+#include "refinedPeriodicOrbitCache.h"
+
+// Time and state at the Poincaré section per seed that reached it, keyed by the index of the seed on the periodic orbit
+typedef std::map< int, std::pair< double, Eigen::Vector6d > > ManifoldStatesAtSection;
+
+void computeManifoldStatesAtThetaForSeeds( ManifoldStatesAtSection& manifoldStatesAtTheta, const RefinedPeriodicOrbit& periodicOrbit,
+                                           const std::vector< int >& indicesOnOrbit, const double massParameter,
+                                           const double displacementFromOrbitSign, const double integrationTimeDirection,
+                                           const double thetaStoppingAngle, const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                           const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                           const double maxEigenvalueDeviation = 1.0E-3,
+                                           const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+// Same, up to the first crossing of any section instead of the angle thetaStoppingAngle about the Moon. Both throw
+// std::runtime_error if the monodromy matrix of periodicOrbit has no real stable/unstable eigenvalue pair.
+void computeManifoldStatesAtSectionForSeeds( ManifoldStatesAtSection& manifoldStatesAtSection, const RefinedPeriodicOrbit& periodicOrbit,
+                                             const std::vector< int >& indicesOnOrbit, const double massParameter,
+                                             const double displacementFromOrbitSign, const double integrationTimeDirection,
+                                             const PoincareSection& poincareSection, const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                             const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                             const double maxEigenvalueDeviation = 1.0E-3,
+                                             const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+// Minimum impulse connection between the unstable manifold of periodicOrbitL1 and the stable manifold of
+// periodicOrbitL2 at theta, starting from initialNumberOfTrajectoriesPerManifold uniformly spaced seeds per manifold.
+// New seeds are inserted between neighbours whose section states are further apart than sectionStateSeparationTolerance
+// and between neighbours whose interpolated section curve passes a crossing of the other manifold at least as closely as
+// the current optimum, until deltaR and deltaV of the optimum
+// change less than minimumImpulseTolerance over two consecutive refinements (or maximumNumberOfTrajectoriesPerManifold seeds,
+// including those that did not reach the section, have been propagated).
+// The optimum is the pair connectManifoldsAtTheta selects, the minimum deltaR under maximumVelocityDiscrepancy.
+// eigenvectorDisplacementFromOrbit, maximumIntegrationTimeManifoldTrajectories and maxEigenvalueDeviation are passed on to
+// the propagation of the seeds.
+// Output has the layout of connectManifoldsAtTheta, with the phase taken as index / points on the orbit.
+Eigen::MatrixXd findMinimumImpulseManifoldConnectionAdaptively( const RefinedPeriodicOrbit& periodicOrbitL1,
+                                                                const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                                const double thetaStoppingAngle, const double massParameter,
+                                                                const int initialNumberOfTrajectoriesPerManifold = 100,
+                                                                const double minimumImpulseTolerance = 1.0E-6,
+                                                                const int maximumNumberOfTrajectoriesPerManifold = 5000,
+                                                                const double sectionStateSeparationTolerance = 5.0E-2,
+                                                                const double maximumVelocityDiscrepancy = 0.5,
+                                                                const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                                                const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                                                const double maxEigenvalueDeviation = 1.0E-3,
+                                                                const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+Eigen::MatrixXd connectManifoldsAtThetaAdaptively( const std::string orbitType, const double thetaStoppingAngle,
+                                                   const double desiredJacobiEnergy, const double massParameter,
+                                                   const int initialNumberOfTrajectoriesPerManifold = 100,
+                                                   const double minimumImpulseTolerance = 1.0E-6,
+                                                   const int maximumNumberOfTrajectoriesPerManifold = 5000,
+                                                   const double sectionStateSeparationTolerance = 5.0E-2,
+                                                   const double maximumVelocityDiscrepancy = 0.5,
+                                                   const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                                   const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                                   const double maxEigenvalueDeviation = 1.0E-3,
+                                                   const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+#endif  // TUDATBUNDLE_ADAPTIVEMANIFOLDSEEDING_H
@@ -24,7 +24,7 @@ Eigen::VectorXd applyDifferentialCorrection(const int librationPointNr, const st
     initialStateVectorInclSTM.block( 0, 0, 6, 1 ) = initialStateVector;
     initialStateVectorInclSTM.block( 0, 1, 6, 6 ).setIdentity( );
 
-    std::map< double, Eigen::Vector6d > stateHistory;
+    TrajectoryBuffer stateHistory;
 
     std::pair< Eigen::MatrixXd, double > halfPeriodState = propagateOrbitToFinalCondition(
                 initialStateVectorInclSTM, massParameter, orbitalPeriod / 2.0, 1.0, stateHistory, -1, 0.0 );
@@ -144,3 +144,104 @@ Eigen::VectorXd applyDifferentialCorrection(const int librationPointNr, const st
 
     return outputVector;
 }
+
+Eigen::VectorXd applyFixedEnergyDifferentialCorrection( const int librationPointNr, const std::string& orbitType,
+                                                        const Eigen::VectorXd& initialStateVector,
+                                                        double orbitalPeriod, const double desiredJacobiEnergy,
+                                                        const double massParameter,
+                                                        double maxPositionDeviationFromPeriodicOrbit,
+                                                        double maxVelocityDeviationFromPeriodicOrbit,
+                                                        double maxJacobiEnergyDeviation, bool& converged,
+                                                        const int maxNumberOfIterations )
+{
+    std::cout << "\nApply fixed energy differential correction (C = " << desiredJacobiEnergy << "):" << std::endl;
+
+    Eigen::MatrixXd initialStateVectorInclSTM = getFullInitialState( initialStateVector );
+
+    TrajectoryBuffer stateHistory;
+    Eigen::MatrixXd stateVectorInclSTM;
+    Eigen::VectorXd stateVectorOnly;
+    double currentTime;
+
+    // Initialize variables
+    Eigen::VectorXd differentialCorrection(7);
+    Eigen::VectorXd outputVector(15);
+    double positionDeviationFromPeriodicOrbit;
+    double velocityDeviationFromPeriodicOrbit;
+    double jacobiEnergyDeviation;
+
+    int numberOfIterations = 0;
+    converged = false;
+    while ( true )
+    {
+        std::pair< Eigen::MatrixXd, double > halfPeriodState = propagateOrbitToFinalCondition(
+                    initialStateVectorInclSTM, massParameter, orbitalPeriod / 2.0, 1.0, stateHistory, -1, 0.0 );
+        stateVectorInclSTM = halfPeriodState.first;
+        currentTime        = halfPeriodState.second;
+        stateVectorOnly    = stateVectorInclSTM.block( 0, 0, 6, 1 );
+
+        if (orbitType == "axial")
+        {
+            // Initial condition for axial family should be [x, 0, 0, 0, ydot, zdot]
+            positionDeviationFromPeriodicOrbit = sqrt(pow(stateVectorOnly(1), 2) + pow(stateVectorOnly(2), 2));
+            velocityDeviationFromPeriodicOrbit = sqrt(pow(stateVectorOnly(3), 2));
+        }
+        else
+        {
+            // Initial condition for other families should be [x, 0, y, 0, ydot, 0]
+            positionDeviationFromPeriodicOrbit = sqrt(pow(stateVectorOnly(1), 2));
+            velocityDeviationFromPeriodicOrbit = sqrt(pow(stateVectorOnly(3), 2) + pow(stateVectorOnly(5), 2));
+        }
+        jacobiEnergyDeviation = std::abs( tudat::gravitation::computeJacobiEnergy(
+                                              massParameter, initialStateVectorInclSTM.block( 0, 0, 6, 1 ) ) - desiredJacobiEnergy );
+
+        std::cout << "positionDeviationFromPeriodicOrbit: " << positionDeviationFromPeriodicOrbit << std::endl
+                  << "velocityDeviationFromPeriodicOrbit: " << velocityDeviationFromPeriodicOrbit << std::endl
+                  << "jacobiEnergyDeviation: "              << jacobiEnergyDeviation              << "\n" << std::endl;
+
+        if ( positionDeviationFromPeriodicOrbit <= maxPositionDeviationFromPeriodicOrbit and
+             velocityDeviationFromPeriodicOrbit <= maxVelocityDeviationFromPeriodicOrbit and
+             jacobiEnergyDeviation <= maxJacobiEnergyDeviation )
+        {
+            converged = true;
+            break;
+        }
+
+        // Stop at the last iterate if the Newton iteration does not converge, so that the caller can fall back on another method
+        if ( numberOfIterations >= maxNumberOfIterations )
+        {
+            std::cout << "\nFIXED ENERGY DIFFERENTIAL CORRECTION DID NOT CONVERGE (L" << librationPointNr << " " << orbitType << ")\n" << std::endl;
+            break;
+        }
+
+        // Apply differential correction on the state and half period simultaneously, including the energy constraint
+        differentialCorrection = computeFixedEnergyDifferentialCorrection( orbitType, initialStateVectorInclSTM.block( 0, 0, 6, 1 ),
+                                                                           stateVectorInclSTM, desiredJacobiEnergy, massParameter );
+
+        initialStateVectorInclSTM.block( 0, 0, 6, 1 ) += differentialCorrection.segment( 0, 6 );
+        orbitalPeriod  = orbitalPeriod + 2.0 * differentialCorrection( 6 );
+        numberOfIterations += 1;
+    }
+
+    if ( converged )
+    {
+        double jacobiEnergyHalfPeriod       = tudat::gravitation::computeJacobiEnergy(massParameter, stateVectorOnly);
+        double jacobiEnergyInitialCondition = tudat::gravitation::computeJacobiEnergy(massParameter, initialStateVectorInclSTM.block( 0, 0, 6, 1 ));
+
+        std::cout << "\nCorrected initial state vector:" << std::endl << initialStateVectorInclSTM.block( 0, 0, 6, 1 )        << std::endl
+                  << "\nwith orbital period: "           << orbitalPeriod                                              << std::endl
+                  << "||J(0) - C|| = "                   << std::abs(jacobiEnergyInitialCondition - desiredJacobiEnergy)    << std::endl
+                  << "||J(0) - J(T/2|| = "               << std::abs(jacobiEnergyInitialCondition - jacobiEnergyHalfPeriod) << std::endl
+                  << "||T/2 - t|| = "                    << std::abs(orbitalPeriod/2.0 - currentTime) << "\n"               << std::endl;
+    }
+
+    // The output vector has the same layout as the output of applyDifferentialCorrection, holding the last iterate if the
+    // correction did not converge
+    outputVector.segment(0,6)    = initialStateVectorInclSTM.block( 0, 0, 6, 1 );
+    outputVector(6)              = orbitalPeriod;
+    outputVector.segment(7,6)    = stateVectorOnly;
+    outputVector(13)             = currentTime;
+    outputVector(14)             = numberOfIterations;
+
+    return outputVector;
+}
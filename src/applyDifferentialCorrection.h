@@ -13,5 +13,14 @@ Eigen::VectorXd applyDifferentialCorrection( const int librationPointNr, const s
                                              double maxVelocityDeviationFromPeriodicOrbit,
                                              const int maxNumberOfIterations = 1000 );
 
+Eigen::VectorXd applyFixedEnergyDifferentialCorrection( const int librationPointNr, const std::string& orbitType,
+                                                        const Eigen::VectorXd& initialStateVector,
+                                                        double orbitalPeriod, const double desiredJacobiEnergy,
+                                                        const double massParameter,
+                                                        double maxPositionDeviationFromPeriodicOrbit,
+                                                        double maxVelocityDeviationFromPeriodicOrbit,
+                                                        double maxJacobiEnergyDeviation, bool& converged,
+                                                        const int maxNumberOfIterations = 50 );
+
 
 #endif  // TUDATBUNDLE_APPLYDIFFERENTIALCORRECTION_H
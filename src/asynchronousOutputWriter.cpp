@@ -0,0 +1,99 @@
+#include <iostream>
+
+#include "asynchronousOutputWriter.h"
+
+AsynchronousOutputWriter::AsynchronousOutputWriter( const unsigned int maximumNumberOfPendingWrites,
+                                                    const unsigned int numberOfWriterThreads ) :
+    maximumNumberOfPendingWrites_( maximumNumberOfPendingWrites > 0 ? maximumNumberOfPendingWrites : 1 ),
+    numberOfActiveWrites_( 0 ), stopRequested_( false )
+{
+    for ( unsigned int i = 0; i < ( numberOfWriterThreads > 0 ? numberOfWriterThreads : 1 ); i++ ) {
+        writerThreads_.push_back( std::thread( &AsynchronousOutputWriter::processWriteTasks, this ) );
+    }
+}
+
+AsynchronousOutputWriter::~AsynchronousOutputWriter( )
+{
+    // Drain the queue before the writer threads are stopped, no output is discarded
+    {
+        std::lock_guard< std::mutex > lock( queueMutex_ );
+        stopRequested_ = true;
+    }
+    queueNotEmpty_.notify_all( );
+    for ( unsigned int i = 0; i < writerThreads_.size( ); i++ ) {
+        writerThreads_.at( i ).join( );
+    }
+
+    if ( firstWriteException_ ) {
+        std::cerr << "Asynchronous output writer: a write task failed and its output may be incomplete" << std::endl;
+    }
+}
+
+void AsynchronousOutputWriter::enqueue( const std::function< void( ) >& writeTask )
+{
+    {
+        std::unique_lock< std::mutex > lock( queueMutex_ );
+        queueNotFull_.wait( lock, [this]( ){ return pendingWrites_.size( ) < maximumNumberOfPendingWrites_; } );
+        pendingWrites_.push_back( writeTask );
+    }
+    queueNotEmpty_.notify_one( );
+}
+
+void AsynchronousOutputWriter::waitUntilFinished( )
+{
+    std::unique_lock< std::mutex > lock( queueMutex_ );
+    queueFinished_.wait( lock, [this]( ){ return pendingWrites_.empty( ) && numberOfActiveWrites_ == 0; } );
+
+    if ( firstWriteException_ ) {
+        std::exception_ptr writeException = firstWriteException_;
+        firstWriteException_ = std::exception_ptr( );
+        std::rethrow_exception( writeException );
+    }
+}
+
+void AsynchronousOutputWriter::processWriteTasks( )
+{
+    while ( true ) {
+        std::function< void( ) > writeTask;
+        {
+            std::unique_lock< std::mutex > lock( queueMutex_ );
+            queueNotEmpty_.wait( lock, [this]( ){ return stopRequested_ || !pendingWrites_.empty( ); } );
+            if ( pendingWrites_.empty( ) ) {
+                return;
+            }
+            writeTask = std::move( pendingWrites_.front( ) );
+            pendingWrites_.pop_front( );
+            numberOfActiveWrites_++;
+        }
+        queueNotFull_.notify_one( );
+
+        try {
+            writeTask( );
+        }
+        catch( ... ) {
+            std::lock_guard< std::mutex > lock( queueMutex_ );
+            if ( !firstWriteException_ ) {
+                firstWriteException_ = std::current_exception( );
+            }
+        }
+
+        // Release the task (and with it the history it owns) before reporting it as finished
+        writeTask = std::function< void( ) >( );
+        {
+            std::lock_guard< std::mutex > lock( queueMutex_ );
+            numberOfActiveWrites_--;
+        }
+        queueFinished_.notify_all( );
+    }
+}
+
+AsynchronousOutputWriter& getAsynchronousOutputWriter( )
+{
+    static AsynchronousOutputWriter asynchronousOutputWriter;
+    return asynchronousOutputWriter;
+}
+
+void waitForPendingOutput( )
+{
+    getAsynchronousOutputWriter( ).waitUntilFinished( );
+}
@@ -0,0 +1,53 @@
+#ifndef TUDATBUNDLE_ASYNCHRONOUSOUTPUTWRITER_H
+#define TUDATBUNDLE_ASYNCHRONOUSOUTPUTWRITER_H
+
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Bounded queue of write tasks that are formatted and flushed by dedicated writer threads. Compute threads hand over
+// ownership of finished histories (moved into the task) and continue integrating; enqueue( ) blocks while the queue is
+// full, so output that can not keep up throttles the producers instead of growing memory without bound.
+class AsynchronousOutputWriter
+{
+public:
+    AsynchronousOutputWriter( const unsigned int maximumNumberOfPendingWrites = 8, const unsigned int numberOfWriterThreads = 1 );
+
+    ~AsynchronousOutputWriter( );
+
+    void enqueue( const std::function< void( ) >& writeTask );
+
+    // Blocks until every enqueued task has been written; rethrows the first exception raised by a write task
+    void waitUntilFinished( );
+
+private:
+    AsynchronousOutputWriter( const AsynchronousOutputWriter& );
+    AsynchronousOutputWriter& operator=( const AsynchronousOutputWriter& );
+
+    void processWriteTasks( );
+
+    const unsigned int maximumNumberOfPendingWrites_;
+
+    std::mutex queueMutex_;
+    std::condition_variable queueNotFull_;
+    std::condition_variable queueNotEmpty_;
+    std::condition_variable queueFinished_;
+    std::deque< std::function< void( ) > > pendingWrites_;
+    unsigned int numberOfActiveWrites_;
+    bool stopRequested_;
+    std::exception_ptr firstWriteException_;
+
+    std::vector< std::thread > writerThreads_;
+};
+
+// Process-wide writer shared by all output routines
+AsynchronousOutputWriter& getAsynchronousOutputWriter( );
+
+void waitForPendingOutput( );
+
+#endif  // TUDATBUNDLE_ASYNCHRONOUSOUTPUTWRITER_H
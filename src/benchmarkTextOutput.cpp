@@ -0,0 +1,95 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "textOutput.h"
+
+// Throughput of the text writers: the iostream formatting with std::setw and std::endl that the writers used before, and
+// TextTableWriter, on rows of manifold states (7 columns) and of initial conditions (44 columns). Both files are compared
+// byte by byte. Run from any directory; the files are written to the working directory and removed afterwards.
+
+namespace
+{
+
+std::string readFile( const std::string& fileName )
+{
+    std::ifstream textFile( fileName.c_str( ), std::ios::binary );
+    return std::string( ( std::istreambuf_iterator< char >( textFile ) ), std::istreambuf_iterator< char >( ) );
+}
+
+void benchmarkTable( const std::string& tableName, const std::vector< double >& values, const int numberOfColumns,
+                     const int precision )
+{
+    const int numberOfRows = static_cast< int >( values.size( ) ) / numberOfColumns;
+    const std::string iostreamFileName = "benchmarkTextOutput_iostream.txt";
+    const std::string tableWriterFileName = "benchmarkTextOutput_tableWriter.txt";
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now( );
+    {
+        std::ofstream textFile( iostreamFileName.c_str( ) );
+        textFile.precision( precision );
+        for ( int rowNumber = 0; rowNumber < numberOfRows; rowNumber++ ) {
+            textFile << std::left << std::scientific;
+            for ( int columnNumber = 0; columnNumber < numberOfColumns; columnNumber++ ) {
+                textFile << std::setw( 25 ) << values[ rowNumber * numberOfColumns + columnNumber ];
+            }
+            textFile << std::endl;
+        }
+    }
+    const double iostreamSeconds = std::chrono::duration< double >( std::chrono::steady_clock::now( ) - startTime ).count( );
+
+    startTime = std::chrono::steady_clock::now( );
+    {
+        TextTableWriter textFile( tableWriterFileName, precision );
+        for ( int rowNumber = 0; rowNumber < numberOfRows; rowNumber++ ) {
+            textFile.appendRow( values.data( ) + rowNumber * numberOfColumns, numberOfColumns );
+        }
+        textFile.close( );
+    }
+    const double tableWriterSeconds = std::chrono::duration< double >( std::chrono::steady_clock::now( ) - startTime ).count( );
+
+    const std::string iostreamText = readFile( iostreamFileName );
+    const bool identicalFiles = ( iostreamText == readFile( tableWriterFileName ) );
+    std::remove( iostreamFileName.c_str( ) );
+    std::remove( tableWriterFileName.c_str( ) );
+
+    const double megabytes = iostreamText.size( ) / 1.0E6;
+    std::cout << tableName << ": " << numberOfRows << " rows, " << megabytes << " MB" << std::endl
+              << "    iostream with std::endl: " << megabytes / iostreamSeconds << " MB/s" << std::endl
+              << "    TextTableWriter:         " << megabytes / tableWriterSeconds << " MB/s ("
+              << iostreamSeconds / tableWriterSeconds << "x)" << std::endl
+              << "    files identical:         " << ( identicalFiles ? "yes" : "NO" ) << std::endl;
+}
+
+}
+
+int main( )
+{
+    std::mt19937_64 randomNumberGenerator( 42 );
+    std::uniform_real_distribution< double > stateDistribution( -1.5, 1.5 );
+    std::uniform_real_distribution< double > exponentDistribution( -12.0, 3.0 );
+
+    // Manifold states: time and state with values of order one
+    std::vector< double > manifoldStates( 7 * 400000 );
+    for ( unsigned int valueNumber = 0; valueNumber < manifoldStates.size( ); valueNumber++ ) {
+        manifoldStates[ valueNumber ] = stateDistribution( randomNumberGenerator );
+    }
+    benchmarkTable( "Manifold states", manifoldStates, 7, 14 );
+
+    // Initial conditions incl. monodromy matrix, spanning many orders of magnitude
+    std::vector< double > initialConditions( 44 * 50000 );
+    for ( unsigned int valueNumber = 0; valueNumber < initialConditions.size( ); valueNumber++ ) {
+        initialConditions[ valueNumber ] = stateDistribution( randomNumberGenerator ) *
+                std::pow( 10.0, exponentDistribution( randomNumberGenerator ) );
+    }
+    benchmarkTable( "Initial conditions", initialConditions, 44, 15 );
+
+    return 0;
+}
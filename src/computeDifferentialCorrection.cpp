@@ -1,7 +1,11 @@
 #include <Eigen/Core>
 #include <Eigen/LU>
+#include <cmath>
+#include <vector>
 #include <iostream>
 
+#include "Tudat/Astrodynamics/Gravitation/jacobiEnergy.h"
+
 #include "computeDifferentialCorrection.h"
 #include "stateDerivativeModel.h"
 
@@ -125,3 +129,91 @@ Eigen::VectorXd computeDifferentialCorrection( const int librationPointNr, const
     return differentialCorrection;
 
 }
+
+Eigen::VectorXd computeJacobiEnergyGradient( const Eigen::VectorXd& cartesianState, const double massParameter )
+{
+    // C = x^2 + y^2 + 2(1-mu)/r1 + 2mu/r2 - v^2, differentiated w.r.t. [x, y, z, xdot, ydot, zdot]
+    double distanceToPrimaryBody   = sqrt( (cartesianState(0) + massParameter) * (cartesianState(0) + massParameter) +
+                                           cartesianState(1) * cartesianState(1) + cartesianState(2) * cartesianState(2) );
+    double distanceToSecondaryBody = sqrt( (cartesianState(0) - 1.0 + massParameter) * (cartesianState(0) - 1.0 + massParameter) +
+                                           cartesianState(1) * cartesianState(1) + cartesianState(2) * cartesianState(2) );
+
+    double termRelatedToPrimaryBody   = 2.0 * (1.0 - massParameter) / (distanceToPrimaryBody * distanceToPrimaryBody * distanceToPrimaryBody);
+    double termRelatedToSecondaryBody = 2.0 * massParameter / (distanceToSecondaryBody * distanceToSecondaryBody * distanceToSecondaryBody);
+
+    Eigen::VectorXd jacobiEnergyGradient(6);
+    jacobiEnergyGradient(0) = 2.0 * cartesianState(0) - termRelatedToPrimaryBody * (cartesianState(0) + massParameter)
+                              - termRelatedToSecondaryBody * (cartesianState(0) - 1.0 + massParameter);
+    jacobiEnergyGradient(1) = 2.0 * cartesianState(1) - (termRelatedToPrimaryBody + termRelatedToSecondaryBody) * cartesianState(1);
+    jacobiEnergyGradient(2) = - (termRelatedToPrimaryBody + termRelatedToSecondaryBody) * cartesianState(2);
+    jacobiEnergyGradient.segment(3, 3) = -2.0 * cartesianState.segment(3, 3);
+
+    return jacobiEnergyGradient;
+}
+
+Eigen::VectorXd computeFixedEnergyDifferentialCorrection( const std::string& orbitType, const Eigen::VectorXd& initialStateVector,
+                                                          const Eigen::MatrixXd& cartesianStateWithStm,
+                                                          const double desiredJacobiEnergy, const double massParameter )
+{
+    // Initiate vectors, matrices etc.
+    Eigen::VectorXd cartesianState = cartesianStateWithStm.block( 0, 0, 6, 1 );
+    Eigen::MatrixXd stmPartOfStateVectorInMatrixForm = cartesianStateWithStm.block( 0, 1, 6, 6 );
+    Eigen::VectorXd cartesianStateDerivative = computeStateDerivative(0.0, cartesianStateWithStm).block(0,0,6,1);
+
+    // Select the free initial state components and the components which have to vanish at T/2:
+    // - horizontal: [x, 0, 0, 0, ydot, 0], correct {x, ydot, T/2} for {y, xdot} at T/2
+    // - axial:      [x, 0, 0, 0, ydot, zdot], correct {x, ydot, zdot, T/2} for {y, z, xdot} at T/2
+    // - otherwise:  [x, 0, z, 0, ydot, 0], correct {x, z, ydot, T/2} for {y, xdot, zdot} at T/2
+    // The Jacobi constant of the initial state closes the system, so x is no longer fixed and the energy is targeted directly.
+    std::vector< int > freeComponents;
+    std::vector< int > constrainedComponents;
+    if (orbitType == "horizontal")
+    {
+        freeComponents        = {0, 4};
+        constrainedComponents = {1, 3};
+    }
+    else if (orbitType == "axial")
+    {
+        freeComponents        = {0, 4, 5};
+        constrainedComponents = {1, 2, 3};
+    }
+    else
+    {
+        freeComponents        = {0, 2, 4};
+        constrainedComponents = {1, 3, 5};
+    }
+
+    const int numberOfConstraints = static_cast< int >( constrainedComponents.size( ) ) + 1;
+    Eigen::MatrixXd updateMatrix         = Eigen::MatrixXd::Zero( numberOfConstraints, numberOfConstraints );
+    Eigen::VectorXd multiplicationMatrix = Eigen::VectorXd::Zero( numberOfConstraints );
+
+    Eigen::VectorXd jacobiEnergyGradient = computeJacobiEnergyGradient( initialStateVector, massParameter );
+
+    for (unsigned int i = 0; i < constrainedComponents.size(); i++)
+    {
+        multiplicationMatrix(i) = cartesianState(constrainedComponents.at(i));
+        for (unsigned int j = 0; j < freeComponents.size(); j++)
+        {
+            updateMatrix(i, j) = stmPartOfStateVectorInMatrixForm(constrainedComponents.at(i), freeComponents.at(j));
+        }
+        updateMatrix(i, numberOfConstraints - 1) = cartesianStateDerivative(constrainedComponents.at(i));
+    }
+    multiplicationMatrix(numberOfConstraints - 1) = tudat::gravitation::computeJacobiEnergy(massParameter, initialStateVector) - desiredJacobiEnergy;
+    for (unsigned int j = 0; j < freeComponents.size(); j++)
+    {
+        updateMatrix(numberOfConstraints - 1, j) = jacobiEnergyGradient(freeComponents.at(j));
+    }
+
+    // Compute the necessary differential correction.
+    Eigen::VectorXd corrections = updateMatrix.fullPivLu().solve(multiplicationMatrix);
+
+    // Put corrections in correct format.
+    Eigen::VectorXd differentialCorrection = Eigen::VectorXd::Zero(7);
+    for (unsigned int j = 0; j < freeComponents.size(); j++)
+    {
+        differentialCorrection(freeComponents.at(j)) = -corrections(j);
+    }
+    differentialCorrection(6) = -corrections(numberOfConstraints - 1);
+
+    return differentialCorrection;
+}
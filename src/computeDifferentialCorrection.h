@@ -6,6 +6,12 @@
 Eigen::VectorXd computeDifferentialCorrection( const int librationPointNr, const std::string& orbitType,
                                                const Eigen::MatrixXd& cartesianStateWithStm, const bool xPositionFixed = false );
 
+Eigen::VectorXd computeJacobiEnergyGradient( const Eigen::VectorXd& cartesianState, const double massParameter );
+
+Eigen::VectorXd computeFixedEnergyDifferentialCorrection( const std::string& orbitType, const Eigen::VectorXd& initialStateVector,
+                                                          const Eigen::MatrixXd& cartesianStateWithStm,
+                                                          const double desiredJacobiEnergy, const double massParameter );
+
 
 
 #endif  // TUDATBUNDLE_COMPUTEDIFFERENTIALCORRECTION_H
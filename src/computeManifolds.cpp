@@ -10,14 +10,31 @@
 #include <math.h>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <atomic>
 #include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "Tudat/Astrodynamics/Gravitation/jacobiEnergy.h"
 #include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
 #include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
 
+#include "asynchronousOutputWriter.h"
+#include "numpyOutput.h"
+#include "orderedTrajectoryStream.h"
 #include "propagateOrbit.h"
 #include "computeManifolds.h"
+#include "poincareSection.h"
+#include "refinedPeriodicOrbitCache.h"
+#include "textOutput.h"
+#include "trajectoryArchive.h"
+#include "trajectoryReducers.h"
 
 
 void determineStableUnstableEigenvectors( Eigen::MatrixXd& monodromyMatrix, Eigen::Vector6d& stableEigenvector,
@@ -82,101 +99,147 @@ bool checkJacobiOnManifoldOutsideBounds( Eigen::MatrixXd& stateVectorInclSTM, do
     return jacobiDeviationOutsideBounds;
 }
 
-void reduceOvershootAtPoincareSectionU1U4( std::pair< Eigen::MatrixXd, double >& stateVectorInclSTMAndTime,
-                                           std::pair< Eigen::MatrixXd, double >& previousStateVectorInclSTMAndTime,
-                                           Eigen::MatrixXd& stateVectorInclSTM, double& currentTime, double& ySign,
-                                           int& integrationDirection, const double& massParameter )
+std::vector< PoincareSection > getManifoldPoincareSections( const int librationPointNr, const int manifoldNumber,
+                                                           const double massParameter )
 {
-    // TODO join together with reduceOvershootAtPoincareSectionU2U3
-    stateVectorInclSTMAndTime = previousStateVectorInclSTMAndTime;
-    stateVectorInclSTM        = stateVectorInclSTMAndTime.first;
-    currentTime               = stateVectorInclSTMAndTime.second;
-    std::cout << "||y|| = " << stateVectorInclSTM(1, 0) << ", at start of iterative procedure" << std::endl;
-
-    for ( int i = 5; i <= 12; i++ ) {
+    // U1 (L1) or U4 (L2): y = 0 at x < 0, for all manifolds
+    std::vector< PoincareSection > poincareSections;
+    poincareSections.push_back( createHyperplaneSection( librationPointNr == 1 ? "U1" : "U4", 1, 0.0, 0, -1.0 ) );
+
+    // U2, U3: x = 1 - mu, for the manifolds towards the Moon
+    if ( (librationPointNr == 1 && ( manifoldNumber == 0 || manifoldNumber == 2)) ||
+         (librationPointNr == 2 && ( manifoldNumber == 1 || manifoldNumber == 3)) ) {
+        poincareSections.push_back( createHyperplaneSection( "U2U3", 0, 1.0 - massParameter ) );
+    }
+    return poincareSections;
+}
 
-        double initialStepSize = pow(10,(static_cast<float>(-i)));
-        double maximumStepSize = pow(10,(static_cast<float>(-i) + 1.0));
+ManifoldStateHistoryWriter::ManifoldStateHistoryWriter( const int numberOfTrajectoriesPerManifold, const int orbitNumber,
+                                                        const int librationPointNr, const std::string& orbitType ):
+    numberOfTrajectoriesPerManifold_( numberOfTrajectoriesPerManifold ), trajectoryArchive_( getTrajectoryArchive( ) ),
+    numpyFiles_( 4 ), textFiles_( 4 )
+{
+    fileNames_ = {"L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_plus.txt",
+                  "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_min.txt",
+                  "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_plus.txt",
+                  "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_min.txt"};
+
+    // Decimated copies for plotting, if levels are configured
+    if (!getTrajectoryDecimationLevels().empty()) {
+        for( int manifoldNumber = 0; manifoldNumber < 4; manifoldNumber++ ) {
+            decimatedFiles_.emplace_back(new DecimatedTrajectoryWriter("../data/raw/manifolds/" + fileNames_.at(manifoldNumber)));
+        }
+    }
 
-        while ( stateVectorInclSTMAndTime.first(1, 0) * ySign > 0 ) {
-            stateVectorInclSTM                = stateVectorInclSTMAndTime.first;
-            currentTime                       = stateVectorInclSTMAndTime.second;
-            previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;
-            stateVectorInclSTMAndTime         = propagateOrbit(stateVectorInclSTM, massParameter, currentTime,
-                                                               integrationDirection, initialStepSize, maximumStepSize);
+    if (trajectoryArchive_) {
+        return;
+    }
 
-            if ( stateVectorInclSTMAndTime.first(1, 0) * ySign < 0 ) {
-                stateVectorInclSTMAndTime = previousStateVectorInclSTMAndTime;
-                break;
-            }
+    // For all four manifolds
+    for( int manifoldNumber = 0; manifoldNumber < 4; manifoldNumber++ ) {
+        removeDataProductFiles("../data/raw/manifolds/" + fileNames_.at(manifoldNumber));
+        if (getDataOutputFormat() == numpy_data_output) {
+            numpyFiles_.at(manifoldNumber).reset(new NumpyTrajectoryFileWriter(getNumpyFileName("../data/raw/manifolds/" + fileNames_.at(manifoldNumber), ".npz")));
+        } else {
+            textFiles_.at(manifoldNumber).reset(new TextTableWriter("../data/raw/manifolds/" + fileNames_.at(manifoldNumber)));
         }
     }
-    std::cout << "||y|| = " << stateVectorInclSTM(1, 0) << ", at end of iterative procedure" << std::endl;
 }
 
-void reduceOvershootAtPoincareSectionU2U3( std::pair< Eigen::MatrixXd, double >& stateVectorInclSTMAndTime,
-                                           std::pair< Eigen::MatrixXd, double >& previousStateVectorInclSTMAndTime,
-                                           Eigen::MatrixXd& stateVectorInclSTM, double& currentTime, double& xDiffSign,
-                                           int& integrationDirection, const double& massParameter )
+ManifoldStateHistoryWriter::~ManifoldStateHistoryWriter( )
+{
+    try {
+        close( );
+    } catch ( const std::exception& ) { }
+}
+
+void ManifoldStateHistoryWriter::writeTrajectory( const int trajectoryTaskNumber, const TrajectoryView& trajectory )
 {
-    stateVectorInclSTMAndTime = previousStateVectorInclSTMAndTime;
-    stateVectorInclSTM        = stateVectorInclSTMAndTime.first;
-    currentTime               = stateVectorInclSTMAndTime.second;
-    std::cout << "||x - (1-mu)|| = "                 << (stateVectorInclSTM(0, 0) - (1.0 - massParameter))
-              << ", at start of iterative procedure" << std::endl;
+    const int manifoldNumber             = trajectoryTaskNumber / numberOfTrajectoriesPerManifold_;
+    const int trajectoryOnManifoldNumber = trajectoryTaskNumber % numberOfTrajectoriesPerManifold_;
 
-    for ( int i = 5; i <= 12; i++ ) {
+    if (!decimatedFiles_.empty()) {
+        decimatedFiles_.at(manifoldNumber)->appendTrajectory(trajectoryOnManifoldNumber, trajectory);
+    }
 
-        double initialStepSize = pow(10,(static_cast<float>(-i)));
-        double maximumStepSize = pow(10,(static_cast<float>(-i) + 1.0));
+    if (trajectoryArchive_) {
+        trajectoryArchive_->appendTrajectory(getTrajectoryArchiveKind(fileNames_.at(manifoldNumber)), trajectoryOnManifoldNumber, trajectory);
+        return;
+    }
+    if (numpyFiles_.at(manifoldNumber)) {
+        numpyFiles_.at(manifoldNumber)->appendTrajectory(trajectory);
+        return;
+    }
 
-        while ( (stateVectorInclSTMAndTime.first(0, 0) - (1.0 - massParameter)) * xDiffSign > 0 ) {
-            stateVectorInclSTM                = stateVectorInclSTMAndTime.first;
-            currentTime                       = stateVectorInclSTMAndTime.second;
-            previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;
-            stateVectorInclSTMAndTime         = propagateOrbit(stateVectorInclSTM, massParameter, currentTime,
-                                                               integrationDirection, initialStepSize, maximumStepSize);
+    // For all states on manifold trajectory
+    TextTableWriter& textFileStateVectors = *textFiles_.at(manifoldNumber);
+    for( int stateNumber = 0; stateNumber < trajectory.size( ); stateNumber++ ) {
+        textFileStateVectors.appendValue( trajectory.getTime( stateNumber ) );
+        textFileStateVectors.appendRow( trajectory.getState( stateNumber ).data( ), 6 );
+    }
+}
 
-            if ( (stateVectorInclSTMAndTime.first(0, 0) - (1.0 - massParameter)) * xDiffSign < 0 ) {
-                stateVectorInclSTMAndTime = previousStateVectorInclSTMAndTime;
-                break;
-            }
+void ManifoldStateHistoryWriter::close( )
+{
+    for( int manifoldNumber = 0; manifoldNumber < 4; manifoldNumber++ ) {
+        if (numpyFiles_.at(manifoldNumber)) {
+            numpyFiles_.at(manifoldNumber)->close();
+            numpyFiles_.at(manifoldNumber).reset();
         }
+        if (textFiles_.at(manifoldNumber)) {
+            textFiles_.at(manifoldNumber)->close();
+            textFiles_.at(manifoldNumber).reset();
+        }
+    }
+    for( unsigned int manifoldNumber = 0; manifoldNumber < decimatedFiles_.size(); manifoldNumber++ ) {
+        decimatedFiles_.at(manifoldNumber)->close();
     }
-    std::cout << "||x - (1-mu)|| = "               << (stateVectorInclSTM(0, 0) - 1.0 + massParameter)
-              << ", at end of iterative procedure" << std::endl;
 }
 
-void writeManifoldStateHistoryToFile( std::map< int, std::map< int, std::map< double, Eigen::Vector6d > > >& manifoldStateHistory,
+void writeManifoldStateHistoryToFile( const TrajectorySet& manifoldStateHistory, const int numberOfTrajectoriesPerManifold,
                                       const int& orbitNumber, const int& librationPointNr, const std::string& orbitType )
 {
-    std::string fileNameStateVector;
-    std::ofstream textFileStateVectors;
-    std::vector<std::string> fileNamesStateVectors = {"L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_plus.txt",
-                                                      "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_min.txt",
-                                                      "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_plus.txt",
-                                                      "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_min.txt"};
+    ManifoldStateHistoryWriter manifoldStateHistoryWriter( numberOfTrajectoriesPerManifold, orbitNumber, librationPointNr, orbitType );
+    for( int trajectoryTaskNumber = 0; trajectoryTaskNumber < 4 * numberOfTrajectoriesPerManifold; trajectoryTaskNumber++ ) {
+        manifoldStateHistoryWriter.writeTrajectory( trajectoryTaskNumber, manifoldStateHistory.getTrajectory( trajectoryTaskNumber ) );
+    }
+    manifoldStateHistoryWriter.close( );
+}
+
+void writeManifoldTerminationReasonsToFile( const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                            const int numberOfTrajectoriesPerManifold, const int& orbitNumber,
+                                            const int& librationPointNr, const std::string& orbitType,
+                                            const std::string& fileNameSuffix )
+{
+    std::vector<std::string> fileNamesTerminationReasons = {"L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_plus" + fileNameSuffix + ".txt",
+                                                            "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_min" + fileNameSuffix + ".txt",
+                                                            "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_plus" + fileNameSuffix + ".txt",
+                                                            "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_min" + fileNameSuffix + ".txt"};
 
     // For all four manifolds
-    for( auto const &ent1 : manifoldStateHistory ) {
-        fileNameStateVector = fileNamesStateVectors.at(ent1.first);
+    for ( int manifoldNumber = 0; manifoldNumber < 4; manifoldNumber++ ) {
+        std::vector< ManifoldTerminationReason > terminationReasonsOnManifold(
+                    terminationReasons.begin( ) + manifoldNumber * numberOfTrajectoriesPerManifold,
+                    terminationReasons.begin( ) + ( manifoldNumber + 1 ) * numberOfTrajectoriesPerManifold );
+        writeManifoldTerminationReasonsToFile( terminationReasonsOnManifold, "../data/raw/manifolds/" + fileNamesTerminationReasons.at(manifoldNumber) );
+    }
+}
 
-        remove(("../data/raw/manifolds/" + fileNameStateVector).c_str());
-        textFileStateVectors.open(("../data/raw/manifolds/" + fileNameStateVector));
-        textFileStateVectors.precision(14);
+void writeTrajectoryReducerSummariesToFile( const std::vector< TrajectoryReducerList >& trajectoryReducers,
+                                            const int numberOfTrajectoriesPerManifold, const int firstManifoldNumber,
+                                            const int& orbitNumber, const int& librationPointNr, const std::string& orbitType )
+{
+    std::vector<std::string> fileNamePrefixes = {"L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_plus",
+                                                 "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_min",
+                                                 "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_plus",
+                                                 "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_min"};
 
-        // For all numberOfTrajectoriesPerManifold
-        for( auto const &ent2 : ent1.second ) {
-            // For all states on manifold trajectory
-            for( auto const &ent3 : ent2.second ) {
-                textFileStateVectors << std::left    << std::scientific << std::setw(25) << ent3.first
-                                     << std::setw(25) << ent3.second(0) << std::setw(25) << ent3.second(1)
-                                     << std::setw(25) << ent3.second(2) << std::setw(25) << ent3.second(3)
-                                     << std::setw(25) << ent3.second(4) << std::setw(25) << ent3.second(5) << std::endl;
-            }
+    for ( int manifoldNumber = firstManifoldNumber; manifoldNumber < 4; manifoldNumber++ ) {
+        TrajectoryReducerList manifoldReducers = trajectoryReducers.at( manifoldNumber * numberOfTrajectoriesPerManifold ).clone( );
+        for ( int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < numberOfTrajectoriesPerManifold; trajectoryOnManifoldNumber++ ) {
+            manifoldReducers.merge( trajectoryReducers.at( manifoldNumber * numberOfTrajectoriesPerManifold + trajectoryOnManifoldNumber ) );
         }
-        textFileStateVectors.close();
-        textFileStateVectors.clear();
+        manifoldReducers.writeSummariesToFiles( "../data/raw/manifolds/" + fileNamePrefixes.at( manifoldNumber ) );
     }
 }
 
@@ -186,8 +249,6 @@ void writeEigenvectorStateHistoryToFile( std::map< int, std::map< int, std::pair
 {
     std::string fileNameEigenvectorDirection;
     std::string fileNameEigenvectorLocation;
-    std::ofstream textFileEigenvectorDirections;
-    std::ofstream textFileEigenvectorLocations;
 
     std::vector<std::string> fileNamesEigenvectorDirections = {"L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_plus_eigenvector.txt",
                                                                "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_S_min_eigenvector.txt",
@@ -198,59 +259,290 @@ void writeEigenvectorStateHistoryToFile( std::map< int, std::map< int, std::pair
                                                                "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_plus_eigenvector_location.txt",
                                                                "L" + std::to_string(librationPointNr) + "_" + orbitType + "_" + std::to_string(orbitNumber) + "_W_U_min_eigenvector_location.txt"};
 
+    std::shared_ptr< TrajectoryArchiveWriter > trajectoryArchive = getTrajectoryArchive();
+
     // For all four manifolds
     for( auto const &ent1 : eigenvectorStateHistory ) {
         fileNameEigenvectorDirection = fileNamesEigenvectorDirections.at(ent1.first);
         fileNameEigenvectorLocation    = fileNamesEigenvectorLocations.at(ent1.first);
 
-        remove(("../data/raw/manifolds/" + fileNameEigenvectorDirection).c_str());
-        remove(("../data/raw/manifolds/" + fileNameEigenvectorLocation).c_str());
-        textFileEigenvectorDirections.open(("../data/raw/manifolds/" + fileNameEigenvectorDirection));
-        textFileEigenvectorLocations.open(("../data/raw/manifolds/" + fileNameEigenvectorLocation));
-        textFileEigenvectorDirections.precision(14);
-        textFileEigenvectorLocations.precision(14);
+        if (trajectoryArchive) {
+            // One record per manifold, with the trajectory number on the manifold in the time column
+            TrajectoryBuffer eigenvectorDirections;
+            TrajectoryBuffer eigenvectorLocations;
+            for( auto const &ent2 : ent1.second ) {
+                eigenvectorDirections.append(ent2.first, ent2.second.first);
+                eigenvectorLocations.append(ent2.first, ent2.second.second);
+            }
+            trajectoryArchive->appendTrajectory(getTrajectoryArchiveKind(fileNameEigenvectorDirection), 0, eigenvectorDirections.getView());
+            trajectoryArchive->appendTrajectory(getTrajectoryArchiveKind(fileNameEigenvectorLocation), 0, eigenvectorLocations.getView());
+            continue;
+        }
+
+        removeDataProductFiles("../data/raw/manifolds/" + fileNameEigenvectorDirection);
+        removeDataProductFiles("../data/raw/manifolds/" + fileNameEigenvectorLocation);
+        if (getDataOutputFormat() == numpy_data_output) {
+            std::vector<double> eigenvectorDirections;
+            std::vector<double> eigenvectorLocations;
+            for( auto const &ent2 : ent1.second ) {
+                eigenvectorDirections.insert(eigenvectorDirections.end(), ent2.second.first.data(), ent2.second.first.data() + 6);
+                eigenvectorLocations.insert(eigenvectorLocations.end(), ent2.second.second.data(), ent2.second.second.data() + 6);
+            }
+            writeNumpyArrayToFile(getNumpyFileName("../data/raw/manifolds/" + fileNameEigenvectorDirection, ".npy"), eigenvectorDirections, 6);
+            writeNumpyArrayToFile(getNumpyFileName("../data/raw/manifolds/" + fileNameEigenvectorLocation, ".npy"), eigenvectorLocations, 6);
+            continue;
+        }
+
+        TextTableWriter textFileEigenvectorDirections("../data/raw/manifolds/" + fileNameEigenvectorDirection);
+        TextTableWriter textFileEigenvectorLocations("../data/raw/manifolds/" + fileNameEigenvectorLocation);
 
         // For all numberOfTrajectoriesPerManifold
         for( auto const &ent2 : ent1.second ) {
-            textFileEigenvectorDirections << std::left << std::scientific << std::setw(25)
-                                          << ent2.second.first(0) << std::setw(25) << ent2.second.first(1) << std::setw(25)
-                                          << ent2.second.first(2) << std::setw(25) << ent2.second.first(3) << std::setw(25)
-                                          << ent2.second.first(4) << std::setw(25) << ent2.second.first(5) << std::endl;
-
-            textFileEigenvectorLocations << std::left << std::scientific << std::setw(25)
-                                         << ent2.second.second(0) << std::setw(25) << ent2.second.second(1) << std::setw(25)
-                                         << ent2.second.second(2) << std::setw(25) << ent2.second.second(3) << std::setw(25)
-                                         << ent2.second.second(4) << std::setw(25) << ent2.second.second(5) << std::endl;
+            textFileEigenvectorDirections.appendRow(ent2.second.first.data(), 6);
+            textFileEigenvectorLocations.appendRow(ent2.second.second.data(), 6);
         }
         textFileEigenvectorDirections.close();
-        textFileEigenvectorDirections.clear();
         textFileEigenvectorLocations.close();
-        textFileEigenvectorLocations.clear();
     }
 }
 
+bool checkSymmetryWithRespectToXzPlane( const Eigen::Vector6d& initialStateVector, const double maxSymmetryDeviation )
+{
+    return std::abs( initialStateVector(1) ) < maxSymmetryDeviation && std::abs( initialStateVector(3) ) < maxSymmetryDeviation &&
+           std::abs( initialStateVector(5) ) < maxSymmetryDeviation;
+}
+
+void reflectManifoldTrajectory( const ManifoldTrajectory& manifoldTrajectory, const TrajectoryView& trajectoryStateHistory,
+                                ManifoldTrajectory& reflectedManifoldTrajectory, TrajectoryBuffer& reflectedTrajectoryStateHistory )
+{
+    Eigen::MatrixXd reflectionMatrix = Eigen::MatrixXd::Identity( 6, 6 );
+    reflectionMatrix(1, 1) = -1.0;
+    reflectionMatrix(3, 3) = -1.0;
+    reflectionMatrix(5, 5) = -1.0;
+
+    reflectedTrajectoryStateHistory.clear( );
+    reflectedTrajectoryStateHistory.reserve( trajectoryStateHistory.size( ) );
+    for ( int stateNumber = 0; stateNumber < trajectoryStateHistory.size( ); stateNumber++ ) {
+        reflectedTrajectoryStateHistory.append( -trajectoryStateHistory.getTime( stateNumber ),
+                                                reflectionMatrix * trajectoryStateHistory.getState( stateNumber ) );
+    }
+    reflectedTrajectoryStateHistory.sortByTime( );
+    reflectedManifoldTrajectory.eigenvectorDirection = reflectionMatrix * manifoldTrajectory.eigenvectorDirection;
+    reflectedManifoldTrajectory.eigenvectorLocation  = reflectionMatrix * manifoldTrajectory.eigenvectorLocation;
+    reflectedManifoldTrajectory.terminationReason    = manifoldTrajectory.terminationReason;
+    reflectedManifoldTrajectory.sectionNumber        = manifoldTrajectory.sectionNumber;
+
+    // The STM of the reflected trajectory is the STM of the original one conjugated with the reflection
+    reflectedManifoldTrajectory.finalStateVectorInclSTM = Eigen::MatrixXd::Zero( 6, 7 );
+    reflectedManifoldTrajectory.finalStateVectorInclSTM.block( 0, 0, 6, 1 ) = reflectionMatrix * manifoldTrajectory.finalStateVectorInclSTM.block( 0, 0, 6, 1 );
+    reflectedManifoldTrajectory.finalStateVectorInclSTM.block( 0, 1, 6, 6 ) = reflectionMatrix * manifoldTrajectory.finalStateVectorInclSTM.block( 0, 1, 6, 6 ) * reflectionMatrix;
+}
+
+void runManifoldTrajectoryTasks( const int numberOfTrajectories, const std::function< void( const int ) >& computeTrajectory )
+{
+    const std::function< void( const int ) >* computeTrajectoryTask = &computeTrajectory;
+
+#ifdef _OPENMP
+    if ( omp_in_parallel( ) ) {
+        // Called from one of the jobs of an enclosing team: spawn the tasks in that team, so idle threads pick them up
+        for ( int trajectoryNumber = 0; trajectoryNumber < numberOfTrajectories; trajectoryNumber++ ) {
+            #pragma omp task untied firstprivate(trajectoryNumber, computeTrajectoryTask)
+            ( *computeTrajectoryTask )( trajectoryNumber );
+        }
+        #pragma omp taskwait
+        return;
+    }
+#endif
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        {
+            for ( int trajectoryNumber = 0; trajectoryNumber < numberOfTrajectories; trajectoryNumber++ ) {
+                #pragma omp task untied firstprivate(trajectoryNumber, computeTrajectoryTask)
+                ( *computeTrajectoryTask )( trajectoryNumber );
+            }
+        }
+    }
+}
+
+void streamManifoldTrajectoryTasks( const int numberOfTrajectories,
+                                    const std::function< void( const int, TrajectoryBuffer& ) >& computeTrajectory,
+                                    const std::function< void( const int, const TrajectoryView& ) >& writeTrajectory )
+{
+#ifdef _OPENMP
+    const int numberOfThreads = omp_in_parallel( ) ? omp_get_num_threads( ) : omp_get_max_threads( );
+#else
+    const int numberOfThreads = 1;
+#endif
+    const int numberOfWorkers = std::max( std::min( numberOfThreads, numberOfTrajectories ), 1 );
+
+    // Every worker takes the next trajectory number and reuses its buffer; a worker that runs too far ahead of the oldest
+    // unwritten trajectory waits, which bounds the reorder buffer to two trajectories per worker
+    OrderedTrajectoryStream trajectoryStream( writeTrajectory, 2 * numberOfWorkers );
+    std::atomic< int > nextTrajectoryNumber( 0 );
+    std::mutex exceptionMutex;
+    std::exception_ptr firstException;
+    runManifoldTrajectoryTasks( numberOfWorkers, [&]( const int ) {
+        TrajectoryBuffer trajectoryStateHistory;
+        try {
+            for ( int trajectoryNumber = nextTrajectoryNumber++; trajectoryNumber < numberOfTrajectories; trajectoryNumber = nextTrajectoryNumber++ ) {
+                trajectoryStream.waitForCapacity( trajectoryNumber );
+                computeTrajectory( trajectoryNumber, trajectoryStateHistory );
+                trajectoryStream.submitTrajectory( trajectoryNumber, trajectoryStateHistory );
+                trajectoryStateHistory.clear( );
+            }
+        } catch ( ... ) {
+            // Exceptions may not leave an OpenMP task; the other workers stop at their next trajectory, or throw from
+            // waitForCapacity if they wait for the trajectory this worker will never submit
+            {
+                std::lock_guard< std::mutex > exceptionLock( exceptionMutex );
+                if ( !firstException ) {
+                    firstException = std::current_exception( );
+                }
+                nextTrajectoryNumber = numberOfTrajectories;
+            }
+            trajectoryStream.abort( );
+        }
+    } );
+
+    if ( firstException ) {
+        std::rethrow_exception( firstException );
+    }
+}
+
+void computeManifoldTrajectory( ManifoldTrajectory& manifoldTrajectory, TrajectoryBuffer& trajectoryStateHistory,
+                                const Eigen::MatrixXd& stateVectorInclSTMOnOrbit,
+                                const Eigen::VectorXd& monodromyMatrixEigenvector, const double offsetSign,
+                                int integrationDirection, const std::vector< PoincareSection >& poincareSections,
+                                double jacobiEnergyOnOrbit, const double massParameter,
+                                const double eigenvectorDisplacementFromOrbit, const int saveFrequency,
+                                const double maximumIntegrationTimeManifoldTrajectories,
+                                const ManifoldTerminationSettings& terminationSettings,
+                                TrajectoryReducerList* trajectoryReducers )
+{
+    bool fullManifoldComputed       = false;
+    bool jacobiEnergyOutsideBounds  = false;
+    int stepCounter                 = 1;
+    int reachedSectionNumber        = -1;
+    ManifoldTerminationReason terminationReason = integration_time_termination;
+
+    Eigen::MatrixXd stateTransitionMatrix = stateVectorInclSTMOnOrbit.block(0, 1, 6, 6);
+    Eigen::Vector6d localStateVector      = stateVectorInclSTMOnOrbit.block(0, 0, 6, 1);
+
+    // Apply displacement epsilon from the periodic orbit at <numberOfTrajectoriesPerManifold> locations on the final orbit.
+    Eigen::Vector6d localNormalizedEigenvector = (stateTransitionMatrix * monodromyMatrixEigenvector).normalized();
+    Eigen::MatrixXd manifoldStartingState      = getFullInitialState( localStateVector + offsetSign * eigenvectorDisplacementFromOrbit * localNormalizedEigenvector );
+
+    manifoldTrajectory.eigenvectorDirection = localNormalizedEigenvector;
+    manifoldTrajectory.eigenvectorLocation  = localStateVector;
+    if ( saveFrequency >= 0 ) {
+        trajectoryStateHistory.append( 0.0, manifoldStartingState.block( 0, 0, 6, 1 ) );
+    }
+    if ( trajectoryReducers ) {
+        trajectoryReducers->addState( 0.0, manifoldStartingState.block( 0, 0, 6, 1 ) );
+    }
+
+    std::pair< Eigen::MatrixXd, double > previousStateVectorInclSTMAndTime = std::make_pair( manifoldStartingState, 0.0 );
+    std::pair< Eigen::MatrixXd, double > stateVectorInclSTMAndTime         = propagateOrbit(manifoldStartingState, massParameter, 0.0, integrationDirection );
+    Eigen::MatrixXd stateVectorInclSTM = stateVectorInclSTMAndTime.first;
+    double currentTime                 = stateVectorInclSTMAndTime.second;
+
+    while ( (std::abs( currentTime ) <= maximumIntegrationTimeManifoldTrajectories) && !fullManifoldComputed ) {
+
+        // Check whether trajectory still belongs to the same energy level
+        jacobiEnergyOutsideBounds = checkJacobiOnManifoldOutsideBounds(stateVectorInclSTM, jacobiEnergyOnOrbit, massParameter);
+        fullManifoldComputed      = jacobiEnergyOutsideBounds;
+        if ( jacobiEnergyOutsideBounds ) {
+            terminationReason = jacobi_energy_termination;
+        }
+
+        // Stop at the first crossing of any of the Poincare sections, approached from the state before it
+        for ( unsigned int sectionNumber = 0; sectionNumber < poincareSections.size( ) && !fullManifoldComputed; sectionNumber++ ) {
+            if ( checkPoincareSectionCrossing( poincareSections.at( sectionNumber ), previousStateVectorInclSTMAndTime.first.col( 0 ),
+                                               stateVectorInclSTM.col( 0 ), integrationDirection ) ) {
+                stateVectorInclSTMAndTime = refinePoincareSectionCrossing( previousStateVectorInclSTMAndTime, poincareSections.at( sectionNumber ),
+                                                                           integrationDirection, massParameter );
+                stateVectorInclSTM        = stateVectorInclSTMAndTime.first;
+                currentTime               = stateVectorInclSTMAndTime.second;
+                fullManifoldComputed      = true;
+                terminationReason         = poincare_section_termination;
+                reachedSectionNumber      = static_cast< int >( sectionNumber );
+            }
+        }
+
+        // Stop at impact with either primary or beyond the escape radius, instead of integrating through the singularity
+        if ( !fullManifoldComputed ) {
+            fullManifoldComputed = checkManifoldTerminationEvent( stateVectorInclSTM, terminationSettings, massParameter, terminationReason );
+        }
+
+        // Write every nth integration step to file.
+        if ( saveFrequency > 0 && ((stepCounter % saveFrequency == 0 || fullManifoldComputed) && !jacobiEnergyOutsideBounds ) ) {
+            trajectoryStateHistory.append( currentTime, stateVectorInclSTM.block( 0, 0, 6, 1 ) );
+        }
+        // The reducers also see the state that left the energy bounds, which is not saved
+        if ( trajectoryReducers ) {
+            trajectoryReducers->addState( currentTime, stateVectorInclSTM.block( 0, 0, 6, 1 ) );
+        }
+
+        if ( !fullManifoldComputed ){
+            // Propagate to next time step.
+            previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;
+            stateVectorInclSTMAndTime         = propagateOrbit(stateVectorInclSTM, massParameter, currentTime, integrationDirection);
+            stateVectorInclSTM                = stateVectorInclSTMAndTime.first;
+            currentTime                       = stateVectorInclSTMAndTime.second;
+            stepCounter++;
+        }
+    }
+
+    trajectoryStateHistory.sortByTime( );
+    manifoldTrajectory.finalStateVectorInclSTM = stateVectorInclSTM;
+    manifoldTrajectory.terminationReason       = terminationReason;
+    manifoldTrajectory.sectionNumber           = reachedSectionNumber;
+}
+
 void computeManifolds( const Eigen::Vector6d initialStateVector, const double orbitalPeriod, const int orbitNumber,
                        const int librationPointNr, const std::string orbitType, const double massParameter,
                        const double eigenvectorDisplacementFromOrbit, const int numberOfTrajectoriesPerManifold,
                        const int saveFrequency, const bool saveEigenvectors,
-                       const double maximumIntegrationTimeManifoldTrajectories, const double maxEigenvalueDeviation )
+                       const double maximumIntegrationTimeManifoldTrajectories, const double maxEigenvalueDeviation,
+                       const bool deriveStableManifoldsBySymmetry, const int numberOfSymmetryVerificationTrajectories,
+                       const ManifoldTerminationSettings& terminationSettings )
+{
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbit = createRefinedPeriodicOrbit( initialStateVector, orbitalPeriod,
+                                                                                              massParameter );
+    computeManifolds( *periodicOrbit, orbitNumber, librationPointNr, orbitType, massParameter, eigenvectorDisplacementFromOrbit,
+                      numberOfTrajectoriesPerManifold, saveFrequency, saveEigenvectors,
+                      maximumIntegrationTimeManifoldTrajectories, maxEigenvalueDeviation, deriveStableManifoldsBySymmetry,
+                      numberOfSymmetryVerificationTrajectories, terminationSettings );
+}
+
+void computeManifolds( const RefinedPeriodicOrbit& periodicOrbit, const int orbitNumber,
+                       const int librationPointNr, const std::string orbitType, const double massParameter,
+                       const double eigenvectorDisplacementFromOrbit, const int numberOfTrajectoriesPerManifold,
+                       const int saveFrequency, const bool saveEigenvectors,
+                       const double maximumIntegrationTimeManifoldTrajectories, const double maxEigenvalueDeviation,
+                       const bool deriveStableManifoldsBySymmetry, const int numberOfSymmetryVerificationTrajectories,
+                       const ManifoldTerminationSettings& terminationSettings )
 {
     // Set output maximum precision
     std::cout.precision(std::numeric_limits<double>::digits10);
 
-    double jacobiEnergyOnOrbit = tudat::gravitation::computeJacobiEnergy(massParameter, initialStateVector);
+    const Eigen::Vector6d& initialStateVector = periodicOrbit.initialStateVector;
+    const double orbitalPeriod                = periodicOrbit.orbitalPeriod;
+    double jacobiEnergyOnOrbit                = periodicOrbit.jacobiEnergy;
     std::cout << "\nInitial state vector:" << std::endl << initialStateVector       << std::endl
               << "\nwith C: " << jacobiEnergyOnOrbit    << ", T: " << orbitalPeriod << std::endl;;
 
-    // Propagate the initialStateVector for a full period and write output to file.
-    std::map< double, Eigen::MatrixXd > stateTransitionMatrixHistory;
-    Eigen::MatrixXd stateVectorInclSTM = propagateOrbitWithStateTransitionMatrixToFinalCondition(getFullInitialState( initialStateVector ), massParameter, orbitalPeriod, 1, stateTransitionMatrixHistory, 1, 0.0 ).first;
+    // The state transition matrix along the full period has already been propagated for the (shared) periodic orbit
+    const TrajectoryBuffer& stateTransitionMatrixHistory = periodicOrbit.stateTransitionMatrixHistory;
+    Eigen::MatrixXd stateVectorInclSTM = periodicOrbit.stateVectorInclSTMAtPeriod;
 
     const unsigned int numberOfPointsOnPeriodicOrbit = stateTransitionMatrixHistory.size();
     std::cout << "numberOfPointsOnPeriodicOrbit: " << numberOfPointsOnPeriodicOrbit << std::endl;
 
     // Determine the eigenvector directions of the (un)stable subspace of the monodromy matrix
-    Eigen::MatrixXd monodromyMatrix = stateVectorInclSTM.block(0,1,6,6);
+    Eigen::MatrixXd monodromyMatrix = periodicOrbit.monodromyMatrix;
 
     Eigen::Vector6d stableEigenvector;
     Eigen::Vector6d unstableEigenvector;
@@ -266,144 +558,184 @@ void computeManifolds( const Eigen::Vector6d initialStateVector, const double or
     double stableEigenvectorSign   = determineEigenvectorSign( stableEigenvector );
     double unstableEigenvectorSign = determineEigenvectorSign( unstableEigenvector );
 
-    int integrationDirection;
-    double currentTime;
-    double offsetSign;
-    Eigen::VectorXd monodromyMatrixEigenvector;
-    Eigen::Vector6d localStateVector           = Eigen::Vector6d::Zero(6);
-    Eigen::Vector6d localNormalizedEigenvector = Eigen::Vector6d::Zero(6);
-    Eigen::MatrixXd manifoldStartingState      = Eigen::MatrixXd::Zero(6, 7);
     std::vector<double> offsetSigns            = {1.0 * stableEigenvectorSign, -1.0 * stableEigenvectorSign, 1.0 * unstableEigenvectorSign, -1.0 * unstableEigenvectorSign};
     std::vector<Eigen::VectorXd> eigenVectors  = {stableEigenvector, stableEigenvector, unstableEigenvector, unstableEigenvector};
     std::vector<int> integrationDirections     = {-1, -1, 1, 1};
-    std::pair< Eigen::MatrixXd, double >                                            stateVectorInclSTMAndTime;
-    std::pair< Eigen::MatrixXd, double >                                            previousStateVectorInclSTMAndTime;
-    std::map< int, std::map< int, std::map< double, Eigen::Vector6d > > >           manifoldStateHistory;  // 1. per manifold 2. per trajectory 3. per time-step
     std::map< int, std::map< int, std::pair< Eigen::Vector6d, Eigen::Vector6d > > > eigenvectorStateHistory;  // 1. per manifold 2. per trajectory 3. direction and location
 
-    for ( int manifoldNumber = 0; manifoldNumber < 4; manifoldNumber++ ) {
+    // The stable manifolds of an xz-symmetric orbit are the mirror images of the unstable ones, so only the latter need propagation
+    bool stableManifoldsBySymmetry = deriveStableManifoldsBySymmetry;
+    if ( stableManifoldsBySymmetry && !checkSymmetryWithRespectToXzPlane( initialStateVector ) ) {
+        std::cout << "Initial state is not symmetric with respect to the xz-plane, stable manifolds are propagated" << std::endl;
+        stableManifoldsBySymmetry = false;
+    }
+    const int firstPropagatedManifoldNumber = stableManifoldsBySymmetry ? 2 : 0;
 
-        bool fullManifoldComputed       = false;
-        bool jacobiEnergyOutsideBounds  = false;
-        bool ySignSet                   = false;
-        bool xDiffSignSet               = false;
-        double ySign                    = 0.0;
-        double xDiffSign                = 0.0;
+    // All trajectories of the four manifolds are independent tasks, each writing only to its own result slot and, through
+    // the builder, to a state history in the arena of its thread
+    std::vector< ManifoldTrajectory > manifoldTrajectories( 4 * numberOfTrajectoriesPerManifold );
+    TrajectorySetBuilder manifoldStateHistoryBuilder( 4 * numberOfTrajectoriesPerManifold );
+    std::vector< std::vector< PoincareSection > > manifoldPoincareSections;
+    for ( int manifoldNumber = 0; manifoldNumber < 4; manifoldNumber++ ) {
+        manifoldPoincareSections.push_back( getManifoldPoincareSections( librationPointNr, manifoldNumber, massParameter ) );
+    }
 
-        offsetSign                 = offsetSigns.at(manifoldNumber);
-        monodromyMatrixEigenvector = eigenVectors.at(manifoldNumber);
-        integrationDirection       = integrationDirections.at(manifoldNumber);
+    // Each task also feeds its own copy of the configured reducers, which are merged per manifold when writing the summaries
+    const std::vector< std::shared_ptr< const TrajectoryReducer > > reducerPrototypes = getTrajectoryReducers( );
+    std::shared_ptr< std::vector< TrajectoryReducerList > > trajectoryReducers = std::make_shared< std::vector< TrajectoryReducerList > >( );
+    if ( !reducerPrototypes.empty( ) ) {
+        trajectoryReducers->reserve( 4 * numberOfTrajectoriesPerManifold );
+        for ( int trajectoryTaskNumber = 0; trajectoryTaskNumber < 4 * numberOfTrajectoriesPerManifold; trajectoryTaskNumber++ ) {
+            trajectoryReducers->emplace_back( reducerPrototypes );
+        }
+    }
 
-        // TODO replace with text (like interior/exterior unstable/stable)
-        std::cout << "\n\nManifold: " << manifoldNumber << "\n" << std::endl;
+    auto computeTrajectoryTask = [&]( const int trajectoryTaskNumber, TrajectoryBuffer& trajectoryStateHistory ) {
+        const int manifoldNumber             = trajectoryTaskNumber / numberOfTrajectoriesPerManifold;
+        const int trajectoryOnManifoldNumber = trajectoryTaskNumber % numberOfTrajectoriesPerManifold;
 
         // Determine the total number of points along the periodic orbit to start the manifolds.
-        for ( int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < numberOfTrajectoriesPerManifold; trajectoryOnManifoldNumber++ ) {
-
-            int indexCount    = 0;
-            int stepCounter   = 1;
-            auto indexOnOrbit = static_cast <int> (std::floor(trajectoryOnManifoldNumber * numberOfPointsOnPeriodicOrbit / numberOfTrajectoriesPerManifold));
-
-            Eigen::MatrixXd stateTransitionMatrix;
-            for ( auto const& it : stateTransitionMatrixHistory ) {
-                if ( indexCount == indexOnOrbit ) {
-                    stateTransitionMatrix = it.second.block(0, 1, 6, 6);
-                    localStateVector = it.second.block(0, 0, 6, 1);
-                    break;
-                }
-                indexCount += 1;
-            }
+        auto indexOnOrbit = static_cast <int> (std::floor(trajectoryOnManifoldNumber * numberOfPointsOnPeriodicOrbit / numberOfTrajectoriesPerManifold));
 
-            // Apply displacement epsilon from the periodic orbit at <numberOfTrajectoriesPerManifold> locations on the final orbit.
-            localNormalizedEigenvector = (stateTransitionMatrix * monodromyMatrixEigenvector).normalized();
-            manifoldStartingState      = getFullInitialState( localStateVector + offsetSign * eigenvectorDisplacementFromOrbit * localNormalizedEigenvector );
-
-            if ( saveEigenvectors ) {
-                eigenvectorStateHistory[ manifoldNumber ][ trajectoryOnManifoldNumber ] = std::make_pair(localNormalizedEigenvector, localStateVector);
-            }
-            if ( saveFrequency >= 0 ) {
-                manifoldStateHistory[ manifoldNumber ][ trajectoryOnManifoldNumber ][ 0.0 ] = manifoldStartingState.block( 0, 0, 6, 1 );
-            }
-
-            stateVectorInclSTMAndTime = propagateOrbit(manifoldStartingState, massParameter, 0.0, integrationDirection );
-            stateVectorInclSTM        = stateVectorInclSTMAndTime.first;
-            currentTime               = stateVectorInclSTMAndTime.second;
-
-            std::cout << "Trajectory on manifold number: " << trajectoryOnManifoldNumber << std::endl;
-
-            while ( (std::abs( currentTime ) <= maximumIntegrationTimeManifoldTrajectories) && !fullManifoldComputed ) {
-
-                // Check whether trajectory still belongs to the same energy level
-                jacobiEnergyOutsideBounds = checkJacobiOnManifoldOutsideBounds(stateVectorInclSTM, jacobiEnergyOnOrbit, massParameter);
-                fullManifoldComputed      = jacobiEnergyOutsideBounds;
-
-                // Determine sign of y when crossing x = 0  (U1, U4)
-                if ( (stateVectorInclSTM(0, 0) < 0) && !ySignSet ) {
-                    if ( stateVectorInclSTM(1, 0) < 0 ){
-                        ySign = -1.0;
-                    }
-                    if ( stateVectorInclSTM(1, 0) > 0 ) {
-                        ySign = 1.0;
-                    }
-                    ySignSet = true;
-                }
+        TrajectoryReducerList* trajectoryTaskReducers = nullptr;
+        if ( !trajectoryReducers->empty( ) ) {
+            trajectoryTaskReducers = &trajectoryReducers->at( trajectoryTaskNumber );
+            trajectoryTaskReducers->beginTrajectory( trajectoryOnManifoldNumber, trajectoryOnManifoldNumber / static_cast< double >( numberOfTrajectoriesPerManifold ) );
+        }
 
-                // Determine whether the trajectory approaches U2, U3 from the right or left (U2, U3)
-                if ( !xDiffSignSet ) {
-                    if ( (stateVectorInclSTM(0, 0) - (1.0 - massParameter)) < 0 ) {
-                        xDiffSign = -1.0;
-                    }
-                    if ( (stateVectorInclSTM(0, 0) - (1.0 - massParameter)) > 0 ) {
-                        xDiffSign = 1.0;
-                    }
-                    xDiffSignSet = true;
-                }
+        computeManifoldTrajectory( manifoldTrajectories.at( trajectoryTaskNumber ), trajectoryStateHistory,
+                                   stateTransitionMatrixHistory.getStateVectorInclSTM( indexOnOrbit ),
+                                   eigenVectors.at( manifoldNumber ), offsetSigns.at( manifoldNumber ),
+                                   integrationDirections.at( manifoldNumber ), manifoldPoincareSections.at( manifoldNumber ),
+                                   jacobiEnergyOnOrbit, massParameter, eigenvectorDisplacementFromOrbit, saveFrequency,
+                                   maximumIntegrationTimeManifoldTrajectories, terminationSettings, trajectoryTaskReducers );
 
-                // Determine when the manifold crosses the x-axis again (U1, U4)
-                if ( (stateVectorInclSTM(1, 0) * ySign < 0) && ySignSet ) {
-                    reduceOvershootAtPoincareSectionU1U4(stateVectorInclSTMAndTime, previousStateVectorInclSTMAndTime,
-                                                         stateVectorInclSTM, currentTime, ySign, integrationDirection,
-                                                         massParameter);
-                    fullManifoldComputed = true;
-                }
+        if ( trajectoryTaskReducers ) {
+            trajectoryTaskReducers->endTrajectory( manifoldTrajectories.at( trajectoryTaskNumber ).terminationReason,
+                                                   manifoldTrajectories.at( trajectoryTaskNumber ).sectionNumber );
+        }
 
-                // Determine when the manifold crosses the Poincare section near the second primary (U2, U3)
-                if ( ((stateVectorInclSTM(0, 0) - (1.0 - massParameter)) * xDiffSign < 0) &&
-                        ((librationPointNr == 1 && ( manifoldNumber == 0 || manifoldNumber == 2)) ||
-                         (librationPointNr == 2 && ( manifoldNumber == 1 || manifoldNumber == 3))) ) {
-                    reduceOvershootAtPoincareSectionU2U3(stateVectorInclSTMAndTime,
-                                                         previousStateVectorInclSTMAndTime,
-                                                         stateVectorInclSTM, currentTime, xDiffSign,
-                                                         integrationDirection, massParameter);
-                    fullManifoldComputed = true;
-                }
+        std::cout << "Trajectory on manifold number: " << trajectoryOnManifoldNumber << " (manifold " << manifoldNumber << ")" << std::endl;
+    };
+
+    // Without the reflection, which needs the unstable histories in the opposite order, every history is streamed to the
+    // output as soon as it and all histories before it are complete, so only a few histories per thread are kept in memory
+    const bool streamManifoldStateHistories = saveFrequency >= 0 && !stableManifoldsBySymmetry;
+    if ( streamManifoldStateHistories ) {
+        ManifoldStateHistoryWriter manifoldStateHistoryWriter( numberOfTrajectoriesPerManifold, orbitNumber, librationPointNr, orbitType );
+        streamManifoldTrajectoryTasks( 4 * numberOfTrajectoriesPerManifold, computeTrajectoryTask,
+                                       [&]( const int trajectoryTaskNumber, const TrajectoryView& trajectoryStateHistory ) {
+            manifoldStateHistoryWriter.writeTrajectory( trajectoryTaskNumber, trajectoryStateHistory );
+        } );
+        manifoldStateHistoryWriter.close( );
+    } else {
+        runManifoldTrajectoryTasks( ( 4 - firstPropagatedManifoldNumber ) * numberOfTrajectoriesPerManifold, [&]( const int propagatedTrajectoryNumber ) {
+            const int trajectoryTaskNumber = firstPropagatedManifoldNumber * numberOfTrajectoriesPerManifold + propagatedTrajectoryNumber;
+            manifoldStateHistoryBuilder.computeTrajectory( trajectoryTaskNumber, [&]( TrajectoryBuffer& trajectoryStateHistory ) {
+                computeTrajectoryTask( trajectoryTaskNumber, trajectoryStateHistory );
+            } );
+        } );
+    }
 
-                // Write every nth integration step to file.
-                if ( saveFrequency > 0 && ((stepCounter % saveFrequency == 0 || fullManifoldComputed) && !jacobiEnergyOutsideBounds ) ) {
-                    manifoldStateHistory[ manifoldNumber ][ trajectoryOnManifoldNumber ][ currentTime ] = stateVectorInclSTM.block( 0, 0, 6, 1 );
-                }
+    if ( stableManifoldsBySymmetry ) {
+        // Trajectory i of W_S_plus (W_S_min) starts at the mirror image of the start of trajectory N - i of W_U_plus (W_U_min)
+        for ( int manifoldNumber = 0; manifoldNumber < 2; manifoldNumber++ ) {
+            for ( int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < numberOfTrajectoriesPerManifold; trajectoryOnManifoldNumber++ ) {
+                const int mirroredTrajectoryOnManifoldNumber = ( numberOfTrajectoriesPerManifold - trajectoryOnManifoldNumber ) % numberOfTrajectoriesPerManifold;
+                const int unstableTrajectoryTaskNumber = ( manifoldNumber + 2 ) * numberOfTrajectoriesPerManifold + mirroredTrajectoryOnManifoldNumber;
+                const int stableTrajectoryTaskNumber   = manifoldNumber * numberOfTrajectoriesPerManifold + trajectoryOnManifoldNumber;
+                manifoldStateHistoryBuilder.computeTrajectory( stableTrajectoryTaskNumber, [&]( TrajectoryBuffer& trajectoryStateHistory ) {
+                    reflectManifoldTrajectory( manifoldTrajectories.at( unstableTrajectoryTaskNumber ),
+                                               manifoldStateHistoryBuilder.getTrajectory( unstableTrajectoryTaskNumber ),
+                                               manifoldTrajectories.at( stableTrajectoryTaskNumber ), trajectoryStateHistory );
+                } );
+            }
+        }
 
-                if ( !fullManifoldComputed ){
-                    // Propagate to next time step.
-                    previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;
-                    stateVectorInclSTMAndTime         = propagateOrbit(stateVectorInclSTM, massParameter, currentTime, integrationDirection);
-                    stateVectorInclSTM                = stateVectorInclSTMAndTime.first;
-                    currentTime                       = stateVectorInclSTMAndTime.second;
-                    stepCounter++;
-                }
+        // Propagate a subsample of the stable trajectories directly, from the mirror image of the start of the unstable
+        // trajectory they were reflected from, and compare the states in which they end with the reflected ones
+        if ( numberOfSymmetryVerificationTrajectories > 0 ) {
+            const int numberOfVerifiedTrajectories = std::min( numberOfSymmetryVerificationTrajectories, numberOfTrajectoriesPerManifold );
+            std::vector< ManifoldTrajectory > verificationTrajectories( 2 * numberOfVerifiedTrajectories );
+
+            runManifoldTrajectoryTasks( 2 * numberOfVerifiedTrajectories, [&]( const int verificationTaskNumber ) {
+                const int manifoldNumber             = verificationTaskNumber / numberOfVerifiedTrajectories;
+                const int trajectoryOnManifoldNumber = ( verificationTaskNumber % numberOfVerifiedTrajectories ) * numberOfTrajectoriesPerManifold / numberOfVerifiedTrajectories;
+                const ManifoldTrajectory& reflectedTrajectory = manifoldTrajectories.at( manifoldNumber * numberOfTrajectoriesPerManifold + trajectoryOnManifoldNumber );
+
+                // With an identity STM the start is the mirrored location displaced along the mirrored (unit) eigenvector
+                Eigen::MatrixXd mirroredStateVectorInclSTM = Eigen::MatrixXd::Zero( 6, 7 );
+                mirroredStateVectorInclSTM.block( 0, 0, 6, 1 ) = reflectedTrajectory.eigenvectorLocation;
+                mirroredStateVectorInclSTM.block( 0, 1, 6, 6 ) = Eigen::MatrixXd::Identity( 6, 6 );
+
+                TrajectoryBuffer verificationStateHistory;
+                computeManifoldTrajectory( verificationTrajectories.at( verificationTaskNumber ), verificationStateHistory,
+                                           mirroredStateVectorInclSTM, reflectedTrajectory.eigenvectorDirection,
+                                           offsetSigns.at( manifoldNumber + 2 ),
+                                           integrationDirections.at( manifoldNumber ), manifoldPoincareSections.at( manifoldNumber ),
+                                           jacobiEnergyOnOrbit, massParameter, eigenvectorDisplacementFromOrbit, 0,
+                                           maximumIntegrationTimeManifoldTrajectories, terminationSettings );
+            } );
+
+            for ( int verificationTaskNumber = 0; verificationTaskNumber < 2 * numberOfVerifiedTrajectories; verificationTaskNumber++ ) {
+                const int manifoldNumber             = verificationTaskNumber / numberOfVerifiedTrajectories;
+                const int trajectoryOnManifoldNumber = ( verificationTaskNumber % numberOfVerifiedTrajectories ) * numberOfTrajectoriesPerManifold / numberOfVerifiedTrajectories;
+                const ManifoldTrajectory& reflectedTrajectory = manifoldTrajectories.at( manifoldNumber * numberOfTrajectoriesPerManifold + trajectoryOnManifoldNumber );
+                const ManifoldTrajectory& verificationTrajectory = verificationTrajectories.at( verificationTaskNumber );
+
+                std::cout << "Symmetry verification trajectory " << trajectoryOnManifoldNumber << " (manifold " << manifoldNumber << "): "
+                          << "||delta X|| at end = " << ( reflectedTrajectory.finalStateVectorInclSTM.block( 0, 0, 6, 1 ) -
+                                                          verificationTrajectory.finalStateVectorInclSTM.block( 0, 0, 6, 1 ) ).norm( )
+                          << ", termination " << getManifoldTerminationReasonName( verificationTrajectory.terminationReason )
+                          << " (reflected: " << getManifoldTerminationReasonName( reflectedTrajectory.terminationReason ) << ")" << std::endl;
             }
-            ySignSet             = false;
-            xDiffSignSet         = false;
-            fullManifoldComputed = false;
         }
+    }
+
+    // Collect the result slots in the layout of the output writers
+    for ( int trajectoryTaskNumber = 0; trajectoryTaskNumber < 4 * numberOfTrajectoriesPerManifold; trajectoryTaskNumber++ ) {
+        const int manifoldNumber             = trajectoryTaskNumber / numberOfTrajectoriesPerManifold;
+        const int trajectoryOnManifoldNumber = trajectoryTaskNumber % numberOfTrajectoriesPerManifold;
+        const ManifoldTrajectory& manifoldTrajectory = manifoldTrajectories.at( trajectoryTaskNumber );
 
+        if ( saveEigenvectors ) {
+            eigenvectorStateHistory[ manifoldNumber ][ trajectoryOnManifoldNumber ] = std::make_pair( manifoldTrajectory.eigenvectorDirection,
+                                                                                                      manifoldTrajectory.eigenvectorLocation );
+        }
+    }
+    if ( !manifoldTrajectories.empty( ) ) {
+        stateVectorInclSTM = manifoldTrajectories.back( ).finalStateVectorInclSTM;
     }
 
-    if( saveFrequency >= 0 ) {
-        writeManifoldStateHistoryToFile( manifoldStateHistory, orbitNumber, librationPointNr, orbitType );
+    // Hand the histories over to the output writer, formatting and flushing happens off the compute thread
+    if( saveFrequency >= 0 && !streamManifoldStateHistories ) {
+        std::shared_ptr< const TrajectorySet > ownedManifoldStateHistory =
+                std::make_shared< const TrajectorySet >( manifoldStateHistoryBuilder.getTrajectorySet( ) );
+        getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+            writeManifoldStateHistoryToFile( *ownedManifoldStateHistory, numberOfTrajectoriesPerManifold, orbitNumber,
+                                             librationPointNr, orbitType );
+        } );
+    }
+    // Only the propagated manifolds have reducer data, the summaries of stable manifolds derived by symmetry are not written
+    if ( !trajectoryReducers->empty( ) ) {
+        getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+            writeTrajectoryReducerSummariesToFile( *trajectoryReducers, numberOfTrajectoriesPerManifold, firstPropagatedManifoldNumber,
+                                                   orbitNumber, librationPointNr, orbitType );
+        } );
+    }
+    std::shared_ptr< std::vector< ManifoldTerminationReason > > ownedTerminationReasons = std::make_shared< std::vector< ManifoldTerminationReason > >( );
+    for ( auto const& manifoldTrajectory : manifoldTrajectories ) {
+        ownedTerminationReasons->push_back( manifoldTrajectory.terminationReason );
     }
+    getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+        writeManifoldTerminationReasonsToFile( *ownedTerminationReasons, numberOfTrajectoriesPerManifold, orbitNumber, librationPointNr, orbitType );
+    } );
     if ( saveEigenvectors ) {
-        writeEigenvectorStateHistoryToFile( eigenvectorStateHistory, orbitNumber, librationPointNr, orbitType );
+        std::shared_ptr< std::map< int, std::map< int, std::pair< Eigen::Vector6d, Eigen::Vector6d > > > > ownedEigenvectorStateHistory =
+                std::make_shared< std::map< int, std::map< int, std::pair< Eigen::Vector6d, Eigen::Vector6d > > > >( std::move( eigenvectorStateHistory ) );
+        getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+            writeEigenvectorStateHistoryToFile( *ownedEigenvectorStateHistory, orbitNumber, librationPointNr, orbitType );
+        } );
     }
 
     std::cout << std::endl
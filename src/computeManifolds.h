@@ -2,6 +2,9 @@
 #define TUDATBUNDLE_COMPUTEMANIFOLDS_H
 
 
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -9,29 +12,126 @@
 
 #include "Tudat/Basics/basicTypedefs.h"
 
+#include "manifoldTermination.h"
+#include "numpyOutput.h"
+#include "poincareSection.h"
+#include "refinedPeriodicOrbitCache.h"
+#include "textOutput.h"
+#include "trajectoryArchive.h"
+#include "trajectoryBuffer.h"
+#include "trajectoryDecimation.h"
+#include "trajectoryReducers.h"
+
 void determineStableUnstableEigenvectors( Eigen::MatrixXd& monodromyMatrix, Eigen::Vector6d& stableEigenvector,
                                           Eigen::Vector6d& unstableEigenvector,
                                           const double maxEigenvalueDeviation = 1.0E-3 );
 
+void computeManifolds( const RefinedPeriodicOrbit& periodicOrbit, const int orbitNumber,
+                       const int librationPointNr, const std::string orbitType,
+                       const double massParameter = tudat::gravitation::circular_restricted_three_body_problem::computeMassParameter(tudat::celestial_body_constants::EARTH_GRAVITATIONAL_PARAMETER, tudat::celestial_body_constants::MOON_GRAVITATIONAL_PARAMETER ),
+                       const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                       const int numberOfTrajectoriesPerManifold = 100, const int saveFrequency = 1000,
+                       const bool saveEigenvectors = true,
+                       const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                       const double maxEigenvalueDeviation = 1.0E-3,
+                       const bool deriveStableManifoldsBySymmetry = false,
+                       const int numberOfSymmetryVerificationTrajectories = 0,
+                       const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+// Result slot of a single manifold trajectory, written by exactly one trajectory task; the state history is stored
+// separately in a TrajectorySet
+struct ManifoldTrajectory
+{
+    Eigen::VectorXd eigenvectorDirection;
+    Eigen::VectorXd eigenvectorLocation;
+    Eigen::MatrixXd finalStateVectorInclSTM;
+    ManifoldTerminationReason terminationReason;
+    int sectionNumber; // Index of the Poincare section that was reached, -1 if none
+};
+
+// Runs computeTrajectory( 0 ) ... computeTrajectory( numberOfTrajectories - 1 ) as OpenMP tasks. Inside an enclosing
+// parallel region the tasks are added to that team, otherwise a new team is started; returns when all tasks are done.
+void runManifoldTrajectoryTasks( const int numberOfTrajectories, const std::function< void( const int ) >& computeTrajectory );
+
+// Runs computeTrajectory( i, buffer ) for i = 0 ... numberOfTrajectories - 1 on one worker task per thread and passes every
+// finished trajectory to writeTrajectory in order of i, through an OrderedTrajectoryStream. Workers that get more than two
+// trajectories per worker ahead of the oldest unwritten one wait, so at most a few trajectories per thread are in memory.
+// writeTrajectory is called by one thread at a time; the first exception of either function is rethrown.
+void streamManifoldTrajectoryTasks( const int numberOfTrajectories,
+                                    const std::function< void( const int, TrajectoryBuffer& ) >& computeTrajectory,
+                                    const std::function< void( const int, const TrajectoryView& ) >& writeTrajectory );
+
+// Terminating sections of manifold manifoldNumber (W_S_plus, W_S_min, W_U_plus, W_U_min): U1 or U4, and U2/U3 for the
+// manifolds towards the Moon
+std::vector< PoincareSection > getManifoldPoincareSections( const int librationPointNr, const int manifoldNumber,
+                                                           const double massParameter );
+
+void computeManifoldTrajectory( ManifoldTrajectory& manifoldTrajectory, TrajectoryBuffer& trajectoryStateHistory,
+                                const Eigen::MatrixXd& stateVectorInclSTMOnOrbit,
+                                const Eigen::VectorXd& monodromyMatrixEigenvector, const double offsetSign,
+                                int integrationDirection, const std::vector< PoincareSection >& poincareSections,
+                                double jacobiEnergyOnOrbit, const double massParameter,
+                                const double eigenvectorDisplacementFromOrbit, const int saveFrequency,
+                                const double maximumIntegrationTimeManifoldTrajectories,
+                                const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ),
+                                TrajectoryReducerList* trajectoryReducers = nullptr );
+
 double determineEigenvectorSign( Eigen::Vector6d& eigenvector );
 
+// True if the orbit crosses the xz-plane perpendicularly at its initial state (y = 0, xdot = 0, zdot = 0)
+bool checkSymmetryWithRespectToXzPlane( const Eigen::Vector6d& initialStateVector, const double maxSymmetryDeviation = 1.0E-8 );
+
+// Maps a trajectory onto its mirror image under (x, -y, z, -xdot, ydot, -zdot, -t), which takes the unstable manifold of an
+// xz-symmetric orbit onto the stable manifold of the same orbit
+void reflectManifoldTrajectory( const ManifoldTrajectory& manifoldTrajectory, const TrajectoryView& trajectoryStateHistory,
+                                ManifoldTrajectory& reflectedManifoldTrajectory, TrajectoryBuffer& reflectedTrajectoryStateHistory );
+
 bool checkJacobiOnManifoldOutsideBounds( Eigen::MatrixXd& stateVectorInclSTM, double& referenceJacobiEnergy,
                                          const double massParameter = tudat::gravitation::circular_restricted_three_body_problem::computeMassParameter(tudat::celestial_body_constants::EARTH_GRAVITATIONAL_PARAMETER, tudat::celestial_body_constants::MOON_GRAVITATIONAL_PARAMETER ),
                                          const double maxJacobiEnergyDeviation = 1.0e-11 );
 
-void reduceOvershootAtPoincareSectionU1U4( std::pair< Eigen::MatrixXd, double >& stateVectorInclSTMAndTime,
-                                           std::pair< Eigen::MatrixXd, double >& previousStateVectorInclSTMAndTime,
-                                           Eigen::MatrixXd& stateVectorInclSTM, double& currentTime, double& ySign,
-                                           int& integrationDirection, const double& massParameter = tudat::gravitation::circular_restricted_three_body_problem::computeMassParameter(tudat::celestial_body_constants::EARTH_GRAVITATIONAL_PARAMETER, tudat::celestial_body_constants::MOON_GRAVITATIONAL_PARAMETER ) );
+// Writes the state histories of W_S_plus, W_S_min, W_U_plus and W_U_min trajectory by trajectory, in the order of the
+// trajectory task numbers (manifoldNumber * numberOfTrajectoriesPerManifold + trajectoryOnManifoldNumber), to the
+// trajectory archive if one is open and otherwise to the .npz or text files of the four manifolds. Not thread safe.
+class ManifoldStateHistoryWriter
+{
+public:
+    ManifoldStateHistoryWriter( const int numberOfTrajectoriesPerManifold, const int orbitNumber, const int librationPointNr,
+                                const std::string& orbitType );
+
+    ~ManifoldStateHistoryWriter( );
 
-void reduceOvershootAtPoincareSectionU2U3( std::pair< Eigen::MatrixXd, double >& stateVectorInclSTMAndTime,
-                                           std::pair< Eigen::MatrixXd, double >& previousStateVectorInclSTMAndTime,
-                                           Eigen::MatrixXd& stateVectorInclSTM, double& currentTime, double& xDiffSign,
-                                           int& integrationDirection, const double& massParameter = tudat::gravitation::circular_restricted_three_body_problem::computeMassParameter(tudat::celestial_body_constants::EARTH_GRAVITATIONAL_PARAMETER, tudat::celestial_body_constants::MOON_GRAVITATIONAL_PARAMETER ) );
+    void writeTrajectory( const int trajectoryTaskNumber, const TrajectoryView& trajectory );
 
-void writeManifoldStateHistoryToFile( std::map< int, std::map< int, std::map< double, Eigen::Vector6d > > >& manifoldStateHistory,
+    void close( );
+
+private:
+    ManifoldStateHistoryWriter( const ManifoldStateHistoryWriter& );
+    ManifoldStateHistoryWriter& operator=( const ManifoldStateHistoryWriter& );
+
+    const int numberOfTrajectoriesPerManifold_;
+    std::vector< std::string > fileNames_;
+    std::shared_ptr< TrajectoryArchiveWriter > trajectoryArchive_;
+    std::vector< std::unique_ptr< NumpyTrajectoryFileWriter > > numpyFiles_;
+    std::vector< std::unique_ptr< TextTableWriter > > textFiles_;
+    std::vector< std::unique_ptr< DecimatedTrajectoryWriter > > decimatedFiles_;
+};
+
+// manifoldStateHistory holds the trajectories of W_S_plus, W_S_min, W_U_plus and W_U_min, numberOfTrajectoriesPerManifold each
+void writeManifoldStateHistoryToFile( const TrajectorySet& manifoldStateHistory, const int numberOfTrajectoriesPerManifold,
                                       const int& orbitNumber, const int& librationPointNr, const std::string& orbitType );
 
+void writeManifoldTerminationReasonsToFile( const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                            const int numberOfTrajectoriesPerManifold, const int& orbitNumber,
+                                            const int& librationPointNr, const std::string& orbitType,
+                                            const std::string& fileNameSuffix = "_termination" );
+
+// Merges the reducers of the trajectory tasks per manifold, in trajectory order, and writes their summaries next to the
+// state histories (L1_horizontal_1_W_S_plus_<reducer name>.txt); manifolds before firstManifoldNumber are skipped
+void writeTrajectoryReducerSummariesToFile( const std::vector< TrajectoryReducerList >& trajectoryReducers,
+                                            const int numberOfTrajectoriesPerManifold, const int firstManifoldNumber,
+                                            const int& orbitNumber, const int& librationPointNr, const std::string& orbitType );
+
 void writeEigenvectorStateHistoryToFile( std::map< int, std::map< int, std::pair< Eigen::Vector6d, Eigen::Vector6d > > >& eigenvectorStateHistory,
                                          const int& orbitNumber, const int& librationPointNr,
                                          const std::string& orbitType );
@@ -43,6 +143,9 @@ void computeManifolds( const Eigen::Vector6d initialStateVector, const double or
                        const int numberOfTrajectoriesPerManifold = 100, const int saveFrequency = 1000,
                        const bool saveEigenvectors = true,
                        const double maximumIntegrationTimeManifoldTrajectories = 50.0,
-                       const double maxEigenvalueDeviation = 1.0E-3 );
+                       const double maxEigenvalueDeviation = 1.0E-3,
+                       const bool deriveStableManifoldsBySymmetry = false,
+                       const int numberOfSymmetryVerificationTrajectories = 0,
+                       const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
 
 #endif  // TUDATBUNDLE_COMPUTEMANIFOLDS_H
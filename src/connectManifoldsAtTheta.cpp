@@ -9,6 +9,7 @@
 #include <sstream>
 #include <string>
 #include <math.h>
+#include <stdexcept>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 
@@ -17,68 +18,73 @@
 #include "Tudat/Astrodynamics/Gravitation/jacobiEnergy.h"
 
 #include "applyDifferentialCorrection.h"
+#include "asynchronousOutputWriter.h"
 #include "computeDifferentialCorrection.h"
 #include "computeManifolds.h"
 #include "connectManifoldsAtTheta.h"
+#include "initialConditionsTable.h"
+#include "manifoldConnectionFront.h"
+#include "manifoldSectionCurves.h"
+#include "numpyOutput.h"
+#include "poincareSection.h"
 #include "propagateOrbit.h"
+#include "refineHeteroclinicConnection.h"
+#include "refinedPeriodicOrbitCache.h"
+#include "textOutput.h"
+#include "trajectoryArchive.h"
+#include "trajectoryDecimation.h"
 
-Eigen::VectorXd readInitialConditionsFromFile(const int librationPointNr, const std::string orbitType,
-                                              int orbitIdOne, int orbitIdTwo, const double massParameter)
+std::vector< std::vector< double > > loadInitialConditionsFromFile( const int librationPointNr, const std::string orbitType )
 {
-    std::ifstream textFileInitialConditions("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_initial_conditions.txt");
-    std::vector<std::vector<double>> initialConditions;
-
-    if (textFileInitialConditions) {
-        std::string line;
+    const std::shared_ptr< const InitialConditionsTable > initialConditionsTable = getInitialConditionsTable(librationPointNr, orbitType);
 
-        while (std::getline(textFileInitialConditions, line)) {
-            initialConditions.push_back(std::vector<double>());
-
-            // Break down the row into column values
-            std::stringstream split(line);
-            double value;
-            while (split >> value) {
-                initialConditions.back().push_back(value);
-            }
-        }
+    std::vector<std::vector<double>> initialConditions;
+    for (int orbitId = 0; orbitId < initialConditionsTable->getNumberOfOrbits(); orbitId++) {
+        initialConditions.push_back(initialConditionsTable->getRow(orbitId));
     }
+    return initialConditions;
+}
 
-    double orbitalPeriod1;
-    double orbitalPeriod2;
-    Eigen::VectorXd initialStateVector1;
-    Eigen::VectorXd initialStateVector2;
-
-    orbitalPeriod1         = initialConditions[orbitIdOne][1];
-    initialStateVector1    = Eigen::VectorXd::Zero(6);
-    initialStateVector1(0) = initialConditions[orbitIdOne][2];
-    initialStateVector1(1) = initialConditions[orbitIdOne][3];
-    initialStateVector1(2) = initialConditions[orbitIdOne][4];
-    initialStateVector1(3) = initialConditions[orbitIdOne][5];
-    initialStateVector1(4) = initialConditions[orbitIdOne][6];
-    initialStateVector1(5) = initialConditions[orbitIdOne][7];
-
-    orbitalPeriod2         = initialConditions[orbitIdTwo][1];
-    initialStateVector2    = Eigen::VectorXd::Zero(6);
-    initialStateVector2(0) = initialConditions[orbitIdTwo][2];
-    initialStateVector2(1) = initialConditions[orbitIdTwo][3];
-    initialStateVector2(2) = initialConditions[orbitIdTwo][4];
-    initialStateVector2(3) = initialConditions[orbitIdTwo][5];
-    initialStateVector2(4) = initialConditions[orbitIdTwo][6];
-    initialStateVector2(5) = initialConditions[orbitIdTwo][7];
-
-    double jacobiEnergy1 = tudat::gravitation::computeJacobiEnergy(massParameter, initialStateVector1);
-    double jacobiEnergy2 = tudat::gravitation::computeJacobiEnergy(massParameter, initialStateVector2);
+Eigen::VectorXd readInitialConditionsFromFile(const int librationPointNr, const std::string orbitType,
+                                              int orbitIdOne, int orbitIdTwo)
+{
+    const std::shared_ptr< const InitialConditionsTable > initialConditions = getInitialConditionsTable(librationPointNr, orbitType);
 
     Eigen::VectorXd selectedInitialConditions(14);
-    selectedInitialConditions(0) = orbitalPeriod1;
-    selectedInitialConditions.segment(1, 6) = initialStateVector1;
-    selectedInitialConditions[7] = orbitalPeriod2;
-    selectedInitialConditions.segment(8, 6) = initialStateVector2;
+    selectedInitialConditions(0) = initialConditions->getValue(orbitIdOne, 1);
+    selectedInitialConditions(7) = initialConditions->getValue(orbitIdTwo, 1);
+    for (int i = 0; i < 6; i++) {
+        selectedInitialConditions(i + 1) = initialConditions->getValue(orbitIdOne, i + 2);
+        selectedInitialConditions(i + 8) = initialConditions->getValue(orbitIdTwo, i + 2);
+    }
 
     return selectedInitialConditions;
 }
 
 
+void getOrbitIdsBracketingJacobiEnergy( const int librationPointNr, const std::string orbitType, const double desiredJacobiEnergy,
+                                        int& orbitIdOne, int& orbitIdTwo )
+{
+    const std::shared_ptr< const InitialConditionsTable > initialConditions = getInitialConditionsTable(librationPointNr, orbitType);
+    const double* jacobiEnergies = initialConditions->getColumn(0);
+
+    // First pair of consecutive family members on either side of the desired energy, else the nearest member and its successor
+    int nearestOrbitId = 0;
+    for (int orbitId = 0; orbitId + 1 < initialConditions->getNumberOfOrbits(); orbitId++) {
+        if ((jacobiEnergies[orbitId] - desiredJacobiEnergy) * (jacobiEnergies[orbitId + 1] - desiredJacobiEnergy) <= 0.0) {
+            orbitIdOne = orbitId;
+            orbitIdTwo = orbitId + 1;
+            return;
+        }
+        if (std::abs(jacobiEnergies[orbitId] - desiredJacobiEnergy) <
+            std::abs(jacobiEnergies[nearestOrbitId] - desiredJacobiEnergy)) {
+            nearestOrbitId = orbitId;
+        }
+    }
+    orbitIdOne = nearestOrbitId;
+    orbitIdTwo = nearestOrbitId + 1;
+}
+
 bool checkJacobiOnManifoldOutsideBounds( Eigen::VectorXd currentStateVector, const double referenceJacobiEnergy,
                                          const double massParameter, const double maxJacobiEnergyDeviation )
 {
@@ -98,27 +104,28 @@ bool checkJacobiOnManifoldOutsideBounds( Eigen::VectorXd currentStateVector, con
 }
 
 
-void computeManifoldStatesAtTheta( std::map< int, std::map< double, Eigen::Vector6d > >& manifoldStateHistory,
-                                   Eigen::VectorXd initialStateVector, double orbitalPeriod, int librationPointNr,
+void computeManifoldStatesAtTheta( TrajectorySet& manifoldStateHistory,
+                                   Eigen::VectorXd initialStateVector, double orbitalPeriod,
                                    const double massParameter, double displacementFromOrbitSign, double integrationTimeDirection,
                                    double thetaStoppingAngle, const int numberOfTrajectoriesPerManifold,
                                    const int saveFrequency, const double eigenvectorDisplacementFromOrbit,
                                    const double maximumIntegrationTimeManifoldTrajectories,
-                                   const double maxEigenvalueDeviation, const std::string orbitType )
+                                   const double maxEigenvalueDeviation )
 {
-    double jacobiEnergyOnOrbit = tudat::gravitation::computeJacobiEnergy(massParameter, initialStateVector);
-    std::cout << "\nInitial state vector:" << std::endl << initialStateVector       << std::endl
-              << "\nwith C: " << jacobiEnergyOnOrbit    << ", T: " << orbitalPeriod << std::endl;;
-
-    // Propagate the initialStateVector for a full period and write output to file.
-    std::map< double, Eigen::MatrixXd > stateTransitionMatrixHistory;
-    Eigen::MatrixXd stateVectorInclSTM = propagateOrbitWithStateTransitionMatrixToFinalCondition(getFullInitialState( initialStateVector ), massParameter, orbitalPeriod, 1, stateTransitionMatrixHistory, 1, 0.0 ).first;
-
-    const unsigned int numberOfPointsOnPeriodicOrbit = stateTransitionMatrixHistory.size();
-    std::cout << "numberOfPointsOnPeriodicOrbit: " << numberOfPointsOnPeriodicOrbit << std::endl;
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbit = createRefinedPeriodicOrbit( initialStateVector, orbitalPeriod,
+                                                                                              massParameter );
+    computeManifoldStatesAtTheta( manifoldStateHistory, *periodicOrbit, massParameter,
+                                  displacementFromOrbitSign, integrationTimeDirection, thetaStoppingAngle,
+                                  numberOfTrajectoriesPerManifold, saveFrequency, eigenvectorDisplacementFromOrbit,
+                                  maximumIntegrationTimeManifoldTrajectories, maxEigenvalueDeviation );
+}
 
+bool determineManifoldEigenvectorAtTheta( const RefinedPeriodicOrbit& periodicOrbit, const double displacementFromOrbitSign,
+                                          const double integrationTimeDirection, Eigen::VectorXd& monodromyMatrixEigenvector,
+                                          double& offsetSign, const double maxEigenvalueDeviation )
+{
     // Determine the eigenvector directions of the (un)stable subspace of the monodromy matrix
-    Eigen::MatrixXd monodromyMatrix = stateVectorInclSTM.block(0,1,6,6);
+    Eigen::MatrixXd monodromyMatrix = periodicOrbit.monodromyMatrix;
 
     Eigen::Vector6d stableEigenvector;
     Eigen::Vector6d unstableEigenvector;
@@ -127,23 +134,13 @@ void computeManifoldStatesAtTheta( std::map< int, std::map< double, Eigen::Vecto
         determineStableUnstableEigenvectors( monodromyMatrix, stableEigenvector, unstableEigenvector, maxEigenvalueDeviation );
     }
     catch( const std::exception& ) {
-        return;
+        return false;
     }
 
     // The sign of the x-component of the eigenvector is determined, which is used to determine the eigenvector offset direction (interior/exterior manifold)
     double stableEigenvectorSign   = determineEigenvectorSign( stableEigenvector );
     double unstableEigenvectorSign = determineEigenvectorSign( unstableEigenvector );
 
-    double currentTime;
-    double currentAngleOnManifold;
-    double offsetSign;
-    Eigen::VectorXd monodromyMatrixEigenvector;
-    Eigen::Vector6d localStateVector           = Eigen::Vector6d::Zero(6);
-    Eigen::Vector6d localNormalizedEigenvector = Eigen::Vector6d::Zero(6);
-    Eigen::MatrixXd manifoldStartingState      = Eigen::MatrixXd::Zero(6, 7);
-    std::pair< Eigen::MatrixXd, double > stateVectorInclSTMAndTime;
-    std::pair< Eigen::MatrixXd, double > previousStateVectorInclSTMAndTime;
-
     if (integrationTimeDirection == 1.0)
     {
         monodromyMatrixEigenvector = unstableEigenvector;
@@ -158,117 +155,207 @@ void computeManifoldStatesAtTheta( std::map< int, std::map< double, Eigen::Vecto
         if (stableEigenvectorSign > 0.0){
             offsetSign = displacementFromOrbitSign * 1.0;
         } else {
-            offsetSign = displacementFromOrbitSign * -1.0;;
+            offsetSign = displacementFromOrbitSign * -1.0;
         }
     }
+    return true;
+}
+
+void computeManifoldStatesAtTheta( TrajectorySet& manifoldStateHistory,
+                                   const RefinedPeriodicOrbit& periodicOrbit,
+                                   const double massParameter, double displacementFromOrbitSign, double integrationTimeDirection,
+                                   double thetaStoppingAngle, const int numberOfTrajectoriesPerManifold,
+                                   const int saveFrequency, const double eigenvectorDisplacementFromOrbit,
+                                   const double maximumIntegrationTimeManifoldTrajectories,
+                                   const double maxEigenvalueDeviation,
+                                   const ManifoldTerminationSettings& terminationSettings,
+                                   std::vector< ManifoldTerminationReason >* terminationReasons,
+                                   TrajectoryReducerList* trajectoryReducers )
+{
+    computeManifoldStatesAtSection( manifoldStateHistory, periodicOrbit, massParameter, displacementFromOrbitSign,
+                                    integrationTimeDirection, getThetaSection( thetaStoppingAngle, massParameter ),
+                                    numberOfTrajectoriesPerManifold, saveFrequency, eigenvectorDisplacementFromOrbit,
+                                    maximumIntegrationTimeManifoldTrajectories, maxEigenvalueDeviation,
+                                    terminationSettings, terminationReasons, trajectoryReducers );
+}
+
+void computeManifoldStatesAtSection( TrajectorySet& manifoldStateHistory,
+                                     const RefinedPeriodicOrbit& periodicOrbit,
+                                     const double massParameter, double displacementFromOrbitSign, double integrationTimeDirection,
+                                     const PoincareSection& poincareSection, const int numberOfTrajectoriesPerManifold,
+                                     const int saveFrequency, const double eigenvectorDisplacementFromOrbit,
+                                     const double maximumIntegrationTimeManifoldTrajectories,
+                                     const double maxEigenvalueDeviation,
+                                     const ManifoldTerminationSettings& terminationSettings,
+                                     std::vector< ManifoldTerminationReason >* terminationReasons,
+                                     TrajectoryReducerList* trajectoryReducers )
+{
+    const Eigen::Vector6d& initialStateVector = periodicOrbit.initialStateVector;
+    const double orbitalPeriod                = periodicOrbit.orbitalPeriod;
+    double jacobiEnergyOnOrbit                = periodicOrbit.jacobiEnergy;
+    std::cout << "\nInitial state vector:" << std::endl << initialStateVector       << std::endl
+              << "\nwith C: " << jacobiEnergyOnOrbit    << ", T: " << orbitalPeriod << std::endl;;
 
-    bool jacobiOutsideBounds   = false;
-    bool fullManifoldComputed  = false;
+    // The state transition matrix along the full period has already been propagated for the (shared) periodic orbit
+    const TrajectoryBuffer& stateTransitionMatrixHistory = periodicOrbit.stateTransitionMatrixHistory;
 
-    // Determine the total number of points along the periodic orbit to start the manifolds.
-    for ( int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < numberOfTrajectoriesPerManifold; trajectoryOnManifoldNumber++ ) {
+    const unsigned int numberOfPointsOnPeriodicOrbit = stateTransitionMatrixHistory.size();
+    std::cout << "numberOfPointsOnPeriodicOrbit: " << numberOfPointsOnPeriodicOrbit << std::endl;
 
-        int indexCount = 0;
-        int stepCounter = 1;
-        auto indexOnOrbit = static_cast <int> (std::floor(
-                trajectoryOnManifoldNumber * numberOfPointsOnPeriodicOrbit / numberOfTrajectoriesPerManifold));
+    double offsetSign;
+    Eigen::VectorXd monodromyMatrixEigenvector;
+    if ( !determineManifoldEigenvectorAtTheta( periodicOrbit, displacementFromOrbitSign, integrationTimeDirection,
+                                               monodromyMatrixEigenvector, offsetSign, maxEigenvalueDeviation ) ) {
+        throw std::runtime_error( "No real stable/unstable eigenvalue pair of the monodromy matrix at C = " +
+                                  std::to_string( jacobiEnergyOnOrbit ) );
+    }
 
-        Eigen::MatrixXd stateTransitionMatrix;
-        for (auto const &it : stateTransitionMatrixHistory) {
-            if (indexCount == indexOnOrbit) {
-                stateTransitionMatrix = it.second.block(0, 1, 6, 6);
-                localStateVector = it.second.block(0, 0, 6, 1);
-                break;
-            }
-            indexCount += 1;
+    // Every trajectory is an independent task writing only to its own result slot and to the arena of its thread
+    TrajectorySetBuilder manifoldStateHistoryBuilder( numberOfTrajectoriesPerManifold );
+    std::vector< ManifoldTerminationReason > trajectoryTerminationReasons( numberOfTrajectoriesPerManifold );
+    std::vector< TrajectoryReducerList > trajectoryTaskReducers;
+    if ( trajectoryReducers != nullptr && !trajectoryReducers->empty( ) ) {
+        for ( int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < numberOfTrajectoriesPerManifold; trajectoryOnManifoldNumber++ ) {
+            trajectoryTaskReducers.push_back( trajectoryReducers->clone( ) );
         }
+    }
 
-        // Apply displacement epsilon from the periodic orbit at <numberOfTrajectoriesPerManifold> locations on the final orbit.
-        localNormalizedEigenvector = (stateTransitionMatrix * monodromyMatrixEigenvector).normalized();
-        manifoldStartingState = getFullInitialState(
-                localStateVector + offsetSign * eigenvectorDisplacementFromOrbit * localNormalizedEigenvector);
+    runManifoldTrajectoryTasks( numberOfTrajectoriesPerManifold, [&]( const int trajectoryOnManifoldNumber ) {
+        // Determine the total number of points along the periodic orbit to start the manifolds.
+        auto indexOnOrbit = static_cast <int> (std::floor(
+                trajectoryOnManifoldNumber * numberOfPointsOnPeriodicOrbit / numberOfTrajectoriesPerManifold));
 
-        if (saveFrequency >= 0) {
-            manifoldStateHistory[trajectoryOnManifoldNumber][0.0] = manifoldStartingState.block(0, 0, 6, 1);
+        TrajectoryReducerList* trajectoryReducersOfTask = nullptr;
+        if ( !trajectoryTaskReducers.empty( ) ) {
+            trajectoryReducersOfTask = &trajectoryTaskReducers.at( trajectoryOnManifoldNumber );
+            trajectoryReducersOfTask->beginTrajectory( trajectoryOnManifoldNumber, trajectoryOnManifoldNumber / static_cast< double >( numberOfTrajectoriesPerManifold ) );
         }
 
-        stateVectorInclSTMAndTime = propagateOrbit(manifoldStartingState, massParameter, 0.0, integrationTimeDirection);
-        previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;  // set first value of this parameter
-        stateVectorInclSTM = stateVectorInclSTMAndTime.first;
-        currentTime = stateVectorInclSTMAndTime.second;
+        manifoldStateHistoryBuilder.computeTrajectory( trajectoryOnManifoldNumber, [&]( TrajectoryBuffer& trajectoryStateHistory ) {
+            trajectoryTerminationReasons.at( trajectoryOnManifoldNumber ) = computeManifoldTrajectoryAtSection(
+                        trajectoryStateHistory, stateTransitionMatrixHistory.getStateVectorInclSTM( indexOnOrbit ),
+                        monodromyMatrixEigenvector, offsetSign, integrationTimeDirection, poincareSection, jacobiEnergyOnOrbit,
+                        massParameter, eigenvectorDisplacementFromOrbit, saveFrequency,
+                        maximumIntegrationTimeManifoldTrajectories, terminationSettings, trajectoryReducersOfTask );
+        } );
+
+        if ( trajectoryReducersOfTask ) {
+            // The theta section is the only section here
+            const ManifoldTerminationReason terminationReason = trajectoryTerminationReasons.at( trajectoryOnManifoldNumber );
+            trajectoryReducersOfTask->endTrajectory( terminationReason, terminationReason == poincare_section_termination ? 0 : -1 );
+        }
 
         std::cout << "Trajectory on manifold number: " << trajectoryOnManifoldNumber << std::endl;
-        while ((std::abs(currentTime) <= maximumIntegrationTimeManifoldTrajectories) and !fullManifoldComputed) {
-
-            // Check whether trajectory still belongs to the same energy level
-            jacobiOutsideBounds  = checkJacobiOnManifoldOutsideBounds(stateVectorInclSTM, jacobiEnergyOnOrbit,
-                                                                      massParameter);
-            fullManifoldComputed = jacobiOutsideBounds;
-
-            // Check whether end condition has been reached
-            currentAngleOnManifold = atan2(stateVectorInclSTM(1, 0), stateVectorInclSTM(0, 0) - (1.0 - massParameter)) * 180.0 / tudat::mathematical_constants::PI;
-
-            if (currentAngleOnManifold * integrationTimeDirection > thetaStoppingAngle * integrationTimeDirection and
-                currentAngleOnManifold * thetaStoppingAngle > 0.0) {
-
-                stateVectorInclSTMAndTime = previousStateVectorInclSTMAndTime;
-                stateVectorInclSTM        = stateVectorInclSTMAndTime.first;
-                currentTime               = stateVectorInclSTMAndTime.second;
-
-                currentAngleOnManifold = atan2(stateVectorInclSTM(1, 0), stateVectorInclSTM(0, 0) - (1.0 - massParameter)) * 180.0 / tudat::mathematical_constants::PI;
-
-                std::cout << "||currentAngle - thetaStoppingAngle|| = "
-                          << std::abs(currentAngleOnManifold - thetaStoppingAngle)
-                          << ", at start of iterative procedure" << std::endl;
-
-                for (int i = 6; i <= 12; i++) {
-                    double initialStepSize = pow(10, (static_cast<float>(-i)));
-                    double maximumStepSize = pow(10, (static_cast<float>(-i) + 1.0));
-
-                    while (currentAngleOnManifold * integrationTimeDirection <
-                           thetaStoppingAngle * integrationTimeDirection) {
-
-                        previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;
-                        stateVectorInclSTM                = stateVectorInclSTMAndTime.first;
-                        currentTime                       = stateVectorInclSTMAndTime.second;
-                        stateVectorInclSTMAndTime         = propagateOrbit(stateVectorInclSTM, massParameter, currentTime,
-                                                                           integrationTimeDirection, initialStepSize, maximumStepSize);
-
-                        currentAngleOnManifold = atan2(stateVectorInclSTMAndTime.first(1, 0), stateVectorInclSTMAndTime.first(0, 0) - (1.0 - massParameter)) * 180.0 / tudat::mathematical_constants::PI;
-
-                        if (currentAngleOnManifold * integrationTimeDirection >
-                            thetaStoppingAngle * integrationTimeDirection) {
-
-                            stateVectorInclSTMAndTime = previousStateVectorInclSTMAndTime;
-                            stateVectorInclSTM        = stateVectorInclSTMAndTime.first;
-                            currentTime               = stateVectorInclSTMAndTime.second;
-                            currentAngleOnManifold    = atan2(stateVectorInclSTM(1, 0), stateVectorInclSTM(0, 0) - (1.0 - massParameter)) * 180.0 / tudat::mathematical_constants::PI;
-
-                            break;
-                        }
-                    }
-                }
-                std::cout << "||currentAngle - thetaStoppingAngle|| = "
-                          << std::abs(currentAngleOnManifold - thetaStoppingAngle)
-                          << ", at end of iterative procedure." << std::endl;
-                fullManifoldComputed = true;
-            } else {
-                // Propagate to next time step.
-                previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;
-                stateVectorInclSTMAndTime         = propagateOrbit(stateVectorInclSTM, massParameter, currentTime, integrationTimeDirection);
-                stateVectorInclSTM                = stateVectorInclSTMAndTime.first;
-                currentTime                       = stateVectorInclSTMAndTime.second;
-                stepCounter++;
-            }
-            // Write every nth integration step to file.
-            if (saveFrequency > 0 && ((stepCounter % saveFrequency == 0) || fullManifoldComputed) && !jacobiOutsideBounds) {
-                manifoldStateHistory[trajectoryOnManifoldNumber][currentTime] = stateVectorInclSTM.block(0, 0, 6, 1);
-            }
+    } );
+
+    manifoldStateHistory = manifoldStateHistoryBuilder.getTrajectorySet( );
+    if ( terminationReasons != nullptr ) {
+        *terminationReasons = trajectoryTerminationReasons;
+    }
+    for ( unsigned int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < trajectoryTaskReducers.size( ); trajectoryOnManifoldNumber++ ) {
+        trajectoryReducers->merge( trajectoryTaskReducers[ trajectoryOnManifoldNumber ] );
+    }
+}
+
+ManifoldTerminationReason computeManifoldTrajectoryAtTheta( TrajectoryBuffer& trajectoryStateHistory,
+                                                            const Eigen::MatrixXd& stateVectorInclSTMOnOrbit,
+                                                            const Eigen::VectorXd& monodromyMatrixEigenvector, const double offsetSign,
+                                                            double integrationTimeDirection, const double thetaStoppingAngle,
+                                                            double jacobiEnergyOnOrbit, const double massParameter,
+                                                            const double eigenvectorDisplacementFromOrbit, const int saveFrequency,
+                                                            const double maximumIntegrationTimeManifoldTrajectories,
+                                                            const ManifoldTerminationSettings& terminationSettings )
+{
+    return computeManifoldTrajectoryAtSection( trajectoryStateHistory, stateVectorInclSTMOnOrbit, monodromyMatrixEigenvector,
+                                               offsetSign, integrationTimeDirection, getThetaSection( thetaStoppingAngle, massParameter ),
+                                               jacobiEnergyOnOrbit, massParameter, eigenvectorDisplacementFromOrbit, saveFrequency,
+                                               maximumIntegrationTimeManifoldTrajectories, terminationSettings );
+}
+
+ManifoldTerminationReason computeManifoldTrajectoryAtSection( TrajectoryBuffer& trajectoryStateHistory,
+                                                              const Eigen::MatrixXd& stateVectorInclSTMOnOrbit,
+                                                              const Eigen::VectorXd& monodromyMatrixEigenvector, const double offsetSign,
+                                                              double integrationTimeDirection, const PoincareSection& poincareSection,
+                                                              double jacobiEnergyOnOrbit, const double massParameter,
+                                                              const double eigenvectorDisplacementFromOrbit, const int saveFrequency,
+                                                              const double maximumIntegrationTimeManifoldTrajectories,
+                                                              const ManifoldTerminationSettings& terminationSettings,
+                                                              TrajectoryReducerList* trajectoryReducers )
+{
+    bool jacobiOutsideBounds      = false;
+    bool fullManifoldComputed     = false;
+    bool terminationEventOccurred = false;
+    int stepCounter               = 1;
+    const int integrationDirection = static_cast< int >( integrationTimeDirection );
+    ManifoldTerminationReason terminationReason = integration_time_termination;
+
+    Eigen::MatrixXd stateTransitionMatrix = stateVectorInclSTMOnOrbit.block(0, 1, 6, 6);
+    Eigen::Vector6d localStateVector      = stateVectorInclSTMOnOrbit.block(0, 0, 6, 1);
+
+    // Apply displacement epsilon from the periodic orbit at <numberOfTrajectoriesPerManifold> locations on the final orbit.
+    Eigen::Vector6d localNormalizedEigenvector = (stateTransitionMatrix * monodromyMatrixEigenvector).normalized();
+    Eigen::MatrixXd manifoldStartingState      = getFullInitialState(
+            localStateVector + offsetSign * eigenvectorDisplacementFromOrbit * localNormalizedEigenvector);
+
+    if (saveFrequency >= 0) {
+        trajectoryStateHistory.append(0.0, manifoldStartingState.block(0, 0, 6, 1));
+    }
+    if (trajectoryReducers) {
+        trajectoryReducers->addState(0.0, manifoldStartingState.block(0, 0, 6, 1));
+    }
+
+    std::pair< Eigen::MatrixXd, double > previousStateVectorInclSTMAndTime = std::make_pair(manifoldStartingState, 0.0);
+    std::pair< Eigen::MatrixXd, double > stateVectorInclSTMAndTime = propagateOrbit(manifoldStartingState, massParameter, 0.0, integrationTimeDirection);
+    Eigen::MatrixXd stateVectorInclSTM = stateVectorInclSTMAndTime.first;
+    double currentTime                 = stateVectorInclSTMAndTime.second;
+
+    while ((std::abs(currentTime) <= maximumIntegrationTimeManifoldTrajectories) and !fullManifoldComputed) {
+
+        // Check whether trajectory still belongs to the same energy level
+        jacobiOutsideBounds  = checkJacobiOnManifoldOutsideBounds(stateVectorInclSTM, jacobiEnergyOnOrbit,
+                                                                  massParameter);
+        fullManifoldComputed = jacobiOutsideBounds;
+        if (jacobiOutsideBounds) {
+            terminationReason = jacobi_energy_termination;
+        }
+
+        // Stop at impact with either primary or beyond the escape radius, instead of integrating through the singularity
+        terminationEventOccurred = checkManifoldTerminationEvent(stateVectorInclSTM, terminationSettings, massParameter, terminationReason);
+        fullManifoldComputed     = fullManifoldComputed or terminationEventOccurred;
+
+        // Check whether end condition has been reached
+        if (!terminationEventOccurred and checkPoincareSectionCrossing(poincareSection, previousStateVectorInclSTMAndTime.first.col(0),
+                                                                       stateVectorInclSTM.col(0), integrationDirection)) {
+
+            stateVectorInclSTMAndTime = refinePoincareSectionCrossing(previousStateVectorInclSTMAndTime, poincareSection,
+                                                                      integrationDirection, massParameter);
+            stateVectorInclSTM        = stateVectorInclSTMAndTime.first;
+            currentTime               = stateVectorInclSTMAndTime.second;
+
+            std::cout << "||" << poincareSection.name << " section function|| = "
+                      << std::abs(evaluatePoincareSection(poincareSection, stateVectorInclSTM.col(0)))
+                      << ", at end of iterative procedure." << std::endl;
+            fullManifoldComputed = true;
+            terminationReason    = poincare_section_termination;
+        } else if (!terminationEventOccurred) {
+            // Propagate to next time step.
+            previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;
+            stateVectorInclSTMAndTime         = propagateOrbit(stateVectorInclSTM, massParameter, currentTime, integrationTimeDirection);
+            stateVectorInclSTM                = stateVectorInclSTMAndTime.first;
+            currentTime                       = stateVectorInclSTMAndTime.second;
+            stepCounter++;
+        }
+        // Write every nth integration step to file.
+        if (saveFrequency > 0 && ((stepCounter % saveFrequency == 0) || fullManifoldComputed) && !jacobiOutsideBounds) {
+            trajectoryStateHistory.append(currentTime, stateVectorInclSTM.block(0, 0, 6, 1));
+        }
+        // The reducers also see the state that left the energy bounds, which is not saved
+        if (trajectoryReducers) {
+            trajectoryReducers->addState(currentTime, stateVectorInclSTM.block(0, 0, 6, 1));
         }
-        jacobiOutsideBounds    = false;
-        fullManifoldComputed   = false;
-        currentAngleOnManifold = 0.0;
     }
+    trajectoryStateHistory.sortByTime();
+    return terminationReason;
 }
 
 
@@ -338,7 +425,37 @@ Eigen::VectorXd refineOrbitJacobiEnergy( const int librationPointNr, const std::
     return refineOrbitJacobiEnergyResult;
 }
 
-void writePoincareSectionToFile( std::map< int, std::map< double, Eigen::Vector6d > >& manifoldStateHistory,
+Eigen::VectorXd correctOrbitAtJacobiEnergy( const int librationPointNr, const std::string orbitType, const double desiredJacobiEnergy,
+                                            const int orbitIdOne, const int orbitIdTwo, const double massParameter, bool& converged,
+                                            const double maxPositionDeviationFromPeriodicOrbit,
+                                            const double maxVelocityDeviationFromPeriodicOrbit,
+                                            const double maxJacobiEnergyDeviation )
+{
+    // A single Newton solve including the energy constraint, seeded by the member of the bracket nearest in energy, so the
+    // solution stays on the branch of the family the caller selected
+    const std::shared_ptr< const InitialConditionsTable > initialConditions = getInitialConditionsTable(librationPointNr, orbitType);
+    int nearestOrbitId = orbitIdOne;
+    if (std::abs(initialConditions->getValue(orbitIdTwo, 0) - desiredJacobiEnergy) <
+        std::abs(initialConditions->getValue(orbitIdOne, 0) - desiredJacobiEnergy))
+    {
+        nearestOrbitId = orbitIdTwo;
+    }
+
+    Eigen::VectorXd nearestInitialStateVector(6);
+    for (int i = 0; i < 6; i++) {
+        nearestInitialStateVector(i) = initialConditions->getValue(nearestOrbitId, i + 2);
+    }
+    std::cout << "Nearest orbit to C = " << desiredJacobiEnergy << ": L" << librationPointNr << " " << orbitType
+              << " " << nearestOrbitId << " (C = " << initialConditions->getValue(nearestOrbitId, 0) << ")" << std::endl;
+
+    return applyFixedEnergyDifferentialCorrection( librationPointNr, orbitType, nearestInitialStateVector,
+                                                   initialConditions->getValue(nearestOrbitId, 1), desiredJacobiEnergy, massParameter,
+                                                   maxPositionDeviationFromPeriodicOrbit, maxVelocityDeviationFromPeriodicOrbit,
+                                                   maxJacobiEnergyDeviation, converged );
+}
+
+void writePoincareSectionToFile( const TrajectorySet& manifoldStateHistory,
+                                 const std::vector< ManifoldTerminationReason >& terminationReasons,
                                  int librationPointNr, std::string orbitType, double desiredJacobiEnergy,
                                  double displacementFromOrbitSign, double integrationTimeDirection, double thetaStoppingAngle,
                                  int numberOfTrajectoriesPerManifold )
@@ -367,109 +484,74 @@ void writePoincareSectionToFile( std::map< int, std::map< double, Eigen::Vector6
                           "_W_U_min_" + desiredJacobiEnergyStr.str() + "_" + (thetaStoppingAngleStr).str() + "_poincare.txt");
     }
 
-    remove(fileNameString.c_str());
-    std::ofstream textFileStateVectorsAtPoincare(fileNameString.c_str());
-    textFileStateVectorsAtPoincare.precision(14);
+    removeDataProductFiles(fileNameString);
+    const bool writeNumpyOutput = (getDataOutputFormat() == numpy_data_output);
+    std::vector<double> stateVectorsAtPoincare;
+    std::unique_ptr< TextTableWriter > textFileStateVectorsAtPoincare;
+    if (!writeNumpyOutput) {
+        textFileStateVectorsAtPoincare.reset(new TextTableWriter(fileNameString));
+    }
 
     double phase;
 
-    // For all numberOfTrajectoriesPerManifold
-    for( auto const &ent1 : manifoldStateHistory  ) {
-        phase = ent1.first / (double) numberOfTrajectoriesPerManifold;
-
-        // For last state on manifold trajectory
-        if (integrationTimeDirection > 0 ) {
-            for (auto ent2 = ent1.second.rbegin(); ent2 != ent1.second.rend(); ++ent2) {
-                textFileStateVectorsAtPoincare << std::left << std::scientific << std::setw(25) << phase
-                                               << std::setw(25) << ent2->first
-                                               << std::setw(25) << ent2->second(0) << std::setw(25) << ent2->second(1)
-                                               << std::setw(25) << ent2->second(2) << std::setw(25) << ent2->second(3)
-                                               << std::setw(25) << ent2->second(4) << std::setw(25) << ent2->second(5)
-                                               << std::endl;
-                break;
-            }
+    // For all numberOfTrajectoriesPerManifold; the endpoints of trajectories that terminated otherwise are no section states
+    for( int trajectoryNumber = 0; trajectoryNumber < manifoldStateHistory.size(); trajectoryNumber++ ) {
+        const TrajectoryView trajectory = manifoldStateHistory.getTrajectory(trajectoryNumber);
+        if (terminationReasons.at(trajectoryNumber) != poincare_section_termination || trajectory.empty()) {
+            continue;
         }
-        else {
-            for (auto ent2 = ent1.second.begin(); ent2 != ent1.second.end(); ++ent2) {
-                textFileStateVectorsAtPoincare << std::left << std::scientific << std::setw(25) << phase
-                                               << std::setw(25) << ent2->first
-                                               << std::setw(25) << ent2->second(0) << std::setw(25) << ent2->second(1)
-                                               << std::setw(25) << ent2->second(2) << std::setw(25) << ent2->second(3)
-                                               << std::setw(25) << ent2->second(4) << std::setw(25) << ent2->second(5)
-                                               << std::endl;
-                break;
-            }
+        phase = trajectoryNumber / (double) numberOfTrajectoriesPerManifold;
+
+        // For last state on manifold trajectory (first state for the stable manifold)
+        const int stateNumberAtPoincare = (integrationTimeDirection > 0 ? trajectory.size() - 1 : 0);
+        const Eigen::Map< const Eigen::VectorXd > stateAtPoincare = trajectory.getState(stateNumberAtPoincare);
+        if (writeNumpyOutput) {
+            stateVectorsAtPoincare.push_back(phase);
+            stateVectorsAtPoincare.push_back(trajectory.getTime(stateNumberAtPoincare));
+            stateVectorsAtPoincare.insert(stateVectorsAtPoincare.end(), stateAtPoincare.data(), stateAtPoincare.data() + 6);
+            continue;
         }
+        textFileStateVectorsAtPoincare->appendValue(phase);
+        textFileStateVectorsAtPoincare->appendValue(trajectory.getTime(stateNumberAtPoincare));
+        textFileStateVectorsAtPoincare->appendRow(stateAtPoincare.data(), 6);
     }
 
-    textFileStateVectorsAtPoincare.close();
-    textFileStateVectorsAtPoincare.clear();
+    if (writeNumpyOutput) {
+        writeNumpyArrayToFile(getNumpyFileName(fileNameString, ".npy"), stateVectorsAtPoincare, 8);
+        return;
+    }
+
+    textFileStateVectorsAtPoincare->close();
 }
 
-Eigen::MatrixXd findMinimumImpulseManifoldConnection( std::map< int, std::map< double, Eigen::Vector6d > >& stableManifoldStateHistoryAtTheta,
-                                                      std::map< int, std::map< double, Eigen::Vector6d > >& unstableManifoldStateHistoryAtTheta,
-                                                      const int numberOfTrajectoriesPerManifold, const double maximumVelocityDiscrepancy )
+namespace
 {
-    double deltaPosition;
-    double deltaVelocity;
-    double minimumDeltaPosition                          = 1000.0;
-    Eigen::VectorXd stableStateVectorAtPoincare          = Eigen::VectorXd::Zero(8);
-    Eigen::VectorXd unstableStateVectorAtPoincare        = Eigen::VectorXd::Zero(8);
-    Eigen::MatrixXd minimumImpulseStateVectorsAtPoincare = Eigen::MatrixXd::Zero(2, 8);
 
-    for (int stableTrajectoryNumber = 0; stableTrajectoryNumber < numberOfTrajectoriesPerManifold; stableTrajectoryNumber++)
+// States at the section and their (phase, time) of the trajectories that reached it (the endpoints of the others are no
+// section states): the first state in time for the stable manifold, the last one for the unstable manifold
+void collectManifoldStatesAtTheta( const TrajectorySet& manifoldStateHistoryAtTheta, const int numberOfTrajectoriesPerManifold,
+                                   const bool isStableManifold, const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                   std::vector< double >& statesAtPoincare,
+                                   std::vector< std::pair< double, double > >& phasesAndTimesAtPoincare )
+{
+    for (int trajectoryNumber = 0; trajectoryNumber < numberOfTrajectoriesPerManifold; trajectoryNumber++)
     {
-        stableStateVectorAtPoincare(0) = static_cast<double>(stableTrajectoryNumber) / static_cast<double>(numberOfTrajectoriesPerManifold);
-        stableStateVectorAtPoincare(1) = stableManifoldStateHistoryAtTheta.at(stableTrajectoryNumber).begin()->first;
-        stableStateVectorAtPoincare(2) = stableManifoldStateHistoryAtTheta.at(stableTrajectoryNumber).begin()->second(0);
-        stableStateVectorAtPoincare(3) = stableManifoldStateHistoryAtTheta.at(stableTrajectoryNumber).begin()->second(1);
-        stableStateVectorAtPoincare(4) = stableManifoldStateHistoryAtTheta.at(stableTrajectoryNumber).begin()->second(2);
-        stableStateVectorAtPoincare(5) = stableManifoldStateHistoryAtTheta.at(stableTrajectoryNumber).begin()->second(3);
-        stableStateVectorAtPoincare(6) = stableManifoldStateHistoryAtTheta.at(stableTrajectoryNumber).begin()->second(4);
-        stableStateVectorAtPoincare(7) = stableManifoldStateHistoryAtTheta.at(stableTrajectoryNumber).begin()->second(5);
-
-//        stableStateVectorAtPoincare.segment(2, 8) = stableManifoldStateHistoryAtTheta.at(stableTrajectoryNumber).begin()->second;
-
-        for (int unstableTrajectoryNumber = 0; unstableTrajectoryNumber < numberOfTrajectoriesPerManifold; unstableTrajectoryNumber++) {
-//            unstableStateVectorAtPoincare(0)            = static_cast<double>(unstableTrajectoryNumber) / static_cast<double>(numberOfTrajectoriesPerManifold);
-//            unstableStateVectorAtPoincare(1)            = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->first;
-//            unstableStateVectorAtPoincare.segment(2, 8) = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->second;
-            unstableStateVectorAtPoincare(0) = static_cast<double>(unstableTrajectoryNumber) / static_cast<double>(numberOfTrajectoriesPerManifold);
-            unstableStateVectorAtPoincare(1) = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->first;
-            unstableStateVectorAtPoincare(2) = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->second(0);
-            unstableStateVectorAtPoincare(3) = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->second(1);
-            unstableStateVectorAtPoincare(4) = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->second(2);
-            unstableStateVectorAtPoincare(5) = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->second(3);
-            unstableStateVectorAtPoincare(6) = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->second(4);
-            unstableStateVectorAtPoincare(7) = unstableManifoldStateHistoryAtTheta.at(unstableTrajectoryNumber).rbegin()->second(5);
-
-            deltaVelocity = std::sqrt( (stableStateVectorAtPoincare(5) - unstableStateVectorAtPoincare(5)) * (stableStateVectorAtPoincare(5) - unstableStateVectorAtPoincare(5)) +
-                                       (stableStateVectorAtPoincare(6) - unstableStateVectorAtPoincare(6)) * (stableStateVectorAtPoincare(6) - unstableStateVectorAtPoincare(6)) +
-                                       (stableStateVectorAtPoincare(7) - unstableStateVectorAtPoincare(7)) * (stableStateVectorAtPoincare(7) - unstableStateVectorAtPoincare(7)) );
-
-            if (deltaVelocity < maximumVelocityDiscrepancy)
-            {
-                deltaPosition = std::sqrt( (stableStateVectorAtPoincare(2) - unstableStateVectorAtPoincare(2)) * (stableStateVectorAtPoincare(2) - unstableStateVectorAtPoincare(2)) +
-                                           (stableStateVectorAtPoincare(3) - unstableStateVectorAtPoincare(3)) * (stableStateVectorAtPoincare(3) - unstableStateVectorAtPoincare(3)) +
-                                           (stableStateVectorAtPoincare(4) - unstableStateVectorAtPoincare(4)) * (stableStateVectorAtPoincare(4) - unstableStateVectorAtPoincare(4)) );
-                if (deltaPosition < minimumDeltaPosition)
-                {
-                    minimumDeltaPosition = deltaPosition;
-                    for (int iCol = 0; iCol < 8; iCol++)
-                    {
-                        minimumImpulseStateVectorsAtPoincare(0, iCol) = stableStateVectorAtPoincare(iCol);
-                        minimumImpulseStateVectorsAtPoincare(1, iCol) = unstableStateVectorAtPoincare(iCol);
-                    }
-                    std::cout << "New optimum found with deltaR = " << minimumDeltaPosition << " (deltaV = " << deltaVelocity << ") at:\n"
-                              << minimumImpulseStateVectorsAtPoincare << std::endl;
-                }
-            }
+        const TrajectoryView trajectory = manifoldStateHistoryAtTheta.getTrajectory(trajectoryNumber);
+        if (terminationReasons.at(trajectoryNumber) != poincare_section_termination || trajectory.empty())
+        {
+            continue;
         }
+        const int stateNumberAtSection = ( isStableManifold ? 0 : trajectory.size() - 1 );
+        const Eigen::Map< const Eigen::VectorXd > stateAtSection = trajectory.getState(stateNumberAtSection);
+        statesAtPoincare.insert(statesAtPoincare.end(), stateAtSection.data(), stateAtSection.data() + 6);
+        phasesAndTimesAtPoincare.push_back(std::make_pair(static_cast<double>(trajectoryNumber) / static_cast<double>(numberOfTrajectoriesPerManifold),
+                                                          trajectory.getTime(stateNumberAtSection)));
     }
-    return minimumImpulseStateVectorsAtPoincare;
 }
 
-void writeManifoldStateHistoryAtThetaToFile( std::map< int, std::map< double, Eigen::Vector6d > >& manifoldStateHistory,
+}
+
+void writeManifoldStateHistoryAtThetaToFile( const TrajectorySet& manifoldStateHistory,
                                              int librationPointNr, std::string orbitType, double desiredJacobiEnergy,
                                              double displacementFromOrbitSign, double integrationTimeDirection, double thetaStoppingAngle)
 {
@@ -497,37 +579,85 @@ void writeManifoldStateHistoryAtThetaToFile( std::map< int, std::map< double, Ei
                           "_W_U_min_" + desiredJacobiEnergyStr.str() + "_" + (thetaStoppingAngleStr).str() + "_full.txt");
     }
 
-    remove(fileNameString.c_str());
-    std::ofstream textFileStateVectors(fileNameString.c_str());
-    textFileStateVectors.precision(14);
+    // Decimated copies for plotting, if levels are configured
+    if (!getTrajectoryDecimationLevels().empty()) {
+        DecimatedTrajectoryWriter decimatedStateHistoryWriter(fileNameString);
+        for( int trajectoryNumber = 0; trajectoryNumber < manifoldStateHistory.size(); trajectoryNumber++ ) {
+            decimatedStateHistoryWriter.appendTrajectory(trajectoryNumber, manifoldStateHistory.getTrajectory(trajectoryNumber));
+        }
+        decimatedStateHistoryWriter.close();
+    }
+
+    std::shared_ptr< TrajectoryArchiveWriter > trajectoryArchive = getTrajectoryArchive();
+    if (trajectoryArchive) {
+        appendTrajectorySetToArchive(*trajectoryArchive, getTrajectoryArchiveKind(fileNameString), manifoldStateHistory, 0,
+                                     manifoldStateHistory.size());
+        return;
+    }
+
+    removeDataProductFiles(fileNameString);
+    if (getDataOutputFormat() == numpy_data_output) {
+        // Trajectories that did not reach the section are kept as empty trajectories
+        writeTrajectorySetToNumpyFile(getNumpyFileName(fileNameString, ".npz"), manifoldStateHistory, 0, manifoldStateHistory.size());
+        return;
+    }
+
+    TextTableWriter textFileStateVectors(fileNameString);
 
     // For all numberOfTrajectoriesPerManifold
-    for( auto const &ent1 : manifoldStateHistory  ) {
+    for( int trajectoryNumber = 0; trajectoryNumber < manifoldStateHistory.size(); trajectoryNumber++ ) {
+        const TrajectoryView trajectory = manifoldStateHistory.getTrajectory(trajectoryNumber);
         // For all states on manifold trajectory
-        for( auto const &ent2 : ent1.second ) {
-            textFileStateVectors << std::left    << std::scientific << std::setw(25) << ent2.first
-                                 << std::setw(25) << ent2.second(0) << std::setw(25) << ent2.second(1)
-                                 << std::setw(25) << ent2.second(2) << std::setw(25) << ent2.second(3)
-                                 << std::setw(25) << ent2.second(4) << std::setw(25) << ent2.second(5) << std::endl;
+        for( int stateNumber = 0; stateNumber < trajectory.size(); stateNumber++ ) {
+            textFileStateVectors.appendValue(trajectory.getTime(stateNumber));
+            textFileStateVectors.appendRow(trajectory.getState(stateNumber).data(), 6);
         }
     }
 
     textFileStateVectors.close();
-    textFileStateVectors.clear();
 }
 
-Eigen::MatrixXd connectManifoldsAtTheta( const std::string orbitType, const double thetaStoppingAngle,
-                                         const int numberOfTrajectoriesPerManifold, const double desiredJacobiEnergy,
-                                         const int saveFrequency, const double massParameter )
+void writeManifoldTerminationReasonsAtThetaToFile( const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                                   int librationPointNr, std::string orbitType, double desiredJacobiEnergy,
+                                                   double displacementFromOrbitSign, double integrationTimeDirection,
+                                                   double thetaStoppingAngle )
 {
-    // Set output maximum precision
-    std::cout.precision(std::numeric_limits<double>::digits10);
+    // Rounding-off values for file name
+    std::ostringstream thetaStoppingAngleStr;
+    thetaStoppingAngleStr << std::setprecision(4) << thetaStoppingAngle;
+    std::ostringstream desiredJacobiEnergyStr;
+    desiredJacobiEnergyStr << std::setprecision(4) << desiredJacobiEnergy;
 
-    int orbitOneL1;
-    int orbitTwoL1;
-    int orbitOneL2;
-    int orbitTwoL2;
+    std::string manifoldName = ( integrationTimeDirection == -1.0 ? "W_S" : "W_U" );
+    manifoldName += ( displacementFromOrbitSign == 1.0 ? "_plus" : "_min" );
+
+    writeManifoldTerminationReasonsToFile( terminationReasons, "../data/raw/poincare_sections/L" + std::to_string(librationPointNr) + "_" +
+                                           orbitType + "_" + manifoldName + "_" + desiredJacobiEnergyStr.str() + "_" +
+                                           thetaStoppingAngleStr.str() + "_termination.txt" );
+}
+
+void writeTrajectoryReducerSummariesAtThetaToFile( const TrajectoryReducerList& trajectoryReducers,
+                                                   int librationPointNr, std::string orbitType, double desiredJacobiEnergy,
+                                                   double displacementFromOrbitSign, double integrationTimeDirection,
+                                                   double thetaStoppingAngle )
+{
+    // Rounding-off values for file name
+    std::ostringstream thetaStoppingAngleStr;
+    thetaStoppingAngleStr << std::setprecision(4) << thetaStoppingAngle;
+    std::ostringstream desiredJacobiEnergyStr;
+    desiredJacobiEnergyStr << std::setprecision(4) << desiredJacobiEnergy;
+
+    std::string manifoldName = ( integrationTimeDirection == -1.0 ? "W_S" : "W_U" );
+    manifoldName += ( displacementFromOrbitSign == 1.0 ? "_plus" : "_min" );
 
+    trajectoryReducers.writeSummariesToFiles( "../data/raw/poincare_sections/L" + std::to_string(librationPointNr) + "_" +
+                                              orbitType + "_" + manifoldName + "_" + desiredJacobiEnergyStr.str() + "_" +
+                                              thetaStoppingAngleStr.str() );
+}
+
+void getOrbitIdsForConnectionAtTheta( const std::string orbitType, int& orbitOneL1, int& orbitTwoL1, int& orbitOneL2, int& orbitTwoL2 )
+{
+    // Members of the precomputed families between which the orbits are refined to the desired Jacobi energy
     if ( orbitType == "horizontal" ){
         orbitOneL1 = 577;
         orbitTwoL1 = 578;
@@ -544,53 +674,172 @@ Eigen::MatrixXd connectManifoldsAtTheta( const std::string orbitType, const doub
         orbitOneL2 = 650;
         orbitTwoL2 = 651;
     }
+}
 
-    // Load orbits in L1 and refine to specific Jacobi energy
-    Eigen::VectorXd selectedInitialConditions = readInitialConditionsFromFile(1, orbitType, orbitOneL1, orbitTwoL1, massParameter);
-    Eigen::VectorXd refinedJacobiEnergyResult = refineOrbitJacobiEnergy(1, orbitType, desiredJacobiEnergy,
-                                                                        selectedInitialConditions.segment(1, 6),
-                                                                        selectedInitialConditions(0),
-                                                                        selectedInitialConditions.segment(8, 6),
-                                                                        selectedInitialConditions(7), massParameter);
+Eigen::MatrixXd connectManifoldsAtTheta( const std::string orbitType, const double thetaStoppingAngle,
+                                         const int numberOfTrajectoriesPerManifold, const double desiredJacobiEnergy,
+                                         const int saveFrequency, const double massParameter,
+                                         const ManifoldTerminationSettings& terminationSettings, const int numberOfTopConnections,
+                                         const bool refineConnection )
+{
+    // Set output maximum precision
+    std::cout.precision(std::numeric_limits<double>::digits10);
+
+    int orbitOneL1;
+    int orbitTwoL1;
+    int orbitOneL2;
+    int orbitTwoL2;
+    getOrbitIdsForConnectionAtTheta( orbitType, orbitOneL1, orbitTwoL1, orbitOneL2, orbitTwoL2 );
 
-    Eigen::VectorXd initialStateVectorL1 = refinedJacobiEnergyResult.segment(0, 6);
-    double orbitalPeriodL1               = refinedJacobiEnergyResult(6);
-    double jacobiEnergyL1                = tudat::gravitation::computeJacobiEnergy(massParameter, initialStateVectorL1);
+    // Load orbits in L1 and refine to specific Jacobi energy (shared between all angles)
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbitL1 = getRefinedPeriodicOrbit( 1, orbitType, desiredJacobiEnergy,
+                                                                                             orbitOneL1, orbitTwoL1, massParameter );
 
     // Calculate state at Poincaré section for exterior unstable manifold departing from L1
-    std::map< int, std::map< double, Eigen::Vector6d > > unstableManifoldStateHistoryAtTheta;  // 1. per trajectory 2. per time-step
-    computeManifoldStatesAtTheta( unstableManifoldStateHistoryAtTheta, initialStateVectorL1, orbitalPeriodL1, 1, massParameter, 1.0, 1.0, thetaStoppingAngle, numberOfTrajectoriesPerManifold );
+    std::shared_ptr< TrajectorySet > unstableManifoldStateHistoryAtTheta = std::make_shared< TrajectorySet >( );  // per trajectory
+    std::shared_ptr< std::vector< ManifoldTerminationReason > > unstableManifoldTerminationReasons = std::make_shared< std::vector< ManifoldTerminationReason > >( );
+    std::shared_ptr< TrajectoryReducerList > unstableManifoldReducers = std::make_shared< TrajectoryReducerList >( getTrajectoryReducers( ) );
+    computeManifoldStatesAtTheta( *unstableManifoldStateHistoryAtTheta, *periodicOrbitL1, massParameter, 1.0, 1.0, thetaStoppingAngle, numberOfTrajectoriesPerManifold,
+                                  1000, 1.0E-6, 50.0, 1.0E-3, terminationSettings, unstableManifoldTerminationReasons.get( ),
+                                  unstableManifoldReducers.get( ) );
 
-    if( saveFrequency >= 0 ) {
-        writeManifoldStateHistoryAtThetaToFile( unstableManifoldStateHistoryAtTheta, 1, orbitType, desiredJacobiEnergy, 1.0, 1.0, thetaStoppingAngle );
-        writePoincareSectionToFile( unstableManifoldStateHistoryAtTheta, 1, orbitType, desiredJacobiEnergy, 1.0, 1.0, thetaStoppingAngle, numberOfTrajectoriesPerManifold );
+    // Load orbits in L2 and refine to specific Jacobi energy (shared between all angles)
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbitL2 = getRefinedPeriodicOrbit( 2, orbitType, desiredJacobiEnergy,
+                                                                                             orbitOneL2, orbitTwoL2, massParameter );
+
+    // Calculate state at Poincaré section for interior stable manifold departing from L2
+    std::shared_ptr< TrajectorySet > stableManifoldStateHistoryAtTheta = std::make_shared< TrajectorySet >( );  // per trajectory
+    std::shared_ptr< std::vector< ManifoldTerminationReason > > stableManifoldTerminationReasons = std::make_shared< std::vector< ManifoldTerminationReason > >( );
+    std::shared_ptr< TrajectoryReducerList > stableManifoldReducers = std::make_shared< TrajectoryReducerList >( getTrajectoryReducers( ) );
+    computeManifoldStatesAtTheta( *stableManifoldStateHistoryAtTheta, *periodicOrbitL2, massParameter, -1.0, -1.0, thetaStoppingAngle, numberOfTrajectoriesPerManifold,
+                                  1000, 1.0E-6, 50.0, 1.0E-3, terminationSettings, stableManifoldTerminationReasons.get( ),
+                                  stableManifoldReducers.get( ) );
+
+    // The summaries are written also when the full state histories are not (saveFrequency < 0)
+    if ( !unstableManifoldReducers->empty( ) ) {
+        getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+            writeTrajectoryReducerSummariesAtThetaToFile( *unstableManifoldReducers, 1, orbitType, desiredJacobiEnergy, 1.0, 1.0, thetaStoppingAngle );
+            writeTrajectoryReducerSummariesAtThetaToFile( *stableManifoldReducers, 2, orbitType, desiredJacobiEnergy, -1.0, -1.0, thetaStoppingAngle );
+        } );
     }
 
-    // Load orbits in L2 and refine to specific Jacobi energy
-    selectedInitialConditions = readInitialConditionsFromFile(2, orbitType, orbitOneL2, orbitTwoL2, massParameter);
-    refinedJacobiEnergyResult = refineOrbitJacobiEnergy(2, orbitType, desiredJacobiEnergy,
-                                                        selectedInitialConditions.segment(1, 6),
-                                                        selectedInitialConditions(0),
-                                                        selectedInitialConditions.segment(8, 6),
-                                                        selectedInitialConditions(7), massParameter);
+    // States at the section of the trajectories that reached it; without any on either manifold the front stays empty
+    std::vector< double > stableStatesAtPoincare;
+    std::vector< double > unstableStatesAtPoincare;
+    std::shared_ptr< std::vector< std::pair< double, double > > > stablePhasesAndTimesAtPoincare = std::make_shared< std::vector< std::pair< double, double > > >( );
+    std::shared_ptr< std::vector< std::pair< double, double > > > unstablePhasesAndTimesAtPoincare = std::make_shared< std::vector< std::pair< double, double > > >( );
+    collectManifoldStatesAtTheta(*stableManifoldStateHistoryAtTheta, numberOfTrajectoriesPerManifold, true, *stableManifoldTerminationReasons,
+                                 stableStatesAtPoincare, *stablePhasesAndTimesAtPoincare);
+    collectManifoldStatesAtTheta(*unstableManifoldStateHistoryAtTheta, numberOfTrajectoriesPerManifold, false, *unstableManifoldTerminationReasons,
+                                 unstableStatesAtPoincare, *unstablePhasesAndTimesAtPoincare);
+    std::cout << stablePhasesAndTimesAtPoincare->size() << " (W_S) and " << unstablePhasesAndTimesAtPoincare->size() << " (W_U) of "
+              << numberOfTrajectoriesPerManifold << " trajectories reached theta = " << thetaStoppingAngle << std::endl;
+
+    // Pareto front and top candidates in one pass; the best candidate is the minimum impulse connection under the deltaV cap
+    std::shared_ptr< ManifoldConnectionFront > connectionFront = std::make_shared< ManifoldConnectionFront >(
+                computeManifoldConnectionFront( stableStatesAtPoincare, unstableStatesAtPoincare, numberOfTopConnections ) );
+    // Rows (phase, time, state) of the stable and unstable trajectory of a candidate
+    auto getConnectionStateVectorsAtPoincare = [&]( const ManifoldConnectionCandidate& connectionCandidate ) {
+        Eigen::MatrixXd connectionStateVectorsAtPoincare = Eigen::MatrixXd::Zero(2, 8);
+        connectionStateVectorsAtPoincare(0, 0) = stablePhasesAndTimesAtPoincare->at(connectionCandidate.stableTrajectoryNumber).first;
+        connectionStateVectorsAtPoincare(0, 1) = stablePhasesAndTimesAtPoincare->at(connectionCandidate.stableTrajectoryNumber).second;
+        connectionStateVectorsAtPoincare.block(0, 2, 1, 6) = Eigen::Map< const Eigen::RowVectorXd >(&stableStatesAtPoincare[6 * connectionCandidate.stableTrajectoryNumber], 6);
+        connectionStateVectorsAtPoincare(1, 0) = unstablePhasesAndTimesAtPoincare->at(connectionCandidate.unstableTrajectoryNumber).first;
+        connectionStateVectorsAtPoincare(1, 1) = unstablePhasesAndTimesAtPoincare->at(connectionCandidate.unstableTrajectoryNumber).second;
+        connectionStateVectorsAtPoincare.block(1, 2, 1, 6) = Eigen::Map< const Eigen::RowVectorXd >(&unstableStatesAtPoincare[6 * connectionCandidate.unstableTrajectoryNumber], 6);
+        return connectionStateVectorsAtPoincare;
+    };
 
-    Eigen::VectorXd initialStateVectorL2 = refinedJacobiEnergyResult.segment(0, 6);
-    double orbitalPeriodL2 = refinedJacobiEnergyResult(6);
-    double jacobiEnergyL2 = tudat::gravitation::computeJacobiEnergy(massParameter, initialStateVectorL2);
+    Eigen::MatrixXd minimumImpulseStateVectorsAtPoincare = Eigen::MatrixXd::Zero(2, 8);
+    if (!connectionFront->topCandidates.empty())
+    {
+        const ManifoldConnectionCandidate& minimumImpulseConnection = connectionFront->topCandidates.front();
+        minimumImpulseStateVectorsAtPoincare = getConnectionStateVectorsAtPoincare(minimumImpulseConnection);
+        std::cout << "Optimum found with deltaR = " << minimumImpulseConnection.deltaPosition << " (deltaV = " << minimumImpulseConnection.deltaVelocity
+                  << ") at:\n" << minimumImpulseStateVectorsAtPoincare << std::endl;
+    }
+    std::cout << "Pareto front at theta = " << thetaStoppingAngle << " holds " << connectionFront->paretoFront.size() << " connections" << std::endl;
 
-    // Calculate state at Poincaré section for interior stable manifold departing from L2
-    std::map< int, std::map< double, Eigen::Vector6d > > stableManifoldStateHistoryAtTheta;  // 1. per trajectory 2. per time-step
-    computeManifoldStatesAtTheta( stableManifoldStateHistoryAtTheta, initialStateVectorL2, orbitalPeriodL2, 2, massParameter, -1.0, -1.0, thetaStoppingAngle, numberOfTrajectoriesPerManifold );
+    // Rounding-off values for file name
+    std::ostringstream thetaStoppingAngleStr;
+    thetaStoppingAngleStr << std::setprecision(4) << thetaStoppingAngle;
+    std::ostringstream desiredJacobiEnergyStr;
+    desiredJacobiEnergyStr << std::setprecision(4) << desiredJacobiEnergy;
+    const std::string connectionFrontFileName = "../data/raw/poincare_sections/" + orbitType + "_" + desiredJacobiEnergyStr.str() + "_" +
+            thetaStoppingAngleStr.str() + "_connection_front.txt";
+    getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+        writeManifoldConnectionFrontToFile( *connectionFront, *stablePhasesAndTimesAtPoincare, *unstablePhasesAndTimesAtPoincare, connectionFrontFileName );
+    } );
+
+    // Correct the pair on the Pareto front with the smallest combined discrepancy to a connection without impulse, if the
+    // manifolds intersect near it (the minimum deltaR pair usually has a large deltaV and lies far from any intersection)
+    if (refineConnection && !connectionFront->paretoFront.empty())
+    {
+        const ManifoldConnectionCandidate* closestConnection = &connectionFront->paretoFront.front();
+        for (unsigned int candidateNumber = 1; candidateNumber < connectionFront->paretoFront.size(); candidateNumber++)
+        {
+            const ManifoldConnectionCandidate& connectionCandidate = connectionFront->paretoFront.at(candidateNumber);
+            if (std::hypot(connectionCandidate.deltaPosition, connectionCandidate.deltaVelocity) <
+                std::hypot(closestConnection->deltaPosition, closestConnection->deltaVelocity))
+            {
+                closestConnection = &connectionCandidate;
+            }
+        }
+        std::shared_ptr< HeteroclinicConnection > heteroclinicConnection = std::make_shared< HeteroclinicConnection >(
+                    refineHeteroclinicConnection( *periodicOrbitL1, *periodicOrbitL2, getConnectionStateVectorsAtPoincare(*closestConnection),
+                                                  thetaStoppingAngle, massParameter ) );
+        std::cout << "Heteroclinic connection at theta = " << thetaStoppingAngle << ( heteroclinicConnection->converged ? " converged" : " did not converge" )
+                  << " with deltaR = " << heteroclinicConnection->deltaPosition << " (deltaV = " << heteroclinicConnection->deltaVelocity << ")" << std::endl;
+
+        const std::string heteroclinicConnectionFileName = "../data/raw/poincare_sections/" + orbitType + "_" + desiredJacobiEnergyStr.str() + "_" +
+                thetaStoppingAngleStr.str() + "_heteroclinic_connection.txt";
+        getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+            writeHeteroclinicConnectionToFile( *heteroclinicConnection, heteroclinicConnectionFileName );
+        } );
+    }
 
-    if( saveFrequency >= 0 ) {
-        writeManifoldStateHistoryAtThetaToFile( stableManifoldStateHistoryAtTheta, 2, orbitType, desiredJacobiEnergy, -1.0, -1.0, thetaStoppingAngle );
-        writePoincareSectionToFile( stableManifoldStateHistoryAtTheta, 2, orbitType, desiredJacobiEnergy, -1.0, -1.0, thetaStoppingAngle, numberOfTrajectoriesPerManifold);
+    // Sub-sample connection candidates where the interpolated section curves of both manifolds intersect in (r, rdot); for
+    // a spatial family only those that also match in (z, zdot) are kept
+    if (orbitType != "horizontal")
+    {
+        std::cout << "Warning: the " << orbitType << " family is spatial, section curve intersections in (r, rdot) are only kept "
+                  << "if they also match in (z, zdot)" << std::endl;
+    }
+    std::shared_ptr< std::vector< ManifoldSectionCurveIntersection > > curveIntersections = std::make_shared< std::vector< ManifoldSectionCurveIntersection > >(
+                findManifoldSectionCurveIntersections( buildManifoldSectionCurveAtTheta( *stableManifoldStateHistoryAtTheta, numberOfTrajectoriesPerManifold, true,
+                                                                                         *stableManifoldTerminationReasons, massParameter ),
+                                                       buildManifoldSectionCurveAtTheta( *unstableManifoldStateHistoryAtTheta, numberOfTrajectoriesPerManifold, false,
+                                                                                         *unstableManifoldTerminationReasons, massParameter ) ) );
+    std::cout << "Section curves at theta = " << thetaStoppingAngle << " intersect " << curveIntersections->size() << " times";
+    if (!curveIntersections->empty())
+    {
+        std::cout << ", closest with deltaR = " << curveIntersections->front().deltaPosition << " (deltaV = " << curveIntersections->front().deltaVelocity
+                  << ") at phases " << curveIntersections->front().stablePhase << " and " << curveIntersections->front().unstablePhase;
     }
+    std::cout << std::endl;
 
+    const std::string curveIntersectionsFileName = "../data/raw/poincare_sections/" + orbitType + "_" + desiredJacobiEnergyStr.str() + "_" +
+            thetaStoppingAngleStr.str() + "_curve_intersections.txt";
+    getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+        writeManifoldSectionCurveIntersectionsToFile( *curveIntersections, curveIntersectionsFileName );
+    } );
 
-    Eigen::MatrixXd minimumImpulseStateVectorsAtPoincare = findMinimumImpulseManifoldConnection( stableManifoldStateHistoryAtTheta,
-                                                                                                 unstableManifoldStateHistoryAtTheta,
-                                                                                                 numberOfTrajectoriesPerManifold );
+    // Both branches are no longer needed here, the output writer takes ownership and writes them off the compute thread
+    if( saveFrequency >= 0 ) {
+        std::shared_ptr< const TrajectorySet > ownedUnstableManifoldStateHistoryAtTheta = unstableManifoldStateHistoryAtTheta;
+        getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+            writeManifoldStateHistoryAtThetaToFile( *ownedUnstableManifoldStateHistoryAtTheta, 1, orbitType, desiredJacobiEnergy, 1.0, 1.0, thetaStoppingAngle );
+            writePoincareSectionToFile( *ownedUnstableManifoldStateHistoryAtTheta, *unstableManifoldTerminationReasons, 1, orbitType, desiredJacobiEnergy, 1.0, 1.0, thetaStoppingAngle, numberOfTrajectoriesPerManifold );
+            writeManifoldTerminationReasonsAtThetaToFile( *unstableManifoldTerminationReasons, 1, orbitType, desiredJacobiEnergy, 1.0, 1.0, thetaStoppingAngle );
+        } );
+
+        std::shared_ptr< const TrajectorySet > ownedStableManifoldStateHistoryAtTheta = stableManifoldStateHistoryAtTheta;
+        getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+            writeManifoldStateHistoryAtThetaToFile( *ownedStableManifoldStateHistoryAtTheta, 2, orbitType, desiredJacobiEnergy, -1.0, -1.0, thetaStoppingAngle );
+            writePoincareSectionToFile( *ownedStableManifoldStateHistoryAtTheta, *stableManifoldTerminationReasons, 2, orbitType, desiredJacobiEnergy, -1.0, -1.0, thetaStoppingAngle, numberOfTrajectoriesPerManifold );
+            writeManifoldTerminationReasonsAtThetaToFile( *stableManifoldTerminationReasons, 2, orbitType, desiredJacobiEnergy, -1.0, -1.0, thetaStoppingAngle );
+        } );
+    }
 /*
  * write initial orbits to file
  * per angle: write trajectory to file
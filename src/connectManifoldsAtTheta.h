@@ -2,6 +2,7 @@
 #define TUDATBUNDLE_CONNECTMANIFOLDSATTHETA_H
 
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -9,20 +10,87 @@
 
 #include "Tudat/Basics/basicTypedefs.h"
 
+#include "manifoldTermination.h"
+#include "poincareSection.h"
+#include "refinedPeriodicOrbitCache.h"
+#include "trajectoryBuffer.h"
+#include "trajectoryReducers.h"
+
+// Rows of the family's initial conditions file, copied from the process-wide table (see getInitialConditionsTable)
+std::vector< std::vector< double > > loadInitialConditionsFromFile( const int librationPointNr, const std::string orbitType );
+
 Eigen::VectorXd readInitialConditionsFromFile(const int librationPointNr, const std::string orbitType,
-                                              int orbitIdOne, int orbitIdTwo, const double massParameter);
+                                              int orbitIdOne, int orbitIdTwo);
+
+// Consecutive members of the family whose Jacobi energies enclose desiredJacobiEnergy (seed orbits for refineOrbitJacobiEnergy)
+void getOrbitIdsBracketingJacobiEnergy( const int librationPointNr, const std::string orbitType, const double desiredJacobiEnergy,
+                                        int& orbitIdOne, int& orbitIdTwo );
 
 bool checkJacobiOnManifoldOutsideBounds( Eigen::VectorXd currentStateVector, const double referenceJacobiEnergy,
                                          const double massParameter, const double maxJacobiEnergyDeviation = 1.0E-11 );
 
-void computeManifoldStatesAtTheta( std::map< int, std::map< double, Eigen::Vector6d > >& manifoldStateHistory,
-                                   Eigen::VectorXd initialStateVector, double orbitalPeriod, int librationPointNr,
+void computeManifoldStatesAtTheta( TrajectorySet& manifoldStateHistory,
+                                   Eigen::VectorXd initialStateVector, double orbitalPeriod,
                                    const double massParameter, double displacementFromOrbitSign, double integrationTimeDirection,
                                    double thetaStoppingAngle, const int numberOfTrajectoriesPerManifold,
                                    const int saveFrequency = 1000,
                                    const double eigenvectorDisplacementFromOrbit = 1.0E-6,
                                    const double maximumIntegrationTimeManifoldTrajectories = 50.0,
-                                   const double maxEigenvalueDeviation = 1.0E-3, const std::string orbitType = "vertical");
+                                   const double maxEigenvalueDeviation = 1.0E-3 );
+
+// Selects the (un)stable eigenvector for the integration direction and the offset sign for the displacement direction;
+// returns false if the monodromy matrix does not have a real stable/unstable eigenvalue pair
+bool determineManifoldEigenvectorAtTheta( const RefinedPeriodicOrbit& periodicOrbit, const double displacementFromOrbitSign,
+                                          const double integrationTimeDirection, Eigen::VectorXd& monodromyMatrixEigenvector,
+                                          double& offsetSign, const double maxEigenvalueDeviation = 1.0E-3 );
+
+// manifoldStateHistory receives one trajectory per seed, in seed order (empty trajectories if saveFrequency < 0). If
+// trajectoryReducers is given, every trajectory also feeds an empty copy of it, merged into it in seed order. Throws
+// std::runtime_error if the monodromy matrix has no real stable/unstable eigenvalue pair.
+void computeManifoldStatesAtTheta( TrajectorySet& manifoldStateHistory,
+                                   const RefinedPeriodicOrbit& periodicOrbit,
+                                   const double massParameter, double displacementFromOrbitSign, double integrationTimeDirection,
+                                   double thetaStoppingAngle, const int numberOfTrajectoriesPerManifold,
+                                   const int saveFrequency = 1000,
+                                   const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                   const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                   const double maxEigenvalueDeviation = 1.0E-3,
+                                   const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ),
+                                   std::vector< ManifoldTerminationReason >* terminationReasons = nullptr,
+                                   TrajectoryReducerList* trajectoryReducers = nullptr );
+
+// Same, up to the first crossing of any section instead of the angle thetaStoppingAngle about the Moon
+void computeManifoldStatesAtSection( TrajectorySet& manifoldStateHistory,
+                                     const RefinedPeriodicOrbit& periodicOrbit,
+                                     const double massParameter, double displacementFromOrbitSign, double integrationTimeDirection,
+                                     const PoincareSection& poincareSection, const int numberOfTrajectoriesPerManifold,
+                                     const int saveFrequency = 1000,
+                                     const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                     const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                     const double maxEigenvalueDeviation = 1.0E-3,
+                                     const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ),
+                                     std::vector< ManifoldTerminationReason >* terminationReasons = nullptr,
+                                     TrajectoryReducerList* trajectoryReducers = nullptr );
+
+ManifoldTerminationReason computeManifoldTrajectoryAtTheta( TrajectoryBuffer& trajectoryStateHistory,
+                                                            const Eigen::MatrixXd& stateVectorInclSTMOnOrbit,
+                                                            const Eigen::VectorXd& monodromyMatrixEigenvector, const double offsetSign,
+                                                            double integrationTimeDirection, const double thetaStoppingAngle,
+                                                            double jacobiEnergyOnOrbit, const double massParameter,
+                                                            const double eigenvectorDisplacementFromOrbit = 1.0E-6, const int saveFrequency = 1000,
+                                                            const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                                            const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+// Trajectory up to the first crossing of poincareSection, which is approached from the integration step before it
+ManifoldTerminationReason computeManifoldTrajectoryAtSection( TrajectoryBuffer& trajectoryStateHistory,
+                                                              const Eigen::MatrixXd& stateVectorInclSTMOnOrbit,
+                                                              const Eigen::VectorXd& monodromyMatrixEigenvector, const double offsetSign,
+                                                              double integrationTimeDirection, const PoincareSection& poincareSection,
+                                                              double jacobiEnergyOnOrbit, const double massParameter,
+                                                              const double eigenvectorDisplacementFromOrbit = 1.0E-6, const int saveFrequency = 1000,
+                                                              const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                                              const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ),
+                                                              TrajectoryReducerList* trajectoryReducers = nullptr );
 
 Eigen::VectorXd refineOrbitJacobiEnergy( const int librationPointNr, const std::string orbitType, const double desiredJacobiEnergy,
                                          Eigen::VectorXd initialStateVector1, double orbitalPeriod1,
@@ -32,24 +100,49 @@ Eigen::VectorXd refineOrbitJacobiEnergy( const int librationPointNr, const std::
                                          const double maxVelocityDeviationFromPeriodicOrbit = 1.0E-12,
                                          const double maxJacobiEnergyDeviation = 1.0E-12 );
 
-void writePoincareSectionToFile( std::map< int, std::map< double, Eigen::Vector6d > >& manifoldStateHistory,
+// Fixed energy correction of whichever of the family members orbitIdOne and orbitIdTwo is nearest to desiredJacobiEnergy;
+// converged tells whether the result is a periodic orbit at that energy
+Eigen::VectorXd correctOrbitAtJacobiEnergy( const int librationPointNr, const std::string orbitType, const double desiredJacobiEnergy,
+                                            const int orbitIdOne, const int orbitIdTwo, const double massParameter, bool& converged,
+                                            const double maxPositionDeviationFromPeriodicOrbit = 1.0E-12,
+                                            const double maxVelocityDeviationFromPeriodicOrbit = 1.0E-12,
+                                            const double maxJacobiEnergyDeviation = 1.0E-12 );
+
+// Rows (phase, time, state) at the section of the trajectories that reached it, as the connection search uses them
+void writePoincareSectionToFile( const TrajectorySet& manifoldStateHistory,
+                                 const std::vector< ManifoldTerminationReason >& terminationReasons,
                                  int librationPointNr, std::string orbitType, double desiredJacobiEnergy,
                                  double displacementFromOrbitSign, double integrationTimeDirection, double thetaStoppingAngle,
                                  int numberOfTrajectoriesPerManifold );
 
-Eigen::MatrixXd findMinimumImpulseManifoldConnection( std::map< int, std::map< double, Eigen::Vector6d > >& stableManifoldStateHistoryAtTheta,
-                                                      std::map< int, std::map< double, Eigen::Vector6d > >& unstableManifoldStateHistoryAtTheta,
-                                                      const int numberOfTrajectoriesPerManifold, const double maximumVelocityDiscrepancy = 0.5 );
 
-void writeManifoldStateHistoryAtThetaToFile( std::map< int, std::map< double, Eigen::Vector6d > >& manifoldStateHistory,
+void writeManifoldStateHistoryAtThetaToFile( const TrajectorySet& manifoldStateHistory,
                                              int librationPointNr, std::string orbitType, double desiredJacobiEnergy,
                                              double displacementFromOrbitSign, double integrationTimeDirection, double thetaStoppingAngle);
 
+void writeManifoldTerminationReasonsAtThetaToFile( const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                                   int librationPointNr, std::string orbitType, double desiredJacobiEnergy,
+                                                   double displacementFromOrbitSign, double integrationTimeDirection,
+                                                   double thetaStoppingAngle );
+
+// L1_horizontal_W_U_plus_3.1_-90_<reducer name>.txt for every reducer in trajectoryReducers
+void writeTrajectoryReducerSummariesAtThetaToFile( const TrajectoryReducerList& trajectoryReducers,
+                                                   int librationPointNr, std::string orbitType, double desiredJacobiEnergy,
+                                                   double displacementFromOrbitSign, double integrationTimeDirection,
+                                                   double thetaStoppingAngle );
+
+void getOrbitIdsForConnectionAtTheta( const std::string orbitType, int& orbitOneL1, int& orbitTwoL1, int& orbitOneL2, int& orbitTwoL2 );
+
+// Minimum impulse connection at theta, the best top candidate of computeManifoldConnectionFront over the trajectories
+// terminated at the section: a 2x8 matrix with the rows (phase, time, state) of the stable and the unstable trajectory,
+// zeros if no pair is within the velocity discrepancy cap
 Eigen::MatrixXd connectManifoldsAtTheta( const std::string orbitType = "vertical", const double thetaStoppingAngle = -90.0,
                                          const int numberOfTrajectoriesPerManifold = 100, const double desiredJacobiEnergy = 3.1,
                                          const int saveFrequency = 1000,
                                          const double massParameter = tudat::gravitation::circular_restricted_three_body_problem::computeMassParameter(
                                                             tudat::celestial_body_constants::EARTH_GRAVITATIONAL_PARAMETER,
-                                                            tudat::celestial_body_constants::MOON_GRAVITATIONAL_PARAMETER ) );
+                                                            tudat::celestial_body_constants::MOON_GRAVITATIONAL_PARAMETER ),
+                                         const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ),
+                                         const int numberOfTopConnections = 10, const bool refineConnection = false );
 
 #endif //TUDATBUNDLE_REFINEORBITCLEVEL_H
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
+#include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
+
+#include "adaptiveManifoldSeeding.h"
+#include "applyDifferentialCorrection.h"
+#include "connectManifoldsAtTheta.h"
+#include "continueHeteroclinicConnection.h"
+#include "manifoldConnectionFront.h"
+
+namespace
+{
+
+HeteroclinicConnection getUnconvergedHeteroclinicConnection( )
+{
+    HeteroclinicConnection heteroclinicConnection;
+    heteroclinicConnection.converged               = false;
+    heteroclinicConnection.numberOfIterations      = 0;
+    heteroclinicConnection.unstableOrbitTime       = 0.0;
+    heteroclinicConnection.unstableIntegrationTime = 0.0;
+    heteroclinicConnection.stableOrbitTime         = 0.0;
+    heteroclinicConnection.stableIntegrationTime   = 0.0;
+    heteroclinicConnection.deltaPosition           = 0.0;
+    heteroclinicConnection.deltaVelocity           = 0.0;
+    return heteroclinicConnection;
+}
+
+std::vector< int > getUniformSeedsOnOrbit( const int numberOfTrajectoriesPerManifold, const int numberOfPointsOnPeriodicOrbit )
+{
+    std::vector< int > uniformSeeds;
+    for ( int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < numberOfTrajectoriesPerManifold; trajectoryOnManifoldNumber++ ) {
+        uniformSeeds.push_back( static_cast< int >( std::floor( static_cast< double >( trajectoryOnManifoldNumber ) * numberOfPointsOnPeriodicOrbit /
+                                                                numberOfTrajectoriesPerManifold ) ) );
+    }
+    return uniformSeeds;
+}
+
+// Uniformly spaced seeds over [centralPhase - phaseWindow, centralPhase + phaseWindow], wrapped around the orbit
+std::vector< int > getLocalSeedsOnOrbit( const double centralPhase, const double phaseWindow, const int numberOfTrajectoriesPerManifold,
+                                         const int numberOfPointsOnPeriodicOrbit )
+{
+    std::vector< int > localSeeds;
+    for ( int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < numberOfTrajectoriesPerManifold; trajectoryOnManifoldNumber++ ) {
+        double phase = centralPhase;
+        if ( numberOfTrajectoriesPerManifold > 1 ) {
+            phase += phaseWindow * ( 2.0 * trajectoryOnManifoldNumber / ( numberOfTrajectoriesPerManifold - 1 ) - 1.0 );
+        }
+        localSeeds.push_back( std::min( static_cast< int >( std::floor( ( phase - std::floor( phase ) ) * numberOfPointsOnPeriodicOrbit ) ),
+                                        numberOfPointsOnPeriodicOrbit - 1 ) );
+    }
+    std::sort( localSeeds.begin( ), localSeeds.end( ) );
+    localSeeds.erase( std::unique( localSeeds.begin( ), localSeeds.end( ) ), localSeeds.end( ) );
+    return localSeeds;
+}
+
+// Fixed energy correction of the previous member of the family; nullptr if it does not converge
+std::shared_ptr< const RefinedPeriodicOrbit > continuePeriodicOrbit( const int librationPointNr, const std::string& orbitType,
+                                                                     const RefinedPeriodicOrbit& previousPeriodicOrbit,
+                                                                     const double desiredJacobiEnergy, const double massParameter )
+{
+    bool correctionConverged;
+    const Eigen::VectorXd correctionResult = applyFixedEnergyDifferentialCorrection( librationPointNr, orbitType,
+                                                                                     previousPeriodicOrbit.initialStateVector,
+                                                                                     previousPeriodicOrbit.orbitalPeriod, desiredJacobiEnergy,
+                                                                                     massParameter, 1.0E-12, 1.0E-12, 1.0E-12,
+                                                                                     correctionConverged );
+    if ( !correctionConverged ) {
+        return std::shared_ptr< const RefinedPeriodicOrbit >( );
+    }
+    return createRefinedPeriodicOrbit( correctionResult.segment( 0, 6 ), correctionResult( 6 ), massParameter, correctionResult );
+}
+
+}
+
+HeteroclinicConnection findHeteroclinicConnectionForSeeds( const RefinedPeriodicOrbit& periodicOrbitL1,
+                                                           const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                           const std::vector< int >& unstableIndicesOnOrbit,
+                                                           const std::vector< int >& stableIndicesOnOrbit,
+                                                           const PoincareSection& poincareSection, const double massParameter,
+                                                           const ManifoldTerminationSettings& terminationSettings )
+{
+    if ( unstableIndicesOnOrbit.empty( ) || stableIndicesOnOrbit.empty( ) ) {
+        return getUnconvergedHeteroclinicConnection( );
+    }
+
+    // The stable manifold is not propagated if no unstable trajectory reaches the section
+    ManifoldStatesAtSection unstableStatesAtSection;
+    ManifoldStatesAtSection stableStatesAtSection;
+    computeManifoldStatesAtSectionForSeeds( unstableStatesAtSection, periodicOrbitL1, unstableIndicesOnOrbit, massParameter, 1.0, 1.0,
+                                            poincareSection, 1.0E-6, 50.0, 1.0E-3, terminationSettings );
+    if ( unstableStatesAtSection.empty( ) ) {
+        return getUnconvergedHeteroclinicConnection( );
+    }
+    computeManifoldStatesAtSectionForSeeds( stableStatesAtSection, periodicOrbitL2, stableIndicesOnOrbit, massParameter, -1.0, -1.0,
+                                            poincareSection, 1.0E-6, 50.0, 1.0E-3, terminationSettings );
+
+    std::vector< ManifoldStatesAtSection::const_iterator > unstableSeeds;
+    std::vector< ManifoldStatesAtSection::const_iterator > stableSeeds;
+    std::vector< double > unstableSectionStates;
+    std::vector< double > stableSectionStates;
+    for ( ManifoldStatesAtSection::const_iterator seed = unstableStatesAtSection.begin( ); seed != unstableStatesAtSection.end( ); seed++ ) {
+        unstableSeeds.push_back( seed );
+        unstableSectionStates.insert( unstableSectionStates.end( ), seed->second.second.data( ), seed->second.second.data( ) + 6 );
+    }
+    for ( ManifoldStatesAtSection::const_iterator seed = stableStatesAtSection.begin( ); seed != stableStatesAtSection.end( ); seed++ ) {
+        stableSeeds.push_back( seed );
+        stableSectionStates.insert( stableSectionStates.end( ), seed->second.second.data( ), seed->second.second.data( ) + 6 );
+    }
+
+    const ManifoldConnectionFront connectionFront = computeManifoldConnectionFront( stableSectionStates, unstableSectionStates );
+    if ( connectionFront.paretoFront.empty( ) ) {
+        return getUnconvergedHeteroclinicConnection( );
+    }
+
+    // The member with the smallest deltaR lies on the wrong side of the section curves more often than not
+    const ManifoldConnectionCandidate* closestConnection = &connectionFront.paretoFront.front( );
+    for ( unsigned int candidateNumber = 1; candidateNumber < connectionFront.paretoFront.size( ); candidateNumber++ ) {
+        const ManifoldConnectionCandidate& connectionCandidate = connectionFront.paretoFront.at( candidateNumber );
+        if ( std::hypot( connectionCandidate.deltaPosition, connectionCandidate.deltaVelocity ) <
+             std::hypot( closestConnection->deltaPosition, closestConnection->deltaVelocity ) ) {
+            closestConnection = &connectionCandidate;
+        }
+    }
+
+    const ManifoldStatesAtSection::const_iterator unstableSeed = unstableSeeds.at( closestConnection->unstableTrajectoryNumber );
+    const ManifoldStatesAtSection::const_iterator stableSeed   = stableSeeds.at( closestConnection->stableTrajectoryNumber );
+    Eigen::Vector4d initialConnectionTimes;
+    initialConnectionTimes << periodicOrbitL1.stateTransitionMatrixHistory.getTime( unstableSeed->first ),
+            unstableSeed->second.first,
+            periodicOrbitL2.stateTransitionMatrixHistory.getTime( stableSeed->first ),
+            stableSeed->second.first;
+
+    return refineHeteroclinicConnection( periodicOrbitL1, periodicOrbitL2, initialConnectionTimes, poincareSection, massParameter );
+}
+
+std::vector< std::pair< double, HeteroclinicConnection > > continueHeteroclinicConnectionInJacobiEnergy(
+        const std::string orbitType, const double thetaStoppingAngle,
+        const double initialJacobiEnergy, const double finalJacobiEnergy, const double massParameter,
+        const double jacobiEnergyStepSize, const int numberOfTrajectoriesPerManifold,
+        const int numberOfLocalTrajectoriesPerManifold, const double localPhaseWindow,
+        const double minimumJacobiEnergyStepSize, const ManifoldTerminationSettings& terminationSettings )
+{
+    // Set output maximum precision
+    std::cout.precision(std::numeric_limits<double>::digits10);
+
+    int orbitOneL1;
+    int orbitTwoL1;
+    int orbitOneL2;
+    int orbitTwoL2;
+    getOrbitIdsForConnectionAtTheta( orbitType, orbitOneL1, orbitTwoL1, orbitOneL2, orbitTwoL2 );
+
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbitL1 = getRefinedPeriodicOrbit( 1, orbitType, initialJacobiEnergy,
+                                                                                             orbitOneL1, orbitTwoL1, massParameter );
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbitL2 = getRefinedPeriodicOrbit( 2, orbitType, initialJacobiEnergy,
+                                                                                             orbitOneL2, orbitTwoL2, massParameter );
+
+    const PoincareSection thetaSection = getThetaSection( thetaStoppingAngle, massParameter );
+    std::vector< std::pair< double, HeteroclinicConnection > > heteroclinicConnectionFamily;
+    HeteroclinicConnection heteroclinicConnection = findHeteroclinicConnectionForSeeds(
+                *periodicOrbitL1, *periodicOrbitL2,
+                getUniformSeedsOnOrbit( numberOfTrajectoriesPerManifold, periodicOrbitL1->stateTransitionMatrixHistory.size( ) ),
+                getUniformSeedsOnOrbit( numberOfTrajectoriesPerManifold, periodicOrbitL2->stateTransitionMatrixHistory.size( ) ),
+                thetaSection, massParameter, terminationSettings );
+
+    double jacobiEnergy = initialJacobiEnergy;
+    if ( heteroclinicConnection.converged ) {
+        heteroclinicConnectionFamily.push_back( std::make_pair( jacobiEnergy, heteroclinicConnection ) );
+        std::cout << "Heteroclinic connection at C = " << jacobiEnergy << " with deltaR = " << heteroclinicConnection.deltaPosition
+                  << " (deltaV = " << heteroclinicConnection.deltaVelocity << ")" << std::endl;
+    } else {
+        std::cout << "No heteroclinic connection at C = " << jacobiEnergy << ", theta = " << thetaStoppingAngle << std::endl;
+    }
+
+    const double continuationDirection = ( finalJacobiEnergy >= initialJacobiEnergy ? 1.0 : -1.0 );
+    double currentStepSize = jacobiEnergyStepSize;
+    while ( heteroclinicConnection.converged && continuationDirection * ( finalJacobiEnergy - jacobiEnergy ) > 0.0 ) {
+        const double nextJacobiEnergy = ( continuationDirection * ( finalJacobiEnergy - jacobiEnergy ) <= currentStepSize ?
+                                          finalJacobiEnergy : jacobiEnergy + continuationDirection * currentStepSize );
+
+        std::shared_ptr< const RefinedPeriodicOrbit > nextPeriodicOrbitL1 = continuePeriodicOrbit( 1, orbitType, *periodicOrbitL1,
+                                                                                                  nextJacobiEnergy, massParameter );
+        std::shared_ptr< const RefinedPeriodicOrbit > nextPeriodicOrbitL2 = continuePeriodicOrbit( 2, orbitType, *periodicOrbitL2,
+                                                                                                  nextJacobiEnergy, massParameter );
+
+        HeteroclinicConnection nextHeteroclinicConnection = getUnconvergedHeteroclinicConnection( );
+        if ( nextPeriodicOrbitL1 && nextPeriodicOrbitL2 ) {
+            // Predictor: same phase along either orbit and same integration times
+            Eigen::Vector4d predictedConnectionTimes;
+            predictedConnectionTimes << heteroclinicConnection.unstableOrbitTime * nextPeriodicOrbitL1->orbitalPeriod / periodicOrbitL1->orbitalPeriod,
+                    heteroclinicConnection.unstableIntegrationTime,
+                    heteroclinicConnection.stableOrbitTime * nextPeriodicOrbitL2->orbitalPeriod / periodicOrbitL2->orbitalPeriod,
+                    heteroclinicConnection.stableIntegrationTime;
+            nextHeteroclinicConnection = refineHeteroclinicConnection( *nextPeriodicOrbitL1, *nextPeriodicOrbitL2, predictedConnectionTimes,
+                                                                       thetaSection, massParameter );
+
+            // Re-seed the manifolds around the previous connection only
+            if ( !nextHeteroclinicConnection.converged ) {
+                std::cout << "Predicted connection at C = " << nextJacobiEnergy << " did not converge, re-seeding locally" << std::endl;
+                nextHeteroclinicConnection = findHeteroclinicConnectionForSeeds(
+                            *nextPeriodicOrbitL1, *nextPeriodicOrbitL2,
+                            getLocalSeedsOnOrbit( heteroclinicConnection.unstableOrbitTime / periodicOrbitL1->orbitalPeriod, localPhaseWindow,
+                                                  numberOfLocalTrajectoriesPerManifold, nextPeriodicOrbitL1->stateTransitionMatrixHistory.size( ) ),
+                            getLocalSeedsOnOrbit( heteroclinicConnection.stableOrbitTime / periodicOrbitL2->orbitalPeriod, localPhaseWindow,
+                                                  numberOfLocalTrajectoriesPerManifold, nextPeriodicOrbitL2->stateTransitionMatrixHistory.size( ) ),
+                            thetaSection, massParameter, terminationSettings );
+            }
+        }
+
+        if ( nextHeteroclinicConnection.converged ) {
+            jacobiEnergy           = nextJacobiEnergy;
+            periodicOrbitL1        = nextPeriodicOrbitL1;
+            periodicOrbitL2        = nextPeriodicOrbitL2;
+            heteroclinicConnection = nextHeteroclinicConnection;
+            heteroclinicConnectionFamily.push_back( std::make_pair( jacobiEnergy, heteroclinicConnection ) );
+            std::cout << "Heteroclinic connection at C = " << jacobiEnergy << " with deltaR = " << heteroclinicConnection.deltaPosition
+                      << " (deltaV = " << heteroclinicConnection.deltaVelocity << ")" << std::endl;
+
+            currentStepSize = std::min( 2.0 * currentStepSize, jacobiEnergyStepSize );
+        } else {
+            currentStepSize /= 2.0;
+            if ( currentStepSize < minimumJacobiEnergyStepSize ) {
+                std::cout << "Continuation of the heteroclinic connection stopped at C = " << jacobiEnergy << std::endl;
+                break;
+            }
+        }
+    }
+
+    std::ostringstream thetaStoppingAngleStr;
+    thetaStoppingAngleStr << std::setprecision(4) << thetaStoppingAngle;
+    writeHeteroclinicConnectionFamilyToFile( heteroclinicConnectionFamily, "../data/raw/poincare_sections/" + orbitType + "_" +
+                                             thetaStoppingAngleStr.str() + "_heteroclinic_connection_family.txt" );
+
+    return heteroclinicConnectionFamily;
+}
@@ -0,0 +1,43 @@
+#ifndef TUDATBUNDLE_CONTINUEHETEROCLINICCONNECTION_H
+#define TUDATBUNDLE_CONTINUEHETEROCLINICCONNECTION_H
+
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+#include "manifoldTermination.h"
+#include "poincareSection.h"
+#include "refineHeteroclinicConnection.h"
+#include "refinedPeriodicOrbitCache.h"
+
+// Connection between the unstable manifold of periodicOrbitL1 and the stable manifold of periodicOrbitL2 at the section, refined
+// from the (deltaR, deltaV) Pareto front member closest to the origin over the given seeds (indices on either orbit). Only
+// seeds that reach the section take part; without seeds, or if none of either manifold reaches the section, the result is
+// not converged.
+HeteroclinicConnection findHeteroclinicConnectionForSeeds( const RefinedPeriodicOrbit& periodicOrbitL1,
+                                                           const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                           const std::vector< int >& unstableIndicesOnOrbit,
+                                                           const std::vector< int >& stableIndicesOnOrbit,
+                                                           const PoincareSection& poincareSection, const double massParameter,
+                                                           const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+// Continues the connection at theta from initialJacobiEnergy to finalJacobiEnergy. Only the first member follows from a
+// full sweep of numberOfTrajectoriesPerManifold seeds; every next member warm starts the L1/L2 orbits from the previous ones
+// and the refinement from the previous connection times (orbit times scaled with the period). If that fails, only
+// numberOfLocalTrajectoriesPerManifold seeds within localPhaseWindow of the previous connection phases are propagated,
+// and if that fails too the energy step is halved down to minimumJacobiEnergyStepSize. Writes the family to
+// <orbitType>_<theta>_heteroclinic_connection_family.txt, one row per converged member.
+std::vector< std::pair< double, HeteroclinicConnection > > continueHeteroclinicConnectionInJacobiEnergy(
+        const std::string orbitType, const double thetaStoppingAngle,
+        const double initialJacobiEnergy, const double finalJacobiEnergy, const double massParameter,
+        const double jacobiEnergyStepSize = 1.0E-3, const int numberOfTrajectoriesPerManifold = 100,
+        const int numberOfLocalTrajectoriesPerManifold = 10, const double localPhaseWindow = 2.0E-2,
+        const double minimumJacobiEnergyStepSize = 1.0E-5,
+        const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+#endif  // TUDATBUNDLE_CONTINUEHETEROCLINICCONNECTION_H
@@ -13,8 +13,10 @@
 #include "createInitialConditions.h"
 #include "applyDifferentialCorrection.h"
 #include "checkEigenvalues.h"
+#include "numpyOutput.h"
 #include "propagateOrbit.h"
 #include "richardsonThirdOrderApproximation.h"
+#include "textOutput.h"
 
 
 void appendResultsVector(const double jacobiEnergy, const double orbitalPeriod, const Eigen::VectorXd& initialStateVector,
@@ -201,10 +203,10 @@ Eigen::MatrixXd getCorrectedInitialState( const Eigen::Vector6d& initialStateGue
     orbitalPeriod = differentialCorrectionResult( 6 );
 
     // Propagate the initialStateVector for a full period and write output to file.
-    std::map< double, Eigen::Vector6d > stateHistory;
+    TrajectoryBuffer stateHistory;
     Eigen::MatrixXd stateVectorInclSTM = propagateOrbitToFinalCondition(
                 getFullInitialState( initialStateVector ), massParameter, orbitalPeriod, 1, stateHistory, 1000, 0.0 ).first;
-    writeStateHistoryToFile( stateHistory, orbitNumber, orbitType, librationPointNr, 1000, false );
+    writeStateHistoryToFileAsynchronously( std::move( stateHistory ), orbitNumber, orbitType, librationPointNr, 1000, false );
 
     // Save results
     double jacobiEnergyHalfPeriod = tudat::gravitation::computeJacobiEnergy( massParameter, differentialCorrectionResult.segment( 7, 6 ) );
@@ -217,56 +219,52 @@ Eigen::MatrixXd getCorrectedInitialState( const Eigen::Vector6d& initialStateGue
 
 }
 
+void writeFinalResultsToNumpyFiles( const int librationPointNr, const std::string orbitType,
+                                    const std::vector< Eigen::VectorXd >& initialConditions,
+                                    const std::vector< Eigen::VectorXd >& differentialCorrections )
+{
+    // Same columns as the text files, one row per family member
+    std::vector< double > initialConditionsRows;
+    std::vector< double > differentialCorrectionsRows;
+    for (unsigned int i=0; i<initialConditions.size(); i++) {
+        initialConditionsRows.insert(initialConditionsRows.end(), initialConditions[i].data(), initialConditions[i].data() + 44);
+        differentialCorrectionsRows.insert(differentialCorrectionsRows.end(), differentialCorrections[i].data(), differentialCorrections[i].data() + 9);
+    }
+
+    const std::string fileNameStringInitialConditions = "../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_initial_conditions.txt";
+    const std::string fileNameStringDifferentialCorrection = "../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_differential_correction.txt";
+    removeDataProductFiles(fileNameStringInitialConditions);
+    removeDataProductFiles(fileNameStringDifferentialCorrection);
+    writeNumpyArrayToFile(getNumpyFileName(fileNameStringInitialConditions, ".npy"), initialConditionsRows, 44);
+    writeNumpyArrayToFile(getNumpyFileName(fileNameStringDifferentialCorrection, ".npy"), differentialCorrectionsRows, 9);
+}
+
 void writeFinalResultsToFiles( const int librationPointNr, const std::string orbitType,
                                std::vector< Eigen::VectorXd > initialConditions,
                                std::vector< Eigen::VectorXd > differentialCorrections )
 {
+    if (getDataOutputFormat() == numpy_data_output) {
+        writeFinalResultsToNumpyFiles(librationPointNr, orbitType, initialConditions, differentialCorrections);
+        return;
+    }
+
     // Prepare file for initial conditions
-    remove(("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_initial_conditions.txt").c_str());
-    std::ofstream textFileInitialConditions;
-    textFileInitialConditions.open(("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_initial_conditions.txt"));
-    textFileInitialConditions.precision(std::numeric_limits<double>::digits10);
+    removeDataProductFiles("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_initial_conditions.txt");
+    TextTableWriter textFileInitialConditions("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_initial_conditions.txt",
+                                              std::numeric_limits<double>::digits10);
 
     // Prepare file for differential correction
-    remove(("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_differential_correction.txt").c_str());
-    std::ofstream textFileDifferentialCorrection;
-    textFileDifferentialCorrection.open(("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_differential_correction.txt"));
-    textFileDifferentialCorrection.precision(std::numeric_limits<double>::digits10);
+    removeDataProductFiles("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_differential_correction.txt");
+    TextTableWriter textFileDifferentialCorrection("../data/raw/orbits/L" + std::to_string(librationPointNr) + "_" + orbitType + "_differential_correction.txt",
+                                                   std::numeric_limits<double>::digits10);
 
-    // Write initial conditions to file
+    // Write initial conditions to file, 44 and 9 columns
     for (unsigned int i=0; i<initialConditions.size(); i++) {
-
-        textFileInitialConditions << std::left << std::scientific                                          << std::setw(25)
-                                  << initialConditions[i][0]  << std::setw(25) << initialConditions[i][1]  << std::setw(25)
-                                  << initialConditions[i][2]  << std::setw(25) << initialConditions[i][3]  << std::setw(25)
-                                  << initialConditions[i][4]  << std::setw(25) << initialConditions[i][5]  << std::setw(25)
-                                  << initialConditions[i][6]  << std::setw(25) << initialConditions[i][7]  << std::setw(25)
-                                  << initialConditions[i][8]  << std::setw(25) << initialConditions[i][9]  << std::setw(25)
-                                  << initialConditions[i][10] << std::setw(25) << initialConditions[i][11] << std::setw(25)
-                                  << initialConditions[i][12] << std::setw(25) << initialConditions[i][13] << std::setw(25)
-                                  << initialConditions[i][14] << std::setw(25) << initialConditions[i][15] << std::setw(25)
-                                  << initialConditions[i][16] << std::setw(25) << initialConditions[i][17] << std::setw(25)
-                                  << initialConditions[i][18] << std::setw(25) << initialConditions[i][19] << std::setw(25)
-                                  << initialConditions[i][20] << std::setw(25) << initialConditions[i][21] << std::setw(25)
-                                  << initialConditions[i][22] << std::setw(25) << initialConditions[i][23] << std::setw(25)
-                                  << initialConditions[i][24] << std::setw(25) << initialConditions[i][25] << std::setw(25)
-                                  << initialConditions[i][26] << std::setw(25) << initialConditions[i][27] << std::setw(25)
-                                  << initialConditions[i][28] << std::setw(25) << initialConditions[i][29] << std::setw(25)
-                                  << initialConditions[i][30] << std::setw(25) << initialConditions[i][31] << std::setw(25)
-                                  << initialConditions[i][32] << std::setw(25) << initialConditions[i][33] << std::setw(25)
-                                  << initialConditions[i][34] << std::setw(25) << initialConditions[i][35] << std::setw(25)
-                                  << initialConditions[i][36] << std::setw(25) << initialConditions[i][37] << std::setw(25)
-                                  << initialConditions[i][38] << std::setw(25) << initialConditions[i][39] << std::setw(25)
-                                  << initialConditions[i][40] << std::setw(25) << initialConditions[i][41] << std::setw(25)
-                                  << initialConditions[i][42] << std::setw(25) << initialConditions[i][43] << std::endl;
-
-        textFileDifferentialCorrection << std::left << std::scientific   << std::setw(25)
-                                       << differentialCorrections[i][0]  << std::setw(25) << differentialCorrections[i][1 ]  << std::setw(25)
-                                       << differentialCorrections[i][2 ]  << std::setw(25) << differentialCorrections[i][3]  << std::setw(25)
-                                       << differentialCorrections[i][4]  << std::setw(25) << differentialCorrections[i][5]  << std::setw(25)
-                                       << differentialCorrections[i][6]  << std::setw(25) << differentialCorrections[i][7]  << std::setw(25)
-                                       << differentialCorrections[i][8]  << std::setw(25) << std::endl;
+        textFileInitialConditions.appendRow(initialConditions[i].data(), 44);
+        textFileDifferentialCorrection.appendRow(differentialCorrections[i].data(), 9);
     }
+    textFileInitialConditions.close();
+    textFileDifferentialCorrection.close();
 }
 
 bool checkTermination( const std::vector< Eigen::VectorXd >& differentialCorrections,
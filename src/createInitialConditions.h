@@ -29,6 +29,11 @@ Eigen::MatrixXd getCorrectedInitialState( const Eigen::Vector6d& initialStateGue
                                           std::vector< Eigen::VectorXd >& differentialCorrections,
                                           const double maxPositionDeviationFromPeriodicOrbit = 1.0e-12, const double maxVelocityDeviationFromPeriodicOrbit = 1.0e-12 );
 
+// Writes initial_conditions.npy and differential_correction.npy with the columns of the text files
+void writeFinalResultsToNumpyFiles( const int librationPointNr, const std::string orbitType,
+                                    const std::vector< Eigen::VectorXd >& initialConditions,
+                                    const std::vector< Eigen::VectorXd >& differentialCorrections );
+
 void writeFinalResultsToFiles( const int librationPointNr, const std::string orbitType,
                                std::vector< Eigen::VectorXd > initialConditions,
                                std::vector< Eigen::VectorXd > differentialCorrections );
@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "initialConditionsTable.h"
+#include "numpyOutput.h"
+
+// The file is mapped with the POSIX mmap and the values are parsed with the 128-bit integers and bit scan builtins of GCC
+// and Clang
+#if !defined( __SIZEOF_INT128__ ) || !defined( __GNUC__ )
+#error "initialConditionsTable.cpp requires unsigned __int128 and __builtin_clzll (GCC or Clang on a 64-bit target)"
+#endif
+
+namespace
+{
+
+bool isSpace( const char character )
+{
+    return character == ' ' || character == '\t' || character == '\r' || character == '\n' || character == '\v' ||
+           character == '\f';
+}
+
+bool isDigit( const char character )
+{
+    return character >= '0' && character <= '9';
+}
+
+int getBitLength( const unsigned __int128 value )
+{
+    const uint64_t highBits = static_cast< uint64_t >( value >> 64 );
+    const uint64_t lowBits  = static_cast< uint64_t >( value );
+    if ( highBits != 0 ) {
+        return 128 - __builtin_clzll( highBits );
+    }
+    return ( lowBits == 0 ? 0 : 64 - __builtin_clzll( lowBits ) );
+}
+
+// Correctly rounded mantissa * 10^decimalExponent for a nonzero mantissa. Small cases are a single exact multiplication or
+// division of doubles; otherwise the significand is computed as mantissa * 5^k (or mantissa * 2^( 64 + s ) / 5^k for
+// negative exponents) in 128 bits and rounded half to even to 53 bits, with the division remainder as sticky bit.
+// Returns false for exponents beyond +-27, where 5^k no longer fits in 64 bits.
+bool convertDecimalExactly( const uint64_t mantissa, const int decimalExponent, double& value )
+{
+    static const double exactPowersOfTen[ 23 ] = {
+        1.0E0, 1.0E1, 1.0E2, 1.0E3, 1.0E4, 1.0E5, 1.0E6, 1.0E7, 1.0E8, 1.0E9, 1.0E10, 1.0E11, 1.0E12, 1.0E13, 1.0E14, 1.0E15,
+        1.0E16, 1.0E17, 1.0E18, 1.0E19, 1.0E20, 1.0E21, 1.0E22 };
+    if ( mantissa <= ( uint64_t( 1 ) << 53 ) && decimalExponent >= -22 && decimalExponent <= 22 ) {
+        value = ( decimalExponent < 0 ? static_cast< double >( mantissa ) / exactPowersOfTen[ -decimalExponent ]
+                                      : static_cast< double >( mantissa ) * exactPowersOfTen[ decimalExponent ] );
+        return true;
+    }
+    if ( decimalExponent < -27 || decimalExponent > 27 ) {
+        return false;
+    }
+
+    uint64_t powerOfFive = 1;
+    for ( int factorNumber = 0; factorNumber < std::abs( decimalExponent ); factorNumber++ ) {
+        powerOfFive *= 5;
+    }
+
+    unsigned __int128 significand;
+    int binaryExponent;
+    bool inexact = false;
+    if ( decimalExponent >= 0 ) {
+        significand = static_cast< unsigned __int128 >( mantissa ) * powerOfFive;
+        binaryExponent = decimalExponent;
+    } else {
+        // The normalised mantissa shifted by 64 bits leaves at least 65 bits in the quotient
+        const int leadingZeros = __builtin_clzll( mantissa );
+        const unsigned __int128 numerator = static_cast< unsigned __int128 >( mantissa << leadingZeros ) << 64;
+        significand = numerator / powerOfFive;
+        inexact = ( numerator - significand * powerOfFive ) != 0;
+        binaryExponent = decimalExponent - 64 - leadingZeros;
+    }
+
+    const int bitLength = getBitLength( significand );
+    if ( bitLength > 53 ) {
+        const int shift = bitLength - 53;
+        const unsigned __int128 lostBits = significand & ( ( static_cast< unsigned __int128 >( 1 ) << shift ) - 1 );
+        const unsigned __int128 half = static_cast< unsigned __int128 >( 1 ) << ( shift - 1 );
+        significand >>= shift;
+        binaryExponent += shift;
+        if ( lostBits > half || ( lostBits == half && ( inexact || ( significand & 1 ) ) ) ) {
+            significand++;
+        }
+    }
+    value = std::ldexp( static_cast< double >( static_cast< uint64_t >( significand ) ), binaryExponent );
+    return true;
+}
+
+// strtod on a copy of the token, which in a mapped file is not followed by a terminating zero
+const char* parseWithStrtod( const char* begin, const char* end, double& value )
+{
+    const char* tokenEnd = begin;
+    while ( tokenEnd < end && !isSpace( *tokenEnd ) ) {
+        tokenEnd++;
+    }
+    const std::string token( begin, tokenEnd );
+    char* numberEnd;
+    value = std::strtod( token.c_str( ), &numberEnd );
+    return begin + ( numberEnd - token.c_str( ) );
+}
+
+struct FileIdentity
+{
+    std::string fileName;
+    long long fileSize;
+    long long modificationTime;
+
+    bool operator==( const FileIdentity& other ) const
+    {
+        return fileName == other.fileName && fileSize == other.fileSize && modificationTime == other.modificationTime;
+    }
+};
+
+// The file the table is read from: the text file, or if there is none the .npy file
+FileIdentity getFileIdentity( const std::string& textFileName )
+{
+    struct stat fileStatus;
+    FileIdentity identity = { textFileName, -1, -1 };
+    if ( stat( textFileName.c_str( ), &fileStatus ) != 0 ) {
+        identity.fileName = getNumpyFileName( textFileName, ".npy" );
+        if ( stat( identity.fileName.c_str( ), &fileStatus ) != 0 ) {
+            return identity;
+        }
+    }
+    identity.fileSize = static_cast< long long >( fileStatus.st_size );
+    identity.modificationTime = static_cast< long long >( fileStatus.st_mtime );
+    return identity;
+}
+
+typedef std::shared_future< std::shared_ptr< const InitialConditionsTable > > InitialConditionsTableFuture;
+
+std::mutex initialConditionsTableCacheMutex;
+std::map< std::string, std::pair< FileIdentity, InitialConditionsTableFuture > > initialConditionsTableCache;
+
+}
+
+const char* parseFloatingPointNumber( const char* begin, const char* end, double& value )
+{
+    const char* character = begin;
+    bool negative = false;
+    if ( character < end && ( *character == '-' || *character == '+' ) ) {
+        negative = ( *character == '-' );
+        character++;
+    }
+
+    // Up to 19 significant digits fit in the mantissa; leading zeros are skipped
+    uint64_t mantissa = 0;
+    int numberOfSignificantDigits = 0;
+    int decimalExponent = 0;
+    bool digitsFound = false;
+    bool digitsDropped = false;
+    while ( character < end && isDigit( *character ) ) {
+        digitsFound = true;
+        if ( numberOfSignificantDigits < 19 ) {
+            mantissa = 10 * mantissa + ( *character - '0' );
+            numberOfSignificantDigits += ( mantissa != 0 );
+        } else {
+            decimalExponent++;
+            digitsDropped |= ( *character != '0' );
+        }
+        character++;
+    }
+    if ( character < end && *character == '.' ) {
+        character++;
+        while ( character < end && isDigit( *character ) ) {
+            digitsFound = true;
+            if ( numberOfSignificantDigits < 19 ) {
+                mantissa = 10 * mantissa + ( *character - '0' );
+                numberOfSignificantDigits += ( mantissa != 0 );
+                decimalExponent--;
+            } else {
+                digitsDropped |= ( *character != '0' );
+            }
+            character++;
+        }
+    }
+
+    // nan, inf, hexadecimal numbers and anything else unusual
+    if ( !digitsFound || digitsDropped || ( character < end && ( *character == 'x' || *character == 'X' ) ) ) {
+        return parseWithStrtod( begin, end, value );
+    }
+
+    // An exponent is only part of the number if it has digits, as in strtod
+    if ( character < end && ( *character == 'e' || *character == 'E' ) ) {
+        const char* exponentCharacter = character + 1;
+        bool negativeExponent = false;
+        if ( exponentCharacter < end && ( *exponentCharacter == '-' || *exponentCharacter == '+' ) ) {
+            negativeExponent = ( *exponentCharacter == '-' );
+            exponentCharacter++;
+        }
+        if ( exponentCharacter < end && isDigit( *exponentCharacter ) ) {
+            int explicitExponent = 0;
+            while ( exponentCharacter < end && isDigit( *exponentCharacter ) ) {
+                explicitExponent = std::min( 10 * explicitExponent + ( *exponentCharacter - '0' ), 100000 );
+                exponentCharacter++;
+            }
+            decimalExponent += ( negativeExponent ? -explicitExponent : explicitExponent );
+            character = exponentCharacter;
+        }
+    }
+
+    if ( mantissa == 0 ) {
+        value = ( negative ? -0.0 : 0.0 );
+        return character;
+    }
+    if ( !convertDecimalExactly( mantissa, decimalExponent, value ) ) {
+        return parseWithStrtod( begin, end, value );
+    }
+    if ( negative ) {
+        value = -value;
+    }
+    return character;
+}
+
+InitialConditionsTable::InitialConditionsTable( const std::string& fileName ):
+    fileName_( fileName ), numberOfOrbits_( 0 ), numberOfColumns_( 0 )
+{
+    const int fileDescriptor = open( fileName.c_str( ), O_RDONLY );
+
+    // Families computed with numpy output only have the .npy file, with the same columns
+    if ( fileDescriptor < 0 ) {
+        const std::string numpyFileName = getNumpyFileName( fileName, ".npy" );
+        if ( access( numpyFileName.c_str( ), R_OK ) != 0 ) {
+            throw std::runtime_error( "Initial conditions: could not open " + fileName );
+        }
+        const std::vector< double > rows = readNumpyArrayFromFile( numpyFileName, numberOfColumns_ );
+        numberOfOrbits_ = ( numberOfColumns_ > 0 ? static_cast< int >( rows.size( ) ) / numberOfColumns_ : 0 );
+        values_.resize( rows.size( ) );
+        for ( int orbitId = 0; orbitId < numberOfOrbits_; orbitId++ ) {
+            for ( int columnNumber = 0; columnNumber < numberOfColumns_; columnNumber++ ) {
+                values_[ columnNumber * numberOfOrbits_ + orbitId ] = rows[ orbitId * numberOfColumns_ + columnNumber ];
+            }
+        }
+        return;
+    }
+
+    struct stat fileStatus;
+    if ( fstat( fileDescriptor, &fileStatus ) != 0 ) {
+        close( fileDescriptor );
+        throw std::runtime_error( "Initial conditions: could not read the size of " + fileName );
+    }
+    const std::size_t fileLength = static_cast< std::size_t >( fileStatus.st_size );
+    void* mappedData = nullptr;
+    if ( fileLength > 0 ) {
+        mappedData = mmap( nullptr, fileLength, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+    }
+    close( fileDescriptor );
+    if ( mappedData == MAP_FAILED ) {
+        throw std::runtime_error( "Initial conditions: could not map " + fileName );
+    }
+    if ( fileLength > 0 ) {
+        madvise( mappedData, fileLength, MADV_SEQUENTIAL );
+    }
+
+    // The values are copied out while parsing, the mapping is only needed until then
+    try {
+        parseText( static_cast< const char* >( mappedData ), fileLength );
+    } catch ( ... ) {
+        if ( fileLength > 0 ) {
+            munmap( mappedData, fileLength );
+        }
+        throw;
+    }
+    if ( fileLength > 0 ) {
+        munmap( mappedData, fileLength );
+    }
+}
+
+const double* InitialConditionsTable::getColumn( const int columnNumber ) const
+{
+    if ( columnNumber < 0 || columnNumber >= numberOfColumns_ ) {
+        throw std::out_of_range( "Initial conditions: column " + std::to_string( columnNumber ) + " not in " + fileName_ );
+    }
+    return values_.data( ) + static_cast< std::size_t >( columnNumber ) * numberOfOrbits_;
+}
+
+double InitialConditionsTable::getValue( const int orbitId, const int columnNumber ) const
+{
+    if ( orbitId < 0 || orbitId >= numberOfOrbits_ ) {
+        throw std::out_of_range( "Initial conditions: orbit " + std::to_string( orbitId ) + " not in " + fileName_ );
+    }
+    return getColumn( columnNumber )[ orbitId ];
+}
+
+std::vector< double > InitialConditionsTable::getRow( const int orbitId ) const
+{
+    std::vector< double > row( numberOfColumns_ );
+    for ( int columnNumber = 0; columnNumber < numberOfColumns_; columnNumber++ ) {
+        row[ columnNumber ] = getValue( orbitId, columnNumber );
+    }
+    return row;
+}
+
+void InitialConditionsTable::parseText( const char* data, const std::size_t length )
+{
+    const char* character = data;
+    const char* end = data + length;
+
+    // Every value is written straight to its place in the column-major table, sized for the number of lines; the columns
+    // are known after the first row, which is collected separately
+    const int maximumNumberOfOrbits = static_cast< int >( std::count( data, end, '\n' ) ) + 1;
+    std::vector< double > firstRow;
+    int lineNumber = 0;
+    while ( character < end ) {
+        lineNumber++;
+        const char* lineEnd = static_cast< const char* >( std::memchr( character, '\n', end - character ) );
+        if ( lineEnd == nullptr ) {
+            lineEnd = end;
+        }
+
+        int columnNumber = 0;
+        while ( true ) {
+            while ( character < lineEnd && isSpace( *character ) ) {
+                character++;
+            }
+            if ( character == lineEnd ) {
+                break;
+            }
+
+            double value;
+            const char* valueEnd = parseFloatingPointNumber( character, lineEnd, value );
+            if ( valueEnd == character || ( valueEnd < lineEnd && !isSpace( *valueEnd ) ) ) {
+                throw std::runtime_error( "Initial conditions: could not parse line " + std::to_string( lineNumber ) +
+                                          " of " + fileName_ );
+            }
+            if ( numberOfOrbits_ == 0 ) {
+                firstRow.push_back( value );
+            } else if ( columnNumber < numberOfColumns_ ) {
+                values_[ static_cast< std::size_t >( columnNumber ) * maximumNumberOfOrbits + numberOfOrbits_ ] = value;
+            }
+            columnNumber++;
+            character = valueEnd;
+        }
+        character = lineEnd + 1;
+
+        if ( columnNumber == 0 ) {
+            continue;
+        }
+        if ( numberOfOrbits_ == 0 ) {
+            numberOfColumns_ = columnNumber;
+            values_.resize( static_cast< std::size_t >( numberOfColumns_ ) * maximumNumberOfOrbits );
+            for ( int firstRowColumn = 0; firstRowColumn < numberOfColumns_; firstRowColumn++ ) {
+                values_[ static_cast< std::size_t >( firstRowColumn ) * maximumNumberOfOrbits ] = firstRow[ firstRowColumn ];
+            }
+        } else if ( columnNumber != numberOfColumns_ ) {
+            throw std::runtime_error( "Initial conditions: line " + std::to_string( lineNumber ) + " of " + fileName_ +
+                                      " has " + std::to_string( columnNumber ) + " values instead of " +
+                                      std::to_string( numberOfColumns_ ) );
+        }
+        numberOfOrbits_++;
+    }
+
+    // Close the gaps left by empty lines
+    if ( numberOfOrbits_ < maximumNumberOfOrbits ) {
+        for ( int columnNumber = 1; columnNumber < numberOfColumns_; columnNumber++ ) {
+            std::copy( values_.begin( ) + static_cast< std::size_t >( columnNumber ) * maximumNumberOfOrbits,
+                       values_.begin( ) + static_cast< std::size_t >( columnNumber ) * maximumNumberOfOrbits + numberOfOrbits_,
+                       values_.begin( ) + static_cast< std::size_t >( columnNumber ) * numberOfOrbits_ );
+        }
+        values_.resize( static_cast< std::size_t >( numberOfColumns_ ) * numberOfOrbits_ );
+        values_.shrink_to_fit( );
+    }
+}
+
+std::shared_ptr< const InitialConditionsTable > getInitialConditionsTable( const int librationPointNr,
+                                                                           const std::string& orbitType )
+{
+    const std::string fileName = "../data/raw/orbits/L" + std::to_string( librationPointNr ) + "_" + orbitType +
+            "_initial_conditions.txt";
+    const FileIdentity fileIdentity = getFileIdentity( fileName );
+
+    // Either pick up the (possibly still pending) table of an unchanged file, or claim parsing it
+    bool parsingClaimed = false;
+    std::promise< std::shared_ptr< const InitialConditionsTable > > parsingPromise;
+    InitialConditionsTableFuture initialConditionsTable;
+    {
+        std::lock_guard< std::mutex > lock( initialConditionsTableCacheMutex );
+        std::map< std::string, std::pair< FileIdentity, InitialConditionsTableFuture > >::iterator cacheEntry =
+                initialConditionsTableCache.find( fileName );
+        if ( cacheEntry != initialConditionsTableCache.end( ) && cacheEntry->second.first == fileIdentity ) {
+            initialConditionsTable = cacheEntry->second.second;
+        } else {
+            initialConditionsTable = parsingPromise.get_future( ).share( );
+            initialConditionsTableCache[ fileName ] = std::make_pair( fileIdentity, initialConditionsTable );
+            parsingClaimed = true;
+        }
+    }
+
+    if ( parsingClaimed ) {
+        try {
+            parsingPromise.set_value( std::make_shared< InitialConditionsTable >( fileName ) );
+        }
+        catch( ... ) {
+            parsingPromise.set_exception( std::current_exception( ) );
+        }
+    }
+
+    return initialConditionsTable.get( );
+}
+
+void clearInitialConditionsTableCache( )
+{
+    std::lock_guard< std::mutex > lock( initialConditionsTableCacheMutex );
+    initialConditionsTableCache.clear( );
+}
@@ -0,0 +1,56 @@
+#ifndef TUDATBUNDLE_INITIALCONDITIONSTABLE_H
+#define TUDATBUNDLE_INITIALCONDITIONSTABLE_H
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Parses the decimal number starting at begin (optional sign, digits, decimal point, exponent; also nan and inf) with the
+// same result as strtod, without reading beyond end. Numbers with at most 19 significant digits and a decimal exponent
+// within +-27 are converted exactly with integer arithmetic, all others by strtod. Returns the end of the number, or
+// begin if no number starts there.
+const char* parseFloatingPointNumber( const char* begin, const char* end, double& value );
+
+// Read-only, column-major copy of an initial conditions file (one orbit per row: Jacobi energy, orbital period, initial
+// state and monodromy matrix). The text file is mapped into memory and tokenised in place, without a copy per line; a
+// family that was only written as .npy is read from that file instead.
+class InitialConditionsTable
+{
+public:
+    explicit InitialConditionsTable( const std::string& fileName );
+
+    const std::string& getFileName( ) const { return fileName_; }
+
+    int getNumberOfOrbits( ) const { return numberOfOrbits_; }
+
+    int getNumberOfColumns( ) const { return numberOfColumns_; }
+
+    // Values of columnNumber for all orbits, contiguous in memory
+    const double* getColumn( const int columnNumber ) const;
+
+    double getValue( const int orbitId, const int columnNumber ) const;
+
+    std::vector< double > getRow( const int orbitId ) const;
+
+private:
+    InitialConditionsTable( const InitialConditionsTable& );
+    InitialConditionsTable& operator=( const InitialConditionsTable& );
+
+    void parseText( const char* data, const std::size_t length );
+
+    const std::string fileName_;
+    int numberOfOrbits_;
+    int numberOfColumns_;
+    std::vector< double > values_;
+};
+
+// Table of ../data/raw/orbits/L<librationPointNr>_<orbitType>_initial_conditions.txt (or .npy), parsed once per process;
+// concurrent callers wait for and share that single table. The table is parsed again when the file has been rewritten
+// since, e.g. by createInitialConditions.
+std::shared_ptr< const InitialConditionsTable > getInitialConditionsTable( const int librationPointNr,
+                                                                           const std::string& orbitType );
+
+void clearInitialConditionsTableCache( );
+
+#endif  // TUDATBUNDLE_INITIALCONDITIONSTABLE_H
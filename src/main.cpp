@@ -14,12 +14,24 @@
 #include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
 #include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
 
+#include "adaptiveManifoldSeeding.h"
+#include "asynchronousOutputWriter.h"
 #include "createInitialConditions.h"
 #include "computeManifolds.h"
 #include "propagateOrbit.h"
 //#include "completeInitialConditionsHaloFamily.h"
 //#include "createInitialConditionsAxialFamily.h"
 #include "connectManifoldsAtTheta.h"
+#include "continueHeteroclinicConnection.h"
+#include "manifoldConnectionMatrix.h"
+#include "manifoldConnectionSweep.h"
+#include "manifoldSectionCrossings.h"
+#include "manifoldTermination.h"
+#include "numpyOutput.h"
+#include "refinedPeriodicOrbitCache.h"
+#include "trajectoryArchive.h"
+#include "trajectoryDecimation.h"
+#include "trajectoryReducers.h"
 //#include "omp.h"
 
 
@@ -27,6 +39,37 @@ double massParameter = tudat::gravitation::circular_restricted_three_body_proble
 
 int main (){
 
+    // Data products are written as .npy/.npz instead of text (column schemas in docs/output_formats.txt); the python
+    // loaders in python/util/load_data.py read either format
+    bool writeNumpyOutput = false;
+    setDataOutputFormat(writeNumpyOutput ? numpy_data_output : text_data_output);
+
+    // Orbits, manifolds, eigenvectors and manifold histories at theta are appended to one indexed archive per run instead
+    // of a file each; read it with TrajectoryArchiveReader or python/util/trajectory_archive.py. Compressed archives store
+    // the time and state columns losslessly XOR-encoded against their extrapolation (xorFloatCodec.h).
+    bool writeTrajectoryArchive = false;
+    bool compressTrajectoryArchive = false;
+    if (writeTrajectoryArchive) {
+        openTrajectoryArchive("../data/raw/trajectories.cr3bp",
+                              compressTrajectoryArchive ? xor_float_trajectory_encoding : raw_trajectory_encoding);
+    }
+
+    // Orbits, manifolds and manifold histories at theta are also written decimated to a coarse and a medium position
+    // tolerance (L1_horizontal_1_W_S_plus_coarse.txt, ...), which the animations in python/animations load instead of the
+    // full data
+    bool writeDecimatedOutput = false;
+    if (writeDecimatedOutput) {
+        setTrajectoryDecimationLevels(getDefaultTrajectoryDecimationLevels());
+    }
+
+    // computeManifolds and connectManifoldsAtTheta also accumulate time of flight, section crossing spread, Jacobi drift and
+    // minimum distance to the Moon over every integration step, and write these summaries (L1_horizontal_1_W_U_plus_
+    // time_of_flight.txt, ...); with a negative saveFrequency only the summaries are written in production sweeps
+    bool writeTrajectoryReducerSummaries = false;
+    if (writeTrajectoryReducerSummaries) {
+        setTrajectoryReducers(getDefaultTrajectoryReducers(massParameter));
+    }
+
     // ================================
     // == Compute initial conditions ==
     // ================================
@@ -67,10 +110,85 @@ int main (){
     // ======================================
 
     double desiredJacobiEnergy = 3.1;
-    int thetaStoppingAngleMin = -180;
-    int thetaStoppingAngleMax = 0;
+    double thetaStoppingAngleMin = -180.0;
+    double thetaStoppingAngleMax = 0.0;
+    double thetaStoppingAngleStepSize = 1.0;
+    std::vector<double> thetaStoppingAngles = getThetaStoppingAngles(thetaStoppingAngleMin, thetaStoppingAngleMax,
+                                                                     thetaStoppingAngleStepSize);
+
+    // Angles are distributed over the threads one at a time (0 uses the OpenMP default number of threads)
+    int numberOfSweepThreads = 0;
+
     int numberOfTrajectoriesPerManifold = 5000;
 
+    // The minimum impulse pair per angle is corrected to a heteroclinic connection; a coarse seed grid then suffices
+    bool refineConnections = false;
+    if (refineConnections) {
+        numberOfTrajectoriesPerManifold = 500;
+    }
+
+    // Adaptive seeding starts from initialNumberOfTrajectoriesPerManifold trajectories per manifold and refines up to
+    // numberOfTrajectoriesPerManifold, between neighbours whose section states lie further apart than
+    // sectionStateSeparationTolerance and near the optimum
+    bool useAdaptiveSeeding = false;
+    int initialNumberOfTrajectoriesPerManifold = 100;
+    double minimumImpulseTolerance = 1.0E-6;
+    double sectionStateSeparationTolerance = 5.0E-2;
+    double maximumVelocityDiscrepancy = 0.5;
+
+    // Per angle, the (deltaR, deltaV) Pareto front and the numberOfTopConnections smallest deltaR are written next to the minimum
+    int numberOfTopConnections = 10;
+
+    // Manifold trajectories stop at impact with the surface of the Earth or Moon and, if nonzero, beyond the escape radius
+    ManifoldTerminationSettings manifoldTerminationSettings(6371.0 / 384400.0, 1737.4 / 384400.0, 0.0);
+
+    // The connection at continuationThetaStoppingAngle is continued from desiredJacobiEnergy to finalJacobiEnergyContinuation.
+    // The first member is found from numberOfTrajectoriesPerManifoldContinuation seeds; a failed step retries with
+    // numberOfLocalTrajectoriesPerManifoldContinuation seeds within localPhaseWindowContinuation of the previous phases,
+    // then halves the step down to minimumJacobiEnergyStepSizeContinuation
+    bool continueConnections = false;
+    double continuationThetaStoppingAngle = -90.0;
+    double finalJacobiEnergyContinuation = 3.15;
+    double jacobiEnergyStepSizeContinuation = 1.0E-3;
+    int numberOfTrajectoriesPerManifoldContinuation = 100;
+    int numberOfLocalTrajectoriesPerManifoldContinuation = 10;
+    double localPhaseWindowContinuation = 2.0E-2;
+    double minimumJacobiEnergyStepSizeContinuation = 1.0E-5;
+
+    // Interior manifolds of all families at L1 and L2 are connected pairwise at the angle about the Moon, crossed in either
+    // direction: cross-family, L1 -> L2, L2 -> L1 and homoclinic. Every branch is propagated once and shared between its pairs.
+    bool computeConnectionMatrix = false;
+    double connectionMatrixThetaStoppingAngle = -90.0;
+    int numberOfTrajectoriesPerManifoldConnectionMatrix = 1000;
+    if (computeConnectionMatrix) {
+        std::vector<std::string> connectionMatrixOrbitTypes = {"horizontal", "vertical", "halo"};
+        std::vector<ManifoldBranch> unstableBranches;
+        std::vector<ManifoldBranch> stableBranches;
+        for (unsigned int orbitTypeNumber = 0; orbitTypeNumber < connectionMatrixOrbitTypes.size(); orbitTypeNumber++) {
+            for (int librationPointNr = 1; librationPointNr <= 2; librationPointNr++) {
+                // Towards the Moon: positive x at L1, negative x at L2
+                double interiorDisplacementSign = (librationPointNr == 1 ? 1.0 : -1.0);
+                unstableBranches.push_back({librationPointNr, connectionMatrixOrbitTypes.at(orbitTypeNumber), desiredJacobiEnergy,
+                                            interiorDisplacementSign, 1.0});
+                stableBranches.push_back({librationPointNr, connectionMatrixOrbitTypes.at(orbitTypeNumber), desiredJacobiEnergy,
+                                          interiorDisplacementSign, -1.0});
+            }
+        }
+
+        PoincareSection connectionMatrixSection = createAngleSection("theta", getPrimaryLocation(2, massParameter),
+                                                                     connectionMatrixThetaStoppingAngle, 0);
+        std::vector<ManifoldConnectionMatrixEntry> connectionMatrix = computeManifoldConnectionMatrix(
+                    unstableBranches, stableBranches, connectionMatrixSection, numberOfTrajectoriesPerManifoldConnectionMatrix,
+                    massParameter, manifoldTerminationSettings, numberOfTopConnections);
+
+        std::ostringstream connectionMatrixStr;
+        connectionMatrixStr << std::setprecision(4) << desiredJacobiEnergy << "_" << connectionMatrixSection.name << "_"
+                            << connectionMatrixThetaStoppingAngle;
+        writeManifoldConnectionMatrixToFile(unstableBranches, stableBranches, connectionMatrix,
+                                            "../data/raw/poincare_sections/" + connectionMatrixStr.str() +
+                                            "_connection_matrix.txt");
+    }
+
     for (int orbitTypeNumber = 0; orbitTypeNumber <= 0; orbitTypeNumber++) {
 
         std::string orbitType;
@@ -82,62 +200,49 @@ int main (){
             orbitType = "halo";
         }
 
-        std::vector<std::pair<double, Eigen::MatrixXd> > assembledResults;
-
-        #pragma omp parallel num_threads(20)
-        {
-            #pragma omp for
-            for (int i = thetaStoppingAngleMin; i <= thetaStoppingAngleMax; i++) {
-                double thetaStoppingAngle = static_cast<double>(i);
-                Eigen::MatrixXd minimumImpulseStateVectorsAtPoincare = connectManifoldsAtTheta(orbitType,
-                                                                                               thetaStoppingAngle,
-                                                                                               numberOfTrajectoriesPerManifold,
-                                                                                               desiredJacobiEnergy);
-                assembledResults.push_back(std::make_pair(thetaStoppingAngle, minimumImpulseStateVectorsAtPoincare));
-            }
+        if (continueConnections) {
+            continueHeteroclinicConnectionInJacobiEnergy(orbitType, continuationThetaStoppingAngle, desiredJacobiEnergy,
+                                                         finalJacobiEnergyContinuation, massParameter,
+                                                         jacobiEnergyStepSizeContinuation, numberOfTrajectoriesPerManifoldContinuation,
+                                                         numberOfLocalTrajectoriesPerManifoldContinuation, localPhaseWindowContinuation,
+                                                         minimumJacobiEnergyStepSizeContinuation,
+                                                         manifoldTerminationSettings);
         }
 
+        std::vector<Eigen::MatrixXd> minimumImpulseStateVectorsAtPoincare = connectManifoldsOverThetaStoppingAngles(
+                    thetaStoppingAngles, [&](const double thetaStoppingAngle) -> Eigen::MatrixXd {
+            if (useAdaptiveSeeding) {
+                return connectManifoldsAtThetaAdaptively(orbitType, thetaStoppingAngle, desiredJacobiEnergy, massParameter,
+                                                         initialNumberOfTrajectoriesPerManifold, minimumImpulseTolerance,
+                                                         numberOfTrajectoriesPerManifold, sectionStateSeparationTolerance,
+                                                         maximumVelocityDiscrepancy, 1.0E-6, 50.0, 1.0E-3,
+                                                         manifoldTerminationSettings);
+            }
+            return connectManifoldsAtTheta(orbitType, thetaStoppingAngle, numberOfTrajectoriesPerManifold, desiredJacobiEnergy,
+                                           1000, massParameter, manifoldTerminationSettings, numberOfTopConnections,
+                                           refineConnections);
+        }, numberOfSweepThreads);
+
         std::ostringstream desiredJacobiEnergyStr;
-        std::string fileNameString;
         desiredJacobiEnergyStr << std::setprecision(4) << desiredJacobiEnergy;
-        fileNameString = ("../data/raw/poincare_sections/" + orbitType + "_" + desiredJacobiEnergyStr.str() + "_minimum_impulse_connections.txt");
-        remove(fileNameString.c_str());
-        std::ofstream textFileAssembledResults(fileNameString.c_str());
-
-        textFileAssembledResults.precision(std::numeric_limits<double>::digits10);
-
-        for (int i = thetaStoppingAngleMin; i <= thetaStoppingAngleMax; i++) {
-            double thetaStoppingAngle = static_cast<double>(i);
-
-            for (unsigned int idx = 0; idx < assembledResults.size(); idx++) {
-                if (assembledResults.at(idx).first == thetaStoppingAngle) {
-                    textFileAssembledResults << std::left << std::scientific << std::setw(30) << thetaStoppingAngle
-                                             << std::setw(30)
-                                             << assembledResults.at(idx).second(0, 0) << std::setw(30)
-                                             << assembledResults.at(idx).second(0, 1) << std::setw(30)
-                                             << assembledResults.at(idx).second(0, 2) << std::setw(30)
-                                             << assembledResults.at(idx).second(0, 3) << std::setw(30)
-                                             << assembledResults.at(idx).second(0, 4) << std::setw(30)
-                                             << assembledResults.at(idx).second(0, 5) << std::setw(30)
-                                             << assembledResults.at(idx).second(0, 6) << std::setw(30)
-                                             << assembledResults.at(idx).second(0, 7) << std::setw(30)
-                                             << assembledResults.at(idx).second(1, 0) << std::setw(30)
-                                             << assembledResults.at(idx).second(1, 1) << std::setw(30)
-                                             << assembledResults.at(idx).second(1, 2) << std::setw(30)
-                                             << assembledResults.at(idx).second(1, 3) << std::setw(30)
-                                             << assembledResults.at(idx).second(1, 4) << std::setw(30)
-                                             << assembledResults.at(idx).second(1, 5) << std::setw(30)
-                                             << assembledResults.at(idx).second(1, 6) << std::setw(30)
-                                             << assembledResults.at(idx).second(1, 7) << std::endl;
-                }
-            }
-        }
-        textFileAssembledResults.close();
+        writeMinimumImpulseConnectionsToFile(thetaStoppingAngles, minimumImpulseStateVectorsAtPoincare,
+                                             "../data/raw/poincare_sections/" + orbitType + "_" + desiredJacobiEnergyStr.str() +
+                                             "_minimum_impulse_connections.txt");
     }
 
     // ================================
     // == Compute manifolds ==
     // ================================
+
+    // Additionally record the first crossings with all of U1-U4 in a single, non-terminating pass per trajectory
+    bool recordSectionCrossings = false;
+    int numberOfSectionCrossings = 3;
+
+    // Propagate only the unstable manifolds and obtain the stable ones by reflection (xz-symmetric orbits). The manifold
+    // histories are then kept in memory until all four manifolds are complete instead of being streamed to the output.
+    bool deriveStableManifoldsBySymmetry = false;
+    int numberOfSymmetryVerificationTrajectories = 0;
+
     #pragma omp parallel num_threads(18)
     {
         #pragma omp for
@@ -240,25 +345,29 @@ int main (){
                 desiredJacobiEnergy = 3.15;
             }
 
-            Eigen::VectorXd selectedInitialConditions = readInitialConditionsFromFile(librationPointNr, orbitType, orbitIdOne, orbitIdOne + 1, massParameter);
-            Eigen::VectorXd refinedJacobiEnergyResult = refineOrbitJacobiEnergy(librationPointNr, orbitType, desiredJacobiEnergy,
-                                                                                selectedInitialConditions.segment(1, 6),
-                                                                                selectedInitialConditions(0),
-                                                                                selectedInitialConditions.segment(8, 6),
-                                                                                selectedInitialConditions(7), massParameter);
-            Eigen::VectorXd initialStateVector = refinedJacobiEnergyResult.segment(0, 6);
-            double orbitalPeriod               = refinedJacobiEnergyResult(6);
+            // Refined orbits are shared with the theta sections above (and between jobs) through the orbit cache
+            std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbit = getRefinedPeriodicOrbit( librationPointNr, orbitType, desiredJacobiEnergy,
+                                                                                                   orbitIdOne, orbitIdOne + 1, massParameter );
+            Eigen::VectorXd initialStateVector = periodicOrbit->initialStateVector;
+            double orbitalPeriod               = periodicOrbit->orbitalPeriod;
 
             Eigen::MatrixXd fullInitialState = getFullInitialState( initialStateVector );
-            std::map< double, Eigen::Vector6d > stateHistory;
+            TrajectoryBuffer stateHistory;
             std::pair< Eigen::MatrixXd, double > endState = propagateOrbitToFinalCondition( fullInitialState, massParameter, orbitalPeriod, 1, stateHistory, 100, 0.0 );
 
-            writeStateHistoryToFile( stateHistory, orbitIdOne, orbitType, librationPointNr, 1000, false );
+            writeStateHistoryToFileAsynchronously( std::move( stateHistory ), orbitIdOne, orbitType, librationPointNr, 1000, false );
 
             // ===============================================================
             // == Compute manifolds based on precomputed initial conditions ==
             // ===============================================================
-            computeManifolds(initialStateVector, orbitalPeriod, orbitIdOne, librationPointNr, orbitType);
+            computeManifolds(*periodicOrbit, orbitIdOne, librationPointNr, orbitType, massParameter, 1.0E-6, 100, 1000, true, 50.0, 1.0E-3,
+                             deriveStableManifoldsBySymmetry, numberOfSymmetryVerificationTrajectories,
+                             manifoldTerminationSettings);
+            if (recordSectionCrossings) {
+                computeManifoldSectionCrossings(*periodicOrbit, orbitIdOne, librationPointNr, orbitType,
+                                                getManifoldSectionAtlas(librationPointNr, massParameter, numberOfSectionCrossings),
+                                                massParameter, 1.0E-6, 100, 50.0, 1.0E-3, manifoldTerminationSettings);
+            }
 
 //                    for (unsigned int librationPointNr = 2; librationPointNr <= 2; librationPointNr++) {
 
@@ -359,5 +468,9 @@ int main (){
         }
     }
 
+    // Make sure all trajectory output handed to the background writer has been flushed
+    waitForPendingOutput( );
+    closeTrajectoryArchive( );
+
     return 0;
 }
@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "manifoldConnectionFront.h"
+#include "sectionStateTree.h"
+#include "textOutput.h"
+
+namespace
+{
+
+// Orders on deltaR, ties on the lowest (stable, unstable) pair
+bool compareByDeltaPosition( const ManifoldConnectionCandidate& candidateOne, const ManifoldConnectionCandidate& candidateTwo )
+{
+    if( candidateOne.deltaPosition != candidateTwo.deltaPosition ) {
+        return candidateOne.deltaPosition < candidateTwo.deltaPosition;
+    }
+    if( candidateOne.stableTrajectoryNumber != candidateTwo.stableTrajectoryNumber ) {
+        return candidateOne.stableTrajectoryNumber < candidateTwo.stableTrajectoryNumber;
+    }
+    return candidateOne.unstableTrajectoryNumber < candidateTwo.unstableTrajectoryNumber;
+}
+
+// Orders on deltaR, then deltaV, ties on the lowest (stable, unstable) pair
+bool compareByDeltaPositionAndVelocity( const ManifoldConnectionCandidate& candidateOne, const ManifoldConnectionCandidate& candidateTwo )
+{
+    if( candidateOne.deltaPosition != candidateTwo.deltaPosition ) {
+        return candidateOne.deltaPosition < candidateTwo.deltaPosition;
+    }
+    if( candidateOne.deltaVelocity != candidateTwo.deltaVelocity ) {
+        return candidateOne.deltaVelocity < candidateTwo.deltaVelocity;
+    }
+    return compareByDeltaPosition( candidateOne, candidateTwo );
+}
+
+bool hasSmallerDeltaPosition( const ManifoldConnectionCandidate& candidate, const double deltaPosition )
+{
+    return candidate.deltaPosition < deltaPosition;
+}
+
+bool hasLargerDeltaPosition( const double deltaPosition, const ManifoldConnectionCandidate& candidate )
+{
+    return deltaPosition < candidate.deltaPosition;
+}
+
+// The front is kept as a staircase: increasing deltaR, strictly decreasing deltaV. Of equal candidates the lowest
+// (stable, unstable) pair stays on the front, whatever the order they are offered in.
+void insertIntoParetoFront( std::vector< ManifoldConnectionCandidate >& paretoFront, const ManifoldConnectionCandidate& candidate )
+{
+    if( !paretoFront.empty( ) && candidate.deltaPosition >= paretoFront.back( ).deltaPosition &&
+        candidate.deltaVelocity >= paretoFront.back( ).deltaVelocity &&
+        ( candidate.deltaPosition > paretoFront.back( ).deltaPosition || candidate.deltaVelocity > paretoFront.back( ).deltaVelocity ) ) {
+        return;
+    }
+
+    // The member with the largest deltaR not above that of the candidate has the smallest deltaV among those members
+    std::vector< ManifoldConnectionCandidate >::iterator upperMember =
+            std::upper_bound( paretoFront.begin( ), paretoFront.end( ), candidate.deltaPosition, hasLargerDeltaPosition );
+    if( upperMember != paretoFront.begin( ) && ( upperMember - 1 )->deltaVelocity <= candidate.deltaVelocity ) {
+        if( ( upperMember - 1 )->deltaPosition == candidate.deltaPosition && ( upperMember - 1 )->deltaVelocity == candidate.deltaVelocity &&
+            compareByDeltaPosition( candidate, *( upperMember - 1 ) ) ) {
+            *( upperMember - 1 ) = candidate;
+        }
+        return;
+    }
+
+    // Remove the members the candidate dominates, which directly follow it on the staircase
+    std::vector< ManifoldConnectionCandidate >::iterator firstDominatedMember =
+            std::lower_bound( paretoFront.begin( ), paretoFront.end( ), candidate.deltaPosition, hasSmallerDeltaPosition );
+    std::vector< ManifoldConnectionCandidate >::iterator lastDominatedMember = firstDominatedMember;
+    while( lastDominatedMember != paretoFront.end( ) && lastDominatedMember->deltaVelocity >= candidate.deltaVelocity ) {
+        ++lastDominatedMember;
+    }
+    paretoFront.insert( paretoFront.erase( firstDominatedMember, lastDominatedMember ), candidate );
+}
+
+// Keeps the numberOfTopCandidates best candidates as a max-heap on compareByDeltaPosition
+void insertIntoTopCandidates( std::vector< ManifoldConnectionCandidate >& topCandidates, const ManifoldConnectionCandidate& candidate,
+                              const int numberOfTopCandidates )
+{
+    if( static_cast< int >( topCandidates.size( ) ) < numberOfTopCandidates ) {
+        topCandidates.push_back( candidate );
+        std::push_heap( topCandidates.begin( ), topCandidates.end( ), compareByDeltaPosition );
+    } else if( numberOfTopCandidates > 0 && compareByDeltaPosition( candidate, topCandidates.front( ) ) ) {
+        std::pop_heap( topCandidates.begin( ), topCandidates.end( ), compareByDeltaPosition );
+        topCandidates.back( ) = candidate;
+        std::push_heap( topCandidates.begin( ), topCandidates.end( ), compareByDeltaPosition );
+    }
+}
+
+// True if every pair with deltaR >= lowerDeltaPosition and deltaV >= lowerDeltaVelocity is dominated by a front member. A
+// member equal to ( lowerDeltaPosition, lowerDeltaVelocity ) does not count, the pair may be equal to it and lower.
+bool isDominatedByParetoFront( const std::vector< ManifoldConnectionCandidate >& paretoFront, const double lowerDeltaPosition,
+                               const double lowerDeltaVelocity )
+{
+    std::vector< ManifoldConnectionCandidate >::const_iterator upperMember =
+            std::upper_bound( paretoFront.begin( ), paretoFront.end( ), lowerDeltaPosition, hasLargerDeltaPosition );
+    if( upperMember == paretoFront.begin( ) || ( upperMember - 1 )->deltaVelocity > lowerDeltaVelocity ) {
+        return false;
+    }
+    return ( upperMember - 1 )->deltaPosition < lowerDeltaPosition || ( upperMember - 1 )->deltaVelocity < lowerDeltaVelocity;
+}
+
+ManifoldConnectionCandidate computeConnectionCandidate( const int stableTrajectoryNumber, const double* stableState,
+                                                        const int unstableTrajectoryNumber, const double* unstableState )
+{
+    // Both the tree search and the all-pairs loop evaluate pairs here only, so they agree to the bit
+    ManifoldConnectionCandidate candidate;
+    candidate.stableTrajectoryNumber   = stableTrajectoryNumber;
+    candidate.unstableTrajectoryNumber = unstableTrajectoryNumber;
+    candidate.deltaVelocity = std::sqrt( ( stableState[ 3 ] - unstableState[ 3 ] ) * ( stableState[ 3 ] - unstableState[ 3 ] ) +
+                                         ( stableState[ 4 ] - unstableState[ 4 ] ) * ( stableState[ 4 ] - unstableState[ 4 ] ) +
+                                         ( stableState[ 5 ] - unstableState[ 5 ] ) * ( stableState[ 5 ] - unstableState[ 5 ] ) );
+    candidate.deltaPosition = std::sqrt( ( stableState[ 0 ] - unstableState[ 0 ] ) * ( stableState[ 0 ] - unstableState[ 0 ] ) +
+                                         ( stableState[ 1 ] - unstableState[ 1 ] ) * ( stableState[ 1 ] - unstableState[ 1 ] ) +
+                                         ( stableState[ 2 ] - unstableState[ 2 ] ) * ( stableState[ 2 ] - unstableState[ 2 ] ) );
+    return candidate;
+}
+
+void addConnectionCandidate( ManifoldConnectionFront& connectionFront, const ManifoldConnectionCandidate& candidate,
+                             const int numberOfTopCandidates, const double maximumVelocityDiscrepancy )
+{
+    insertIntoParetoFront( connectionFront.paretoFront, candidate );
+    if( candidate.deltaVelocity < maximumVelocityDiscrepancy ) {
+        insertIntoTopCandidates( connectionFront.topCandidates, candidate, numberOfTopCandidates );
+    }
+}
+
+// Offers the pairs of stableState with the unstable states in the box of nodeNumber, skipping boxes whose lower bounds on
+// deltaR and deltaV rule out both the front and the top candidates
+void searchConnectionCandidates( const SectionStateTree& unstableStateTree, const int nodeNumber, const int stableTrajectoryNumber,
+                                 const double* stableState, const int numberOfTopCandidates, const double maximumVelocityDiscrepancy,
+                                 ManifoldConnectionFront& connectionFront )
+{
+    const SectionStateTreeNode& node = unstableStateTree.nodes[ nodeNumber ];
+    const double lowerDeltaPosition = computeDistanceToSectionStateBox( node, stableState, 0 );
+    const double lowerDeltaVelocity = computeDistanceToSectionStateBox( node, stableState, 3 );
+
+    // The top candidates are a max-heap, the front of which is the last one kept; pairs at its deltaR may still be lower
+    const bool mayEnterTopCandidates = numberOfTopCandidates > 0 && lowerDeltaVelocity < maximumVelocityDiscrepancy &&
+            ( static_cast< int >( connectionFront.topCandidates.size( ) ) < numberOfTopCandidates ||
+              lowerDeltaPosition <= connectionFront.topCandidates.front( ).deltaPosition );
+    if( !mayEnterTopCandidates && isDominatedByParetoFront( connectionFront.paretoFront, lowerDeltaPosition, lowerDeltaVelocity ) ) {
+        return;
+    }
+
+    if( node.leftChild < 0 ) {
+        for( int pointNumber = node.firstPoint; pointNumber < node.lastPoint; pointNumber++ ) {
+            const int unstableTrajectoryNumber = unstableStateTree.pointOrder[ pointNumber ];
+            addConnectionCandidate( connectionFront, computeConnectionCandidate( stableTrajectoryNumber, stableState, unstableTrajectoryNumber,
+                                                                                 &unstableStateTree.sectionStates[ 6 * unstableTrajectoryNumber ] ),
+                                    numberOfTopCandidates, maximumVelocityDiscrepancy );
+        }
+        return;
+    }
+
+    // Descend into the nearer child first, so the bounds tighten as early as possible
+    int nearChild = node.leftChild;
+    int farChild  = node.rightChild;
+    if( computeDistanceToSectionStateBox( unstableStateTree.nodes[ farChild ], stableState, 0 ) <
+        computeDistanceToSectionStateBox( unstableStateTree.nodes[ nearChild ], stableState, 0 ) ) {
+        std::swap( nearChild, farChild );
+    }
+    searchConnectionCandidates( unstableStateTree, nearChild, stableTrajectoryNumber, stableState, numberOfTopCandidates,
+                                maximumVelocityDiscrepancy, connectionFront );
+    searchConnectionCandidates( unstableStateTree, farChild, stableTrajectoryNumber, stableState, numberOfTopCandidates,
+                                maximumVelocityDiscrepancy, connectionFront );
+}
+
+}
+
+ManifoldConnectionFront computeManifoldConnectionFront( const std::vector< double >& stableStatesAtSection,
+                                                        const std::vector< double >& unstableStatesAtSection,
+                                                        const int numberOfTopCandidates, const double maximumVelocityDiscrepancy,
+                                                        const bool useSpatialIndex )
+{
+    const int numberOfStableStates   = static_cast< int >( stableStatesAtSection.size( ) / 6 );
+    const int numberOfUnstableStates = static_cast< int >( unstableStatesAtSection.size( ) / 6 );
+    std::vector< ManifoldConnectionFront > threadConnectionFronts;
+
+    SectionStateTree unstableStateTree;
+    if( useSpatialIndex ) {
+        unstableStateTree = buildSectionStateTree( unstableStatesAtSection );
+    }
+
+    #pragma omp parallel
+    {
+        ManifoldConnectionFront threadConnectionFront;
+
+        #pragma omp for schedule(static)
+        for( int stableTrajectoryNumber = 0; stableTrajectoryNumber < numberOfStableStates; stableTrajectoryNumber++ ) {
+            const double* stableState = &stableStatesAtSection[ 6 * stableTrajectoryNumber ];
+            if( useSpatialIndex ) {
+                if( !unstableStateTree.nodes.empty( ) ) {
+                    searchConnectionCandidates( unstableStateTree, 0, stableTrajectoryNumber, stableState, numberOfTopCandidates,
+                                                maximumVelocityDiscrepancy, threadConnectionFront );
+                }
+                continue;
+            }
+            for( int unstableTrajectoryNumber = 0; unstableTrajectoryNumber < numberOfUnstableStates; unstableTrajectoryNumber++ ) {
+                addConnectionCandidate( threadConnectionFront,
+                                        computeConnectionCandidate( stableTrajectoryNumber, stableState, unstableTrajectoryNumber,
+                                                                    &unstableStatesAtSection[ 6 * unstableTrajectoryNumber ] ),
+                                        numberOfTopCandidates, maximumVelocityDiscrepancy );
+            }
+        }
+
+        #pragma omp critical
+        threadConnectionFronts.push_back( threadConnectionFront );
+    }
+
+    // Merge the per-thread buffers; the full ordering makes the result independent of the partitioning over the threads
+    ManifoldConnectionFront connectionFront;
+    std::vector< ManifoldConnectionCandidate > paretoFrontCandidates;
+    for( unsigned int threadNumber = 0; threadNumber < threadConnectionFronts.size( ); threadNumber++ ) {
+        paretoFrontCandidates.insert( paretoFrontCandidates.end( ), threadConnectionFronts.at( threadNumber ).paretoFront.begin( ),
+                                      threadConnectionFronts.at( threadNumber ).paretoFront.end( ) );
+        connectionFront.topCandidates.insert( connectionFront.topCandidates.end( ), threadConnectionFronts.at( threadNumber ).topCandidates.begin( ),
+                                              threadConnectionFronts.at( threadNumber ).topCandidates.end( ) );
+    }
+
+    std::sort( paretoFrontCandidates.begin( ), paretoFrontCandidates.end( ), compareByDeltaPositionAndVelocity );
+    double minimumDeltaVelocity = std::numeric_limits< double >::infinity( );
+    for( unsigned int candidateNumber = 0; candidateNumber < paretoFrontCandidates.size( ); candidateNumber++ ) {
+        if( paretoFrontCandidates.at( candidateNumber ).deltaVelocity < minimumDeltaVelocity ) {
+            minimumDeltaVelocity = paretoFrontCandidates.at( candidateNumber ).deltaVelocity;
+            connectionFront.paretoFront.push_back( paretoFrontCandidates.at( candidateNumber ) );
+        }
+    }
+
+    std::sort( connectionFront.topCandidates.begin( ), connectionFront.topCandidates.end( ), compareByDeltaPosition );
+    if( static_cast< int >( connectionFront.topCandidates.size( ) ) > numberOfTopCandidates ) {
+        connectionFront.topCandidates.resize( numberOfTopCandidates );
+    }
+
+    return connectionFront;
+}
+
+void writeManifoldConnectionFrontToFile( const ManifoldConnectionFront& connectionFront,
+                                         const std::vector< std::pair< double, double > >& stablePhasesAndTimes,
+                                         const std::vector< std::pair< double, double > >& unstablePhasesAndTimes,
+                                         const std::string& fileNameString )
+{
+    TextTableWriter textFileConnectionFront(fileNameString);
+
+    for( int candidateKind = 0; candidateKind < 2; candidateKind++ ) {
+        const std::vector< ManifoldConnectionCandidate >& candidates = ( candidateKind == 0 ? connectionFront.paretoFront
+                                                                                           : connectionFront.topCandidates );
+        for( unsigned int rank = 0; rank < candidates.size( ); rank++ ) {
+            const ManifoldConnectionCandidate& candidate = candidates.at( rank );
+            textFileConnectionFront.appendText( std::to_string( candidateKind ) );
+            textFileConnectionFront.appendText( std::to_string( rank ) );
+            textFileConnectionFront.appendValue( candidate.deltaPosition );
+            textFileConnectionFront.appendValue( candidate.deltaVelocity );
+            textFileConnectionFront.appendValue( stablePhasesAndTimes.at( candidate.stableTrajectoryNumber ).first );
+            textFileConnectionFront.appendValue( stablePhasesAndTimes.at( candidate.stableTrajectoryNumber ).second );
+            textFileConnectionFront.appendValue( unstablePhasesAndTimes.at( candidate.unstableTrajectoryNumber ).first );
+            textFileConnectionFront.appendValue( unstablePhasesAndTimes.at( candidate.unstableTrajectoryNumber ).second );
+            textFileConnectionFront.endRow( );
+        }
+    }
+
+    textFileConnectionFront.close( );
+}
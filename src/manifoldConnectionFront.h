@@ -0,0 +1,45 @@
+#ifndef TUDATBUNDLE_MANIFOLDCONNECTIONFRONT_H
+#define TUDATBUNDLE_MANIFOLDCONNECTIONFRONT_H
+
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Pair of section states, numbered in the order of the stable and unstable state arrays
+struct ManifoldConnectionCandidate
+{
+    int stableTrajectoryNumber;
+    int unstableTrajectoryNumber;
+    double deltaPosition;
+    double deltaVelocity;
+};
+
+// Pareto front of (deltaR, deltaV) over all pairs, sorted by increasing deltaR (and thus decreasing deltaV), and the
+// candidates with the smallest deltaR under the velocity discrepancy cap, sorted by increasing deltaR
+struct ManifoldConnectionFront
+{
+    std::vector< ManifoldConnectionCandidate > paretoFront;
+    std::vector< ManifoldConnectionCandidate > topCandidates;
+};
+
+// Front and top candidates over all stable x unstable pairs of section states (x, y, z, xdot, ydot, zdot per state). With
+// the spatial index every stable state only visits the boxes of a k-d tree over the unstable states that may hold a pair
+// entering the front or the top candidates, otherwise all pairs are evaluated. Every thread reduces its stable states
+// into its own front and top candidates, which are merged at the end; ties are resolved on the lowest (stable, unstable)
+// pair, so the result depends neither on the number of threads nor on useSpatialIndex. topCandidates.front( ) is the pair
+// connectManifoldsAtTheta selects.
+ManifoldConnectionFront computeManifoldConnectionFront( const std::vector< double >& stableStatesAtSection,
+                                                        const std::vector< double >& unstableStatesAtSection,
+                                                        const int numberOfTopCandidates = 10,
+                                                        const double maximumVelocityDiscrepancy = 0.5,
+                                                        const bool useSpatialIndex = true );
+
+// Writes one row per candidate: kind (0 Pareto front, 1 top candidate), rank, deltaR, deltaV and the (phase, time) at the
+// section of the stable and of the unstable trajectory, looked up per trajectory number
+void writeManifoldConnectionFrontToFile( const ManifoldConnectionFront& connectionFront,
+                                         const std::vector< std::pair< double, double > >& stablePhasesAndTimes,
+                                         const std::vector< std::pair< double, double > >& unstablePhasesAndTimes,
+                                         const std::string& fileNameString );
+
+#endif  // TUDATBUNDLE_MANIFOLDCONNECTIONFRONT_H
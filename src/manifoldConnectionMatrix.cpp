@@ -0,0 +1,306 @@
+#include <cmath>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
+#include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
+
+#include "computeManifolds.h"
+#include "connectManifoldsAtTheta.h"
+#include "manifoldConnectionMatrix.h"
+#include "refinedPeriodicOrbitCache.h"
+#include "textOutput.h"
+
+namespace
+{
+
+struct ManifoldBranchSectionDataKey
+{
+    int librationPointNr;
+    std::string orbitType;
+    double jacobiEnergy;
+    double displacementFromOrbitSign;
+    double integrationTimeDirection;
+    std::string sectionName;
+    std::vector< double > sectionParameters;
+    int numberOfTrajectoriesPerManifold;
+    double massParameter;
+    std::vector< double > propagationParameters;
+
+    bool operator<( const ManifoldBranchSectionDataKey& other ) const
+    {
+        return std::tie( librationPointNr, orbitType, jacobiEnergy, displacementFromOrbitSign, integrationTimeDirection,
+                         sectionName, sectionParameters, numberOfTrajectoriesPerManifold, massParameter, propagationParameters ) <
+               std::tie( other.librationPointNr, other.orbitType, other.jacobiEnergy, other.displacementFromOrbitSign,
+                         other.integrationTimeDirection, other.sectionName, other.sectionParameters,
+                         other.numberOfTrajectoriesPerManifold, other.massParameter, other.propagationParameters );
+    }
+};
+
+typedef std::shared_future< std::shared_ptr< const ManifoldBranchSectionData > > ManifoldBranchSectionDataFuture;
+
+std::mutex manifoldBranchSectionDataCacheMutex;
+std::map< ManifoldBranchSectionDataKey, ManifoldBranchSectionDataFuture > manifoldBranchSectionDataCache;
+
+// Every member of the section that affects where (and whether) it is crossed
+std::vector< double > getPoincareSectionParameters( const PoincareSection& poincareSection )
+{
+    std::vector< double > sectionParameters( poincareSection.normal.data( ), poincareSection.normal.data( ) + 6 );
+    sectionParameters.insert( sectionParameters.end( ), poincareSection.centre.data( ), poincareSection.centre.data( ) + 3 );
+    sectionParameters.push_back( static_cast< double >( poincareSection.geometry ) );
+    sectionParameters.push_back( poincareSection.value );
+    sectionParameters.push_back( static_cast< double >( poincareSection.crossingDirection ) );
+    sectionParameters.push_back( static_cast< double >( poincareSection.conditionComponent ) );
+    sectionParameters.push_back( poincareSection.conditionSign );
+    return sectionParameters;
+}
+
+std::shared_ptr< const ManifoldBranchSectionData > computeManifoldBranchSectionData(
+        const ManifoldBranch& manifoldBranch, const PoincareSection& poincareSection,
+        const int numberOfTrajectoriesPerManifold, const double massParameter,
+        const ManifoldTerminationSettings& terminationSettings, const double eigenvectorDisplacementFromOrbit,
+        const double maximumIntegrationTimeManifoldTrajectories, const double maxEigenvalueDeviation )
+{
+    std::shared_ptr< ManifoldBranchSectionData > sectionData = std::make_shared< ManifoldBranchSectionData >( );
+    sectionData->manifoldBranch  = manifoldBranch;
+    sectionData->poincareSection = poincareSection;
+
+    int orbitIdOne;
+    int orbitIdTwo;
+    getOrbitIdsBracketingJacobiEnergy( manifoldBranch.librationPointNr, manifoldBranch.orbitType, manifoldBranch.jacobiEnergy,
+                                       orbitIdOne, orbitIdTwo );
+    std::shared_ptr< const RefinedPeriodicOrbit > periodicOrbit = getRefinedPeriodicOrbit(
+                manifoldBranch.librationPointNr, manifoldBranch.orbitType, manifoldBranch.jacobiEnergy, orbitIdOne, orbitIdTwo,
+                massParameter );
+
+    double offsetSign;
+    Eigen::VectorXd monodromyMatrixEigenvector;
+    if ( !determineManifoldEigenvectorAtTheta( *periodicOrbit, manifoldBranch.displacementFromOrbitSign,
+                                               manifoldBranch.integrationTimeDirection, monodromyMatrixEigenvector, offsetSign,
+                                               maxEigenvalueDeviation ) ) {
+        std::cout << "No manifold for L" << manifoldBranch.librationPointNr << " " << manifoldBranch.orbitType
+                  << " at C = " << manifoldBranch.jacobiEnergy << std::endl;
+        return sectionData;
+    }
+
+    const int numberOfPointsOnPeriodicOrbit = periodicOrbit->stateTransitionMatrixHistory.size( );
+    std::vector< int > indicesOnOrbit( numberOfTrajectoriesPerManifold );
+    TrajectorySetBuilder trajectoryStateHistoryBuilder( numberOfTrajectoriesPerManifold );
+    sectionData->terminationReasons.resize( numberOfTrajectoriesPerManifold );
+
+    // Only the initial and final state of each trajectory are stored
+    runManifoldTrajectoryTasks( numberOfTrajectoriesPerManifold, [&]( const int trajectoryNumber ) {
+        indicesOnOrbit.at( trajectoryNumber ) = static_cast< int >( std::floor( static_cast< double >( trajectoryNumber ) *
+                                                                                numberOfPointsOnPeriodicOrbit /
+                                                                                numberOfTrajectoriesPerManifold ) );
+        trajectoryStateHistoryBuilder.computeTrajectory( trajectoryNumber, [&]( TrajectoryBuffer& trajectoryStateHistory ) {
+            sectionData->terminationReasons.at( trajectoryNumber ) = computeManifoldTrajectoryAtSection(
+                        trajectoryStateHistory,
+                        periodicOrbit->stateTransitionMatrixHistory.getStateVectorInclSTM( indicesOnOrbit.at( trajectoryNumber ) ),
+                        monodromyMatrixEigenvector, offsetSign, manifoldBranch.integrationTimeDirection, poincareSection,
+                        periodicOrbit->jacobiEnergy, massParameter, eigenvectorDisplacementFromOrbit,
+                        std::numeric_limits< int >::max( ), maximumIntegrationTimeManifoldTrajectories, terminationSettings );
+        } );
+    } );
+
+    // The state at the section is the last state in integration direction
+    for ( int trajectoryNumber = 0; trajectoryNumber < numberOfTrajectoriesPerManifold; trajectoryNumber++ ) {
+        if ( sectionData->terminationReasons.at( trajectoryNumber ) != poincare_section_termination ) {
+            continue;
+        }
+        const TrajectoryView trajectoryStateHistory = trajectoryStateHistoryBuilder.getTrajectory( trajectoryNumber );
+        const int stateNumberAtSection = ( manifoldBranch.integrationTimeDirection > 0.0 ? trajectoryStateHistory.size( ) - 1 : 0 );
+        const Eigen::Map< const Eigen::VectorXd > stateAtSection = trajectoryStateHistory.getState( stateNumberAtSection );
+        sectionData->statesAtSection.insert( sectionData->statesAtSection.end( ), stateAtSection.data( ), stateAtSection.data( ) + 6 );
+        sectionData->phasesAndTimesAtSection.push_back(
+                    std::make_pair( static_cast< double >( indicesOnOrbit.at( trajectoryNumber ) ) / numberOfPointsOnPeriodicOrbit,
+                                    trajectoryStateHistory.getTime( stateNumberAtSection ) ) );
+    }
+
+    std::cout << "L" << manifoldBranch.librationPointNr << " " << manifoldBranch.orbitType << " (C = " << manifoldBranch.jacobiEnergy
+              << ", displacement " << manifoldBranch.displacementFromOrbitSign << ", direction " << manifoldBranch.integrationTimeDirection
+              << "): " << sectionData->phasesAndTimesAtSection.size( ) << " of " << numberOfTrajectoriesPerManifold
+              << " trajectories reached section " << poincareSection.name << std::endl;
+    return sectionData;
+}
+
+}
+
+std::shared_ptr< const ManifoldBranchSectionData > getManifoldBranchSectionData(
+        const ManifoldBranch& manifoldBranch, const PoincareSection& poincareSection,
+        const int numberOfTrajectoriesPerManifold, const double massParameter,
+        const ManifoldTerminationSettings& terminationSettings, const double eigenvectorDisplacementFromOrbit,
+        const double maximumIntegrationTimeManifoldTrajectories, const double maxEigenvalueDeviation )
+{
+    ManifoldBranchSectionDataKey key;
+    key.librationPointNr                = manifoldBranch.librationPointNr;
+    key.orbitType                       = manifoldBranch.orbitType;
+    key.jacobiEnergy                    = manifoldBranch.jacobiEnergy;
+    key.displacementFromOrbitSign       = manifoldBranch.displacementFromOrbitSign;
+    key.integrationTimeDirection        = manifoldBranch.integrationTimeDirection;
+    key.sectionName                     = poincareSection.name;
+    key.sectionParameters               = getPoincareSectionParameters( poincareSection );
+    key.numberOfTrajectoriesPerManifold = numberOfTrajectoriesPerManifold;
+    key.massParameter                   = massParameter;
+    key.propagationParameters           = { terminationSettings.primaryRadius, terminationSettings.secondaryRadius,
+                                            terminationSettings.escapeRadius, eigenvectorDisplacementFromOrbit,
+                                            maximumIntegrationTimeManifoldTrajectories, maxEigenvalueDeviation };
+
+    // Either pick up the (possibly still pending) entry, or claim the computation of a new one
+    bool propagationClaimed = false;
+    std::promise< std::shared_ptr< const ManifoldBranchSectionData > > propagationPromise;
+    ManifoldBranchSectionDataFuture sectionData;
+    {
+        std::lock_guard< std::mutex > lock( manifoldBranchSectionDataCacheMutex );
+        std::map< ManifoldBranchSectionDataKey, ManifoldBranchSectionDataFuture >::iterator cacheEntry =
+                manifoldBranchSectionDataCache.find( key );
+        if ( cacheEntry != manifoldBranchSectionDataCache.end( ) ) {
+            sectionData = cacheEntry->second;
+        } else {
+            sectionData = propagationPromise.get_future( ).share( );
+            manifoldBranchSectionDataCache[ key ] = sectionData;
+            propagationClaimed = true;
+        }
+    }
+
+    // The claiming worker propagates the branch outside of the lock, all other workers block in get( ) until it is done
+    if ( propagationClaimed ) {
+        try {
+            propagationPromise.set_value( computeManifoldBranchSectionData( manifoldBranch, poincareSection,
+                                                                            numberOfTrajectoriesPerManifold, massParameter,
+                                                                            terminationSettings, eigenvectorDisplacementFromOrbit,
+                                                                            maximumIntegrationTimeManifoldTrajectories,
+                                                                            maxEigenvalueDeviation ) );
+        }
+        catch( ... ) {
+            propagationPromise.set_exception( std::current_exception( ) );
+        }
+    }
+
+    return sectionData.get( );
+}
+
+void clearManifoldBranchSectionDataCache( )
+{
+    std::lock_guard< std::mutex > lock( manifoldBranchSectionDataCacheMutex );
+    manifoldBranchSectionDataCache.clear( );
+}
+
+ManifoldConnectionFront connectManifoldBranches( const ManifoldBranchSectionData& unstableSectionData,
+                                                 const ManifoldBranchSectionData& stableSectionData,
+                                                 const int numberOfTopCandidates, const double maximumVelocityDiscrepancy )
+{
+    return computeManifoldConnectionFront( stableSectionData.statesAtSection, unstableSectionData.statesAtSection,
+                                           numberOfTopCandidates, maximumVelocityDiscrepancy );
+}
+
+Eigen::MatrixXd getManifoldBranchConnectionStateVectors( const ManifoldBranchSectionData& unstableSectionData,
+                                                         const ManifoldBranchSectionData& stableSectionData,
+                                                         const ManifoldConnectionCandidate& connectionCandidate )
+{
+    Eigen::MatrixXd connectionStateVectors = Eigen::MatrixXd::Zero( 2, 8 );
+    connectionStateVectors( 0, 0 ) = stableSectionData.phasesAndTimesAtSection.at( connectionCandidate.stableTrajectoryNumber ).first;
+    connectionStateVectors( 0, 1 ) = stableSectionData.phasesAndTimesAtSection.at( connectionCandidate.stableTrajectoryNumber ).second;
+    connectionStateVectors.block( 0, 2, 1, 6 ) = Eigen::Map< const Eigen::RowVectorXd >(
+                &stableSectionData.statesAtSection[ 6 * connectionCandidate.stableTrajectoryNumber ], 6 );
+    connectionStateVectors( 1, 0 ) = unstableSectionData.phasesAndTimesAtSection.at( connectionCandidate.unstableTrajectoryNumber ).first;
+    connectionStateVectors( 1, 1 ) = unstableSectionData.phasesAndTimesAtSection.at( connectionCandidate.unstableTrajectoryNumber ).second;
+    connectionStateVectors.block( 1, 2, 1, 6 ) = Eigen::Map< const Eigen::RowVectorXd >(
+                &unstableSectionData.statesAtSection[ 6 * connectionCandidate.unstableTrajectoryNumber ], 6 );
+    return connectionStateVectors;
+}
+
+std::vector< ManifoldConnectionMatrixEntry > computeManifoldConnectionMatrix(
+        const std::vector< ManifoldBranch >& unstableBranches, const std::vector< ManifoldBranch >& stableBranches,
+        const PoincareSection& poincareSection, const int numberOfTrajectoriesPerManifold, const double massParameter,
+        const ManifoldTerminationSettings& terminationSettings, const int numberOfTopCandidates,
+        const double maximumVelocityDiscrepancy )
+{
+    // All propagation happens here, once per branch
+    std::vector< std::shared_ptr< const ManifoldBranchSectionData > > unstableSectionData;
+    for ( unsigned int branchNumber = 0; branchNumber < unstableBranches.size( ); branchNumber++ ) {
+        unstableSectionData.push_back( getManifoldBranchSectionData( unstableBranches.at( branchNumber ), poincareSection,
+                                                                     numberOfTrajectoriesPerManifold, massParameter,
+                                                                     terminationSettings ) );
+    }
+    std::vector< std::shared_ptr< const ManifoldBranchSectionData > > stableSectionData;
+    for ( unsigned int branchNumber = 0; branchNumber < stableBranches.size( ); branchNumber++ ) {
+        stableSectionData.push_back( getManifoldBranchSectionData( stableBranches.at( branchNumber ), poincareSection,
+                                                                   numberOfTrajectoriesPerManifold, massParameter,
+                                                                   terminationSettings ) );
+    }
+
+    std::vector< ManifoldConnectionMatrixEntry > connectionMatrix;
+    for ( unsigned int unstableBranchNumber = 0; unstableBranchNumber < unstableBranches.size( ); unstableBranchNumber++ ) {
+        for ( unsigned int stableBranchNumber = 0; stableBranchNumber < stableBranches.size( ); stableBranchNumber++ ) {
+            const ManifoldBranchSectionData& unstableData = *unstableSectionData.at( unstableBranchNumber );
+            const ManifoldBranchSectionData& stableData   = *stableSectionData.at( stableBranchNumber );
+
+            ManifoldConnectionMatrixEntry matrixEntry;
+            matrixEntry.unstableBranchNumber      = unstableBranchNumber;
+            matrixEntry.stableBranchNumber        = stableBranchNumber;
+            matrixEntry.numberOfUnstableCrossings = unstableData.phasesAndTimesAtSection.size( );
+            matrixEntry.numberOfStableCrossings   = stableData.phasesAndTimesAtSection.size( );
+            matrixEntry.connectionFront           = connectManifoldBranches( unstableData, stableData, numberOfTopCandidates,
+                                                                             maximumVelocityDiscrepancy );
+            matrixEntry.minimumImpulseStateVectorsAtSection = Eigen::MatrixXd::Zero( 2, 8 );
+            if ( !matrixEntry.connectionFront.topCandidates.empty( ) ) {
+                matrixEntry.minimumImpulseStateVectorsAtSection = getManifoldBranchConnectionStateVectors(
+                            unstableData, stableData, matrixEntry.connectionFront.topCandidates.front( ) );
+                std::cout << "L" << unstableData.manifoldBranch.librationPointNr << " " << unstableData.manifoldBranch.orbitType
+                          << " -> L" << stableData.manifoldBranch.librationPointNr << " " << stableData.manifoldBranch.orbitType
+                          << ": deltaR = " << matrixEntry.connectionFront.topCandidates.front( ).deltaPosition
+                          << " (deltaV = " << matrixEntry.connectionFront.topCandidates.front( ).deltaVelocity << ")" << std::endl;
+            }
+            connectionMatrix.push_back( matrixEntry );
+        }
+    }
+    return connectionMatrix;
+}
+
+void writeManifoldConnectionMatrixToFile( const std::vector< ManifoldBranch >& unstableBranches,
+                                          const std::vector< ManifoldBranch >& stableBranches,
+                                          const std::vector< ManifoldConnectionMatrixEntry >& connectionMatrix,
+                                          const std::string& fileNameString )
+{
+    TextTableWriter textFileConnectionMatrix(fileNameString);
+
+    for ( unsigned int entryNumber = 0; entryNumber < connectionMatrix.size( ); entryNumber++ ) {
+        const ManifoldConnectionMatrixEntry& matrixEntry = connectionMatrix.at( entryNumber );
+        const ManifoldBranch& unstableBranch = unstableBranches.at( matrixEntry.unstableBranchNumber );
+        const ManifoldBranch& stableBranch   = stableBranches.at( matrixEntry.stableBranchNumber );
+
+        // Pairs without any candidate under the velocity discrepancy cap have no deltaR and deltaV
+        double deltaPosition = std::numeric_limits< double >::quiet_NaN( );
+        double deltaVelocity = std::numeric_limits< double >::quiet_NaN( );
+        if ( !matrixEntry.connectionFront.topCandidates.empty( ) ) {
+            deltaPosition = matrixEntry.connectionFront.topCandidates.front( ).deltaPosition;
+            deltaVelocity = matrixEntry.connectionFront.topCandidates.front( ).deltaVelocity;
+        }
+
+        textFileConnectionMatrix.appendText( std::to_string( unstableBranch.librationPointNr ) );
+        textFileConnectionMatrix.appendText( unstableBranch.orbitType );
+        textFileConnectionMatrix.appendValue( unstableBranch.jacobiEnergy );
+        textFileConnectionMatrix.appendValue( unstableBranch.displacementFromOrbitSign );
+        textFileConnectionMatrix.appendText( std::to_string( stableBranch.librationPointNr ) );
+        textFileConnectionMatrix.appendText( stableBranch.orbitType );
+        textFileConnectionMatrix.appendValue( stableBranch.jacobiEnergy );
+        textFileConnectionMatrix.appendValue( stableBranch.displacementFromOrbitSign );
+        textFileConnectionMatrix.appendText( std::to_string( matrixEntry.numberOfUnstableCrossings ) );
+        textFileConnectionMatrix.appendText( std::to_string( matrixEntry.numberOfStableCrossings ) );
+        textFileConnectionMatrix.appendValue( deltaPosition );
+        textFileConnectionMatrix.appendValue( deltaVelocity );
+        for ( int rowNumber = 0; rowNumber < 2; rowNumber++ ) {
+            for ( int columnNumber = 0; columnNumber < 8; columnNumber++ ) {
+                textFileConnectionMatrix.appendValue( matrixEntry.minimumImpulseStateVectorsAtSection( rowNumber, columnNumber ) );
+            }
+        }
+        textFileConnectionMatrix.endRow( );
+    }
+
+    textFileConnectionMatrix.close( );
+}
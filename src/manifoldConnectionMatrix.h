@@ -0,0 +1,92 @@
+#ifndef TUDATBUNDLE_MANIFOLDCONNECTIONMATRIX_H
+#define TUDATBUNDLE_MANIFOLDCONNECTIONMATRIX_H
+
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+#include "manifoldConnectionFront.h"
+#include "manifoldTermination.h"
+#include "poincareSection.h"
+
+// Manifold of the family member at jacobiEnergy, departing (integrationTimeDirection 1, unstable) or arriving
+// (integrationTimeDirection -1, stable), on the side of the orbit selected by displacementFromOrbitSign
+struct ManifoldBranch
+{
+    int librationPointNr;
+    std::string orbitType;
+    double jacobiEnergy;
+    double displacementFromOrbitSign;
+    double integrationTimeDirection;
+};
+
+// First crossings of a manifold branch with a section. Only trajectories that reached the section are stored, flat in
+// statesAtSection (x, y, z, xdot, ydot, zdot per crossing) with their (phase on the orbit, time at the section)
+struct ManifoldBranchSectionData
+{
+    ManifoldBranch manifoldBranch;
+    PoincareSection poincareSection;
+    std::vector< double > statesAtSection;
+    std::vector< std::pair< double, double > > phasesAndTimesAtSection;
+    std::vector< ManifoldTerminationReason > terminationReasons;  // per trajectory on the manifold
+};
+
+// Returns the section crossings of numberOfTrajectoriesPerManifold uniformly seeded trajectories of the branch. Like
+// getRefinedPeriodicOrbit, the propagation is performed once per process for every combination of branch, section,
+// number of trajectories and settings; concurrent callers requesting the same data wait for and share that single result.
+std::shared_ptr< const ManifoldBranchSectionData > getManifoldBranchSectionData(
+        const ManifoldBranch& manifoldBranch, const PoincareSection& poincareSection,
+        const int numberOfTrajectoriesPerManifold, const double massParameter,
+        const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ),
+        const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+        const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+        const double maxEigenvalueDeviation = 1.0E-3 );
+
+void clearManifoldBranchSectionDataCache( );
+
+// Connection of a departing to an arriving branch at their common section, without any further integration
+ManifoldConnectionFront connectManifoldBranches( const ManifoldBranchSectionData& unstableSectionData,
+                                                 const ManifoldBranchSectionData& stableSectionData,
+                                                 const int numberOfTopCandidates = 10,
+                                                 const double maximumVelocityDiscrepancy = 0.5 );
+
+// Rows (phase, time, state) of the stable and unstable trajectory of a candidate (layout of connectManifoldsAtTheta)
+Eigen::MatrixXd getManifoldBranchConnectionStateVectors( const ManifoldBranchSectionData& unstableSectionData,
+                                                         const ManifoldBranchSectionData& stableSectionData,
+                                                         const ManifoldConnectionCandidate& connectionCandidate );
+
+struct ManifoldConnectionMatrixEntry
+{
+    int unstableBranchNumber;
+    int stableBranchNumber;
+    int numberOfUnstableCrossings;
+    int numberOfStableCrossings;
+    ManifoldConnectionFront connectionFront;
+
+    // Minimum impulse connection under the velocity discrepancy cap, zero if there is none
+    Eigen::MatrixXd minimumImpulseStateVectorsAtSection;
+};
+
+// Connects every departing branch to every arriving branch at the section, whether of the same or another family, from
+// the same or the other libration point (heteroclinic in either direction) or from the same orbit (homoclinic). Every
+// branch is propagated once; each additional pair only costs the search over the cached section states.
+std::vector< ManifoldConnectionMatrixEntry > computeManifoldConnectionMatrix(
+        const std::vector< ManifoldBranch >& unstableBranches, const std::vector< ManifoldBranch >& stableBranches,
+        const PoincareSection& poincareSection, const int numberOfTrajectoriesPerManifold, const double massParameter,
+        const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ),
+        const int numberOfTopCandidates = 10, const double maximumVelocityDiscrepancy = 0.5 );
+
+// Writes one row per pair: both branches (libration point, family, Jacobi energy, displacement sign), the number of
+// crossings of either branch, deltaR, deltaV and the (phase, time, state) rows of the minimum impulse connection
+void writeManifoldConnectionMatrixToFile( const std::vector< ManifoldBranch >& unstableBranches,
+                                          const std::vector< ManifoldBranch >& stableBranches,
+                                          const std::vector< ManifoldConnectionMatrixEntry >& connectionMatrix,
+                                          const std::string& fileNameString );
+
+#endif  // TUDATBUNDLE_MANIFOLDCONNECTIONMATRIX_H
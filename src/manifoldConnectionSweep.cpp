@@ -0,0 +1,100 @@
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "manifoldConnectionSweep.h"
+#include "numpyOutput.h"
+#include "textOutput.h"
+
+std::vector< double > getThetaStoppingAngles( const double thetaStoppingAngleMin, const double thetaStoppingAngleMax,
+                                              const double thetaStoppingAngleStepSize )
+{
+    std::vector< double > thetaStoppingAngles;
+    if ( thetaStoppingAngleStepSize <= 0.0 || thetaStoppingAngleMax < thetaStoppingAngleMin ) {
+        return thetaStoppingAngles;
+    }
+
+    const int numberOfThetaStoppingAngles = static_cast< int >( std::floor( ( thetaStoppingAngleMax - thetaStoppingAngleMin ) /
+                                                                            thetaStoppingAngleStepSize + 1.0E-9 ) ) + 1;
+    for ( int angleNumber = 0; angleNumber < numberOfThetaStoppingAngles; angleNumber++ ) {
+        thetaStoppingAngles.push_back( thetaStoppingAngleMin + angleNumber * thetaStoppingAngleStepSize );
+    }
+    return thetaStoppingAngles;
+}
+
+std::vector< Eigen::MatrixXd > connectManifoldsOverThetaStoppingAngles(
+        const std::vector< double >& thetaStoppingAngles,
+        const std::function< Eigen::MatrixXd( const double ) >& connectManifoldsAtAngle,
+        const int numberOfThreads )
+{
+    std::vector< Eigen::MatrixXd > minimumImpulseStateVectorsAtPoincare( thetaStoppingAngles.size( ) );
+    const int numberOfThetaStoppingAngles = static_cast< int >( thetaStoppingAngles.size( ) );
+
+    // Exceptions may not leave the parallel loop; the first one is rethrown once all angles are done
+    std::mutex exceptionMutex;
+    std::exception_ptr firstException;
+#ifdef _OPENMP
+    const int numberOfSweepThreads = ( numberOfThreads > 0 ? numberOfThreads : omp_get_max_threads( ) );
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(numberOfSweepThreads)
+#else
+    (void)numberOfThreads;
+#endif
+    for ( int angleNumber = 0; angleNumber < numberOfThetaStoppingAngles; angleNumber++ ) {
+        try {
+            minimumImpulseStateVectorsAtPoincare.at( angleNumber ) = connectManifoldsAtAngle( thetaStoppingAngles.at( angleNumber ) );
+        } catch ( ... ) {
+            std::lock_guard< std::mutex > exceptionLock( exceptionMutex );
+            if ( !firstException ) {
+                firstException = std::current_exception( );
+            }
+        }
+    }
+    if ( firstException ) {
+        std::rethrow_exception( firstException );
+    }
+
+    return minimumImpulseStateVectorsAtPoincare;
+}
+
+void writeMinimumImpulseConnectionsToFile( const std::vector< double >& thetaStoppingAngles,
+                                           const std::vector< Eigen::MatrixXd >& minimumImpulseStateVectorsAtPoincare,
+                                           const std::string& fileNameString )
+{
+    removeDataProductFiles(fileNameString);
+    if ( getDataOutputFormat( ) == numpy_data_output ) {
+        std::vector< double > assembledResults;
+        for ( unsigned int angleNumber = 0; angleNumber < thetaStoppingAngles.size( ); angleNumber++ ) {
+            const Eigen::MatrixXd& connectionStateVectors = minimumImpulseStateVectorsAtPoincare.at( angleNumber );
+            assembledResults.push_back( thetaStoppingAngles.at( angleNumber ) );
+            for ( int rowNumber = 0; rowNumber < 2; rowNumber++ ) {
+                for ( int columnNumber = 0; columnNumber < 8; columnNumber++ ) {
+                    assembledResults.push_back( connectionStateVectors.rows( ) == 2 && connectionStateVectors.cols( ) == 8 ?
+                                                    connectionStateVectors( rowNumber, columnNumber ) : 0.0 );
+                }
+            }
+        }
+        writeNumpyArrayToFile( getNumpyFileName( fileNameString, ".npy" ), assembledResults, 17 );
+        return;
+    }
+
+    TextTableWriter textFileAssembledResults(fileNameString, std::numeric_limits<double>::digits10, 30);
+
+    for ( unsigned int angleNumber = 0; angleNumber < thetaStoppingAngles.size( ); angleNumber++ ) {
+        const Eigen::MatrixXd& connectionStateVectors = minimumImpulseStateVectorsAtPoincare.at( angleNumber );
+        textFileAssembledResults.appendValue( thetaStoppingAngles.at( angleNumber ) );
+        for ( int rowNumber = 0; rowNumber < 2; rowNumber++ ) {
+            for ( int columnNumber = 0; columnNumber < 8; columnNumber++ ) {
+                textFileAssembledResults.appendValue( connectionStateVectors.rows( ) == 2 && connectionStateVectors.cols( ) == 8 ?
+                                                          connectionStateVectors( rowNumber, columnNumber ) : 0.0 );
+            }
+        }
+        textFileAssembledResults.endRow( );
+    }
+
+    textFileAssembledResults.close();
+}
@@ -0,0 +1,30 @@
+#ifndef TUDATBUNDLE_MANIFOLDCONNECTIONSWEEP_H
+#define TUDATBUNDLE_MANIFOLDCONNECTIONSWEEP_H
+
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+// Angles from thetaStoppingAngleMin up to and including thetaStoppingAngleMax in steps of thetaStoppingAngleStepSize;
+// every angle is computed from its index, so no rounding error accumulates along the list
+std::vector< double > getThetaStoppingAngles( const double thetaStoppingAngleMin, const double thetaStoppingAngleMax,
+                                              const double thetaStoppingAngleStepSize = 1.0 );
+
+// Evaluates connectManifoldsAtAngle for every angle in parallel. Every angle has its own preallocated result slot and
+// angles are handed out one at a time, as the angles close to the Moon take much longer than the others; the result is
+// in the order of thetaStoppingAngles for any number of threads (0 uses the OpenMP default). The first exception of
+// connectManifoldsAtAngle is rethrown after all angles have been evaluated.
+std::vector< Eigen::MatrixXd > connectManifoldsOverThetaStoppingAngles(
+        const std::vector< double >& thetaStoppingAngles,
+        const std::function< Eigen::MatrixXd( const double ) >& connectManifoldsAtAngle,
+        const int numberOfThreads = 0 );
+
+// One row per angle: the angle followed by both rows of the connection matrix (layout of connectManifoldsAtTheta)
+void writeMinimumImpulseConnectionsToFile( const std::vector< double >& thetaStoppingAngles,
+                                           const std::vector< Eigen::MatrixXd >& minimumImpulseStateVectorsAtPoincare,
+                                           const std::string& fileNameString );
+
+#endif  // TUDATBUNDLE_MANIFOLDCONNECTIONSWEEP_H
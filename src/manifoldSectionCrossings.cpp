@@ -0,0 +1,173 @@
+#include <cmath>
+#include <memory>
+
+#include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
+#include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
+
+#include "asynchronousOutputWriter.h"
+#include "computeManifolds.h"
+#include "manifoldSectionCrossings.h"
+#include "propagateOrbit.h"
+#include "textOutput.h"
+
+std::vector< ManifoldSection > getManifoldSectionAtlas( const int librationPointNr, const double massParameter,
+                                                        const int maximumNumberOfCrossings )
+{
+    std::vector< ManifoldSection > manifoldSections;
+    ManifoldSection manifoldSectionU1U4 = { createHyperplaneSection( librationPointNr == 1 ? "U1" : "U4", 1, 0.0, 0, -1.0 ),
+                                            maximumNumberOfCrossings, false };
+    ManifoldSection manifoldSectionU2   = { createHyperplaneSection( "U2", 0, 1.0 - massParameter, 1, -1.0 ), maximumNumberOfCrossings, false };
+    ManifoldSection manifoldSectionU3   = { createHyperplaneSection( "U3", 0, 1.0 - massParameter, 1, 1.0 ), maximumNumberOfCrossings, false };
+    manifoldSections.push_back( manifoldSectionU1U4 );
+    manifoldSections.push_back( manifoldSectionU2 );
+    manifoldSections.push_back( manifoldSectionU3 );
+    return manifoldSections;
+}
+
+ManifoldTerminationReason computeManifoldTrajectorySectionCrossings( ManifoldSectionCrossings& sectionCrossings,
+                                                                     const Eigen::MatrixXd& stateVectorInclSTMOnOrbit,
+                                                                     const Eigen::VectorXd& monodromyMatrixEigenvector, const double offsetSign,
+                                                                     const int integrationDirection, const std::vector< ManifoldSection >& manifoldSections,
+                                                                     double jacobiEnergyOnOrbit, const double massParameter,
+                                                                     const double eigenvectorDisplacementFromOrbit,
+                                                                     const double maximumIntegrationTimeManifoldTrajectories,
+                                                                     const ManifoldTerminationSettings& terminationSettings )
+{
+    ManifoldTerminationReason terminationReason = integration_time_termination;
+    sectionCrossings.assign( manifoldSections.size( ), std::vector< std::pair< double, Eigen::Vector6d > >( ) );
+
+    Eigen::MatrixXd stateTransitionMatrix = stateVectorInclSTMOnOrbit.block(0, 1, 6, 6);
+    Eigen::Vector6d localStateVector      = stateVectorInclSTMOnOrbit.block(0, 0, 6, 1);
+
+    // Apply displacement epsilon from the periodic orbit
+    Eigen::Vector6d localNormalizedEigenvector = (stateTransitionMatrix * monodromyMatrixEigenvector).normalized();
+    Eigen::MatrixXd manifoldStartingState      = getFullInitialState( localStateVector + offsetSign * eigenvectorDisplacementFromOrbit * localNormalizedEigenvector );
+
+    std::pair< Eigen::MatrixXd, double > previousStateVectorInclSTMAndTime = std::make_pair( manifoldStartingState, 0.0 );
+    std::pair< Eigen::MatrixXd, double > stateVectorInclSTMAndTime         = propagateOrbit( manifoldStartingState, massParameter, 0.0, integrationDirection );
+
+    bool fullManifoldComputed = false;
+    while ( std::abs( stateVectorInclSTMAndTime.second ) <= maximumIntegrationTimeManifoldTrajectories && !fullManifoldComputed ) {
+
+        // Check whether trajectory still belongs to the same energy level
+        fullManifoldComputed = checkJacobiOnManifoldOutsideBounds( stateVectorInclSTMAndTime.first, jacobiEnergyOnOrbit, massParameter );
+        if ( fullManifoldComputed ) {
+            terminationReason = jacobi_energy_termination;
+        } else {
+            fullManifoldComputed = checkManifoldTerminationEvent( stateVectorInclSTMAndTime.first, terminationSettings, massParameter, terminationReason );
+        }
+
+        for ( unsigned int sectionNumber = 0; sectionNumber < manifoldSections.size( ) && !fullManifoldComputed; sectionNumber++ ) {
+            const ManifoldSection& manifoldSection = manifoldSections.at( sectionNumber );
+            if ( static_cast< int >( sectionCrossings.at( sectionNumber ).size( ) ) >= manifoldSection.maximumNumberOfCrossings ) {
+                continue;
+            }
+
+            // Sign change of the section function over the last integration step, in the selected direction and on the selected side
+            if ( checkPoincareSectionCrossing( manifoldSection.poincareSection, previousStateVectorInclSTMAndTime.first.col( 0 ),
+                                               stateVectorInclSTMAndTime.first.col( 0 ), integrationDirection ) ) {
+
+                std::pair< Eigen::MatrixXd, double > crossingStateVectorInclSTMAndTime = refinePoincareSectionCrossing(
+                            previousStateVectorInclSTMAndTime, manifoldSection.poincareSection, integrationDirection, massParameter );
+                sectionCrossings.at( sectionNumber ).push_back( std::make_pair( crossingStateVectorInclSTMAndTime.second,
+                                                                                crossingStateVectorInclSTMAndTime.first.block( 0, 0, 6, 1 ) ) );
+
+                if ( manifoldSection.terminatesTrajectory &&
+                     static_cast< int >( sectionCrossings.at( sectionNumber ).size( ) ) >= manifoldSection.maximumNumberOfCrossings ) {
+                    fullManifoldComputed = true;
+                    terminationReason    = poincare_section_termination;
+                }
+            }
+        }
+
+        if ( !fullManifoldComputed ) {
+            // Propagate to next time step.
+            previousStateVectorInclSTMAndTime = stateVectorInclSTMAndTime;
+            stateVectorInclSTMAndTime         = propagateOrbit( stateVectorInclSTMAndTime.first, massParameter,
+                                                                stateVectorInclSTMAndTime.second, integrationDirection );
+        }
+    }
+    return terminationReason;
+}
+
+void writeManifoldSectionCrossingsToFile( const std::vector< ManifoldSectionCrossings >& sectionCrossingsPerTrajectory,
+                                          const std::vector< ManifoldSection >& manifoldSections,
+                                          const int numberOfTrajectoriesPerManifold, const int orbitNumber,
+                                          const int librationPointNr, const std::string& orbitType )
+{
+    // One table per section: manifold number, trajectory number, crossing number, time, state
+    for ( unsigned int sectionNumber = 0; sectionNumber < manifoldSections.size( ); sectionNumber++ ) {
+        std::string fileNameString = "../data/raw/manifolds/L" + std::to_string(librationPointNr) + "_" + orbitType + "_" +
+                                     std::to_string(orbitNumber) + "_" + manifoldSections.at( sectionNumber ).poincareSection.name + "_crossings.txt";
+        TextTableWriter textFileSectionCrossings(fileNameString);
+
+        for ( unsigned int trajectoryTaskNumber = 0; trajectoryTaskNumber < sectionCrossingsPerTrajectory.size( ); trajectoryTaskNumber++ ) {
+            const std::vector< std::pair< double, Eigen::Vector6d > >& crossings = sectionCrossingsPerTrajectory.at( trajectoryTaskNumber ).at( sectionNumber );
+            for ( unsigned int crossingNumber = 0; crossingNumber < crossings.size( ); crossingNumber++ ) {
+                textFileSectionCrossings.appendText( std::to_string( trajectoryTaskNumber / numberOfTrajectoriesPerManifold ), 5 );
+                textFileSectionCrossings.appendText( std::to_string( trajectoryTaskNumber % numberOfTrajectoriesPerManifold ), 10 );
+                textFileSectionCrossings.appendText( std::to_string( crossingNumber ), 5 );
+                textFileSectionCrossings.appendValue( crossings.at( crossingNumber ).first );
+                textFileSectionCrossings.appendRow( crossings.at( crossingNumber ).second.data( ), 6 );
+            }
+        }
+        textFileSectionCrossings.close( );
+    }
+}
+
+void computeManifoldSectionCrossings( const RefinedPeriodicOrbit& periodicOrbit, const int orbitNumber,
+                                      const int librationPointNr, const std::string orbitType,
+                                      const std::vector< ManifoldSection >& manifoldSections, const double massParameter,
+                                      const double eigenvectorDisplacementFromOrbit, const int numberOfTrajectoriesPerManifold,
+                                      const double maximumIntegrationTimeManifoldTrajectories, const double maxEigenvalueDeviation,
+                                      const ManifoldTerminationSettings& terminationSettings )
+{
+    // Determine the eigenvector directions of the (un)stable subspace of the monodromy matrix
+    Eigen::MatrixXd monodromyMatrix = periodicOrbit.monodromyMatrix;
+    Eigen::Vector6d stableEigenvector;
+    Eigen::Vector6d unstableEigenvector;
+
+    try {
+        determineStableUnstableEigenvectors( monodromyMatrix, stableEigenvector, unstableEigenvector, maxEigenvalueDeviation );
+    }
+    catch( const std::exception& ) {
+        return;
+    }
+
+    double stableEigenvectorSign   = determineEigenvectorSign( stableEigenvector );
+    double unstableEigenvectorSign = determineEigenvectorSign( unstableEigenvector );
+
+    std::vector<double> offsetSigns           = {1.0 * stableEigenvectorSign, -1.0 * stableEigenvectorSign, 1.0 * unstableEigenvectorSign, -1.0 * unstableEigenvectorSign};
+    std::vector<Eigen::VectorXd> eigenVectors = {stableEigenvector, stableEigenvector, unstableEigenvector, unstableEigenvector};
+    std::vector<int> integrationDirections    = {-1, -1, 1, 1};
+
+    const unsigned int numberOfPointsOnPeriodicOrbit = periodicOrbit.stateTransitionMatrixHistory.size();
+    std::shared_ptr< std::vector< ManifoldSectionCrossings > > sectionCrossingsPerTrajectory =
+            std::make_shared< std::vector< ManifoldSectionCrossings > >( 4 * numberOfTrajectoriesPerManifold );
+    std::shared_ptr< std::vector< ManifoldTerminationReason > > terminationReasons =
+            std::make_shared< std::vector< ManifoldTerminationReason > >( 4 * numberOfTrajectoriesPerManifold );
+
+    // A single pass per trajectory records the crossings with all sections
+    runManifoldTrajectoryTasks( 4 * numberOfTrajectoriesPerManifold, [&]( const int trajectoryTaskNumber ) {
+        const int manifoldNumber             = trajectoryTaskNumber / numberOfTrajectoriesPerManifold;
+        const int trajectoryOnManifoldNumber = trajectoryTaskNumber % numberOfTrajectoriesPerManifold;
+        auto indexOnOrbit = static_cast <int> (std::floor(trajectoryOnManifoldNumber * numberOfPointsOnPeriodicOrbit / numberOfTrajectoriesPerManifold));
+
+        terminationReasons->at( trajectoryTaskNumber ) = computeManifoldTrajectorySectionCrossings(
+                    sectionCrossingsPerTrajectory->at( trajectoryTaskNumber ),
+                    periodicOrbit.stateTransitionMatrixHistory.getStateVectorInclSTM( indexOnOrbit ),
+                    eigenVectors.at( manifoldNumber ), offsetSigns.at( manifoldNumber ),
+                    integrationDirections.at( manifoldNumber ), manifoldSections,
+                    periodicOrbit.jacobiEnergy, massParameter, eigenvectorDisplacementFromOrbit,
+                    maximumIntegrationTimeManifoldTrajectories, terminationSettings );
+    } );
+
+    std::shared_ptr< const std::vector< ManifoldSection > > ownedManifoldSections =
+            std::make_shared< const std::vector< ManifoldSection > >( manifoldSections );
+    getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+        writeManifoldSectionCrossingsToFile( *sectionCrossingsPerTrajectory, *ownedManifoldSections, numberOfTrajectoriesPerManifold,
+                                             orbitNumber, librationPointNr, orbitType );
+        writeManifoldTerminationReasonsToFile( *terminationReasons, numberOfTrajectoriesPerManifold, orbitNumber, librationPointNr,
+                                               orbitType, "_crossings_termination" );
+    } );
+}
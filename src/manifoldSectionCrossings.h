@@ -0,0 +1,60 @@
+#ifndef TUDATBUNDLE_MANIFOLDSECTIONCROSSINGS_H
+#define TUDATBUNDLE_MANIFOLDSECTIONCROSSINGS_H
+
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+#include "manifoldTermination.h"
+#include "poincareSection.h"
+#include "refinedPeriodicOrbitCache.h"
+
+// The first maximumNumberOfCrossings crossings of poincareSection are recorded; if terminatesTrajectory is set the trajectory
+// stops at the last of these, otherwise it continues through the section.
+struct ManifoldSection
+{
+    PoincareSection poincareSection;
+    int maximumNumberOfCrossings;
+    bool terminatesTrajectory;
+};
+
+// Time and state at the recorded crossings of one trajectory, per section
+typedef std::vector< std::vector< std::pair< double, Eigen::Vector6d > > > ManifoldSectionCrossings;
+
+// U1 (L1) or U4 (L2): y = 0 at x < 0, U2: x = 1 - mu at y < 0, U3: x = 1 - mu at y > 0; none of them terminal
+std::vector< ManifoldSection > getManifoldSectionAtlas( const int librationPointNr, const double massParameter,
+                                                        const int maximumNumberOfCrossings );
+
+ManifoldTerminationReason computeManifoldTrajectorySectionCrossings( ManifoldSectionCrossings& sectionCrossings,
+                                                                     const Eigen::MatrixXd& stateVectorInclSTMOnOrbit,
+                                                                     const Eigen::VectorXd& monodromyMatrixEigenvector, const double offsetSign,
+                                                                     const int integrationDirection, const std::vector< ManifoldSection >& manifoldSections,
+                                                                     double jacobiEnergyOnOrbit, const double massParameter,
+                                                                     const double eigenvectorDisplacementFromOrbit,
+                                                                     const double maximumIntegrationTimeManifoldTrajectories,
+                                                                     const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+void writeManifoldSectionCrossingsToFile( const std::vector< ManifoldSectionCrossings >& sectionCrossingsPerTrajectory,
+                                          const std::vector< ManifoldSection >& manifoldSections,
+                                          const int numberOfTrajectoriesPerManifold, const int orbitNumber,
+                                          const int librationPointNr, const std::string& orbitType );
+
+// Propagates all four manifolds of the periodic orbit once, recording the crossings of every section in manifoldSections
+// instead of stopping at the first crossing; writes one crossing table per section and the termination reason per trajectory.
+// This is a propagation of its own, on top of that of computeManifolds (whose trajectories end at the first crossing).
+void computeManifoldSectionCrossings( const RefinedPeriodicOrbit& periodicOrbit, const int orbitNumber,
+                                      const int librationPointNr, const std::string orbitType,
+                                      const std::vector< ManifoldSection >& manifoldSections, const double massParameter,
+                                      const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                      const int numberOfTrajectoriesPerManifold = 100,
+                                      const double maximumIntegrationTimeManifoldTrajectories = 50.0,
+                                      const double maxEigenvalueDeviation = 1.0E-3,
+                                      const ManifoldTerminationSettings& terminationSettings = ManifoldTerminationSettings( ) );
+
+#endif  // TUDATBUNDLE_MANIFOLDSECTIONCROSSINGS_H
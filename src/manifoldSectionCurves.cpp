@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <Eigen/LU>
+
+#include "manifoldSectionCurves.h"
+#include "textOutput.h"
+
+namespace
+{
+
+// Phase from phaseOne forward to phaseTwo, wrapping at one
+double computePhaseDifference( const double phaseOne, const double phaseTwo )
+{
+    double phaseDifference = phaseTwo - phaseOne;
+    if( phaseDifference <= 0.0 ) {
+        phaseDifference += 1.0;
+    }
+    return phaseDifference;
+}
+
+bool isCurveClosed( const ManifoldSectionCurve& sectionCurve )
+{
+    return sectionCurve.phases.size( ) > 1 && sectionCurve.reachedSection.front( ) && sectionCurve.reachedSection.back( );
+}
+
+// Sample after (before) sampleNumber along the curve, or -1 if the curve is broken there
+int getNextSampleNumber( const ManifoldSectionCurve& sectionCurve, const int sampleNumber )
+{
+    const int numberOfSamples = static_cast< int >( sectionCurve.phases.size( ) );
+    int nextSampleNumber = sampleNumber + 1;
+    if( nextSampleNumber == numberOfSamples ) {
+        if( !isCurveClosed( sectionCurve ) ) {
+            return -1;
+        }
+        nextSampleNumber = 0;
+    }
+    return ( sectionCurve.reachedSection.at( sampleNumber ) && sectionCurve.reachedSection.at( nextSampleNumber ) ) ? nextSampleNumber : -1;
+}
+
+int getPreviousSampleNumber( const ManifoldSectionCurve& sectionCurve, const int sampleNumber )
+{
+    const int numberOfSamples = static_cast< int >( sectionCurve.phases.size( ) );
+    int previousSampleNumber = sampleNumber - 1;
+    if( previousSampleNumber < 0 ) {
+        if( !isCurveClosed( sectionCurve ) ) {
+            return -1;
+        }
+        previousSampleNumber = numberOfSamples - 1;
+    }
+    return ( sectionCurve.reachedSection.at( sampleNumber ) && sectionCurve.reachedSection.at( previousSampleNumber ) ) ? previousSampleNumber : -1;
+}
+
+// Catmull-Rom tangents with respect to phase, one-sided at the ends of a broken curve
+std::vector< double > computeHermiteTangents( const ManifoldSectionCurve& sectionCurve, const std::vector< double >& values,
+                                              const int numberOfComponents )
+{
+    const int numberOfSamples = static_cast< int >( sectionCurve.phases.size( ) );
+    std::vector< double > tangents( values.size( ), 0.0 );
+    for( int sampleNumber = 0; sampleNumber < numberOfSamples; sampleNumber++ ) {
+        const int previousSampleNumber = getPreviousSampleNumber( sectionCurve, sampleNumber );
+        const int nextSampleNumber     = getNextSampleNumber( sectionCurve, sampleNumber );
+        int firstSampleNumber          = ( previousSampleNumber >= 0 ? previousSampleNumber : sampleNumber );
+        int lastSampleNumber           = ( nextSampleNumber >= 0 ? nextSampleNumber : sampleNumber );
+        if( firstSampleNumber == lastSampleNumber ) {
+            continue;
+        }
+
+        double phaseDifference = 0.0;
+        if( firstSampleNumber != sampleNumber ) {
+            phaseDifference += computePhaseDifference( sectionCurve.phases.at( firstSampleNumber ), sectionCurve.phases.at( sampleNumber ) );
+        }
+        if( lastSampleNumber != sampleNumber ) {
+            phaseDifference += computePhaseDifference( sectionCurve.phases.at( sampleNumber ), sectionCurve.phases.at( lastSampleNumber ) );
+        }
+        for( int componentNumber = 0; componentNumber < numberOfComponents; componentNumber++ ) {
+            tangents.at( numberOfComponents * sampleNumber + componentNumber ) =
+                    ( values.at( numberOfComponents * lastSampleNumber + componentNumber ) -
+                      values.at( numberOfComponents * firstSampleNumber + componentNumber ) ) / phaseDifference;
+        }
+    }
+    return tangents;
+}
+
+// Cubic Hermite value (derivativeOrder 0) or derivative with respect to the segment parameter (derivativeOrder 1) of
+// every component on the segment from sampleNumber to nextSampleNumber
+Eigen::VectorXd evaluateHermiteSegment( const ManifoldSectionCurve& sectionCurve, const std::vector< double >& values,
+                                        const std::vector< double >& tangents, const int numberOfComponents,
+                                        const int sampleNumber, const int nextSampleNumber, const double segmentParameter,
+                                        const int derivativeOrder )
+{
+    const double s = segmentParameter;
+    double basisOne, basisTwo, basisThree, basisFour;
+    if( derivativeOrder == 0 ) {
+        basisOne   = 2.0 * s * s * s - 3.0 * s * s + 1.0;
+        basisTwo   = s * s * s - 2.0 * s * s + s;
+        basisThree = -2.0 * s * s * s + 3.0 * s * s;
+        basisFour  = s * s * s - s * s;
+    } else {
+        basisOne   = 6.0 * s * s - 6.0 * s;
+        basisTwo   = 3.0 * s * s - 4.0 * s + 1.0;
+        basisThree = -6.0 * s * s + 6.0 * s;
+        basisFour  = 3.0 * s * s - 2.0 * s;
+    }
+
+    const double segmentPhase = computePhaseDifference( sectionCurve.phases.at( sampleNumber ), sectionCurve.phases.at( nextSampleNumber ) );
+    Eigen::VectorXd segmentValue( numberOfComponents );
+    for( int componentNumber = 0; componentNumber < numberOfComponents; componentNumber++ ) {
+        segmentValue( componentNumber ) = basisOne * values.at( numberOfComponents * sampleNumber + componentNumber ) +
+                basisTwo * segmentPhase * tangents.at( numberOfComponents * sampleNumber + componentNumber ) +
+                basisThree * values.at( numberOfComponents * nextSampleNumber + componentNumber ) +
+                basisFour * segmentPhase * tangents.at( numberOfComponents * nextSampleNumber + componentNumber );
+    }
+    return segmentValue;
+}
+
+// Bounding box (minimum, maximum per reduced coordinate) of the Bezier control polygon, which contains the segment
+Eigen::Vector4d computeSegmentBoundingBox( const ManifoldSectionCurve& sectionCurve, const int sampleNumber, const int nextSampleNumber )
+{
+    const double segmentPhase = computePhaseDifference( sectionCurve.phases.at( sampleNumber ), sectionCurve.phases.at( nextSampleNumber ) );
+    Eigen::Vector4d boundingBox;
+    for( int componentNumber = 0; componentNumber < 2; componentNumber++ ) {
+        const double startValue = sectionCurve.reducedCoordinates.at( 2 * sampleNumber + componentNumber );
+        const double endValue   = sectionCurve.reducedCoordinates.at( 2 * nextSampleNumber + componentNumber );
+        const double controlValueOne = startValue + segmentPhase * sectionCurve.reducedCoordinateTangents.at( 2 * sampleNumber + componentNumber ) / 3.0;
+        const double controlValueTwo = endValue - segmentPhase * sectionCurve.reducedCoordinateTangents.at( 2 * nextSampleNumber + componentNumber ) / 3.0;
+        boundingBox( 2 * componentNumber )     = std::min( std::min( startValue, endValue ), std::min( controlValueOne, controlValueTwo ) );
+        boundingBox( 2 * componentNumber + 1 ) = std::max( std::max( startValue, endValue ), std::max( controlValueOne, controlValueTwo ) );
+    }
+    return boundingBox;
+}
+
+}
+
+Eigen::Vector4d computeReducedThetaSectionCoordinates( const Eigen::Vector6d& stateVector, const double massParameter )
+{
+    const double xDistanceToMoon = stateVector( 0 ) - ( 1.0 - massParameter );
+    const double distanceToMoon  = std::sqrt( xDistanceToMoon * xDistanceToMoon + stateVector( 1 ) * stateVector( 1 ) );
+
+    Eigen::Vector4d reducedSectionCoordinates;
+    reducedSectionCoordinates << distanceToMoon,
+            ( xDistanceToMoon * stateVector( 3 ) + stateVector( 1 ) * stateVector( 4 ) ) / distanceToMoon,
+            stateVector( 2 ), stateVector( 5 );
+    return reducedSectionCoordinates;
+}
+
+ManifoldSectionCurve buildManifoldSectionCurve( const std::vector< double >& phases, const std::vector< double >& statesAtSection,
+                                                const std::vector< bool >& reachedSection, const double massParameter,
+                                                const int reducedCoordinateOne, const int reducedCoordinateTwo )
+{
+    ManifoldSectionCurve sectionCurve;
+    sectionCurve.phases         = phases;
+    sectionCurve.reachedSection = reachedSection;
+    sectionCurve.states         = statesAtSection;
+
+    for( unsigned int sampleNumber = 0; sampleNumber < phases.size( ); sampleNumber++ ) {
+        const Eigen::Vector4d reducedSectionCoordinates = computeReducedThetaSectionCoordinates(
+                    Eigen::Map< const Eigen::Vector6d >( &statesAtSection.at( 6 * sampleNumber ) ), massParameter );
+        sectionCurve.reducedCoordinates.push_back( reducedSectionCoordinates( reducedCoordinateOne ) );
+        sectionCurve.reducedCoordinates.push_back( reducedSectionCoordinates( reducedCoordinateTwo ) );
+    }
+
+    sectionCurve.stateTangents             = computeHermiteTangents( sectionCurve, sectionCurve.states, 6 );
+    sectionCurve.reducedCoordinateTangents = computeHermiteTangents( sectionCurve, sectionCurve.reducedCoordinates, 2 );
+    return sectionCurve;
+}
+
+ManifoldSectionCurve buildManifoldSectionCurveAtTheta( const TrajectorySet& manifoldStateHistoryAtTheta,
+                                                       const int numberOfTrajectoriesPerManifold, const bool isStableManifold,
+                                                       const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                                       const double massParameter,
+                                                       const int reducedCoordinateOne, const int reducedCoordinateTwo )
+{
+    std::vector< double > phases;
+    std::vector< double > statesAtSection;
+    std::vector< bool > reachedSection;
+    for( int trajectoryNumber = 0; trajectoryNumber < numberOfTrajectoriesPerManifold; trajectoryNumber++ ) {
+        const TrajectoryView trajectoryStateHistory = manifoldStateHistoryAtTheta.getTrajectory( trajectoryNumber );
+        const Eigen::Map< const Eigen::VectorXd > stateVectorAtSection = ( isStableManifold ? trajectoryStateHistory.getState( 0 )
+                                                                                             : trajectoryStateHistory.getFinalState( ) );
+        phases.push_back( static_cast< double >( trajectoryNumber ) / static_cast< double >( numberOfTrajectoriesPerManifold ) );
+        statesAtSection.insert( statesAtSection.end( ), stateVectorAtSection.data( ), stateVectorAtSection.data( ) + 6 );
+        reachedSection.push_back( terminationReasons.at( trajectoryNumber ) == poincare_section_termination );
+    }
+    return buildManifoldSectionCurve( phases, statesAtSection, reachedSection, massParameter, reducedCoordinateOne, reducedCoordinateTwo );
+}
+
+std::vector< ManifoldSectionCurveIntersection > findManifoldSectionCurveIntersections( const ManifoldSectionCurve& stableCurve,
+                                                                                        const ManifoldSectionCurve& unstableCurve,
+                                                                                        const double intersectionTolerance,
+                                                                                        const int maximumNumberOfIterations,
+                                                                                        const double maximumOutOfPlaneDeviation )
+{
+    if( maximumNumberOfIterations < 1 ) {
+        throw std::runtime_error( "Section curve intersections: maximumNumberOfIterations is " +
+                                  std::to_string( maximumNumberOfIterations ) + ", at least 1 is needed" );
+    }
+
+    // Segments of both curves, as (first sample, next sample), with their bounding boxes
+    std::vector< std::pair< int, int > > unstableSegments;
+    std::vector< Eigen::Vector4d, Eigen::aligned_allocator< Eigen::Vector4d > > unstableSegmentBoundingBoxes;
+    for( int sampleNumber = 0; sampleNumber < static_cast< int >( unstableCurve.phases.size( ) ); sampleNumber++ ) {
+        const int nextSampleNumber = getNextSampleNumber( unstableCurve, sampleNumber );
+        if( nextSampleNumber >= 0 ) {
+            unstableSegments.push_back( std::make_pair( sampleNumber, nextSampleNumber ) );
+            unstableSegmentBoundingBoxes.push_back( computeSegmentBoundingBox( unstableCurve, sampleNumber, nextSampleNumber ) );
+        }
+    }
+
+    std::vector< ManifoldSectionCurveIntersection > curveIntersections;
+    for( int stableSampleNumber = 0; stableSampleNumber < static_cast< int >( stableCurve.phases.size( ) ); stableSampleNumber++ ) {
+        const int nextStableSampleNumber = getNextSampleNumber( stableCurve, stableSampleNumber );
+        if( nextStableSampleNumber < 0 ) {
+            continue;
+        }
+        const Eigen::Vector4d stableSegmentBoundingBox = computeSegmentBoundingBox( stableCurve, stableSampleNumber, nextStableSampleNumber );
+
+        for( unsigned int segmentNumber = 0; segmentNumber < unstableSegments.size( ); segmentNumber++ ) {
+            const Eigen::Vector4d& unstableSegmentBoundingBox = unstableSegmentBoundingBoxes.at( segmentNumber );
+            if( stableSegmentBoundingBox( 1 ) < unstableSegmentBoundingBox( 0 ) || unstableSegmentBoundingBox( 1 ) < stableSegmentBoundingBox( 0 ) ||
+                stableSegmentBoundingBox( 3 ) < unstableSegmentBoundingBox( 2 ) || unstableSegmentBoundingBox( 3 ) < stableSegmentBoundingBox( 2 ) ) {
+                continue;
+            }
+            const int unstableSampleNumber     = unstableSegments.at( segmentNumber ).first;
+            const int nextUnstableSampleNumber = unstableSegments.at( segmentNumber ).second;
+
+            // Start from the intersection of the chords, if they (nearly) intersect
+            const Eigen::Vector2d stableChordStart( &stableCurve.reducedCoordinates.at( 2 * stableSampleNumber ) );
+            const Eigen::Vector2d stableChord = Eigen::Vector2d( &stableCurve.reducedCoordinates.at( 2 * nextStableSampleNumber ) ) - stableChordStart;
+            const Eigen::Vector2d unstableChordStart( &unstableCurve.reducedCoordinates.at( 2 * unstableSampleNumber ) );
+            const Eigen::Vector2d unstableChord = Eigen::Vector2d( &unstableCurve.reducedCoordinates.at( 2 * nextUnstableSampleNumber ) ) - unstableChordStart;
+            Eigen::Vector2d segmentParameters( 0.5, 0.5 );
+            Eigen::Matrix2d chordMatrix;
+            chordMatrix << stableChord, -unstableChord;
+            if( chordMatrix.determinant( ) != 0.0 ) {
+                const Eigen::Vector2d chordParameters = chordMatrix.inverse( ) * ( unstableChordStart - stableChordStart );
+                segmentParameters = chordParameters.cwiseMax( 0.0 ).cwiseMin( 1.0 );
+            }
+
+            // Newton iteration on stableCurve(s) - unstableCurve(u) = 0
+            Eigen::Vector2d curveDifference = Eigen::Vector2d::Constant( std::numeric_limits< double >::infinity( ) );
+            for( int iterationNumber = 0; iterationNumber < maximumNumberOfIterations; iterationNumber++ ) {
+                curveDifference = evaluateHermiteSegment( stableCurve, stableCurve.reducedCoordinates, stableCurve.reducedCoordinateTangents, 2,
+                                                          stableSampleNumber, nextStableSampleNumber, segmentParameters( 0 ), 0 ) -
+                        evaluateHermiteSegment( unstableCurve, unstableCurve.reducedCoordinates, unstableCurve.reducedCoordinateTangents, 2,
+                                                unstableSampleNumber, nextUnstableSampleNumber, segmentParameters( 1 ), 0 );
+                if( curveDifference.lpNorm< Eigen::Infinity >( ) < intersectionTolerance ) {
+                    break;
+                }
+
+                Eigen::Matrix2d curveDifferenceJacobian;
+                curveDifferenceJacobian << evaluateHermiteSegment( stableCurve, stableCurve.reducedCoordinates, stableCurve.reducedCoordinateTangents, 2,
+                                                                   stableSampleNumber, nextStableSampleNumber, segmentParameters( 0 ), 1 ),
+                        -evaluateHermiteSegment( unstableCurve, unstableCurve.reducedCoordinates, unstableCurve.reducedCoordinateTangents, 2,
+                                                 unstableSampleNumber, nextUnstableSampleNumber, segmentParameters( 1 ), 1 );
+                if( curveDifferenceJacobian.determinant( ) == 0.0 ) {
+                    break;
+                }
+                segmentParameters -= curveDifferenceJacobian.inverse( ) * curveDifference;
+
+                // Far outside the segments the cubic extrapolation is meaningless
+                if( segmentParameters.minCoeff( ) < -0.5 || segmentParameters.maxCoeff( ) > 1.5 ) {
+                    break;
+                }
+            }
+
+            // The node shared by two segments is taken on the segment that starts there
+            if( curveDifference.lpNorm< Eigen::Infinity >( ) >= intersectionTolerance ||
+                segmentParameters.minCoeff( ) < -1.0E-10 || segmentParameters.maxCoeff( ) >= 1.0 - 1.0E-10 ) {
+                continue;
+            }
+            segmentParameters = segmentParameters.cwiseMax( 0.0 );
+
+            ManifoldSectionCurveIntersection curveIntersection;
+            curveIntersection.stablePhase = stableCurve.phases.at( stableSampleNumber ) + segmentParameters( 0 ) *
+                    computePhaseDifference( stableCurve.phases.at( stableSampleNumber ), stableCurve.phases.at( nextStableSampleNumber ) );
+            curveIntersection.unstablePhase = unstableCurve.phases.at( unstableSampleNumber ) + segmentParameters( 1 ) *
+                    computePhaseDifference( unstableCurve.phases.at( unstableSampleNumber ), unstableCurve.phases.at( nextUnstableSampleNumber ) );
+            curveIntersection.stablePhase   = curveIntersection.stablePhase - std::floor( curveIntersection.stablePhase );
+            curveIntersection.unstablePhase = curveIntersection.unstablePhase - std::floor( curveIntersection.unstablePhase );
+            curveIntersection.stableState   = evaluateHermiteSegment( stableCurve, stableCurve.states, stableCurve.stateTangents, 6,
+                                                                      stableSampleNumber, nextStableSampleNumber, segmentParameters( 0 ), 0 );
+            curveIntersection.unstableState = evaluateHermiteSegment( unstableCurve, unstableCurve.states, unstableCurve.stateTangents, 6,
+                                                                       unstableSampleNumber, nextUnstableSampleNumber, segmentParameters( 1 ), 0 );
+            if( std::abs( curveIntersection.stableState( 2 ) - curveIntersection.unstableState( 2 ) ) > maximumOutOfPlaneDeviation ||
+                std::abs( curveIntersection.stableState( 5 ) - curveIntersection.unstableState( 5 ) ) > maximumOutOfPlaneDeviation ) {
+                continue;
+            }
+            curveIntersection.deltaPosition = ( curveIntersection.stableState.segment( 0, 3 ) - curveIntersection.unstableState.segment( 0, 3 ) ).norm( );
+            curveIntersection.deltaVelocity = ( curveIntersection.stableState.segment( 3, 3 ) - curveIntersection.unstableState.segment( 3, 3 ) ).norm( );
+            curveIntersections.push_back( curveIntersection );
+        }
+    }
+
+    std::stable_sort( curveIntersections.begin( ), curveIntersections.end( ),
+                      []( const ManifoldSectionCurveIntersection& intersectionOne, const ManifoldSectionCurveIntersection& intersectionTwo ) {
+        return intersectionOne.deltaPosition < intersectionTwo.deltaPosition;
+    } );
+    return curveIntersections;
+}
+
+void writeManifoldSectionCurveIntersectionsToFile( const std::vector< ManifoldSectionCurveIntersection >& curveIntersections,
+                                                   const std::string& fileNameString )
+{
+    TextTableWriter textFileCurveIntersections(fileNameString);
+
+    for( unsigned int intersectionNumber = 0; intersectionNumber < curveIntersections.size( ); intersectionNumber++ ) {
+        const ManifoldSectionCurveIntersection& curveIntersection = curveIntersections.at( intersectionNumber );
+        textFileCurveIntersections.appendValue( curveIntersection.stablePhase );
+        textFileCurveIntersections.appendValue( curveIntersection.unstablePhase );
+        textFileCurveIntersections.appendValue( curveIntersection.deltaPosition );
+        textFileCurveIntersections.appendValue( curveIntersection.deltaVelocity );
+        for( int componentNumber = 0; componentNumber < 6; componentNumber++ ) {
+            textFileCurveIntersections.appendValue( curveIntersection.stableState( componentNumber ) );
+        }
+        for( int componentNumber = 0; componentNumber < 6; componentNumber++ ) {
+            textFileCurveIntersections.appendValue( curveIntersection.unstableState( componentNumber ) );
+        }
+        textFileCurveIntersections.endRow( );
+    }
+
+    textFileCurveIntersections.close( );
+}
@@ -0,0 +1,70 @@
+#ifndef TUDATBUNDLE_MANIFOLDSECTIONCURVES_H
+#define TUDATBUNDLE_MANIFOLDSECTIONCURVES_H
+
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+#include "manifoldTermination.h"
+#include "trajectoryBuffer.h"
+
+// Crossings of one manifold with the theta section, ordered by orbit phase and interpolated piecewise by cubic Hermite
+// polynomials in phase (Catmull-Rom tangents). Samples that did not reach the section break the curve; the curve closes
+// from the last to the first sample if both reached it.
+struct ManifoldSectionCurve
+{
+    std::vector< double > phases;
+    std::vector< bool > reachedSection;
+    std::vector< double > states;                       // x, y, z, xdot, ydot, zdot per sample
+    std::vector< double > stateTangents;                // d(state)/d(phase) per sample
+    std::vector< double > reducedCoordinates;           // two reduced section coordinates per sample
+    std::vector< double > reducedCoordinateTangents;
+};
+
+// Interpolated phases of both manifolds at an intersection of their curves, and the discrepancy of the interpolated states
+struct ManifoldSectionCurveIntersection
+{
+    double stablePhase;
+    double unstablePhase;
+    Eigen::VectorXd stableState;
+    Eigen::VectorXd unstableState;
+    double deltaPosition;
+    double deltaVelocity;
+};
+
+// Reduced coordinates on the theta section: distance to the Moon in the xy-plane, its rate, z and zdot
+Eigen::Vector4d computeReducedThetaSectionCoordinates( const Eigen::Vector6d& stateVector, const double massParameter );
+
+// phases in [0, 1) in increasing order; reducedCoordinateOne and reducedCoordinateTwo select from the reduced section
+// coordinates, the default (r, rdot) is a full description of the planar section at fixed Jacobi energy
+ManifoldSectionCurve buildManifoldSectionCurve( const std::vector< double >& phases, const std::vector< double >& statesAtSection,
+                                                const std::vector< bool >& reachedSection, const double massParameter,
+                                                const int reducedCoordinateOne = 0, const int reducedCoordinateTwo = 1 );
+
+// Section curve of a theta manifold with trajectory i at phase i / numberOfTrajectoriesPerManifold: the first state in time
+// for a stable manifold, the last one for an unstable manifold
+ManifoldSectionCurve buildManifoldSectionCurveAtTheta( const TrajectorySet& manifoldStateHistoryAtTheta,
+                                                       const int numberOfTrajectoriesPerManifold, const bool isStableManifold,
+                                                       const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                                       const double massParameter,
+                                                       const int reducedCoordinateOne = 0, const int reducedCoordinateTwo = 1 );
+
+// All intersections of the two curves in the reduced coordinates, sorted by increasing deltaR of the interpolated states.
+// Only for a planar family is (r, rdot) a full description of the section; for a spatial family the curves cross in
+// that projection without meeting, so intersections whose interpolated states differ by more than
+// maximumOutOfPlaneDeviation in z or zdot are discarded (planar states always pass). Throws std::runtime_error if
+// maximumNumberOfIterations is below 1.
+std::vector< ManifoldSectionCurveIntersection > findManifoldSectionCurveIntersections( const ManifoldSectionCurve& stableCurve,
+                                                                                        const ManifoldSectionCurve& unstableCurve,
+                                                                                        const double intersectionTolerance = 1.0E-13,
+                                                                                        const int maximumNumberOfIterations = 20,
+                                                                                        const double maximumOutOfPlaneDeviation = 1.0E-6 );
+
+void writeManifoldSectionCurveIntersectionsToFile( const std::vector< ManifoldSectionCurveIntersection >& curveIntersections,
+                                                   const std::string& fileNameString );
+
+#endif  // TUDATBUNDLE_MANIFOLDSECTIONCURVES_H
@@ -0,0 +1,57 @@
+#include "manifoldTermination.h"
+#include "textOutput.h"
+
+bool checkManifoldTerminationEvent( const Eigen::MatrixXd& stateVectorInclSTM, const ManifoldTerminationSettings& terminationSettings,
+                                    const double massParameter, ManifoldTerminationReason& terminationReason )
+{
+    const Eigen::Vector3d positionVector = stateVectorInclSTM.block( 0, 0, 3, 1 );
+    const Eigen::Vector3d primaryLocation( -massParameter, 0.0, 0.0 );
+    const Eigen::Vector3d secondaryLocation( 1.0 - massParameter, 0.0, 0.0 );
+
+    if ( ( positionVector - primaryLocation ).norm( ) < terminationSettings.primaryRadius ) {
+        terminationReason = primary_impact_termination;
+        return true;
+    }
+    if ( ( positionVector - secondaryLocation ).norm( ) < terminationSettings.secondaryRadius ) {
+        terminationReason = secondary_impact_termination;
+        return true;
+    }
+    if ( terminationSettings.escapeRadius > 0.0 && positionVector.norm( ) > terminationSettings.escapeRadius ) {
+        terminationReason = escape_termination;
+        return true;
+    }
+    return false;
+}
+
+std::string getManifoldTerminationReasonName( const ManifoldTerminationReason terminationReason )
+{
+    switch ( terminationReason ) {
+    case poincare_section_termination:
+        return "poincare_section_reached";
+    case jacobi_energy_termination:
+        return "jacobi_energy_outside_bounds";
+    case integration_time_termination:
+        return "maximum_integration_time_reached";
+    case primary_impact_termination:
+        return "primary_impact";
+    case secondary_impact_termination:
+        return "secondary_impact";
+    case escape_termination:
+        return "escape";
+    }
+    return "unknown";
+}
+
+void writeManifoldTerminationReasonsToFile( const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                            const std::string& fileNameString )
+{
+    TextTableWriter textFileTerminationReasons(fileNameString);
+
+    for ( unsigned int trajectoryOnManifoldNumber = 0; trajectoryOnManifoldNumber < terminationReasons.size( ); trajectoryOnManifoldNumber++ ) {
+        textFileTerminationReasons.appendText( std::to_string( trajectoryOnManifoldNumber ), 10 );
+        textFileTerminationReasons.appendText( std::to_string( static_cast< int >( terminationReasons.at( trajectoryOnManifoldNumber ) ) ), 5 );
+        textFileTerminationReasons.appendText( getManifoldTerminationReasonName( terminationReasons.at( trajectoryOnManifoldNumber ) ), 0 );
+        textFileTerminationReasons.endRow( );
+    }
+    textFileTerminationReasons.close( );
+}
@@ -0,0 +1,44 @@
+#ifndef TUDATBUNDLE_MANIFOLDTERMINATION_H
+#define TUDATBUNDLE_MANIFOLDTERMINATION_H
+
+
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+enum ManifoldTerminationReason
+{
+    poincare_section_termination = 0,
+    jacobi_energy_termination = 1,
+    integration_time_termination = 2,
+    primary_impact_termination = 3,
+    secondary_impact_termination = 4,
+    escape_termination = 5
+};
+
+// Terminal events on top of the section, the Jacobi energy bound and the integration time. Radii are nondimensional
+// (Earth-Moon distance of 384400 km); the escape radius is measured from the barycenter, a radius of zero disables the event.
+struct ManifoldTerminationSettings
+{
+    ManifoldTerminationSettings( const double primaryRadius = 6371.0 / 384400.0,
+                                 const double secondaryRadius = 1737.4 / 384400.0,
+                                 const double escapeRadius = 0.0 ):
+        primaryRadius( primaryRadius ), secondaryRadius( secondaryRadius ), escapeRadius( escapeRadius ) { }
+
+    double primaryRadius;
+    double secondaryRadius;
+    double escapeRadius;
+};
+
+// Returns true (and sets terminationReason) if the state lies inside either primary or beyond the escape radius
+bool checkManifoldTerminationEvent( const Eigen::MatrixXd& stateVectorInclSTM, const ManifoldTerminationSettings& terminationSettings,
+                                    const double massParameter, ManifoldTerminationReason& terminationReason );
+
+std::string getManifoldTerminationReasonName( const ManifoldTerminationReason terminationReason );
+
+// Writes trajectory number, termination reason and its name for every trajectory of a manifold
+void writeManifoldTerminationReasonsToFile( const std::vector< ManifoldTerminationReason >& terminationReasons,
+                                            const std::string& fileNameString );
+
+#endif  // TUDATBUNDLE_MANIFOLDTERMINATION_H
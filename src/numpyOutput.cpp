@@ -0,0 +1,407 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "numpyOutput.h"
+
+namespace
+{
+
+std::atomic< DataOutputFormat > currentDataOutputFormat( text_data_output );
+
+void appendLittleEndian( std::string& bytes, const uint64_t value, const int numberOfBytes )
+{
+    for ( int byteNumber = 0; byteNumber < numberOfBytes; byteNumber++ ) {
+        bytes.push_back( static_cast< char >( ( value >> ( 8 * byteNumber ) ) & 0xFF ) );
+    }
+}
+
+uint64_t readLittleEndian( const std::string& bytes, const std::size_t position, const int numberOfBytes )
+{
+    uint64_t value = 0;
+    for ( int byteNumber = 0; byteNumber < numberOfBytes; byteNumber++ ) {
+        value |= static_cast< uint64_t >( static_cast< unsigned char >( bytes.at( position + byteNumber ) ) ) << ( 8 * byteNumber );
+    }
+    return value;
+}
+
+uint64_t getBits( const double value )
+{
+    uint64_t bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+uint64_t getBits( const long long value )
+{
+    return static_cast< uint64_t >( value );
+}
+
+// Magic string, version 1.0 and header of a .npy file. The header is padded with spaces so that the data starts at a
+// multiple of 64 bytes, and to at least minimumHeaderLength bytes so that a longer shape can be filled in later.
+std::string getNumpyHeaderBytes( const std::string& descr, const std::string& shape, const std::size_t minimumHeaderLength = 0 )
+{
+    std::string header = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': " + shape + ", }";
+    const std::size_t preambleLength = 10;
+    if ( header.size( ) + 1 < minimumHeaderLength ) {
+        header.append( minimumHeaderLength - 1 - header.size( ), ' ' );
+    }
+    header.append( 63 - ( preambleLength + header.size( ) ) % 64, ' ' );
+    header.push_back( '\n' );
+
+    std::string bytes( "\x93NUMPY\x01\x00", 8 );
+    appendLittleEndian( bytes, header.size( ), 2 );
+    bytes += header;
+    return bytes;
+}
+
+// Version 1.0 .npy file; the values are written byte by byte, so the file is little-endian on any host
+template< typename ValueType >
+std::string getNumpyArrayBytes( const std::string& descr, const std::vector< ValueType >& values, const int numberOfColumns )
+{
+    std::string shape;
+    if ( numberOfColumns > 0 ) {
+        if ( values.size( ) % numberOfColumns != 0 ) {
+            throw std::runtime_error( "Numpy output: number of values is not a multiple of the number of columns" );
+        }
+        shape = "(" + std::to_string( values.size( ) / numberOfColumns ) + ", " + std::to_string( numberOfColumns ) + ")";
+    } else {
+        shape = "(" + std::to_string( values.size( ) ) + ",)";
+    }
+
+    std::string bytes = getNumpyHeaderBytes( descr, shape );
+    bytes.reserve( bytes.size( ) + 8 * values.size( ) );
+    for ( unsigned int valueNumber = 0; valueNumber < values.size( ); valueNumber++ ) {
+        appendLittleEndian( bytes, getBits( values[ valueNumber ] ), 8 );
+    }
+    return bytes;
+}
+
+const std::vector< uint32_t >& getCrc32Table( )
+{
+    static const std::vector< uint32_t > crcTable = []( ) {
+        std::vector< uint32_t > table( 256 );
+        for ( uint32_t tableEntry = 0; tableEntry < 256; tableEntry++ ) {
+            uint32_t crc = tableEntry;
+            for ( int bitNumber = 0; bitNumber < 8; bitNumber++ ) {
+                crc = ( crc & 1 ) ? 0xEDB88320u ^ ( crc >> 1 ) : crc >> 1;
+            }
+            table[ tableEntry ] = crc;
+        }
+        return table;
+    }( );
+    return crcTable;
+}
+
+// CRC-32 of the bytes so far, continued with numberOfBytes more bytes; start with 0
+uint32_t updateCrc32( const uint32_t crcSoFar, const char* bytes, const std::size_t numberOfBytes )
+{
+    const std::vector< uint32_t >& crcTable = getCrc32Table( );
+    uint32_t crc = crcSoFar ^ 0xFFFFFFFFu;
+    for ( std::size_t byteNumber = 0; byteNumber < numberOfBytes; byteNumber++ ) {
+        crc = crcTable[ ( crc ^ static_cast< unsigned char >( bytes[ byteNumber ] ) ) & 0xFF ] ^ ( crc >> 8 );
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+const uint64_t zipDosDate = ( 1 << 5 ) | 1;  // 1980-01-01
+
+// Header of a stored (uncompressed) zip member, followed directly by its data
+void appendZipLocalHeader( std::string& bytes, const std::string& memberName, const uint32_t crc, const uint64_t memberSize )
+{
+    appendLittleEndian( bytes, 0x04034b50, 4 );
+    appendLittleEndian( bytes, 20, 2 );  // version needed to extract
+    appendLittleEndian( bytes, 0, 2 );   // flags
+    appendLittleEndian( bytes, 0, 2 );   // stored
+    appendLittleEndian( bytes, 0, 2 );   // time
+    appendLittleEndian( bytes, zipDosDate, 2 );
+    appendLittleEndian( bytes, crc, 4 );
+    appendLittleEndian( bytes, memberSize, 4 );
+    appendLittleEndian( bytes, memberSize, 4 );
+    appendLittleEndian( bytes, memberName.size( ), 2 );
+    appendLittleEndian( bytes, 0, 2 );
+    bytes += memberName;
+}
+
+void appendZipCentralDirectoryEntry( std::string& bytes, const std::string& memberName, const uint32_t crc,
+                                     const uint64_t memberSize, const uint64_t localHeaderOffset )
+{
+    appendLittleEndian( bytes, 0x02014b50, 4 );
+    appendLittleEndian( bytes, 20, 2 );  // version made by
+    appendLittleEndian( bytes, 20, 2 );  // version needed to extract
+    appendLittleEndian( bytes, 0, 2 );
+    appendLittleEndian( bytes, 0, 2 );
+    appendLittleEndian( bytes, 0, 2 );
+    appendLittleEndian( bytes, zipDosDate, 2 );
+    appendLittleEndian( bytes, crc, 4 );
+    appendLittleEndian( bytes, memberSize, 4 );
+    appendLittleEndian( bytes, memberSize, 4 );
+    appendLittleEndian( bytes, memberName.size( ), 2 );
+    appendLittleEndian( bytes, 0, 2 );  // extra field length
+    appendLittleEndian( bytes, 0, 2 );  // comment length
+    appendLittleEndian( bytes, 0, 2 );  // disk number
+    appendLittleEndian( bytes, 0, 2 );  // internal attributes
+    appendLittleEndian( bytes, 0, 4 );  // external attributes
+    appendLittleEndian( bytes, localHeaderOffset, 4 );
+    bytes += memberName;
+}
+
+void appendZipEndOfCentralDirectory( std::string& bytes, const int numberOfMembers, const uint64_t centralDirectorySize,
+                                     const uint64_t centralDirectoryOffset )
+{
+    appendLittleEndian( bytes, 0x06054b50, 4 );
+    appendLittleEndian( bytes, 0, 2 );
+    appendLittleEndian( bytes, 0, 2 );
+    appendLittleEndian( bytes, numberOfMembers, 2 );
+    appendLittleEndian( bytes, numberOfMembers, 2 );
+    appendLittleEndian( bytes, centralDirectorySize, 4 );
+    appendLittleEndian( bytes, centralDirectoryOffset, 4 );
+    appendLittleEndian( bytes, 0, 2 );
+}
+
+void writeBytesToFile( const std::string& fileName, const std::string& bytes )
+{
+    std::ofstream binaryFile( fileName.c_str( ), std::ios::binary );
+    if ( !binaryFile ) {
+        throw std::runtime_error( "Numpy output: could not open " + fileName );
+    }
+    binaryFile.write( bytes.data( ), bytes.size( ) );
+}
+
+}
+
+void setDataOutputFormat( const DataOutputFormat dataOutputFormat )
+{
+    currentDataOutputFormat = dataOutputFormat;
+}
+
+DataOutputFormat getDataOutputFormat( )
+{
+    return currentDataOutputFormat;
+}
+
+std::string getNumpyFileName( const std::string& textFileName, const std::string& numpyExtension )
+{
+    const std::string textExtension = ".txt";
+    if ( textFileName.size( ) >= textExtension.size( ) &&
+         textFileName.compare( textFileName.size( ) - textExtension.size( ), textExtension.size( ), textExtension ) == 0 ) {
+        return textFileName.substr( 0, textFileName.size( ) - textExtension.size( ) ) + numpyExtension;
+    }
+    return textFileName + numpyExtension;
+}
+
+void removeDataProductFiles( const std::string& textFileName )
+{
+    remove( textFileName.c_str( ) );
+    remove( getNumpyFileName( textFileName, ".npy" ).c_str( ) );
+    remove( getNumpyFileName( textFileName, ".npz" ).c_str( ) );
+}
+
+void writeNumpyArrayToFile( const std::string& fileName, const std::vector< double >& values, const int numberOfColumns )
+{
+    writeBytesToFile( fileName, getNumpyArrayBytes( "<f8", values, numberOfColumns ) );
+}
+
+std::vector< double > readNumpyArrayFromFile( const std::string& fileName, int& numberOfColumns )
+{
+    std::ifstream binaryFile( fileName.c_str( ), std::ios::binary );
+    if ( !binaryFile ) {
+        throw std::runtime_error( "Numpy input: could not open " + fileName );
+    }
+    const std::string bytes( ( std::istreambuf_iterator< char >( binaryFile ) ), std::istreambuf_iterator< char >( ) );
+
+    if ( bytes.size( ) < 10 || bytes.compare( 0, 6, "\x93NUMPY" ) != 0 ) {
+        throw std::runtime_error( "Numpy input: " + fileName + " is not a .npy file" );
+    }
+    const int majorVersion = static_cast< unsigned char >( bytes[ 6 ] );
+    const int headerLengthSize = ( majorVersion == 1 ? 2 : 4 );
+    const std::size_t headerLength = readLittleEndian( bytes, 8, headerLengthSize );
+    const std::size_t dataStart = 8 + headerLengthSize + headerLength;
+    const std::string header = bytes.substr( 8 + headerLengthSize, headerLength );
+
+    if ( header.find( "'descr': '<f8'" ) == std::string::npos || header.find( "'fortran_order': False" ) == std::string::npos ) {
+        throw std::runtime_error( "Numpy input: " + fileName + " is not a C-ordered little-endian float64 array" );
+    }
+
+    // Shape ( numberOfRows, numberOfColumns )
+    const std::size_t shapeStart = header.find( '(', header.find( "'shape'" ) );
+    const char* shapeString = header.c_str( ) + shapeStart + 1;
+    char* shapeEnd;
+    const long numberOfRows = std::strtol( shapeString, &shapeEnd, 10 );
+    while ( *shapeEnd == ',' || *shapeEnd == ' ' ) {
+        shapeEnd++;
+    }
+    numberOfColumns = ( *shapeEnd == ')' ? 1 : static_cast< int >( std::strtol( shapeEnd, &shapeEnd, 10 ) ) );
+
+    const std::size_t numberOfValues = static_cast< std::size_t >( numberOfRows ) * numberOfColumns;
+    if ( bytes.size( ) < dataStart + 8 * numberOfValues ) {
+        throw std::runtime_error( "Numpy input: " + fileName + " is truncated" );
+    }
+
+    std::vector< double > values( numberOfValues );
+    for ( std::size_t valueNumber = 0; valueNumber < numberOfValues; valueNumber++ ) {
+        const uint64_t bits = readLittleEndian( bytes, dataStart + 8 * valueNumber, 8 );
+        std::memcpy( &values[ valueNumber ], &bits, sizeof( bits ) );
+    }
+    return values;
+}
+
+void NumpyArchive::addArray( const std::string& name, const std::vector< double >& values, const int numberOfColumns )
+{
+    members_.push_back( std::make_pair( name + ".npy", getNumpyArrayBytes( "<f8", values, numberOfColumns ) ) );
+}
+
+void NumpyArchive::addArray( const std::string& name, const std::vector< long long >& values, const int numberOfColumns )
+{
+    members_.push_back( std::make_pair( name + ".npy", getNumpyArrayBytes( "<i8", values, numberOfColumns ) ) );
+}
+
+void NumpyArchive::writeToFile( const std::string& fileName ) const
+{
+    // Stored (uncompressed) zip archive: a local header and the data per member, followed by the central directory
+    std::string archiveBytes;
+    std::string centralDirectory;
+    for ( unsigned int memberNumber = 0; memberNumber < members_.size( ); memberNumber++ ) {
+        const std::string& memberName = members_[ memberNumber ].first;
+        const std::string& memberBytes = members_[ memberNumber ].second;
+        if ( archiveBytes.size( ) + memberBytes.size( ) > 0xFFFFFFFFu ) {
+            throw std::runtime_error( "Numpy output: " + fileName + " exceeds the 4 GB limit of a zip archive without zip64" );
+        }
+        const uint32_t crc = updateCrc32( 0, memberBytes.data( ), memberBytes.size( ) );
+        const uint64_t localHeaderOffset = archiveBytes.size( );
+
+        appendZipLocalHeader( archiveBytes, memberName, crc, memberBytes.size( ) );
+        archiveBytes += memberBytes;
+        appendZipCentralDirectoryEntry( centralDirectory, memberName, crc, memberBytes.size( ), localHeaderOffset );
+    }
+
+    const uint64_t centralDirectoryOffset = archiveBytes.size( );
+    archiveBytes += centralDirectory;
+    appendZipEndOfCentralDirectory( archiveBytes, members_.size( ), centralDirectory.size( ), centralDirectoryOffset );
+
+    writeBytesToFile( fileName, archiveBytes );
+}
+
+NumpyTrajectoryFileWriter::NumpyTrajectoryFileWriter( const std::string& fileName, const int stateDimension ):
+    fileName_( fileName ), numberOfColumns_( 1 + stateDimension ), offsets_( 1, 0 ), closed_( false )
+{
+    binaryFile_.open( fileName.c_str( ), std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary );
+    if ( !binaryFile_ ) {
+        throw std::runtime_error( "Numpy output: could not open " + fileName );
+    }
+
+    // Local header and .npy header of 'states' with placeholders, both are filled in by close( ). The .npy header has room
+    // for a shape with the largest possible number of rows.
+    std::string headerBytes;
+    appendZipLocalHeader( headerBytes, "states.npy", 0, 0 );
+    statesHeaderLength_ = getNumpyHeaderBytes( "<f8", getShape( 0xFFFFFFFFFFFFFFFFull ) ).size( );
+    headerBytes += getNumpyHeaderBytes( "<f8", getShape( 0 ), statesHeaderLength_ - 10 );
+    binaryFile_.write( headerBytes.data( ), headerBytes.size( ) );
+}
+
+NumpyTrajectoryFileWriter::~NumpyTrajectoryFileWriter( )
+{
+    try {
+        close( );
+    } catch ( const std::exception& ) { }
+}
+
+void NumpyTrajectoryFileWriter::appendTrajectory( const TrajectoryView& trajectory )
+{
+    if ( closed_ ) {
+        throw std::runtime_error( "Numpy output: " + fileName_ + " is already closed" );
+    }
+    if ( 1 + trajectory.getStateDimension( ) != numberOfColumns_ && !trajectory.empty( ) ) {
+        throw std::runtime_error( "Numpy output: state dimension of a trajectory does not match " + fileName_ );
+    }
+
+    rowBytes_.clear( );
+    for ( int stateNumber = 0; stateNumber < trajectory.size( ); stateNumber++ ) {
+        appendLittleEndian( rowBytes_, getBits( trajectory.getTime( stateNumber ) ), 8 );
+        const double* state = trajectory.getStateData( ) + stateNumber * trajectory.getStateDimension( );
+        for ( int elementNumber = 0; elementNumber < trajectory.getStateDimension( ); elementNumber++ ) {
+            appendLittleEndian( rowBytes_, getBits( state[ elementNumber ] ), 8 );
+        }
+    }
+    binaryFile_.write( rowBytes_.data( ), rowBytes_.size( ) );
+    offsets_.push_back( offsets_.back( ) + trajectory.size( ) );
+}
+
+void NumpyTrajectoryFileWriter::close( )
+{
+    if ( closed_ ) {
+        return;
+    }
+    closed_ = true;
+
+    const std::string localHeaderName = "states.npy";
+    const uint64_t localHeaderLength = 30 + localHeaderName.size( );
+    const uint64_t statesMemberSize = statesHeaderLength_ + 8 * numberOfColumns_ * static_cast< uint64_t >( offsets_.back( ) );
+    const std::string offsetsBytes = getNumpyArrayBytes( "<i8", offsets_, 0 );
+    const uint64_t offsetsHeaderOffset = localHeaderLength + statesMemberSize;
+    if ( offsetsHeaderOffset + 30 + 11 + offsetsBytes.size( ) > 0xFFFFFFFFu ) {
+        throw std::runtime_error( "Numpy output: " + fileName_ + " exceeds the 4 GB limit of a zip archive without zip64" );
+    }
+
+    // Shape of 'states', then the CRC of the member, which is read back in blocks instead of being kept in memory
+    const std::string statesHeader = getNumpyHeaderBytes( "<f8", getShape( offsets_.back( ) ), statesHeaderLength_ - 10 );
+    binaryFile_.seekp( localHeaderLength );
+    binaryFile_.write( statesHeader.data( ), statesHeader.size( ) );
+    binaryFile_.flush( );
+
+    uint32_t crc = 0;
+    std::vector< char > readBlock( 1 << 20 );
+    binaryFile_.seekg( localHeaderLength );
+    for ( uint64_t bytesRead = 0; bytesRead < statesMemberSize; ) {
+        const std::size_t blockSize = static_cast< std::size_t >( std::min< uint64_t >( readBlock.size( ), statesMemberSize - bytesRead ) );
+        binaryFile_.read( readBlock.data( ), blockSize );
+        crc = updateCrc32( crc, readBlock.data( ), blockSize );
+        bytesRead += blockSize;
+    }
+
+    std::string localHeader;
+    appendZipLocalHeader( localHeader, localHeaderName, crc, statesMemberSize );
+    binaryFile_.seekp( 0 );
+    binaryFile_.write( localHeader.data( ), localHeader.size( ) );
+
+    // 'offsets' and the central directory after the states
+    const uint32_t offsetsCrc = updateCrc32( 0, offsetsBytes.data( ), offsetsBytes.size( ) );
+    std::string trailingBytes;
+    appendZipLocalHeader( trailingBytes, "offsets.npy", offsetsCrc, offsetsBytes.size( ) );
+    trailingBytes += offsetsBytes;
+
+    std::string centralDirectory;
+    appendZipCentralDirectoryEntry( centralDirectory, localHeaderName, crc, statesMemberSize, 0 );
+    appendZipCentralDirectoryEntry( centralDirectory, "offsets.npy", offsetsCrc, offsetsBytes.size( ), offsetsHeaderOffset );
+    const uint64_t centralDirectoryOffset = offsetsHeaderOffset + trailingBytes.size( );
+    trailingBytes += centralDirectory;
+    appendZipEndOfCentralDirectory( trailingBytes, 2, centralDirectory.size( ), centralDirectoryOffset );
+
+    binaryFile_.seekp( offsetsHeaderOffset );
+    binaryFile_.write( trailingBytes.data( ), trailingBytes.size( ) );
+    binaryFile_.close( );
+    if ( !binaryFile_ ) {
+        throw std::runtime_error( "Numpy output: could not write " + fileName_ );
+    }
+}
+
+std::string NumpyTrajectoryFileWriter::getShape( const unsigned long long numberOfRows ) const
+{
+    return "(" + std::to_string( numberOfRows ) + ", " + std::to_string( numberOfColumns_ ) + ")";
+}
+
+void writeTrajectorySetToNumpyFile( const std::string& fileName, const TrajectorySet& trajectorySet,
+                                    const int firstTrajectoryNumber, const int numberOfTrajectories )
+{
+    NumpyTrajectoryFileWriter trajectoryFile( fileName, trajectorySet.getStateDimension( ) );
+    for ( int trajectoryNumber = firstTrajectoryNumber; trajectoryNumber < firstTrajectoryNumber + numberOfTrajectories; trajectoryNumber++ ) {
+        trajectoryFile.appendTrajectory( trajectorySet.getTrajectory( trajectoryNumber ) );
+    }
+    trajectoryFile.close( );
+}
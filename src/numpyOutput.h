@@ -0,0 +1,93 @@
+#ifndef TUDATBUNDLE_NUMPYOUTPUT_H
+#define TUDATBUNDLE_NUMPYOUTPUT_H
+
+
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trajectoryBuffer.h"
+
+// Format in which the data products (initial conditions, differential corrections, orbits, manifolds, eigenvectors,
+// Poincare sections and minimum impulse connections) are written; the column schemas are listed in docs/output_formats.txt
+enum DataOutputFormat
+{
+    text_data_output,
+    numpy_data_output
+};
+
+// Process-wide, set once at the start of a run
+void setDataOutputFormat( const DataOutputFormat dataOutputFormat );
+
+DataOutputFormat getDataOutputFormat( );
+
+// Name of the .npy or .npz counterpart of a .txt data product
+std::string getNumpyFileName( const std::string& textFileName, const std::string& numpyExtension );
+
+// Removes the .txt, .npy and .npz versions of a data product, so that it only exists in the format of the latest run
+void removeDataProductFiles( const std::string& textFileName );
+
+// Writes a row-major array of numberOfRows x numberOfColumns doubles (shape ( numberOfRows, ) if numberOfColumns is 0) as
+// a .npy file, which np.load reads without parsing
+void writeNumpyArrayToFile( const std::string& fileName, const std::vector< double >& values, const int numberOfColumns );
+
+// Reads a two-dimensional .npy file of doubles as written by writeNumpyArrayToFile (C order, little-endian float64)
+std::vector< double > readNumpyArrayFromFile( const std::string& fileName, int& numberOfColumns );
+
+// Named arrays written together as an uncompressed .npz archive (np.savez layout)
+class NumpyArchive
+{
+public:
+    NumpyArchive( ) { }
+
+    void addArray( const std::string& name, const std::vector< double >& values, const int numberOfColumns );
+
+    void addArray( const std::string& name, const std::vector< long long >& values, const int numberOfColumns );
+
+    void writeToFile( const std::string& fileName ) const;
+
+private:
+    NumpyArchive( const NumpyArchive& );
+    NumpyArchive& operator=( const NumpyArchive& );
+
+    // Member name and contents of the .npy file of every array
+    std::vector< std::pair< std::string, std::string > > members_;
+};
+
+// Writes trajectories one at a time into an .npz archive with the layout of writeTrajectorySetToNumpyFile, so only the
+// trajectory being appended has to be in memory. The rows go straight to the file; close( ) fills in the shape and CRC of
+// 'states' and adds 'offsets'. The archive is only readable after close( ), which the destructor calls if needed.
+class NumpyTrajectoryFileWriter
+{
+public:
+    NumpyTrajectoryFileWriter( const std::string& fileName, const int stateDimension = 6 );
+
+    ~NumpyTrajectoryFileWriter( );
+
+    void appendTrajectory( const TrajectoryView& trajectory );
+
+    void close( );
+
+private:
+    NumpyTrajectoryFileWriter( const NumpyTrajectoryFileWriter& );
+    NumpyTrajectoryFileWriter& operator=( const NumpyTrajectoryFileWriter& );
+
+    std::string getShape( const unsigned long long numberOfRows ) const;
+
+    const std::string fileName_;
+    const int numberOfColumns_;
+    std::fstream binaryFile_;
+    std::size_t statesHeaderLength_;
+    std::vector< long long > offsets_;
+    std::string rowBytes_;
+    bool closed_;
+};
+
+// Writes the trajectories firstTrajectoryNumber up to firstTrajectoryNumber + numberOfTrajectories as an .npz archive with
+// 'states' (time followed by the state, one row per state) and 'offsets' (int64, first row of every trajectory followed
+// by the number of rows, so trajectory i is states[ offsets[ i ]:offsets[ i + 1 ] ] and may be empty)
+void writeTrajectorySetToNumpyFile( const std::string& fileName, const TrajectorySet& trajectorySet,
+                                    const int firstTrajectoryNumber, const int numberOfTrajectories );
+
+#endif  // TUDATBUNDLE_NUMPYOUTPUT_H
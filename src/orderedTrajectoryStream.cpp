@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "orderedTrajectoryStream.h"
+
+OrderedTrajectoryStream::OrderedTrajectoryStream( const std::function< void( const int, const TrajectoryView& ) >& writeTrajectory,
+                                                  const int maximumNumberOfBufferedTrajectories ):
+    writeTrajectory_( writeTrajectory ), maximumNumberOfBufferedTrajectories_( std::max( maximumNumberOfBufferedTrajectories, 1 ) ),
+    nextTrajectoryNumber_( 0 ), writing_( false ), writeFailed_( false ) { }
+
+void OrderedTrajectoryStream::waitForCapacity( const int trajectoryNumber )
+{
+    std::unique_lock< std::mutex > bufferLock( bufferMutex_ );
+    windowAdvanced_.wait( bufferLock, [&]( ) {
+        return trajectoryNumber < nextTrajectoryNumber_ + maximumNumberOfBufferedTrajectories_ || writeFailed_;
+    } );
+    if ( writeFailed_ ) {
+        throw std::runtime_error( "Ordered trajectory stream: an earlier trajectory could not be computed or written" );
+    }
+}
+
+void OrderedTrajectoryStream::submitTrajectory( const int trajectoryNumber, TrajectoryBuffer& trajectory )
+{
+    std::unique_lock< std::mutex > bufferLock( bufferMutex_ );
+    if ( writeFailed_ ) {
+        throw std::runtime_error( "Ordered trajectory stream: an earlier trajectory could not be computed or written" );
+    }
+
+    // The trajectory next in line is written from the buffer of the caller, which keeps its capacity; others are moved into
+    // the reorder buffer. If another thread is writing, it also picks up this trajectory when it is next in line.
+    TrajectoryBuffer* nextTrajectory = &trajectory;
+    if ( writing_ || trajectoryNumber != nextTrajectoryNumber_ ) {
+        // The caller is left with an empty buffer of the same state dimension
+        std::swap( bufferedTrajectories_.insert( std::make_pair( trajectoryNumber, TrajectoryBuffer( trajectory.getStateDimension( ) ) ) ).first->second,
+                   trajectory );
+        if ( writing_ ) {
+            return;
+        }
+        nextTrajectory = nullptr;
+    }
+
+    writing_ = true;
+    TrajectoryBuffer writtenTrajectory;
+    while ( true ) {
+        if ( nextTrajectory == nullptr ) {
+            std::map< int, TrajectoryBuffer >::iterator bufferedTrajectory = bufferedTrajectories_.find( nextTrajectoryNumber_ );
+            if ( bufferedTrajectory == bufferedTrajectories_.end( ) ) {
+                break;
+            }
+            std::swap( writtenTrajectory, bufferedTrajectory->second );
+            bufferedTrajectories_.erase( bufferedTrajectory );
+            nextTrajectory = &writtenTrajectory;
+        }
+
+        // The sink is called outside the lock, so submitting threads never wait for the output
+        bufferLock.unlock( );
+        try {
+            writeTrajectory_( nextTrajectoryNumber_, nextTrajectory->getView( ) );
+        } catch ( ... ) {
+            bufferLock.lock( );
+            writing_ = false;
+            writeFailed_ = true;
+            bufferedTrajectories_.clear( );
+            windowAdvanced_.notify_all( );
+            throw;
+        }
+        nextTrajectory->clear( );
+        bufferLock.lock( );
+
+        nextTrajectory = nullptr;
+        nextTrajectoryNumber_++;
+        windowAdvanced_.notify_all( );
+    }
+    writing_ = false;
+}
+
+void OrderedTrajectoryStream::abort( )
+{
+    std::lock_guard< std::mutex > bufferLock( bufferMutex_ );
+    writeFailed_ = true;
+    bufferedTrajectories_.clear( );
+    windowAdvanced_.notify_all( );
+}
+
+int OrderedTrajectoryStream::getNumberOfWrittenTrajectories( ) const
+{
+    std::lock_guard< std::mutex > bufferLock( bufferMutex_ );
+    return nextTrajectoryNumber_;
+}
@@ -0,0 +1,54 @@
+#ifndef TUDATBUNDLE_ORDEREDTRAJECTORYSTREAM_H
+#define TUDATBUNDLE_ORDEREDTRAJECTORYSTREAM_H
+
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+
+#include "trajectoryBuffer.h"
+
+// Hands trajectories that are completed in any order by concurrent tasks to a sink in trajectory number order (0, 1, 2,
+// ...). A completed trajectory waits in a small reorder buffer until all trajectories before it have been written; the
+// thread that completes the next trajectory in line writes it and everything behind it that is ready, while the other
+// threads continue. At most maximumNumberOfBufferedTrajectories trajectories are held, so the memory does not depend on
+// the total number of trajectories.
+class OrderedTrajectoryStream
+{
+public:
+    OrderedTrajectoryStream( const std::function< void( const int, const TrajectoryView& ) >& writeTrajectory,
+                             const int maximumNumberOfBufferedTrajectories );
+
+    // Blocks until trajectoryNumber lies within the reorder window, call before computing it. Deadlock free as long as every
+    // trajectory before it is being computed or has been submitted. Throws once writing a trajectory has failed or the
+    // stream was aborted.
+    void waitForCapacity( const int trajectoryNumber );
+
+    // Takes over the contents of trajectory (which is left empty) and writes it once all trajectories before it are written;
+    // thread safe. An exception of the sink is rethrown to the submitting thread that wrote the trajectory, after which
+    // the stream accepts no more trajectories.
+    void submitTrajectory( const int trajectoryNumber, TrajectoryBuffer& trajectory );
+
+    // Called by a task that gives up on its trajectory (which is then never submitted): wakes the threads waiting for
+    // capacity, which throw, and makes the stream accept no more trajectories
+    void abort( );
+
+    int getNumberOfWrittenTrajectories( ) const;
+
+private:
+    OrderedTrajectoryStream( const OrderedTrajectoryStream& );
+    OrderedTrajectoryStream& operator=( const OrderedTrajectoryStream& );
+
+    const std::function< void( const int, const TrajectoryView& ) > writeTrajectory_;
+    const int maximumNumberOfBufferedTrajectories_;
+
+    mutable std::mutex bufferMutex_;
+    std::condition_variable windowAdvanced_;
+    std::map< int, TrajectoryBuffer > bufferedTrajectories_;
+    int nextTrajectoryNumber_;
+    bool writing_;
+    bool writeFailed_;
+};
+
+#endif  // TUDATBUNDLE_ORDEREDTRAJECTORYSTREAM_H
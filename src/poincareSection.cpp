@@ -0,0 +1,189 @@
+#include <cmath>
+
+#include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
+#include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
+
+#include "poincareSection.h"
+#include "propagateOrbit.h"
+
+PoincareSection createHyperplaneSection( const std::string& name, const int stateComponent, const double value,
+                                         const int conditionComponent, const double conditionSign, const int crossingDirection )
+{
+    Eigen::Vector6d normal = Eigen::Vector6d::Zero( );
+    normal( stateComponent ) = 1.0;
+
+    PoincareSection poincareSection = createHyperplaneSection( name, normal, value, crossingDirection );
+    poincareSection.conditionComponent = conditionComponent;
+    poincareSection.conditionSign      = conditionSign;
+    return poincareSection;
+}
+
+PoincareSection createHyperplaneSection( const std::string& name, const Eigen::Vector6d& normal, const double value,
+                                         const int crossingDirection )
+{
+    PoincareSection poincareSection;
+    poincareSection.name               = name;
+    poincareSection.geometry           = hyperplane_section;
+    poincareSection.normal             = normal;
+    poincareSection.centre             = Eigen::Vector3d::Zero( );
+    poincareSection.value              = value;
+    poincareSection.crossingDirection  = crossingDirection;
+    poincareSection.conditionComponent = -1;
+    poincareSection.conditionSign      = 1.0;
+    return poincareSection;
+}
+
+PoincareSection createAngleSection( const std::string& name, const Eigen::Vector3d& centre, const double angleInDegrees,
+                                    const int crossingDirection )
+{
+    PoincareSection poincareSection;
+    poincareSection.name               = name;
+    poincareSection.geometry           = angle_section;
+    poincareSection.normal             = Eigen::Vector6d::Zero( );
+    poincareSection.centre             = centre;
+    poincareSection.value              = angleInDegrees * tudat::mathematical_constants::PI / 180.0;
+    poincareSection.crossingDirection  = crossingDirection;
+    poincareSection.conditionComponent = -1;
+    poincareSection.conditionSign      = 1.0;
+    return poincareSection;
+}
+
+PoincareSection createSphereSection( const std::string& name, const Eigen::Vector3d& centre, const double radius,
+                                     const int crossingDirection )
+{
+    PoincareSection poincareSection;
+    poincareSection.name               = name;
+    poincareSection.geometry           = sphere_section;
+    poincareSection.normal             = Eigen::Vector6d::Zero( );
+    poincareSection.centre             = centre;
+    poincareSection.value              = radius;
+    poincareSection.crossingDirection  = crossingDirection;
+    poincareSection.conditionComponent = -1;
+    poincareSection.conditionSign      = 1.0;
+    return poincareSection;
+}
+
+Eigen::Vector3d getPrimaryLocation( const int primaryNr, const double massParameter )
+{
+    return Eigen::Vector3d( primaryNr == 1 ? -massParameter : 1.0 - massParameter, 0.0, 0.0 );
+}
+
+Eigen::Vector3d getLibrationPointLocation( const int librationPointNr, const double massParameter )
+{
+    // Newton iteration on the x-derivative of the effective potential along the x-axis
+    double xLocation;
+    if ( librationPointNr == 1 ) {
+        xLocation = 1.0 - massParameter - std::cbrt( massParameter / 3.0 );
+    } else if ( librationPointNr == 2 ) {
+        xLocation = 1.0 - massParameter + std::cbrt( massParameter / 3.0 );
+    } else {
+        xLocation = -1.0 - 5.0 * massParameter / 12.0;
+    }
+
+    for ( int iterationNumber = 0; iterationNumber < 50; iterationNumber++ ) {
+        const double distanceToEarth = xLocation + massParameter;
+        const double distanceToMoon  = xLocation - 1.0 + massParameter;
+        const double potentialDerivative = xLocation - ( 1.0 - massParameter ) * distanceToEarth / std::pow( std::abs( distanceToEarth ), 3 ) -
+                massParameter * distanceToMoon / std::pow( std::abs( distanceToMoon ), 3 );
+        const double potentialSecondDerivative = 1.0 + 2.0 * ( 1.0 - massParameter ) / std::pow( std::abs( distanceToEarth ), 3 ) +
+                2.0 * massParameter / std::pow( std::abs( distanceToMoon ), 3 );
+
+        const double correction = potentialDerivative / potentialSecondDerivative;
+        xLocation -= correction;
+        if ( std::abs( correction ) < 1.0E-15 ) {
+            break;
+        }
+    }
+    return Eigen::Vector3d( xLocation, 0.0, 0.0 );
+}
+
+PoincareSection getThetaSection( const double thetaStoppingAngle, const double massParameter )
+{
+    return createAngleSection( "theta", getPrimaryLocation( 2, massParameter ), thetaStoppingAngle, 1 );
+}
+
+double evaluatePoincareSection( const PoincareSection& poincareSection, const Eigen::Ref< const Eigen::VectorXd >& stateVector )
+{
+    switch ( poincareSection.geometry ) {
+    case angle_section:
+        return std::remainder( std::atan2( stateVector( 1 ) - poincareSection.centre( 1 ), stateVector( 0 ) - poincareSection.centre( 0 ) ) -
+                               poincareSection.value, 2.0 * tudat::mathematical_constants::PI );
+    case sphere_section:
+        return ( stateVector.segment( 0, 3 ) - poincareSection.centre ).norm( ) - poincareSection.value;
+    default:
+        return poincareSection.normal.dot( stateVector.segment( 0, 6 ) ) - poincareSection.value;
+    }
+}
+
+Eigen::Vector6d computePoincareSectionGradient( const PoincareSection& poincareSection,
+                                                const Eigen::Ref< const Eigen::VectorXd >& stateVector )
+{
+    Eigen::Vector6d sectionGradient = Eigen::Vector6d::Zero( );
+    switch ( poincareSection.geometry ) {
+    case angle_section: {
+        const double xDistance = stateVector( 0 ) - poincareSection.centre( 0 );
+        const double yDistance = stateVector( 1 ) - poincareSection.centre( 1 );
+        const double squaredDistance = xDistance * xDistance + yDistance * yDistance;
+        sectionGradient( 0 ) = -yDistance / squaredDistance;
+        sectionGradient( 1 ) = xDistance / squaredDistance;
+        break;
+    }
+    case sphere_section:
+        sectionGradient.segment( 0, 3 ) = ( stateVector.segment( 0, 3 ) - poincareSection.centre ).normalized( );
+        break;
+    default:
+        sectionGradient = poincareSection.normal;
+    }
+    return sectionGradient;
+}
+
+bool satisfiesPoincareSectionCondition( const PoincareSection& poincareSection, const Eigen::Ref< const Eigen::VectorXd >& stateVector )
+{
+    return poincareSection.conditionComponent < 0 ||
+           stateVector( poincareSection.conditionComponent ) * poincareSection.conditionSign > 0.0;
+}
+
+bool checkPoincareSectionCrossing( const PoincareSection& poincareSection, const Eigen::Ref< const Eigen::VectorXd >& previousStateVector,
+                                   const Eigen::Ref< const Eigen::VectorXd >& stateVector, const int integrationDirection )
+{
+    const double previousSectionValue = evaluatePoincareSection( poincareSection, previousStateVector );
+    const double sectionValue         = evaluatePoincareSection( poincareSection, stateVector );
+    if ( previousSectionValue * sectionValue >= 0.0 ) {
+        return false;
+    }
+    if ( poincareSection.geometry == angle_section &&
+         std::abs( sectionValue - previousSectionValue ) > tudat::mathematical_constants::PI ) {
+        return false;
+    }
+    if ( poincareSection.crossingDirection != 0 &&
+         ( sectionValue - previousSectionValue ) * integrationDirection * poincareSection.crossingDirection < 0.0 ) {
+        return false;
+    }
+    return satisfiesPoincareSectionCondition( poincareSection, stateVector );
+}
+
+std::pair< Eigen::MatrixXd, double > refinePoincareSectionCrossing( const std::pair< Eigen::MatrixXd, double >& previousStateVectorInclSTMAndTime,
+                                                                     const PoincareSection& poincareSection, const int integrationDirection,
+                                                                     const double massParameter )
+{
+    std::pair< Eigen::MatrixXd, double > stateVectorInclSTMAndTime = previousStateVectorInclSTMAndTime;
+    const double sectionSign = evaluatePoincareSection( poincareSection, previousStateVectorInclSTMAndTime.first.col( 0 ) ) > 0.0 ? 1.0 : -1.0;
+
+    for ( int i = 5; i <= 12; i++ ) {
+
+        double initialStepSize = pow(10,(static_cast<float>(-i)));
+        double maximumStepSize = pow(10,(static_cast<float>(-i) + 1.0));
+
+        while ( evaluatePoincareSection( poincareSection, stateVectorInclSTMAndTime.first.col( 0 ) ) * sectionSign > 0 ) {
+            std::pair< Eigen::MatrixXd, double > candidateStateVectorInclSTMAndTime = propagateOrbit(
+                        stateVectorInclSTMAndTime.first, massParameter, stateVectorInclSTMAndTime.second,
+                        integrationDirection, initialStepSize, maximumStepSize );
+
+            if ( evaluatePoincareSection( poincareSection, candidateStateVectorInclSTMAndTime.first.col( 0 ) ) * sectionSign < 0 ) {
+                break;
+            }
+            stateVectorInclSTMAndTime = candidateStateVectorInclSTMAndTime;
+        }
+    }
+    return stateVectorInclSTMAndTime;
+}
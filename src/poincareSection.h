@@ -0,0 +1,78 @@
+#ifndef TUDATBUNDLE_POINCARESECTION_H
+#define TUDATBUNDLE_POINCARESECTION_H
+
+
+#include <string>
+#include <utility>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+enum PoincareSectionGeometry
+{
+    hyperplane_section,
+    angle_section,
+    sphere_section
+};
+
+// Section at the zero of evaluatePoincareSection:
+//   hyperplane: normal . stateVector - value, for any linear combination of the synodic state
+//   angle:      angle of (x, y) about centre minus value [rad], wrapped to [-pi, pi]
+//   sphere:     distance to centre minus value
+// Crossings only count in crossingDirection of the section function in physical time (+1 increasing, -1 decreasing,
+// 0 either) and where stateVector(conditionComponent) has the sign conditionSign (no condition for conditionComponent = -1).
+struct PoincareSection
+{
+    std::string name;
+    PoincareSectionGeometry geometry;
+    Eigen::Vector6d normal;
+    Eigen::Vector3d centre;
+    double value;
+    int crossingDirection;
+    int conditionComponent;
+    double conditionSign;
+};
+
+PoincareSection createHyperplaneSection( const std::string& name, const int stateComponent, const double value,
+                                         const int conditionComponent = -1, const double conditionSign = 1.0,
+                                         const int crossingDirection = 0 );
+
+PoincareSection createHyperplaneSection( const std::string& name, const Eigen::Vector6d& normal, const double value,
+                                         const int crossingDirection = 0 );
+
+PoincareSection createAngleSection( const std::string& name, const Eigen::Vector3d& centre, const double angleInDegrees,
+                                    const int crossingDirection = 0 );
+
+PoincareSection createSphereSection( const std::string& name, const Eigen::Vector3d& centre, const double radius,
+                                     const int crossingDirection = 0 );
+
+// Synodic position of the Earth (1) or Moon (2)
+Eigen::Vector3d getPrimaryLocation( const int primaryNr, const double massParameter );
+
+// Synodic position of the collinear libration points L1, L2 and L3
+Eigen::Vector3d getLibrationPointLocation( const int librationPointNr, const double massParameter );
+
+// Angle about the Moon at which the theta manifolds are connected, passed counterclockwise in physical time
+PoincareSection getThetaSection( const double thetaStoppingAngle, const double massParameter );
+
+double evaluatePoincareSection( const PoincareSection& poincareSection, const Eigen::Ref< const Eigen::VectorXd >& stateVector );
+
+// Derivative of evaluatePoincareSection with respect to the state
+Eigen::Vector6d computePoincareSectionGradient( const PoincareSection& poincareSection,
+                                                const Eigen::Ref< const Eigen::VectorXd >& stateVector );
+
+bool satisfiesPoincareSectionCondition( const PoincareSection& poincareSection, const Eigen::Ref< const Eigen::VectorXd >& stateVector );
+
+// True if the section is crossed in the selected direction and on the selected side over an integration step from
+// previousStateVector to stateVector; the jump of an angle section at the opposite ray does not count as a crossing
+bool checkPoincareSectionCrossing( const PoincareSection& poincareSection, const Eigen::Ref< const Eigen::VectorXd >& previousStateVector,
+                                   const Eigen::Ref< const Eigen::VectorXd >& stateVector, const int integrationDirection );
+
+// Last state before the crossing following previousStateVectorInclSTMAndTime, approached with decreasing fixed step sizes
+// (1E-5 down to 1E-12)
+std::pair< Eigen::MatrixXd, double > refinePoincareSectionCrossing( const std::pair< Eigen::MatrixXd, double >& previousStateVectorInclSTMAndTime,
+                                                                     const PoincareSection& poincareSection, const int integrationDirection,
+                                                                     const double massParameter );
+
+#endif  // TUDATBUNDLE_POINCARESECTION_H
@@ -1,3 +1,6 @@
+#include <map>
+#include <memory>
+
 #include "Tudat/Mathematics/NumericalIntegrators/rungeKuttaVariableStepSizeIntegrator.h"
 #include "Tudat/Mathematics/NumericalIntegrators/rungeKuttaCoefficients.h"
 #include "Tudat/Mathematics/RootFinders/newtonRaphson.h"
@@ -6,8 +9,12 @@
 #include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
 #include "Tudat/InputOutput/basicInputOutput.h"
 
+#include "asynchronousOutputWriter.h"
+#include "numpyOutput.h"
 #include "propagateOrbit.h"
 #include "stateDerivativeModel.h"
+#include "trajectoryArchive.h"
+#include "trajectoryDecimation.h"
 
 Eigen::MatrixXd getFullInitialState( const Eigen::Vector6d& initialState )
 {
@@ -18,7 +25,7 @@ Eigen::MatrixXd getFullInitialState( const Eigen::Vector6d& initialState )
 }
 
 void writeStateHistoryToFile(
-        const std::map< double, Eigen::Vector6d >& stateHistory,
+        const TrajectoryBuffer& stateHistory,
         const int orbitId, const std::string orbitType, const int librationPointNr,
         const int saveEveryNthIntegrationStep, const bool completeInitialConditionsHaloFamily )
 {
@@ -48,7 +55,59 @@ void writeStateHistoryToFile(
         }
     }
 
-    tudat::input_output::writeDataMapToTextFile( stateHistory, fileNameString, directoryString );
+    // All members of a family share a kind in the archive, the orbit id identifies the trajectory
+    std::string kind = "L" + std::to_string(librationPointNr) + "_" + orbitType + ( completeInitialConditionsHaloFamily ? "_n" : "" );
+    if ( saveEveryNthIntegrationStep != 1000 ) {
+        kind += "_" + std::to_string(saveEveryNthIntegrationStep);
+    }
+
+    // Decimated copies for plotting, if levels are configured
+    if ( !getTrajectoryDecimationLevels( ).empty( ) ) {
+        DecimatedTrajectoryWriter decimatedStateHistoryWriter( directoryString + fileNameString, kind );
+        decimatedStateHistoryWriter.appendTrajectory( orbitId, stateHistory.getView( ) );
+        decimatedStateHistoryWriter.close( );
+    }
+
+    std::shared_ptr< TrajectoryArchiveWriter > trajectoryArchive = getTrajectoryArchive( );
+    if ( trajectoryArchive ) {
+        trajectoryArchive->appendTrajectory( kind, orbitId, stateHistory.getView( ) );
+        return;
+    }
+
+    removeDataProductFiles( directoryString + fileNameString );
+    if ( getDataOutputFormat( ) == numpy_data_output ) {
+        std::vector< double > stateHistoryRows;
+        stateHistoryRows.reserve( 7 * stateHistory.size( ) );
+        for ( int stateNumber = 0; stateNumber < stateHistory.size( ); stateNumber++ ) {
+            stateHistoryRows.push_back( stateHistory.getTime( stateNumber ) );
+            for ( int i = 0; i < 6; i++ ) {
+                stateHistoryRows.push_back( stateHistory.getState( stateNumber )( i ) );
+            }
+        }
+        writeNumpyArrayToFile( getNumpyFileName( directoryString + fileNameString, ".npy" ), stateHistoryRows, 7 );
+        return;
+    }
+
+    // The Tudat writer sets the number format of the orbit files, so it is fed a map built from the buffer
+    std::map< double, Eigen::Vector6d > stateHistoryMap;
+    for ( int stateNumber = 0; stateNumber < stateHistory.size( ); stateNumber++ ) {
+        stateHistoryMap[ stateHistory.getTime( stateNumber ) ] = stateHistory.getState( stateNumber );
+    }
+    tudat::input_output::writeDataMapToTextFile( stateHistoryMap, fileNameString, directoryString );
+}
+
+void writeStateHistoryToFileAsynchronously(
+        TrajectoryBuffer&& stateHistory,
+        const int orbitId, const std::string orbitType, const int librationPointNr,
+        const int saveEveryNthIntegrationStep, const bool completeInitialConditionsHaloFamily )
+{
+    // The writer thread takes ownership of the history, the caller can continue with the next orbit
+    std::shared_ptr< const TrajectoryBuffer > ownedStateHistory =
+            std::make_shared< const TrajectoryBuffer >( std::move( stateHistory ) );
+    getAsynchronousOutputWriter( ).enqueue( [=]( ) {
+        writeStateHistoryToFile( *ownedStateHistory, orbitId, orbitType, librationPointNr,
+                                 saveEveryNthIntegrationStep, completeInitialConditionsHaloFamily );
+    } );
 }
 
 std::pair< Eigen::MatrixXd, double > propagateOrbit(
@@ -91,11 +150,11 @@ std::pair< Eigen::MatrixXd, double > propagateOrbit(
 
 std::pair< Eigen::MatrixXd, double >  propagateOrbitToFinalCondition(
         const Eigen::MatrixXd fullInitialState, const double massParameter, const double finalTime, int direction,
-        std::map< double, Eigen::Vector6d >& stateHistory, const int saveFrequency, const double initialTime )
+        TrajectoryBuffer& stateHistory, const int saveFrequency, const double initialTime )
 {           
     if( saveFrequency >= 0 )
     {
-        stateHistory[ initialTime ] = fullInitialState.block( 0, 0, 6, 1 );
+        stateHistory.append( initialTime, fullInitialState.block( 0, 0, 6, 1 ) );
     }
 
     // Perform first integration step
@@ -117,7 +176,7 @@ std::pair< Eigen::MatrixXd, double >  propagateOrbitToFinalCondition(
             // Write every nth integration step to file.
             if ( saveFrequency > 0 && ( stepCounter % saveFrequency == 0 ) )
             {
-                stateHistory[ currentTime ] = currentState.first.block( 0, 0, 6, 1 );
+                stateHistory.append( currentTime, currentState.first.block( 0, 0, 6, 1 ) );
             }
 
             currentTime = currentState.second;
@@ -138,19 +197,20 @@ std::pair< Eigen::MatrixXd, double >  propagateOrbitToFinalCondition(
     // Add final state after minimizing overshoot
     if ( saveFrequency > 0 )
     {
-        stateHistory[ currentTime ] = currentState.first.block( 0, 0, 6, 1 );
+        stateHistory.append( currentTime, currentState.first.block( 0, 0, 6, 1 ) );
     }
+    stateHistory.sortByTime( );
 
     return currentState;
 }
 
 std::pair< Eigen::MatrixXd, double >  propagateOrbitWithStateTransitionMatrixToFinalCondition(
         const Eigen::MatrixXd fullInitialState, const double massParameter, const double finalTime, int direction,
-        std::map< double, Eigen::MatrixXd >& stateTransitionMatrixHistory, const int saveFrequency, const double initialTime )
+        TrajectoryBuffer& stateTransitionMatrixHistory, const int saveFrequency, const double initialTime )
 {
     if( saveFrequency >= 0 )
     {
-        stateTransitionMatrixHistory[ initialTime ] = fullInitialState;
+        stateTransitionMatrixHistory.append( initialTime, fullInitialState );
     }
 
     // Perform first integration step
@@ -171,7 +231,7 @@ std::pair< Eigen::MatrixXd, double >  propagateOrbitWithStateTransitionMatrixToF
             // Write every nth integration step to file.
             if ( saveFrequency > 0 && ( stepCounter % saveFrequency == 0 ) && i == 5 )
             {
-                stateTransitionMatrixHistory[ currentTime ] = currentState.first;
+                stateTransitionMatrixHistory.append( currentTime, currentState.first );
             }
 
             currentTime = currentState.second;
@@ -187,6 +247,7 @@ std::pair< Eigen::MatrixXd, double >  propagateOrbitWithStateTransitionMatrixToF
             }
         }
     }
+    stateTransitionMatrixHistory.sortByTime( );
 
     return currentState;
 }
@@ -1,16 +1,24 @@
 #ifndef TUDATBUNDLE_PROPAGATEORBIT_H
 #define TUDATBUNDLE_PROPAGATEORBIT_H
 
-#include <map>
+#include <string>
 
 #include <Eigen/Core>
 
 #include "Tudat/Basics/basicTypedefs.h"
 
+#include "trajectoryBuffer.h"
+
 Eigen::MatrixXd getFullInitialState( const Eigen::Vector6d& initialState );
 
 void writeStateHistoryToFile(
-        const std::map< double, Eigen::Vector6d >& stateHistory,
+        const TrajectoryBuffer& stateHistory,
+        const int orbitId, const std::string orbitType, const int librationPointNr,
+        const int saveEveryNthIntegrationStep, const bool completeInitialConditionsHaloFamily );
+
+// Hands the state history over to the asynchronous output writer instead of writing it on the calling thread
+void writeStateHistoryToFileAsynchronously(
+        TrajectoryBuffer&& stateHistory,
         const int orbitId, const std::string orbitType, const int librationPointNr,
         const int saveEveryNthIntegrationStep, const bool completeInitialConditionsHaloFamily );
 
@@ -20,10 +28,10 @@ std::pair< Eigen::MatrixXd, double > propagateOrbit(
 
 std::pair< Eigen::MatrixXd, double >  propagateOrbitToFinalCondition(
         const Eigen::MatrixXd fullInitialState, const double massParameter, const double finalTime, int direction,
-        std::map< double, Eigen::Vector6d >& stateHistory, const int saveFrequency = -1, const double initialTime = 0.0 );
+        TrajectoryBuffer& stateHistory, const int saveFrequency = -1, const double initialTime = 0.0 );
 
 std::pair< Eigen::MatrixXd, double >  propagateOrbitWithStateTransitionMatrixToFinalCondition(
         const Eigen::MatrixXd fullInitialState, const double massParameter, const double finalTime, int direction,
-        std::map< double, Eigen::MatrixXd >& stateTransitionMatrixHistory, const int saveFrequency = -1, const double initialTime = 0.0);
+        TrajectoryBuffer& stateTransitionMatrixHistory, const int saveFrequency = -1, const double initialTime = 0.0);
 
 #endif  // TUDATBUNDLE_PROPAGATEORBIT_H
@@ -0,0 +1,290 @@
+#include <cmath>
+
+#include <Eigen/SVD>
+
+#include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
+#include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
+
+#include "computeManifolds.h"
+#include "connectManifoldsAtTheta.h"
+#include "propagateOrbit.h"
+#include "refineHeteroclinicConnection.h"
+#include "stateDerivativeModel.h"
+#include "textOutput.h"
+
+namespace
+{
+
+// Manifold arc from orbitTime along the periodic orbit over integrationTime, with the derivatives of the state at its end
+// with respect to both times. The eigenvector displacement rotates along the orbit with d(STM * eigenvector)/dt = A * STM *
+// eigenvector; although of the order of the displacement, its effect is amplified along the arc and not negligible.
+void computeConnectionArc( const RefinedPeriodicOrbit& periodicOrbit, const Eigen::VectorXd& monodromyMatrixEigenvector,
+                           const double offsetSign, const double eigenvectorDisplacementFromOrbit,
+                           const double orbitTime, const double integrationTime, const double massParameter,
+                           Eigen::Vector6d& stateVectorAtSection, Eigen::Vector6d& derivativeWrtOrbitTime,
+                           Eigen::Vector6d& derivativeWrtIntegrationTime )
+{
+    const Eigen::MatrixXd stateVectorInclSTMOnOrbit = getStateVectorInclSTMOnPeriodicOrbit( periodicOrbit, orbitTime, massParameter );
+    const Eigen::Vector6d localStateVector          = stateVectorInclSTMOnOrbit.block( 0, 0, 6, 1 );
+    const Eigen::Vector6d localEigenvector          = stateVectorInclSTMOnOrbit.block( 0, 1, 6, 6 ) * monodromyMatrixEigenvector;
+    const Eigen::Vector6d localNormalizedEigenvector = localEigenvector.normalized( );
+
+    // Derivative of the displaced initial state with respect to orbitTime
+    const Eigen::MatrixXd stateDerivativeOnOrbit = computeStateDerivative( 0.0, getFullInitialState( localStateVector ) );
+    const Eigen::Vector6d localEigenvectorDerivative = stateDerivativeOnOrbit.block( 0, 1, 6, 6 ) * localEigenvector;
+    const Eigen::Vector6d initialStateDerivativeWrtOrbitTime = stateDerivativeOnOrbit.block( 0, 0, 6, 1 ) +
+            offsetSign * eigenvectorDisplacementFromOrbit * ( localEigenvectorDerivative - localNormalizedEigenvector *
+                                                              localNormalizedEigenvector.dot( localEigenvectorDerivative ) ) / localEigenvector.norm( );
+
+    const Eigen::MatrixXd stateVectorInclSTMAtSection = propagateStateVectorInclSTMToTime(
+                getFullInitialState( localStateVector + offsetSign * eigenvectorDisplacementFromOrbit * localNormalizedEigenvector ),
+                massParameter, 0.0, integrationTime );
+
+    stateVectorAtSection         = stateVectorInclSTMAtSection.block( 0, 0, 6, 1 );
+    derivativeWrtOrbitTime       = stateVectorInclSTMAtSection.block( 0, 1, 6, 6 ) * initialStateDerivativeWrtOrbitTime;
+    derivativeWrtIntegrationTime = computeStateDerivative( 0.0, getFullInitialState( stateVectorAtSection ) ).block( 0, 0, 6, 1 );
+}
+
+// Mismatch between both arcs (6) and section function of the unstable arc (1), with its Jacobian with respect to
+// (unstable orbit time, unstable integration time, stable orbit time, stable integration time)
+void computeConnectionMismatch( const RefinedPeriodicOrbit& periodicOrbitL1, const RefinedPeriodicOrbit& periodicOrbitL2,
+                                const Eigen::VectorXd& unstableEigenvector, const double unstableOffsetSign,
+                                const Eigen::VectorXd& stableEigenvector, const double stableOffsetSign,
+                                const double eigenvectorDisplacementFromOrbit, const PoincareSection& poincareSection,
+                                const double massParameter, const Eigen::Vector4d& connectionTimes,
+                                Eigen::VectorXd& connectionMismatch, Eigen::MatrixXd& connectionMismatchJacobian,
+                                Eigen::Vector6d& unstableStateVectorAtSection, Eigen::Vector6d& stableStateVectorAtSection )
+{
+    Eigen::Vector6d unstableDerivativeWrtOrbitTime, unstableDerivativeWrtIntegrationTime;
+    Eigen::Vector6d stableDerivativeWrtOrbitTime, stableDerivativeWrtIntegrationTime;
+    computeConnectionArc( periodicOrbitL1, unstableEigenvector, unstableOffsetSign, eigenvectorDisplacementFromOrbit,
+                          connectionTimes( 0 ), connectionTimes( 1 ), massParameter, unstableStateVectorAtSection,
+                          unstableDerivativeWrtOrbitTime, unstableDerivativeWrtIntegrationTime );
+    computeConnectionArc( periodicOrbitL2, stableEigenvector, stableOffsetSign, eigenvectorDisplacementFromOrbit,
+                          connectionTimes( 2 ), connectionTimes( 3 ), massParameter, stableStateVectorAtSection,
+                          stableDerivativeWrtOrbitTime, stableDerivativeWrtIntegrationTime );
+
+    const Eigen::Vector6d sectionGradient = computePoincareSectionGradient( poincareSection, unstableStateVectorAtSection );
+
+    connectionMismatch = Eigen::VectorXd::Zero( 7 );
+    connectionMismatch.segment( 0, 6 ) = unstableStateVectorAtSection - stableStateVectorAtSection;
+    connectionMismatch( 6 ) = evaluatePoincareSection( poincareSection, unstableStateVectorAtSection );
+
+    connectionMismatchJacobian = Eigen::MatrixXd::Zero( 7, 4 );
+    connectionMismatchJacobian.block( 0, 0, 6, 1 ) = unstableDerivativeWrtOrbitTime;
+    connectionMismatchJacobian.block( 0, 1, 6, 1 ) = unstableDerivativeWrtIntegrationTime;
+    connectionMismatchJacobian.block( 0, 2, 6, 1 ) = -stableDerivativeWrtOrbitTime;
+    connectionMismatchJacobian.block( 0, 3, 6, 1 ) = -stableDerivativeWrtIntegrationTime;
+    connectionMismatchJacobian( 6, 0 ) = sectionGradient.dot( unstableDerivativeWrtOrbitTime );
+    connectionMismatchJacobian( 6, 1 ) = sectionGradient.dot( unstableDerivativeWrtIntegrationTime );
+}
+
+void writeHeteroclinicConnectionRow( TextTableWriter& textFileHeteroclinicConnection, const HeteroclinicConnection& heteroclinicConnection )
+{
+    textFileHeteroclinicConnection.appendText( std::to_string( static_cast< int >( heteroclinicConnection.converged ) ) );
+    textFileHeteroclinicConnection.appendText( std::to_string( heteroclinicConnection.numberOfIterations ) );
+    textFileHeteroclinicConnection.appendValue( heteroclinicConnection.unstableOrbitTime );
+    textFileHeteroclinicConnection.appendValue( heteroclinicConnection.unstableIntegrationTime );
+    textFileHeteroclinicConnection.appendValue( heteroclinicConnection.stableOrbitTime );
+    textFileHeteroclinicConnection.appendValue( heteroclinicConnection.stableIntegrationTime );
+    textFileHeteroclinicConnection.appendValue( heteroclinicConnection.deltaPosition );
+    textFileHeteroclinicConnection.appendValue( heteroclinicConnection.deltaVelocity );
+    for ( int componentNumber = 0; componentNumber < 6; componentNumber++ ) {
+        textFileHeteroclinicConnection.appendValue( heteroclinicConnection.unstableStateAtSection.size( ) == 6 ?
+                                                        heteroclinicConnection.unstableStateAtSection( componentNumber ) : 0.0 );
+    }
+    textFileHeteroclinicConnection.endRow( );
+}
+
+}
+
+Eigen::MatrixXd propagateStateVectorInclSTMToTime( const Eigen::MatrixXd& stateVectorInclSTM, const double massParameter,
+                                                   const double initialTime, const double finalTime )
+{
+    const int direction = ( finalTime >= initialTime ? 1 : -1 );
+    std::pair< Eigen::MatrixXd, double > stateVectorInclSTMAndTime = std::make_pair( stateVectorInclSTM, initialTime );
+    std::pair< Eigen::MatrixXd, double > nextStateVectorInclSTMAndTime;
+
+    // Regular steps until the next one would pass finalTime, then decreasing fixed steps to approach it
+    for (int i = 4; i <= 12; i++)
+    {
+        double stepSize = pow(10, (static_cast<float>(-i)));
+        while (true)
+        {
+            if (i == 4) {
+                nextStateVectorInclSTMAndTime = propagateOrbit(stateVectorInclSTMAndTime.first, massParameter,
+                                                               stateVectorInclSTMAndTime.second, direction);
+            } else {
+                nextStateVectorInclSTMAndTime = propagateOrbit(stateVectorInclSTMAndTime.first, massParameter,
+                                                               stateVectorInclSTMAndTime.second, direction, stepSize, stepSize);
+            }
+            if ((nextStateVectorInclSTMAndTime.second - finalTime) * direction > 0.0) {
+                break;
+            }
+            stateVectorInclSTMAndTime = nextStateVectorInclSTMAndTime;
+        }
+    }
+    return stateVectorInclSTMAndTime.first;
+}
+
+double getPeriodicOrbitTimeAtPhase( const RefinedPeriodicOrbit& periodicOrbit, const double phase )
+{
+    const TrajectoryBuffer& stateTransitionMatrixHistory = periodicOrbit.stateTransitionMatrixHistory;
+    const int numberOfPointsOnPeriodicOrbit = stateTransitionMatrixHistory.size( );
+
+    // phase * points is the seed index up to rounding; otherwise its fraction is at least 1 / N, far above the margin
+    const double indexOnOrbit = ( phase - std::floor( phase ) ) * numberOfPointsOnPeriodicOrbit;
+    const int seedIndexOnOrbit = std::min( static_cast< int >( std::floor( indexOnOrbit + 1.0E-6 ) ), numberOfPointsOnPeriodicOrbit - 1 );
+    return stateTransitionMatrixHistory.getTime( seedIndexOnOrbit );
+}
+
+Eigen::MatrixXd getStateVectorInclSTMOnPeriodicOrbit( const RefinedPeriodicOrbit& periodicOrbit, const double orbitTime,
+                                                      const double massParameter )
+{
+    const double timeSinceStartOfOrbit = orbitTime - std::floor( orbitTime / periodicOrbit.orbitalPeriod ) * periodicOrbit.orbitalPeriod;
+
+    // Continue from the last stored integration step before the requested time
+    const TrajectoryBuffer& stateTransitionMatrixHistory = periodicOrbit.stateTransitionMatrixHistory;
+    const int previousPointOnOrbit = stateTransitionMatrixHistory.findStateNumberAtOrBeforeTime( timeSinceStartOfOrbit );
+    return propagateStateVectorInclSTMToTime( stateTransitionMatrixHistory.getStateVectorInclSTM( previousPointOnOrbit ), massParameter,
+                                              stateTransitionMatrixHistory.getTime( previousPointOnOrbit ), timeSinceStartOfOrbit );
+}
+
+HeteroclinicConnection refineHeteroclinicConnection( const RefinedPeriodicOrbit& periodicOrbitL1, const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                     const Eigen::MatrixXd& minimumImpulseStateVectorsAtPoincare,
+                                                     const double thetaStoppingAngle, const double massParameter,
+                                                     const double eigenvectorDisplacementFromOrbit, const double maxEigenvalueDeviation,
+                                                     const double connectionTolerance, const int maximumNumberOfIterations )
+{
+    Eigen::Vector4d initialConnectionTimes;
+    initialConnectionTimes << getPeriodicOrbitTimeAtPhase( periodicOrbitL1, minimumImpulseStateVectorsAtPoincare(1, 0) ),
+            minimumImpulseStateVectorsAtPoincare(1, 1),
+            getPeriodicOrbitTimeAtPhase( periodicOrbitL2, minimumImpulseStateVectorsAtPoincare(0, 0) ),
+            minimumImpulseStateVectorsAtPoincare(0, 1);
+
+    return refineHeteroclinicConnection( periodicOrbitL1, periodicOrbitL2, initialConnectionTimes, thetaStoppingAngle, massParameter,
+                                         eigenvectorDisplacementFromOrbit, maxEigenvalueDeviation, connectionTolerance,
+                                         maximumNumberOfIterations );
+}
+
+HeteroclinicConnection refineHeteroclinicConnection( const RefinedPeriodicOrbit& periodicOrbitL1, const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                     const Eigen::Vector4d& initialConnectionTimes,
+                                                     const double thetaStoppingAngle, const double massParameter,
+                                                     const double eigenvectorDisplacementFromOrbit, const double maxEigenvalueDeviation,
+                                                     const double connectionTolerance, const int maximumNumberOfIterations )
+{
+    return refineHeteroclinicConnection( periodicOrbitL1, periodicOrbitL2, initialConnectionTimes,
+                                         getThetaSection( thetaStoppingAngle, massParameter ), massParameter,
+                                         eigenvectorDisplacementFromOrbit, maxEigenvalueDeviation, connectionTolerance,
+                                         maximumNumberOfIterations );
+}
+
+HeteroclinicConnection refineHeteroclinicConnection( const RefinedPeriodicOrbit& periodicOrbitL1, const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                     const Eigen::Vector4d& initialConnectionTimes,
+                                                     const PoincareSection& poincareSection, const double massParameter,
+                                                     const double eigenvectorDisplacementFromOrbit, const double maxEigenvalueDeviation,
+                                                     const double connectionTolerance, const int maximumNumberOfIterations )
+{
+    HeteroclinicConnection heteroclinicConnection;
+    heteroclinicConnection.converged          = false;
+    heteroclinicConnection.numberOfIterations = 0;
+    heteroclinicConnection.unstableOrbitTime       = initialConnectionTimes( 0 );
+    heteroclinicConnection.unstableIntegrationTime = initialConnectionTimes( 1 );
+    heteroclinicConnection.stableOrbitTime         = initialConnectionTimes( 2 );
+    heteroclinicConnection.stableIntegrationTime   = initialConnectionTimes( 3 );
+    heteroclinicConnection.deltaPosition           = 0.0;
+    heteroclinicConnection.deltaVelocity           = 0.0;
+
+    // Exterior unstable manifold of the L1 orbit and interior stable manifold of the L2 orbit, as in connectManifoldsAtTheta
+    Eigen::VectorXd unstableEigenvector;
+    Eigen::VectorXd stableEigenvector;
+    double unstableOffsetSign;
+    double stableOffsetSign;
+    if ( !determineManifoldEigenvectorAtTheta( periodicOrbitL1, 1.0, 1.0, unstableEigenvector, unstableOffsetSign, maxEigenvalueDeviation ) ||
+         !determineManifoldEigenvectorAtTheta( periodicOrbitL2, -1.0, -1.0, stableEigenvector, stableOffsetSign, maxEigenvalueDeviation ) ) {
+        return heteroclinicConnection;
+    }
+
+    Eigen::Vector4d connectionTimes = initialConnectionTimes;
+
+    Eigen::VectorXd connectionMismatch;
+    Eigen::MatrixXd connectionMismatchJacobian;
+    Eigen::Vector6d unstableStateVectorAtSection;
+    Eigen::Vector6d stableStateVectorAtSection;
+    computeConnectionMismatch( periodicOrbitL1, periodicOrbitL2, unstableEigenvector, unstableOffsetSign, stableEigenvector,
+                               stableOffsetSign, eigenvectorDisplacementFromOrbit, poincareSection, massParameter,
+                               connectionTimes, connectionMismatch, connectionMismatchJacobian,
+                               unstableStateVectorAtSection, stableStateVectorAtSection );
+
+    while ( heteroclinicConnection.numberOfIterations < maximumNumberOfIterations ) {
+        if ( connectionMismatch.lpNorm< Eigen::Infinity >( ) < connectionTolerance ) {
+            heteroclinicConnection.converged = true;
+            break;
+        }
+
+        // Minimum-norm least-squares step; halved while it does not reduce the mismatch
+        const Eigen::Vector4d connectionTimesCorrection =
+                -connectionMismatchJacobian.jacobiSvd( Eigen::ComputeThinU | Eigen::ComputeThinV ).solve( connectionMismatch );
+        bool mismatchReduced = false;
+        double stepFraction  = 1.0;
+        for ( int halvingNumber = 0; halvingNumber < 8 && !mismatchReduced; halvingNumber++ ) {
+            const Eigen::Vector4d newConnectionTimes = connectionTimes + stepFraction * connectionTimesCorrection;
+            Eigen::VectorXd newConnectionMismatch;
+            Eigen::MatrixXd newConnectionMismatchJacobian;
+            Eigen::Vector6d newUnstableStateVectorAtSection;
+            Eigen::Vector6d newStableStateVectorAtSection;
+            computeConnectionMismatch( periodicOrbitL1, periodicOrbitL2, unstableEigenvector, unstableOffsetSign, stableEigenvector,
+                                       stableOffsetSign, eigenvectorDisplacementFromOrbit, poincareSection, massParameter,
+                                       newConnectionTimes, newConnectionMismatch, newConnectionMismatchJacobian,
+                                       newUnstableStateVectorAtSection, newStableStateVectorAtSection );
+
+            if ( newConnectionMismatch.norm( ) < connectionMismatch.norm( ) ) {
+                mismatchReduced              = true;
+                connectionTimes              = newConnectionTimes;
+                connectionMismatch           = newConnectionMismatch;
+                connectionMismatchJacobian   = newConnectionMismatchJacobian;
+                unstableStateVectorAtSection = newUnstableStateVectorAtSection;
+                stableStateVectorAtSection   = newStableStateVectorAtSection;
+            }
+            stepFraction *= 0.5;
+        }
+        heteroclinicConnection.numberOfIterations++;
+
+        // Stationary point of the mismatch: closest approach of both manifolds near the candidate
+        if ( !mismatchReduced ) {
+            break;
+        }
+    }
+
+    heteroclinicConnection.unstableOrbitTime       = connectionTimes( 0 );
+    heteroclinicConnection.unstableIntegrationTime = connectionTimes( 1 );
+    heteroclinicConnection.stableOrbitTime         = connectionTimes( 2 );
+    heteroclinicConnection.stableIntegrationTime   = connectionTimes( 3 );
+    heteroclinicConnection.unstableStateAtSection  = unstableStateVectorAtSection;
+    heteroclinicConnection.stableStateAtSection    = stableStateVectorAtSection;
+    heteroclinicConnection.deltaPosition           = connectionMismatch.segment( 0, 3 ).norm( );
+    heteroclinicConnection.deltaVelocity           = connectionMismatch.segment( 3, 3 ).norm( );
+    return heteroclinicConnection;
+}
+
+void writeHeteroclinicConnectionToFile( const HeteroclinicConnection& heteroclinicConnection, const std::string& fileNameString )
+{
+    TextTableWriter textFileHeteroclinicConnection(fileNameString);
+
+    writeHeteroclinicConnectionRow( textFileHeteroclinicConnection, heteroclinicConnection );
+
+    textFileHeteroclinicConnection.close( );
+}
+
+void writeHeteroclinicConnectionFamilyToFile( const std::vector< std::pair< double, HeteroclinicConnection > >& heteroclinicConnectionFamily,
+                                              const std::string& fileNameString )
+{
+    TextTableWriter textFileHeteroclinicConnectionFamily(fileNameString);
+
+    for ( unsigned int memberNumber = 0; memberNumber < heteroclinicConnectionFamily.size( ); memberNumber++ ) {
+        textFileHeteroclinicConnectionFamily.appendValue( heteroclinicConnectionFamily.at( memberNumber ).first );
+        writeHeteroclinicConnectionRow( textFileHeteroclinicConnectionFamily, heteroclinicConnectionFamily.at( memberNumber ).second );
+    }
+
+    textFileHeteroclinicConnectionFamily.close( );
+}
@@ -0,0 +1,84 @@
+#ifndef TUDATBUNDLE_REFINEHETEROCLINICCONNECTION_H
+#define TUDATBUNDLE_REFINEHETEROCLINICCONNECTION_H
+
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+#include "poincareSection.h"
+#include "refinedPeriodicOrbitCache.h"
+
+// Connection between the unstable manifold of the L1 orbit and the stable manifold of the L2 orbit, as the departure time
+// along each periodic orbit and the integration time from there to the theta section
+struct HeteroclinicConnection
+{
+    bool converged;
+    int numberOfIterations;
+    double unstableOrbitTime;
+    double unstableIntegrationTime;
+    double stableOrbitTime;
+    double stableIntegrationTime;
+    Eigen::VectorXd unstableStateAtSection;
+    Eigen::VectorXd stableStateAtSection;
+    double deltaPosition;
+    double deltaVelocity;
+};
+
+// Propagates a state vector incl. STM from initialTime to finalTime (in either direction), ending on finalTime within 1E-12
+Eigen::MatrixXd propagateStateVectorInclSTMToTime( const Eigen::MatrixXd& stateVectorInclSTM, const double massParameter,
+                                                   const double initialTime, const double finalTime );
+
+// Time along the periodic orbit of the seed with the given phase (fraction of the points on the orbit). Seeds start at the
+// stored point floor( i * points / N ) of phase i / N, or at point index of phase index / points for adaptive seeds, so the
+// time of that point is returned instead of one interpolated at phase * points.
+double getPeriodicOrbitTimeAtPhase( const RefinedPeriodicOrbit& periodicOrbit, const double phase );
+
+// State vector incl. the STM since the start of the orbit, at any time along the periodic orbit
+Eigen::MatrixXd getStateVectorInclSTMOnPeriodicOrbit( const RefinedPeriodicOrbit& periodicOrbit, const double orbitTime,
+                                                      const double massParameter );
+
+// Drives the state mismatch at the theta section between the unstable manifold of periodicOrbitL1 (forward arc) and the
+// stable manifold of periodicOrbitL2 (backward arc) to zero. Starts from a row pair (phase, time, state) in the layout of
+// connectManifoldsAtTheta; the departure times along both orbits and the integration times are corrected by
+// Gauss-Newton iterations with the minimum-norm (SVD) step, which handles the redundancy of the Jacobi energy condition.
+// Converges if the mismatch and the distance to the section are below connectionTolerance; without a connection nearby
+// (e.g. spatial orbits) the result is the closest approach found.
+HeteroclinicConnection refineHeteroclinicConnection( const RefinedPeriodicOrbit& periodicOrbitL1, const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                     const Eigen::MatrixXd& minimumImpulseStateVectorsAtPoincare,
+                                                     const double thetaStoppingAngle, const double massParameter,
+                                                     const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                                     const double maxEigenvalueDeviation = 1.0E-3,
+                                                     const double connectionTolerance = 1.0E-9,
+                                                     const int maximumNumberOfIterations = 20 );
+
+// Same, starting from the departure time along and the integration time from either orbit: (unstable orbit time, unstable
+// integration time, stable orbit time, stable integration time)
+HeteroclinicConnection refineHeteroclinicConnection( const RefinedPeriodicOrbit& periodicOrbitL1, const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                     const Eigen::Vector4d& initialConnectionTimes,
+                                                     const double thetaStoppingAngle, const double massParameter,
+                                                     const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                                     const double maxEigenvalueDeviation = 1.0E-3,
+                                                     const double connectionTolerance = 1.0E-9,
+                                                     const int maximumNumberOfIterations = 20 );
+
+// Same, with the unstable arc ending on any section instead of the angle thetaStoppingAngle about the Moon
+HeteroclinicConnection refineHeteroclinicConnection( const RefinedPeriodicOrbit& periodicOrbitL1, const RefinedPeriodicOrbit& periodicOrbitL2,
+                                                     const Eigen::Vector4d& initialConnectionTimes,
+                                                     const PoincareSection& poincareSection, const double massParameter,
+                                                     const double eigenvectorDisplacementFromOrbit = 1.0E-6,
+                                                     const double maxEigenvalueDeviation = 1.0E-3,
+                                                     const double connectionTolerance = 1.0E-9,
+                                                     const int maximumNumberOfIterations = 20 );
+
+void writeHeteroclinicConnectionToFile( const HeteroclinicConnection& heteroclinicConnection, const std::string& fileNameString );
+
+// One row per member, the Jacobi energy followed by the columns of writeHeteroclinicConnectionToFile
+void writeHeteroclinicConnectionFamilyToFile( const std::vector< std::pair< double, HeteroclinicConnection > >& heteroclinicConnectionFamily,
+                                              const std::string& fileNameString );
+
+#endif  // TUDATBUNDLE_REFINEHETEROCLINICCONNECTION_H
@@ -0,0 +1,136 @@
+#include <future>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+#include "Tudat/Astrodynamics/BasicAstrodynamics/celestialBodyConstants.h"
+#include "Tudat/Astrodynamics/Gravitation/librationPoint.h"
+#include "Tudat/Astrodynamics/Gravitation/jacobiEnergy.h"
+
+#include "connectManifoldsAtTheta.h"
+#include "propagateOrbit.h"
+#include "refinedPeriodicOrbitCache.h"
+
+namespace
+{
+
+struct RefinedPeriodicOrbitKey
+{
+    int librationPointNr;
+    std::string orbitType;
+    double desiredJacobiEnergy;
+    int orbitIdOne;
+    int orbitIdTwo;
+    double maxPositionDeviationFromPeriodicOrbit;
+    double maxVelocityDeviationFromPeriodicOrbit;
+    double maxJacobiEnergyDeviation;
+    double massParameter;
+
+    bool operator<( const RefinedPeriodicOrbitKey& other ) const
+    {
+        return std::tie( librationPointNr, orbitType, desiredJacobiEnergy, orbitIdOne, orbitIdTwo, maxPositionDeviationFromPeriodicOrbit,
+                         maxVelocityDeviationFromPeriodicOrbit, maxJacobiEnergyDeviation, massParameter ) <
+               std::tie( other.librationPointNr, other.orbitType, other.desiredJacobiEnergy, other.orbitIdOne, other.orbitIdTwo,
+                         other.maxPositionDeviationFromPeriodicOrbit, other.maxVelocityDeviationFromPeriodicOrbit,
+                         other.maxJacobiEnergyDeviation, other.massParameter );
+    }
+};
+
+typedef std::shared_future< std::shared_ptr< const RefinedPeriodicOrbit > > RefinedPeriodicOrbitFuture;
+
+std::mutex refinedPeriodicOrbitCacheMutex;
+std::map< RefinedPeriodicOrbitKey, RefinedPeriodicOrbitFuture > refinedPeriodicOrbitCache;
+
+}
+
+std::shared_ptr< const RefinedPeriodicOrbit > createRefinedPeriodicOrbit( const Eigen::Vector6d& initialStateVector,
+                                                                          const double orbitalPeriod,
+                                                                          const double massParameter,
+                                                                          const Eigen::VectorXd& refinementResult )
+{
+    std::shared_ptr< RefinedPeriodicOrbit > periodicOrbit = std::make_shared< RefinedPeriodicOrbit >( );
+    periodicOrbit->initialStateVector = initialStateVector;
+    periodicOrbit->orbitalPeriod      = orbitalPeriod;
+    periodicOrbit->jacobiEnergy       = tudat::gravitation::computeJacobiEnergy( massParameter, initialStateVector );
+    periodicOrbit->refinementResult   = refinementResult;
+    periodicOrbit->stateTransitionMatrixHistory = TrajectoryBuffer( 42 );
+
+    // Propagate the initialStateVector for a full period, saving the STM at every integration step
+    periodicOrbit->stateVectorInclSTMAtPeriod = propagateOrbitWithStateTransitionMatrixToFinalCondition(
+                getFullInitialState( initialStateVector ), massParameter, orbitalPeriod, 1,
+                periodicOrbit->stateTransitionMatrixHistory, 1, 0.0 ).first;
+    periodicOrbit->monodromyMatrix = periodicOrbit->stateVectorInclSTMAtPeriod.block( 0, 1, 6, 6 );
+
+    return periodicOrbit;
+}
+
+std::shared_ptr< const RefinedPeriodicOrbit > getRefinedPeriodicOrbit( const int librationPointNr, const std::string& orbitType,
+                                                                       const double desiredJacobiEnergy,
+                                                                       const int orbitIdOne, const int orbitIdTwo,
+                                                                       const double massParameter,
+                                                                       const double maxPositionDeviationFromPeriodicOrbit,
+                                                                       const double maxVelocityDeviationFromPeriodicOrbit,
+                                                                       const double maxJacobiEnergyDeviation )
+{
+    RefinedPeriodicOrbitKey key = { librationPointNr, orbitType, desiredJacobiEnergy, orbitIdOne, orbitIdTwo,
+                                    maxPositionDeviationFromPeriodicOrbit, maxVelocityDeviationFromPeriodicOrbit,
+                                    maxJacobiEnergyDeviation, massParameter };
+
+    // Either pick up the (possibly still pending) entry, or claim the computation of a new one
+    bool refinementClaimed = false;
+    std::promise< std::shared_ptr< const RefinedPeriodicOrbit > > refinementPromise;
+    RefinedPeriodicOrbitFuture refinedPeriodicOrbit;
+    {
+        std::lock_guard< std::mutex > lock( refinedPeriodicOrbitCacheMutex );
+        std::map< RefinedPeriodicOrbitKey, RefinedPeriodicOrbitFuture >::iterator cacheEntry = refinedPeriodicOrbitCache.find( key );
+        if ( cacheEntry != refinedPeriodicOrbitCache.end( ) ) {
+            refinedPeriodicOrbit = cacheEntry->second;
+        } else {
+            refinedPeriodicOrbit = refinementPromise.get_future( ).share( );
+            refinedPeriodicOrbitCache[ key ] = refinedPeriodicOrbit;
+            refinementClaimed = true;
+        }
+    }
+
+    // The claiming worker refines the orbit outside of the lock, all other workers block in get( ) until it is done
+    if ( refinementClaimed ) {
+        try {
+            // Target the energy directly from the nearer of the two seed orbits, fall back on the regula falsi refinement
+            // between them if the fixed energy correction does not converge
+            bool correctionConverged;
+            Eigen::VectorXd refinedJacobiEnergyResult = correctOrbitAtJacobiEnergy( librationPointNr, orbitType, desiredJacobiEnergy,
+                                                                                    orbitIdOne, orbitIdTwo, massParameter,
+                                                                                    correctionConverged,
+                                                                                    maxPositionDeviationFromPeriodicOrbit,
+                                                                                    maxVelocityDeviationFromPeriodicOrbit,
+                                                                                    maxJacobiEnergyDeviation );
+            if ( !correctionConverged ) {
+                Eigen::VectorXd selectedInitialConditions = readInitialConditionsFromFile( librationPointNr, orbitType, orbitIdOne,
+                                                                                           orbitIdTwo );
+                refinedJacobiEnergyResult = refineOrbitJacobiEnergy( librationPointNr, orbitType, desiredJacobiEnergy,
+                                                                     selectedInitialConditions.segment( 1, 6 ),
+                                                                     selectedInitialConditions( 0 ),
+                                                                     selectedInitialConditions.segment( 8, 6 ),
+                                                                     selectedInitialConditions( 7 ), massParameter,
+                                                                     maxPositionDeviationFromPeriodicOrbit,
+                                                                     maxVelocityDeviationFromPeriodicOrbit,
+                                                                     maxJacobiEnergyDeviation );
+            }
+
+            refinementPromise.set_value( createRefinedPeriodicOrbit( refinedJacobiEnergyResult.segment( 0, 6 ),
+                                                                     refinedJacobiEnergyResult( 6 ), massParameter,
+                                                                     refinedJacobiEnergyResult ) );
+        }
+        catch( ... ) {
+            refinementPromise.set_exception( std::current_exception( ) );
+        }
+    }
+
+    return refinedPeriodicOrbit.get( );
+}
+
+void clearRefinedPeriodicOrbitCache( )
+{
+    std::lock_guard< std::mutex > lock( refinedPeriodicOrbitCacheMutex );
+    refinedPeriodicOrbitCache.clear( );
+}
@@ -0,0 +1,51 @@
+#ifndef TUDATBUNDLE_REFINEDPERIODICORBITCACHE_H
+#define TUDATBUNDLE_REFINEDPERIODICORBITCACHE_H
+
+
+#include <memory>
+#include <string>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+#include "trajectoryBuffer.h"
+
+// Periodic orbit refined to a desired Jacobi energy, including the state transition matrix along one full period
+struct RefinedPeriodicOrbit
+{
+    Eigen::Vector6d initialStateVector;
+    double orbitalPeriod;
+    double jacobiEnergy;
+
+    // Output of the energy refinement (layout of applyDifferentialCorrection)
+    Eigen::VectorXd refinementResult;
+
+    // State vector incl. STM after one full period and the corresponding monodromy matrix
+    Eigen::MatrixXd stateVectorInclSTMAtPeriod;
+    Eigen::MatrixXd monodromyMatrix;
+
+    // State vector incl. STM at every integration step along the orbit (saveFrequency = 1), stateDimension 42
+    TrajectoryBuffer stateTransitionMatrixHistory;
+};
+
+std::shared_ptr< const RefinedPeriodicOrbit > createRefinedPeriodicOrbit( const Eigen::Vector6d& initialStateVector,
+                                                                          const double orbitalPeriod,
+                                                                          const double massParameter,
+                                                                          const Eigen::VectorXd& refinementResult = Eigen::VectorXd( ) );
+
+// Returns the orbit of the given family at desiredJacobiEnergy, on the branch bracketed by orbitIdOne and orbitIdTwo. The
+// refinement (a fixed energy correction of the nearer of both, or if that fails the regula falsi refinement between them)
+// is performed once per process for every combination of libration point, family, energy, bracket, tolerances and mass
+// parameter; concurrent callers requesting the same orbit wait for and share that single result.
+std::shared_ptr< const RefinedPeriodicOrbit > getRefinedPeriodicOrbit( const int librationPointNr, const std::string& orbitType,
+                                                                       const double desiredJacobiEnergy,
+                                                                       const int orbitIdOne, const int orbitIdTwo,
+                                                                       const double massParameter,
+                                                                       const double maxPositionDeviationFromPeriodicOrbit = 1.0E-12,
+                                                                       const double maxVelocityDeviationFromPeriodicOrbit = 1.0E-12,
+                                                                       const double maxJacobiEnergyDeviation = 1.0E-12 );
+
+void clearRefinedPeriodicOrbitCache( );
+
+#endif  // TUDATBUNDLE_REFINEDPERIODICORBITCACHE_H
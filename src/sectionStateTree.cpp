@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cmath>
+
+#include "sectionStateTree.h"
+
+namespace
+{
+
+int buildSectionStateTreeNode( SectionStateTree& sectionStateTree, const int firstPoint, const int lastPoint,
+                               const int maximumLeafSize )
+{
+    SectionStateTreeNode node;
+    node.firstPoint = firstPoint;
+    node.lastPoint  = lastPoint;
+    node.leftChild  = -1;
+    node.rightChild = -1;
+
+    for ( int stateComponent = 0; stateComponent < 6; stateComponent++ ) {
+        node.lowerBound[ stateComponent ] = sectionStateTree.sectionStates.at( 6 * sectionStateTree.pointOrder.at( firstPoint ) + stateComponent );
+        node.upperBound[ stateComponent ] = node.lowerBound[ stateComponent ];
+    }
+    for ( int pointNumber = firstPoint + 1; pointNumber < lastPoint; pointNumber++ ) {
+        for ( int stateComponent = 0; stateComponent < 6; stateComponent++ ) {
+            const double stateValue = sectionStateTree.sectionStates.at( 6 * sectionStateTree.pointOrder.at( pointNumber ) + stateComponent );
+            node.lowerBound[ stateComponent ] = std::min( node.lowerBound[ stateComponent ], stateValue );
+            node.upperBound[ stateComponent ] = std::max( node.upperBound[ stateComponent ], stateValue );
+        }
+    }
+
+    const int nodeNumber = sectionStateTree.nodes.size( );
+    sectionStateTree.nodes.push_back( node );
+    if ( lastPoint - firstPoint <= maximumLeafSize ) {
+        return nodeNumber;
+    }
+
+    // Split at the median of the position component with the largest spread
+    int splitComponent = 0;
+    for ( int stateComponent = 1; stateComponent < 3; stateComponent++ ) {
+        if ( node.upperBound[ stateComponent ] - node.lowerBound[ stateComponent ] >
+             node.upperBound[ splitComponent ] - node.lowerBound[ splitComponent ] ) {
+            splitComponent = stateComponent;
+        }
+    }
+    const int middlePoint = ( firstPoint + lastPoint ) / 2;
+    const std::vector< double >& sectionStates = sectionStateTree.sectionStates;
+    std::nth_element( sectionStateTree.pointOrder.begin( ) + firstPoint, sectionStateTree.pointOrder.begin( ) + middlePoint,
+                      sectionStateTree.pointOrder.begin( ) + lastPoint, [&]( const int first, const int second ) {
+        return sectionStates[ 6 * first + splitComponent ] < sectionStates[ 6 * second + splitComponent ] ||
+               ( sectionStates[ 6 * first + splitComponent ] == sectionStates[ 6 * second + splitComponent ] && first < second );
+    } );
+
+    const int leftChild  = buildSectionStateTreeNode( sectionStateTree, firstPoint, middlePoint, maximumLeafSize );
+    const int rightChild = buildSectionStateTreeNode( sectionStateTree, middlePoint, lastPoint, maximumLeafSize );
+    sectionStateTree.nodes.at( nodeNumber ).leftChild  = leftChild;
+    sectionStateTree.nodes.at( nodeNumber ).rightChild = rightChild;
+    return nodeNumber;
+}
+
+}
+
+SectionStateTree buildSectionStateTree( const std::vector< double >& sectionStates, const int maximumLeafSize )
+{
+    SectionStateTree sectionStateTree;
+    sectionStateTree.sectionStates = sectionStates;
+
+    const int numberOfSectionStates = sectionStates.size( ) / 6;
+    for ( int stateNumber = 0; stateNumber < numberOfSectionStates; stateNumber++ ) {
+        sectionStateTree.pointOrder.push_back( stateNumber );
+    }
+    if ( numberOfSectionStates > 0 ) {
+        buildSectionStateTreeNode( sectionStateTree, 0, numberOfSectionStates, std::max( maximumLeafSize, 1 ) );
+    }
+    return sectionStateTree;
+}
+
+double computeDistanceToSectionStateBox( const SectionStateTreeNode& node, const double* queryState, const int firstComponent )
+{
+    double componentDistance[ 3 ];
+    for ( int stateComponent = firstComponent; stateComponent < firstComponent + 3; stateComponent++ ) {
+        componentDistance[ stateComponent - firstComponent ] = 0.0;
+        if ( queryState[ stateComponent ] < node.lowerBound[ stateComponent ] ) {
+            componentDistance[ stateComponent - firstComponent ] = queryState[ stateComponent ] - node.lowerBound[ stateComponent ];
+        } else if ( queryState[ stateComponent ] > node.upperBound[ stateComponent ] ) {
+            componentDistance[ stateComponent - firstComponent ] = queryState[ stateComponent ] - node.upperBound[ stateComponent ];
+        }
+    }
+    return std::sqrt( componentDistance[ 0 ] * componentDistance[ 0 ] + componentDistance[ 1 ] * componentDistance[ 1 ] +
+                      componentDistance[ 2 ] * componentDistance[ 2 ] );
+}
@@ -0,0 +1,33 @@
+#ifndef TUDATBUNDLE_SECTIONSTATETREE_H
+#define TUDATBUNDLE_SECTIONSTATETREE_H
+
+
+#include <vector>
+
+// Node of a k-d tree over section states, split on position; the bounding box covers position and velocity of all
+// states in pointOrder[ firstPoint, lastPoint )
+struct SectionStateTreeNode
+{
+    int firstPoint;
+    int lastPoint;
+    int leftChild;
+    int rightChild;
+    double lowerBound[ 6 ];
+    double upperBound[ 6 ];
+};
+
+struct SectionStateTree
+{
+    std::vector< double > sectionStates;  // x, y, z, xdot, ydot, zdot per state, in the order they were added
+    std::vector< int > pointOrder;
+    std::vector< SectionStateTreeNode > nodes;
+};
+
+SectionStateTree buildSectionStateTree( const std::vector< double >& sectionStates, const int maximumLeafSize = 8 );
+
+// Lower bound on the distance between queryState and any state in the box of node, in position (firstComponent 0) or
+// velocity (firstComponent 3). Every term is rounded the same way as the exact distance, so the bound never exceeds the
+// evaluated distance.
+double computeDistanceToSectionStateBox( const SectionStateTreeNode& node, const double* queryState, const int firstComponent );
+
+#endif  // TUDATBUNDLE_SECTIONSTATETREE_H
@@ -0,0 +1,207 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "textOutput.h"
+
+// The exact formatting below needs the 128-bit integers of GCC and Clang
+#if !defined( __SIZEOF_INT128__ )
+#error "textOutput.cpp requires unsigned __int128 (GCC or Clang on a 64-bit target)"
+#endif
+
+namespace
+{
+
+// Formats value as "%.*e" for precisions up to 16 with exact integer arithmetic: for value = M * 2^E the precision + 1
+// significant digits are M * 5^k * 2^( E + k ) with k = precision - decimal exponent, rounded half to even like the C
+// library does. Covers the values with 5^k below 2^64, i.e. magnitudes from about 1e-12 up to 1e15; returns -1 for all
+// other values (zero, very small or large values, subnormals, inf and nan), which are left to snprintf.
+int formatScientificExactly( char* formattedValue, const double value, const int precision )
+{
+    if ( precision < 0 || precision > 16 ) {
+        return -1;
+    }
+
+    uint64_t bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    const int exponentField = static_cast< int >( ( bits >> 52 ) & 0x7FF );
+    if ( exponentField == 0 || exponentField == 0x7FF ) {
+        return -1;
+    }
+    const uint64_t mantissa = ( bits & ( ( uint64_t( 1 ) << 52 ) - 1 ) ) | ( uint64_t( 1 ) << 52 );
+    const int binaryExponent = exponentField - 1075;
+
+    static const uint64_t powersOfTen[ 18 ] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+        10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull,
+        10000000000000000ull, 100000000000000000ull };
+
+    // Estimate of the decimal exponent from the binary one, corrected below until the digits have the right length
+    int decimalExponent = static_cast< int >( std::floor( ( exponentField - 1023 ) * 0.30102999566398119521 ) );
+    unsigned __int128 significantDigits = 0;
+    for ( int attempt = 0; attempt < 3; attempt++ ) {
+        const int decimalShift = precision - decimalExponent;
+        if ( decimalShift < 0 || decimalShift > 27 ) {
+            return -1;
+        }
+        uint64_t powerOfFive = 1;
+        for ( int factorNumber = 0; factorNumber < decimalShift; factorNumber++ ) {
+            powerOfFive *= 5;
+        }
+
+        const unsigned __int128 scaledMantissa = static_cast< unsigned __int128 >( mantissa ) * powerOfFive;
+        const int binaryShift = binaryExponent + decimalShift;
+        if ( binaryShift >= 0 ) {
+            if ( binaryShift > 10 ) {
+                return -1;
+            }
+            significantDigits = scaledMantissa << binaryShift;
+        } else {
+            if ( binaryShift < -120 ) {
+                return -1;
+            }
+            const int rightShift = -binaryShift;
+            const unsigned __int128 quotient  = scaledMantissa >> rightShift;
+            const unsigned __int128 remainder = scaledMantissa - ( quotient << rightShift );
+            const unsigned __int128 half      = static_cast< unsigned __int128 >( 1 ) << ( rightShift - 1 );
+            significantDigits = quotient;
+            if ( remainder > half || ( remainder == half && ( significantDigits & 1 ) ) ) {
+                significantDigits++;
+            }
+        }
+
+        if ( significantDigits >= powersOfTen[ precision + 1 ] ) {
+            decimalExponent++;
+        } else if ( significantDigits < powersOfTen[ precision ] ) {
+            decimalExponent--;
+        } else {
+            break;
+        }
+    }
+    if ( significantDigits < powersOfTen[ precision ] || significantDigits >= powersOfTen[ precision + 1 ] ) {
+        return -1;
+    }
+
+    char* character = formattedValue;
+    if ( bits >> 63 ) {
+        *character++ = '-';
+    }
+    uint64_t remainingDigits = static_cast< uint64_t >( significantDigits );
+    char digits[ 17 ];
+    for ( int digitNumber = precision; digitNumber >= 0; digitNumber-- ) {
+        digits[ digitNumber ] = static_cast< char >( '0' + remainingDigits % 10 );
+        remainingDigits /= 10;
+    }
+    *character++ = digits[ 0 ];
+    if ( precision > 0 ) {
+        *character++ = '.';
+        std::memcpy( character, digits + 1, precision );
+        character += precision;
+    }
+
+    // At least two exponent digits, as in printf
+    *character++ = 'e';
+    *character++ = ( decimalExponent < 0 ? '-' : '+' );
+    const int absoluteExponent = ( decimalExponent < 0 ? -decimalExponent : decimalExponent );
+    if ( absoluteExponent >= 100 ) {
+        *character++ = static_cast< char >( '0' + absoluteExponent / 100 );
+    }
+    *character++ = static_cast< char >( '0' + ( absoluteExponent / 10 ) % 10 );
+    *character++ = static_cast< char >( '0' + absoluteExponent % 10 );
+    return static_cast< int >( character - formattedValue );
+}
+
+}
+
+void appendScientificColumn( std::string& text, const double value, const int precision, const int columnWidth )
+{
+    // std::num_put formats doubles with the "%.*e" conversion of the C library; the exact fast path gives the same digits
+    char formattedValue[ 64 ];
+    int length = formatScientificExactly( formattedValue, value, precision );
+    if ( length < 0 ) {
+        length = std::snprintf( formattedValue, sizeof( formattedValue ), "%.*e", precision, value );
+    }
+    if ( length < 0 || length >= static_cast< int >( sizeof( formattedValue ) ) ) {
+        throw std::runtime_error( "Text output: could not format a value with precision " + std::to_string( precision ) );
+    }
+
+    text.append( formattedValue, length );
+    if ( length < columnWidth ) {
+        text.append( columnWidth - length, ' ' );
+    }
+}
+
+TextTableWriter::TextTableWriter( const std::string& fileName, const int precision, const int columnWidth,
+                                  const std::size_t bufferSize ):
+    fileName_( fileName ), precision_( precision ), columnWidth_( columnWidth ), bufferSize_( bufferSize ),
+    textFile_( fileName.c_str( ), std::ios::binary )
+{
+    if ( !textFile_ ) {
+        throw std::runtime_error( "Text output: could not open " + fileName );
+    }
+    buffer_.reserve( bufferSize_ + 1024 );
+}
+
+TextTableWriter::~TextTableWriter( )
+{
+    try {
+        close( );
+    } catch ( const std::exception& ) { }
+}
+
+void TextTableWriter::appendValue( const double value )
+{
+    appendScientificColumn( buffer_, value, precision_, columnWidth_ );
+}
+
+void TextTableWriter::appendText( const std::string& text )
+{
+    appendText( text, columnWidth_ );
+}
+
+void TextTableWriter::appendText( const std::string& text, const int columnWidth )
+{
+    buffer_.append( text );
+    if ( static_cast< int >( text.size( ) ) < columnWidth ) {
+        buffer_.append( columnWidth - text.size( ), ' ' );
+    }
+}
+
+void TextTableWriter::appendRow( const double* values, const int numberOfValues )
+{
+    for ( int valueNumber = 0; valueNumber < numberOfValues; valueNumber++ ) {
+        appendScientificColumn( buffer_, values[ valueNumber ], precision_, columnWidth_ );
+    }
+    endRow( );
+}
+
+void TextTableWriter::endRow( )
+{
+    buffer_.push_back( '\n' );
+    if ( buffer_.size( ) >= bufferSize_ ) {
+        writeBuffer( );
+    }
+}
+
+void TextTableWriter::close( )
+{
+    if ( !textFile_.is_open( ) ) {
+        return;
+    }
+    writeBuffer( );
+    textFile_.close( );
+    if ( !textFile_ ) {
+        throw std::runtime_error( "Text output: could not write " + fileName_ );
+    }
+}
+
+void TextTableWriter::writeBuffer( )
+{
+    textFile_.write( buffer_.data( ), buffer_.size( ) );
+    buffer_.clear( );
+    if ( !textFile_ ) {
+        throw std::runtime_error( "Text output: could not write " + fileName_ );
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef TUDATBUNDLE_TEXTOUTPUT_H
+#define TUDATBUNDLE_TEXTOUTPUT_H
+
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+// Appends value in scientific notation with precision digits after the decimal point, left aligned and padded with
+// spaces to columnWidth characters: the same characters as std::left << std::scientific << std::setw( columnWidth ) on a
+// stream with that precision, without the locale and stream state handling per value
+void appendScientificColumn( std::string& text, const double value, const int precision, const int columnWidth );
+
+// Writer of the whitespace separated text tables (manifolds, Poincare sections, initial conditions, ...). Values are
+// formatted into a reusable buffer that is written to the file in blocks of bufferSize bytes; rows are ended with '\n'
+// and the file is only flushed when a block is full and on close( ), instead of after every row as with std::endl. The
+// files are identical to those of the iostream writers, so the python parsers read them unchanged. The exact formatting
+// path uses unsigned __int128, which GCC and Clang provide on 64-bit targets.
+class TextTableWriter
+{
+public:
+    TextTableWriter( const std::string& fileName, const int precision = 14, const int columnWidth = 25,
+                     const std::size_t bufferSize = 1 << 20 );
+
+    ~TextTableWriter( );
+
+    void appendValue( const double value );
+
+    // Appends text (integers, labels) left aligned and padded with spaces to the column width, as std::left and
+    // std::setw do; longer text is not truncated
+    void appendText( const std::string& text );
+
+    void appendText( const std::string& text, const int columnWidth );
+
+    // Appends numberOfValues values followed by the end of the row
+    void appendRow( const double* values, const int numberOfValues );
+
+    void endRow( );
+
+    void close( );
+
+private:
+    TextTableWriter( const TextTableWriter& );
+    TextTableWriter& operator=( const TextTableWriter& );
+
+    void writeBuffer( );
+
+    const std::string fileName_;
+    const int precision_;
+    const int columnWidth_;
+    const std::size_t bufferSize_;
+    std::ofstream textFile_;
+    std::string buffer_;
+};
+
+#endif  // TUDATBUNDLE_TEXTOUTPUT_H
@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trajectoryArchive.h"
+#include "xorFloatCodec.h"
+
+namespace
+{
+
+const char fileHeaderMagic[ 8 ] = { 'C', 'R', '3', 'B', 'P', 'T', 'A', '\0' };
+const char footerMagic[ 8 ] = { 'C', 'R', '3', 'B', 'P', 'I', 'D', 'X' };
+const uint32_t recordMagic = 0x52435254;
+const uint64_t fileHeaderLength = 16;
+const uint64_t recordHeaderLength = 40;
+const uint64_t indexEntryLength = 48;
+const uint64_t footerLength = 24;
+
+uint64_t getPaddedLength( const uint64_t length )
+{
+    return ( length + 7 ) / 8 * 8;
+}
+
+void appendLittleEndian( std::string& bytes, const uint64_t value, const int numberOfBytes )
+{
+    for ( int byteNumber = 0; byteNumber < numberOfBytes; byteNumber++ ) {
+        bytes.push_back( static_cast< char >( ( value >> ( 8 * byteNumber ) ) & 0xFF ) );
+    }
+}
+
+uint64_t readLittleEndian( const char* data, const int numberOfBytes )
+{
+    uint64_t value = 0;
+    for ( int byteNumber = 0; byteNumber < numberOfBytes; byteNumber++ ) {
+        value |= static_cast< uint64_t >( static_cast< unsigned char >( data[ byteNumber ] ) ) << ( 8 * byteNumber );
+    }
+    return value;
+}
+
+std::pair< const char*, std::size_t > mapFile( const std::string& fileName )
+{
+    const int fileDescriptor = open( fileName.c_str( ), O_RDONLY );
+    if ( fileDescriptor < 0 ) {
+        throw std::runtime_error( "Trajectory archive: could not open " + fileName );
+    }
+    struct stat fileStatus;
+    if ( fstat( fileDescriptor, &fileStatus ) != 0 ) {
+        close( fileDescriptor );
+        throw std::runtime_error( "Trajectory archive: could not read the size of " + fileName );
+    }
+    const std::size_t fileLength = static_cast< std::size_t >( fileStatus.st_size );
+
+    void* mappedData = nullptr;
+    if ( fileLength > 0 ) {
+        mappedData = mmap( nullptr, fileLength, PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+    }
+    close( fileDescriptor );
+    if ( mappedData == MAP_FAILED ) {
+        throw std::runtime_error( "Trajectory archive: could not map " + fileName );
+    }
+    return std::make_pair( static_cast< const char* >( mappedData ), fileLength );
+}
+
+void unmapFile( const std::pair< const char*, std::size_t >& mappedFile )
+{
+    if ( mappedFile.second > 0 ) {
+        munmap( const_cast< char* >( mappedFile.first ), mappedFile.second );
+    }
+}
+
+// Entries from the index at the end of the archive; false if the footer or an index entry points outside the file (an
+// archive that was overwritten or truncated), in which case the record headers are read instead
+bool readIndexEntries( const char* data, const std::size_t length, std::vector< TrajectoryArchiveEntry >& entries,
+                       uint64_t& dataEnd )
+{
+    const uint64_t indexEnd = length - footerLength;
+    const uint64_t indexOffset = readLittleEndian( data + indexEnd, 8 );
+    const uint64_t numberOfRecords = readLittleEndian( data + indexEnd + 8, 8 );
+    if ( indexOffset < fileHeaderLength || indexOffset > indexEnd ||
+         numberOfRecords > ( indexEnd - indexOffset ) / indexEntryLength ) {
+        return false;
+    }
+
+    uint64_t position = indexOffset;
+    for ( uint64_t recordNumber = 0; recordNumber < numberOfRecords; recordNumber++ ) {
+        if ( indexEnd - position < indexEntryLength ) {
+            return false;
+        }
+        TrajectoryArchiveEntry entry;
+        const uint64_t kindLength = readLittleEndian( data + position, 4 );
+        if ( kindLength > indexEnd - position - indexEntryLength ) {
+            return false;
+        }
+        entry.stateDimension = static_cast< int >( readLittleEndian( data + position + 4, 4 ) );
+        entry.id = static_cast< long long >( readLittleEndian( data + position + 8, 8 ) );
+        entry.dataOffset = readLittleEndian( data + position + 16, 8 );
+        entry.numberOfStates = readLittleEndian( data + position + 24, 8 );
+        entry.dataLength = readLittleEndian( data + position + 32, 8 );
+        entry.encoding = static_cast< int >( readLittleEndian( data + position + 40, 4 ) );
+        if ( entry.dataOffset < fileHeaderLength || entry.dataOffset > indexOffset ||
+             entry.dataLength > indexOffset - entry.dataOffset ) {
+            return false;
+        }
+        entry.kind.assign( data + position + indexEntryLength, kindLength );
+        entries.push_back( entry );
+        position += indexEntryLength + std::min( getPaddedLength( kindLength ), indexEnd - position - indexEntryLength );
+    }
+    dataEnd = indexOffset;
+    return true;
+}
+
+// Entries from the index, or from the record headers if the archive has no (complete or consistent) index; dataEnd is
+// set to the end of the last complete record
+std::vector< TrajectoryArchiveEntry > readEntries( const char* data, const std::size_t length, const std::string& fileName,
+                                                   uint64_t& dataEnd )
+{
+    if ( length < fileHeaderLength || std::memcmp( data, fileHeaderMagic, 8 ) != 0 ) {
+        throw std::runtime_error( "Trajectory archive: " + fileName + " is not a trajectory archive" );
+    }
+
+    std::vector< TrajectoryArchiveEntry > entries;
+    if ( length >= fileHeaderLength + footerLength && std::memcmp( data + length - 8, footerMagic, 8 ) == 0 ) {
+        if ( readIndexEntries( data, length, entries, dataEnd ) ) {
+            return entries;
+        }
+        entries.clear( );
+    }
+
+    uint64_t position = fileHeaderLength;
+    while ( position + recordHeaderLength <= length && readLittleEndian( data + position, 4 ) == recordMagic ) {
+        TrajectoryArchiveEntry entry;
+        const uint64_t kindLength = readLittleEndian( data + position + 4, 4 );
+        entry.id = static_cast< long long >( readLittleEndian( data + position + 8, 8 ) );
+        entry.numberOfStates = readLittleEndian( data + position + 16, 8 );
+        entry.stateDimension = static_cast< int >( readLittleEndian( data + position + 24, 4 ) );
+        entry.encoding = static_cast< int >( readLittleEndian( data + position + 28, 4 ) );
+        entry.dataLength = readLittleEndian( data + position + 32, 8 );
+        entry.dataOffset = position + recordHeaderLength + getPaddedLength( kindLength );
+        if ( entry.dataOffset > length || entry.dataLength > length - entry.dataOffset ) {
+            break;
+        }
+        entry.kind.assign( data + position + recordHeaderLength, kindLength );
+        entries.push_back( entry );
+        position = entry.dataOffset + getPaddedLength( entry.dataLength );
+    }
+    dataEnd = position;
+    return entries;
+}
+
+}
+
+TrajectoryArchiveWriter::TrajectoryArchiveWriter( const std::string& fileName, const TrajectoryArchiveEncoding encoding ):
+    fileName_( fileName ), encoding_( encoding ), dataEnd_( fileHeaderLength ), indexWritten_( false )
+{
+    struct stat fileStatus;
+    if ( stat( fileName_.c_str( ), &fileStatus ) == 0 && fileStatus.st_size > 0 ) {
+        const std::pair< const char*, std::size_t > mappedFile = mapFile( fileName_ );
+        try {
+            entries_ = readEntries( mappedFile.first, mappedFile.second, fileName_, dataEnd_ );
+        } catch ( ... ) {
+            unmapFile( mappedFile );
+            throw;
+        }
+        unmapFile( mappedFile );
+
+        // Without its old index, an archive that is appended to and then killed is read by scanning the records
+        if ( truncate( fileName_.c_str( ), static_cast< off_t >( dataEnd_ ) ) != 0 ) {
+            throw std::runtime_error( "Trajectory archive: could not reopen " + fileName_ );
+        }
+    } else {
+        std::ofstream newArchiveFile( fileName_.c_str( ), std::ios::binary );
+        std::string fileHeader( fileHeaderMagic, 8 );
+        appendLittleEndian( fileHeader, 1, 4 );
+        appendLittleEndian( fileHeader, 0, 4 );
+        newArchiveFile.write( fileHeader.data( ), fileHeader.size( ) );
+    }
+
+    archiveFile_.open( fileName_.c_str( ), std::ios::in | std::ios::out | std::ios::binary );
+    if ( !archiveFile_ ) {
+        throw std::runtime_error( "Trajectory archive: could not open " + fileName_ );
+    }
+}
+
+TrajectoryArchiveWriter::~TrajectoryArchiveWriter( )
+{
+    try {
+        close( );
+    } catch ( const std::exception& indexException ) {
+        std::cerr << indexException.what( ) << std::endl;
+    }
+}
+
+void TrajectoryArchiveWriter::appendTrajectory( const std::string& kind, const long long id, const TrajectoryView& trajectory )
+{
+    TrajectoryArchiveEntry entry;
+    entry.kind = kind;
+    entry.id = id;
+    entry.numberOfStates = trajectory.size( );
+    entry.stateDimension = trajectory.getStateDimension( );
+    entry.encoding = encoding_;
+    entry.dataLength = 8 * entry.numberOfStates * ( 1 + entry.stateDimension );
+
+    // Compressed before the archive is locked, so that writer threads compress in parallel
+    std::string encodedData;
+    if ( encoding_ == xor_float_trajectory_encoding ) {
+        XorFloatEncoder trajectoryEncoder;
+        trajectoryEncoder.encodeColumn( trajectory.getTimeData( ), trajectory.size( ) );
+        for ( int componentNumber = 0; componentNumber < trajectory.getStateDimension( ); componentNumber++ ) {
+            trajectoryEncoder.encodeColumn( trajectory.getStateData( ) + componentNumber, trajectory.size( ),
+                                            trajectory.getStateDimension( ) );
+        }
+        encodedData = trajectoryEncoder.finish( );
+        entry.dataLength = encodedData.size( );
+    }
+
+    std::string recordHeader;
+    appendLittleEndian( recordHeader, recordMagic, 4 );
+    appendLittleEndian( recordHeader, kind.size( ), 4 );
+    appendLittleEndian( recordHeader, static_cast< uint64_t >( id ), 8 );
+    appendLittleEndian( recordHeader, entry.numberOfStates, 8 );
+    appendLittleEndian( recordHeader, entry.stateDimension, 4 );
+    appendLittleEndian( recordHeader, entry.encoding, 4 );
+    appendLittleEndian( recordHeader, entry.dataLength, 8 );
+    recordHeader += kind;
+    recordHeader.append( getPaddedLength( kind.size( ) ) - kind.size( ), '\0' );
+
+    std::lock_guard< std::mutex > lock( archiveMutex_ );
+    if ( indexWritten_ ) {
+        archiveFile_.flush( );
+        if ( truncate( fileName_.c_str( ), static_cast< off_t >( dataEnd_ ) ) != 0 ) {
+            throw std::runtime_error( "Trajectory archive: could not remove the index of " + fileName_ );
+        }
+        indexWritten_ = false;
+    }
+    entry.dataOffset = dataEnd_ + recordHeader.size( );
+    archiveFile_.seekp( dataEnd_ );
+    archiveFile_.write( recordHeader.data( ), recordHeader.size( ) );
+    if ( encoding_ == xor_float_trajectory_encoding ) {
+        archiveFile_.write( encodedData.data( ), encodedData.size( ) );
+    } else if ( !trajectory.empty( ) ) {
+        archiveFile_.write( reinterpret_cast< const char* >( trajectory.getTimeData( ) ), 8 * trajectory.size( ) );
+        archiveFile_.write( reinterpret_cast< const char* >( trajectory.getStateData( ) ),
+                            8 * trajectory.size( ) * trajectory.getStateDimension( ) );
+    }
+    archiveFile_.write( std::string( getPaddedLength( entry.dataLength ) - entry.dataLength, '\0' ).data( ),
+                        getPaddedLength( entry.dataLength ) - entry.dataLength );
+    if ( !archiveFile_ ) {
+        throw std::runtime_error( "Trajectory archive: could not write to " + fileName_ );
+    }
+    dataEnd_ = entry.dataOffset + getPaddedLength( entry.dataLength );
+    entries_.push_back( entry );
+}
+
+void TrajectoryArchiveWriter::close( )
+{
+    std::lock_guard< std::mutex > lock( archiveMutex_ );
+    if ( indexWritten_ ) {
+        return;
+    }
+
+    std::string index;
+    for ( unsigned int entryNumber = 0; entryNumber < entries_.size( ); entryNumber++ ) {
+        const TrajectoryArchiveEntry& entry = entries_[ entryNumber ];
+        appendLittleEndian( index, entry.kind.size( ), 4 );
+        appendLittleEndian( index, entry.stateDimension, 4 );
+        appendLittleEndian( index, static_cast< uint64_t >( entry.id ), 8 );
+        appendLittleEndian( index, entry.dataOffset, 8 );
+        appendLittleEndian( index, entry.numberOfStates, 8 );
+        appendLittleEndian( index, entry.dataLength, 8 );
+        appendLittleEndian( index, entry.encoding, 4 );
+        appendLittleEndian( index, 0, 4 );
+        index += entry.kind;
+        index.append( getPaddedLength( entry.kind.size( ) ) - entry.kind.size( ), '\0' );
+    }
+    appendLittleEndian( index, dataEnd_, 8 );
+    appendLittleEndian( index, entries_.size( ), 8 );
+    index.append( footerMagic, 8 );
+
+    archiveFile_.seekp( dataEnd_ );
+    archiveFile_.write( index.data( ), index.size( ) );
+    archiveFile_.flush( );
+
+    // A previous index or an incomplete record of a killed run may extend beyond the new footer
+    if ( truncate( fileName_.c_str( ), static_cast< off_t >( dataEnd_ + index.size( ) ) ) != 0 || !archiveFile_ ) {
+        throw std::runtime_error( "Trajectory archive: could not write the index of " + fileName_ );
+    }
+    indexWritten_ = true;
+}
+
+TrajectoryArchiveReader::TrajectoryArchiveReader( const std::string& fileName ):
+    fileName_( fileName ), mappedData_( nullptr ), mappedLength_( 0 )
+{
+    const std::pair< const char*, std::size_t > mappedFile = mapFile( fileName_ );
+    mappedData_ = mappedFile.first;
+    mappedLength_ = mappedFile.second;
+
+    uint64_t dataEnd;
+    try {
+        entries_ = readEntries( mappedData_, mappedLength_, fileName_, dataEnd );
+    } catch ( ... ) {
+        unmapFile( mappedFile );
+        throw;
+    }
+
+    // A trajectory appended again under the same kind and id replaces the earlier one
+    for ( unsigned int entryNumber = 0; entryNumber < entries_.size( ); entryNumber++ ) {
+        entryNumbers_[ std::make_pair( entries_[ entryNumber ].kind, entries_[ entryNumber ].id ) ] = entryNumber;
+    }
+}
+
+TrajectoryArchiveReader::~TrajectoryArchiveReader( )
+{
+    unmapFile( std::make_pair( mappedData_, mappedLength_ ) );
+}
+
+std::vector< long long > TrajectoryArchiveReader::getIds( const std::string& kind ) const
+{
+    std::vector< long long > ids;
+    for ( std::map< std::pair< std::string, long long >, int >::const_iterator entryNumber =
+          entryNumbers_.lower_bound( std::make_pair( kind, std::numeric_limits< long long >::min( ) ) );
+          entryNumber != entryNumbers_.end( ) && entryNumber->first.first == kind; ++entryNumber ) {
+        ids.push_back( entryNumber->first.second );
+    }
+    return ids;
+}
+
+bool TrajectoryArchiveReader::contains( const std::string& kind, const long long id ) const
+{
+    return entryNumbers_.count( std::make_pair( kind, id ) ) > 0;
+}
+
+const TrajectoryArchiveEntry& TrajectoryArchiveReader::findEntry( const std::string& kind, const long long id ) const
+{
+    std::map< std::pair< std::string, long long >, int >::const_iterator entryNumber = entryNumbers_.find( std::make_pair( kind, id ) );
+    if ( entryNumber == entryNumbers_.end( ) ) {
+        throw std::runtime_error( "Trajectory archive: " + fileName_ + " holds no trajectory " + kind + " " + std::to_string( id ) );
+    }
+    return entries_[ entryNumber->second ];
+}
+
+TrajectoryView TrajectoryArchiveReader::getTrajectory( const std::string& kind, const long long id ) const
+{
+    const TrajectoryArchiveEntry& entry = findEntry( kind, id );
+    if ( entry.encoding != raw_trajectory_encoding ) {
+        throw std::runtime_error( "Trajectory archive: " + kind + " " + std::to_string( id ) + " is compressed, use decodeTrajectory" );
+    }
+    if ( entry.stateDimension < 0 ||
+         entry.numberOfStates > entry.dataLength / ( 8 * ( 1 + static_cast< uint64_t >( entry.stateDimension ) ) ) ) {
+        throw std::runtime_error( "Trajectory archive: " + kind + " " + std::to_string( id ) + " in " + fileName_ + " is truncated" );
+    }
+    const double* times = reinterpret_cast< const double* >( mappedData_ + entry.dataOffset );
+    return TrajectoryView( times, times + entry.numberOfStates, static_cast< int >( entry.numberOfStates ), entry.stateDimension );
+}
+
+std::string getTrajectoryArchiveKind( const std::string& textFileName )
+{
+    std::string kind = textFileName.substr( textFileName.find_last_of( '/' ) + 1 );
+    if ( kind.size( ) > 4 && kind.compare( kind.size( ) - 4, 4, ".txt" ) == 0 ) {
+        kind.resize( kind.size( ) - 4 );
+    }
+    return kind;
+}
+
+void appendTrajectorySetToArchive( TrajectoryArchiveWriter& trajectoryArchive, const std::string& kind,
+                                   const TrajectorySet& trajectorySet, const int firstTrajectoryNumber,
+                                   const int numberOfTrajectories )
+{
+    for ( int trajectoryNumber = 0; trajectoryNumber < numberOfTrajectories; trajectoryNumber++ ) {
+        trajectoryArchive.appendTrajectory( kind, trajectoryNumber, trajectorySet.getTrajectory( firstTrajectoryNumber + trajectoryNumber ) );
+    }
+}
+
+void TrajectoryArchiveReader::decodeTrajectory( const std::string& kind, const long long id, TrajectoryBuffer& trajectory ) const
+{
+    const TrajectoryArchiveEntry& entry = findEntry( kind, id );
+    trajectory = TrajectoryBuffer( entry.stateDimension );
+    if ( entry.encoding == raw_trajectory_encoding ) {
+        const TrajectoryView trajectoryView = getTrajectory( kind, id );
+        trajectory.reserve( trajectoryView.size( ) );
+        for ( int stateNumber = 0; stateNumber < trajectoryView.size( ); stateNumber++ ) {
+            trajectory.append( trajectoryView.getTime( stateNumber ), trajectoryView.getState( stateNumber ) );
+        }
+        return;
+    }
+    if ( entry.encoding != xor_float_trajectory_encoding ) {
+        throw std::runtime_error( "Trajectory archive: unknown encoding of " + kind + " " + std::to_string( id ) );
+    }
+
+    // Columns are decoded one after the other, the rows are assembled afterwards
+    const int numberOfStates = static_cast< int >( entry.numberOfStates );
+    std::vector< double > times( numberOfStates );
+    std::vector< double > states( entry.numberOfStates * entry.stateDimension );
+    XorFloatDecoder trajectoryDecoder( mappedData_ + entry.dataOffset, entry.dataLength );
+    trajectoryDecoder.beginColumn( numberOfStates );
+    for ( int stateNumber = 0; stateNumber < numberOfStates; stateNumber++ ) {
+        times[ stateNumber ] = trajectoryDecoder.decodeNextValue( );
+    }
+    for ( int componentNumber = 0; componentNumber < entry.stateDimension; componentNumber++ ) {
+        trajectoryDecoder.beginColumn( numberOfStates );
+        for ( int stateNumber = 0; stateNumber < numberOfStates; stateNumber++ ) {
+            states[ stateNumber * entry.stateDimension + componentNumber ] = trajectoryDecoder.decodeNextValue( );
+        }
+    }
+
+    trajectory.reserve( numberOfStates );
+    for ( int stateNumber = 0; stateNumber < numberOfStates; stateNumber++ ) {
+        trajectory.append( times[ stateNumber ],
+                           Eigen::Map< const Eigen::VectorXd >( states.data( ) + stateNumber * entry.stateDimension, entry.stateDimension ) );
+    }
+}
+
+namespace
+{
+
+std::mutex trajectoryArchiveMutex;
+std::shared_ptr< TrajectoryArchiveWriter > trajectoryArchive;
+
+}
+
+void openTrajectoryArchive( const std::string& fileName, const TrajectoryArchiveEncoding encoding )
+{
+    std::shared_ptr< TrajectoryArchiveWriter > newTrajectoryArchive = std::make_shared< TrajectoryArchiveWriter >( fileName, encoding );
+    std::lock_guard< std::mutex > lock( trajectoryArchiveMutex );
+    trajectoryArchive = newTrajectoryArchive;
+}
+
+std::shared_ptr< TrajectoryArchiveWriter > getTrajectoryArchive( )
+{
+    std::lock_guard< std::mutex > lock( trajectoryArchiveMutex );
+    return trajectoryArchive;
+}
+
+void closeTrajectoryArchive( )
+{
+    std::lock_guard< std::mutex > lock( trajectoryArchiveMutex );
+    if ( trajectoryArchive ) {
+        trajectoryArchive->close( );
+        trajectoryArchive.reset( );
+    }
+}
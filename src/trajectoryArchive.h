@@ -0,0 +1,133 @@
+#ifndef TUDATBUNDLE_TRAJECTORYARCHIVE_H
+#define TUDATBUNDLE_TRAJECTORYARCHIVE_H
+
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trajectoryBuffer.h"
+
+// Single append-only file holding many trajectories, in place of a file per orbit or manifold. Every trajectory is
+// stored under a kind (the name of the data product, e.g. L1_horizontal_9001_W_S_plus) and an id within that kind (e.g.
+// the trajectory number on the manifold). Layout, all little-endian:
+//   file header   "CR3BPTA" '\0', uint32 version, uint32 0
+//   per record    uint32 0x52435254, uint32 kindLength, int64 id, uint64 numberOfStates, uint32 stateDimension,
+//                 uint32 encoding, uint64 dataLength, kind padded to 8 bytes, data padded to 8 bytes (encoding 0:
+//                 numberOfStates times followed by numberOfStates x stateDimension states, both float64; encoding 1: the
+//                 time column followed by every state component as a column, compressed by XorFloatEncoder)
+//   index         per record uint32 kindLength, uint32 stateDimension, int64 id, uint64 dataOffset,
+//                 uint64 numberOfStates, uint64 dataLength, uint32 encoding, uint32 0, kind padded to 8 bytes
+//   footer        uint64 indexOffset, uint64 numberOfRecords, "CR3BPIDX"
+// The index is written when the archive is closed and removed when records are appended to it again, until the next
+// close. An archive without index (e.g. of a run that was killed) is indexed by scanning the record headers.
+enum TrajectoryArchiveEncoding
+{
+    raw_trajectory_encoding = 0,
+    xor_float_trajectory_encoding = 1
+};
+
+struct TrajectoryArchiveEntry
+{
+    std::string kind;
+    long long id;
+    uint64_t dataOffset;
+    uint64_t numberOfStates;
+    uint64_t dataLength;
+    int stateDimension;
+    int encoding;
+};
+
+// Appends trajectories to an archive; thread safe, so write tasks on several writer threads can share one archive
+class TrajectoryArchiveWriter
+{
+public:
+    // Opens fileName, continuing an existing archive; the records appended by this writer are stored with encoding
+    explicit TrajectoryArchiveWriter( const std::string& fileName,
+                                      const TrajectoryArchiveEncoding encoding = raw_trajectory_encoding );
+
+    ~TrajectoryArchiveWriter( );
+
+    void appendTrajectory( const std::string& kind, const long long id, const TrajectoryView& trajectory );
+
+    // Writes the index; appending may continue afterwards
+    void close( );
+
+    const std::string& getFileName( ) const { return fileName_; }
+
+private:
+    TrajectoryArchiveWriter( const TrajectoryArchiveWriter& );
+    TrajectoryArchiveWriter& operator=( const TrajectoryArchiveWriter& );
+
+    const std::string fileName_;
+    const TrajectoryArchiveEncoding encoding_;
+
+    std::mutex archiveMutex_;
+    std::fstream archiveFile_;
+    uint64_t dataEnd_;
+    std::vector< TrajectoryArchiveEntry > entries_;
+    bool indexWritten_;
+};
+
+// Random access to the trajectories of an archive, which is mapped into memory instead of read
+class TrajectoryArchiveReader
+{
+public:
+    explicit TrajectoryArchiveReader( const std::string& fileName );
+
+    ~TrajectoryArchiveReader( );
+
+    int getNumberOfTrajectories( ) const { return static_cast< int >( entries_.size( ) ); }
+
+    const TrajectoryArchiveEntry& getEntry( const int trajectoryNumber ) const { return entries_.at( trajectoryNumber ); }
+
+    // Ids stored under kind, in increasing order
+    std::vector< long long > getIds( const std::string& kind ) const;
+
+    bool contains( const std::string& kind, const long long id ) const;
+
+    // View into the mapped file of the trajectory last appended under kind and id, valid as long as the reader exists;
+    // only for uncompressed records
+    TrajectoryView getTrajectory( const std::string& kind, const long long id ) const;
+
+    // Copy of the trajectory last appended under kind and id, for any encoding
+    void decodeTrajectory( const std::string& kind, const long long id, TrajectoryBuffer& trajectory ) const;
+
+private:
+    TrajectoryArchiveReader( const TrajectoryArchiveReader& );
+    TrajectoryArchiveReader& operator=( const TrajectoryArchiveReader& );
+
+    const TrajectoryArchiveEntry& findEntry( const std::string& kind, const long long id ) const;
+
+    const std::string fileName_;
+    const char* mappedData_;
+    std::size_t mappedLength_;
+
+    std::vector< TrajectoryArchiveEntry > entries_;
+    std::map< std::pair< std::string, long long >, int > entryNumbers_;
+};
+
+// Kind under which a data product is archived: its text file name without directory and extension
+std::string getTrajectoryArchiveKind( const std::string& textFileName );
+
+// Appends trajectories firstTrajectoryNumber up to firstTrajectoryNumber + numberOfTrajectories of the set, with ids
+// counting from 0
+void appendTrajectorySetToArchive( TrajectoryArchiveWriter& trajectoryArchive, const std::string& kind,
+                                   const TrajectorySet& trajectorySet, const int firstTrajectoryNumber,
+                                   const int numberOfTrajectories );
+
+// Process-wide archive targeted by the orbit, manifold and eigenvector writers while it is open
+void openTrajectoryArchive( const std::string& fileName,
+                            const TrajectoryArchiveEncoding encoding = raw_trajectory_encoding );
+
+// The open archive, or nullptr if the writers write separate files
+std::shared_ptr< TrajectoryArchiveWriter > getTrajectoryArchive( );
+
+void closeTrajectoryArchive( );
+
+#endif  // TUDATBUNDLE_TRAJECTORYARCHIVE_H
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <numeric>
+
+#include "trajectoryBuffer.h"
+
+int TrajectoryView::findStateNumberAtOrBeforeTime( const double time ) const
+{
+    const int nextStateNumber = static_cast< int >( std::upper_bound( times_, times_ + numberOfStates_, time ) - times_ );
+    return std::max( nextStateNumber - 1, 0 );
+}
+
+void TrajectoryBuffer::append( const double time, const Eigen::Ref< const Eigen::MatrixXd >& state )
+{
+    // Same semantics as assigning to history[ time ] for a history that is filled in integration order
+    if ( !times_.empty( ) && times_.back( ) == time ) {
+        times_.pop_back( );
+        states_.resize( states_.size( ) - stateDimension_ );
+    }
+
+    times_.push_back( time );
+    for ( int columnNumber = 0; columnNumber < state.cols( ); columnNumber++ ) {
+        for ( int rowNumber = 0; rowNumber < state.rows( ); rowNumber++ ) {
+            states_.push_back( state( rowNumber, columnNumber ) );
+        }
+    }
+}
+
+void TrajectoryBuffer::sortByTime( )
+{
+    if ( std::is_sorted( times_.begin( ), times_.end( ) ) ) {
+        return;
+    }
+
+    // Backward integration yields a decreasing time column, which only has to be reversed
+    std::vector< int > stateOrder( times_.size( ) );
+    std::iota( stateOrder.begin( ), stateOrder.end( ), 0 );
+    if ( std::is_sorted( times_.rbegin( ), times_.rend( ) ) ) {
+        std::reverse( stateOrder.begin( ), stateOrder.end( ) );
+    } else {
+        std::stable_sort( stateOrder.begin( ), stateOrder.end( ), [&]( const int stateOne, const int stateTwo ) {
+            return times_[ stateOne ] < times_[ stateTwo ];
+        } );
+    }
+
+    std::vector< double > sortedTimes( times_.size( ) );
+    std::vector< double > sortedStates( states_.size( ) );
+    for ( unsigned int stateNumber = 0; stateNumber < stateOrder.size( ); stateNumber++ ) {
+        sortedTimes[ stateNumber ] = times_[ stateOrder[ stateNumber ] ];
+        std::copy( states_.begin( ) + stateOrder[ stateNumber ] * stateDimension_,
+                   states_.begin( ) + ( stateOrder[ stateNumber ] + 1 ) * stateDimension_,
+                   sortedStates.begin( ) + stateNumber * stateDimension_ );
+    }
+    times_.swap( sortedTimes );
+    states_.swap( sortedStates );
+}
+
+void TrajectoryBuffer::reserve( const int numberOfStates )
+{
+    times_.reserve( numberOfStates );
+    states_.reserve( numberOfStates * stateDimension_ );
+}
+
+void TrajectoryBuffer::clear( )
+{
+    times_.clear( );
+    states_.clear( );
+}
+
+int TrajectorySet::appendTrajectory( const TrajectoryView& trajectory )
+{
+    if ( !trajectory.empty( ) ) {
+        times_.insert( times_.end( ), trajectory.getTimeData( ), trajectory.getTimeData( ) + trajectory.size( ) );
+        states_.insert( states_.end( ), trajectory.getStateData( ),
+                        trajectory.getStateData( ) + trajectory.size( ) * stateDimension_ );
+    }
+    offsets_.push_back( static_cast< int >( times_.size( ) ) );
+    return size( ) - 1;
+}
+
+void TrajectorySet::reserve( const int numberOfTrajectories, const int numberOfStates )
+{
+    offsets_.reserve( numberOfTrajectories + 1 );
+    times_.reserve( numberOfStates );
+    states_.reserve( numberOfStates * stateDimension_ );
+}
+
+void TrajectorySet::clear( )
+{
+    times_.clear( );
+    states_.clear( );
+    offsets_.assign( 1, 0 );
+}
+
+TrajectorySetBuilder::TrajectorySetBuilder( const int numberOfTrajectories, const int stateDimension ):
+    stateDimension_( stateDimension ), trajectoryLocations_( numberOfTrajectories, std::make_pair( -1, -1 ) ) { }
+
+void TrajectorySetBuilder::computeTrajectory( const int trajectoryNumber,
+                                              const std::function< void( TrajectoryBuffer& ) >& computeTrajectory )
+{
+    // Take a free arena, or add one if all are in use by other tasks
+    TrajectoryArena* trajectoryArena;
+    int arenaNumber;
+    {
+        std::lock_guard< std::mutex > lock( arenaMutex_ );
+        if ( freeArenaNumbers_.empty( ) ) {
+            arenas_.push_back( std::unique_ptr< TrajectoryArena >( new TrajectoryArena( stateDimension_ ) ) );
+            freeArenaNumbers_.push_back( static_cast< int >( arenas_.size( ) ) - 1 );
+        }
+        arenaNumber = freeArenaNumbers_.back( );
+        freeArenaNumbers_.pop_back( );
+        trajectoryArena = arenas_[ arenaNumber ].get( );
+    }
+
+    trajectoryArena->scratchBuffer.clear( );
+    computeTrajectory( trajectoryArena->scratchBuffer );
+    const int numberInArena = trajectoryArena->trajectorySet.appendTrajectory( trajectoryArena->scratchBuffer.getView( ) );
+
+    std::lock_guard< std::mutex > lock( arenaMutex_ );
+    trajectoryLocations_.at( trajectoryNumber ) = std::make_pair( arenaNumber, numberInArena );
+    freeArenaNumbers_.push_back( arenaNumber );
+}
+
+TrajectoryView TrajectorySetBuilder::getTrajectory( const int trajectoryNumber ) const
+{
+    const std::pair< int, int >& trajectoryLocation = trajectoryLocations_.at( trajectoryNumber );
+    if ( trajectoryLocation.first < 0 ) {
+        return TrajectoryView( nullptr, nullptr, 0, stateDimension_ );
+    }
+    return arenas_[ trajectoryLocation.first ]->trajectorySet.getTrajectory( trajectoryLocation.second );
+}
+
+TrajectorySet TrajectorySetBuilder::getTrajectorySet( ) const
+{
+    int totalNumberOfStates = 0;
+    for ( unsigned int arenaNumber = 0; arenaNumber < arenas_.size( ); arenaNumber++ ) {
+        totalNumberOfStates += arenas_[ arenaNumber ]->trajectorySet.getTotalNumberOfStates( );
+    }
+
+    TrajectorySet trajectorySet( stateDimension_ );
+    trajectorySet.reserve( trajectoryLocations_.size( ), totalNumberOfStates );
+    for ( unsigned int trajectoryNumber = 0; trajectoryNumber < trajectoryLocations_.size( ); trajectoryNumber++ ) {
+        trajectorySet.appendTrajectory( getTrajectory( trajectoryNumber ) );
+    }
+    return trajectorySet;
+}
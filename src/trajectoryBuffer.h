@@ -0,0 +1,184 @@
+#ifndef TUDATBUNDLE_TRAJECTORYBUFFER_H
+#define TUDATBUNDLE_TRAJECTORYBUFFER_H
+
+
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+// Read-only view on the time column and the state rows (stateDimension values per row, a state vector incl. STM is
+// stored column-major with stateDimension 42) of one trajectory, in increasing time
+class TrajectoryView
+{
+public:
+    TrajectoryView( const double* times, const double* states, const int numberOfStates, const int stateDimension ):
+        times_( times ), states_( states ), numberOfStates_( numberOfStates ), stateDimension_( stateDimension ) { }
+
+    int size( ) const { return numberOfStates_; }
+
+    bool empty( ) const { return numberOfStates_ == 0; }
+
+    int getStateDimension( ) const { return stateDimension_; }
+
+    const double* getTimeData( ) const { return times_; }
+
+    const double* getStateData( ) const { return states_; }
+
+    double getTime( const int stateNumber ) const { return times_[ stateNumber ]; }
+
+    Eigen::Map< const Eigen::VectorXd > getState( const int stateNumber ) const
+    {
+        return Eigen::Map< const Eigen::VectorXd >( states_ + stateNumber * stateDimension_, stateDimension_ );
+    }
+
+    double getFinalTime( ) const
+    {
+        assert( numberOfStates_ > 0 );
+        return times_[ numberOfStates_ - 1 ];
+    }
+
+    Eigen::Map< const Eigen::VectorXd > getFinalState( ) const
+    {
+        assert( numberOfStates_ > 0 );
+        return getState( numberOfStates_ - 1 );
+    }
+
+    // State vector incl. STM (6 x stateDimension / 6)
+    Eigen::Map< const Eigen::MatrixXd > getStateVectorInclSTM( const int stateNumber ) const
+    {
+        return Eigen::Map< const Eigen::MatrixXd >( states_ + stateNumber * stateDimension_, 6, stateDimension_ / 6 );
+    }
+
+    // Last state at or before time, or the first state if time lies before it
+    int findStateNumberAtOrBeforeTime( const double time ) const;
+
+private:
+    const double* times_;
+    const double* states_;
+    int numberOfStates_;
+    int stateDimension_;
+};
+
+// Single trajectory in contiguous time and state columns. States are appended in integration order, a state at the same
+// time as the last one replaces it, and sortByTime( ) puts the rows of a trajectory integrated backwards in increasing
+// time once it is complete. clear( ) keeps the allocated capacity.
+class TrajectoryBuffer
+{
+public:
+    explicit TrajectoryBuffer( const int stateDimension = 6 ): stateDimension_( stateDimension ) { }
+
+    // state holds stateDimension values, e.g. a Vector6d or a full 6 x 7 state vector incl. STM
+    void append( const double time, const Eigen::Ref< const Eigen::MatrixXd >& state );
+
+    void sortByTime( );
+
+    void reserve( const int numberOfStates );
+
+    void clear( );
+
+    int size( ) const { return static_cast< int >( times_.size( ) ); }
+
+    bool empty( ) const { return times_.empty( ); }
+
+    int getStateDimension( ) const { return stateDimension_; }
+
+    double getTime( const int stateNumber ) const { return times_[ stateNumber ]; }
+
+    Eigen::Map< const Eigen::VectorXd > getState( const int stateNumber ) const { return getView( ).getState( stateNumber ); }
+
+    Eigen::Map< const Eigen::MatrixXd > getStateVectorInclSTM( const int stateNumber ) const
+    {
+        return getView( ).getStateVectorInclSTM( stateNumber );
+    }
+
+    int findStateNumberAtOrBeforeTime( const double time ) const { return getView( ).findStateNumberAtOrBeforeTime( time ); }
+
+    TrajectoryView getView( ) const { return TrajectoryView( times_.data( ), states_.data( ), size( ), stateDimension_ ); }
+
+private:
+    int stateDimension_;
+    std::vector< double > times_;
+    std::vector< double > states_;
+};
+
+// Many trajectories back to back in one time column and one state column, with the offset of the first state of every
+// trajectory. Trajectories are numbered in the order in which they are appended.
+class TrajectorySet
+{
+public:
+    explicit TrajectorySet( const int stateDimension = 6 ): stateDimension_( stateDimension ), offsets_( 1, 0 ) { }
+
+    // Returns the number of the appended trajectory
+    int appendTrajectory( const TrajectoryView& trajectory );
+
+    void reserve( const int numberOfTrajectories, const int numberOfStates );
+
+    void clear( );
+
+    int size( ) const { return static_cast< int >( offsets_.size( ) ) - 1; }
+
+    int getStateDimension( ) const { return stateDimension_; }
+
+    int getTotalNumberOfStates( ) const { return static_cast< int >( times_.size( ) ); }
+
+    // Valid until the next trajectory is appended
+    TrajectoryView getTrajectory( const int trajectoryNumber ) const
+    {
+        assert( trajectoryNumber >= 0 && trajectoryNumber < size( ) );
+        return TrajectoryView( times_.data( ) + offsets_[ trajectoryNumber ], states_.data( ) + offsets_[ trajectoryNumber ] * stateDimension_,
+                               offsets_[ trajectoryNumber + 1 ] - offsets_[ trajectoryNumber ], stateDimension_ );
+    }
+
+private:
+    int stateDimension_;
+    std::vector< double > times_;
+    std::vector< double > states_;
+    std::vector< int > offsets_;
+};
+
+// Collects the trajectories of concurrent tasks into a TrajectorySet. Every task takes a free arena (a scratch buffer that
+// is reused from trajectory to trajectory and a set to which the finished trajectory is appended), so once the arenas
+// have grown no memory is allocated per trajectory or per state. getTrajectorySet( ) copies all trajectories once, in
+// trajectory number order, so the result does not depend on the number of threads.
+class TrajectorySetBuilder
+{
+public:
+    TrajectorySetBuilder( const int numberOfTrajectories, const int stateDimension = 6 );
+
+    // Runs computeTrajectory on an empty buffer and stores the result as trajectory trajectoryNumber; thread safe
+    void computeTrajectory( const int trajectoryNumber, const std::function< void( TrajectoryBuffer& ) >& computeTrajectory );
+
+    // Trajectory computed before (an empty one if not computed); not while tasks are running, valid until the next call of
+    // computeTrajectory
+    TrajectoryView getTrajectory( const int trajectoryNumber ) const;
+
+    TrajectorySet getTrajectorySet( ) const;
+
+private:
+    TrajectorySetBuilder( const TrajectorySetBuilder& );
+    TrajectorySetBuilder& operator=( const TrajectorySetBuilder& );
+
+    struct TrajectoryArena
+    {
+        explicit TrajectoryArena( const int stateDimension ): scratchBuffer( stateDimension ), trajectorySet( stateDimension ) { }
+
+        TrajectoryBuffer scratchBuffer;
+        TrajectorySet trajectorySet;
+    };
+
+    const int stateDimension_;
+
+    std::mutex arenaMutex_;
+    std::vector< std::unique_ptr< TrajectoryArena > > arenas_;
+    std::vector< int > freeArenaNumbers_;
+
+    // Arena and number within the set of that arena per trajectory, -1 if not computed
+    std::vector< std::pair< int, int > > trajectoryLocations_;
+};
+
+#endif  // TUDATBUNDLE_TRAJECTORYBUFFER_H
@@ -0,0 +1,182 @@
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+#include "trajectoryDecimation.h"
+
+namespace
+{
+
+std::mutex trajectoryDecimationLevelsMutex;
+std::vector< TrajectoryDecimationLevel > currentTrajectoryDecimationLevels;
+
+// Distance between the position of state stateNumber and the cubic Hermite interpolation at its time between the states
+// firstStateNumber and lastStateNumber, with the velocities (state elements 3 to 5) as derivatives of the position
+double getHermiteInterpolationError( const TrajectoryView& trajectory, const int firstStateNumber, const int lastStateNumber,
+                                     const int stateNumber )
+{
+    const double* firstState = trajectory.getStateData( ) + firstStateNumber * trajectory.getStateDimension( );
+    const double* lastState  = trajectory.getStateData( ) + lastStateNumber * trajectory.getStateDimension( );
+    const double* state      = trajectory.getStateData( ) + stateNumber * trajectory.getStateDimension( );
+
+    const double timeStep = trajectory.getTime( lastStateNumber ) - trajectory.getTime( firstStateNumber );
+    if ( timeStep == 0.0 ) {
+        return std::sqrt( ( state[ 0 ] - firstState[ 0 ] ) * ( state[ 0 ] - firstState[ 0 ] ) +
+                          ( state[ 1 ] - firstState[ 1 ] ) * ( state[ 1 ] - firstState[ 1 ] ) +
+                          ( state[ 2 ] - firstState[ 2 ] ) * ( state[ 2 ] - firstState[ 2 ] ) );
+    }
+
+    // Hermite basis functions at the normalised time s in [0, 1]; the sign of the time step covers stable manifolds
+    const double s = ( trajectory.getTime( stateNumber ) - trajectory.getTime( firstStateNumber ) ) / timeStep;
+    const double h00 = ( 1.0 + 2.0 * s ) * ( 1.0 - s ) * ( 1.0 - s );
+    const double h10 = s * ( 1.0 - s ) * ( 1.0 - s );
+    const double h01 = s * s * ( 3.0 - 2.0 * s );
+    const double h11 = s * s * ( s - 1.0 );
+
+    double squaredError = 0.0;
+    for ( int i = 0; i < 3; i++ ) {
+        const double interpolatedPosition = h00 * firstState[ i ] + h10 * timeStep * firstState[ i + 3 ] +
+                                            h01 * lastState[ i ] + h11 * timeStep * lastState[ i + 3 ];
+        squaredError += ( state[ i ] - interpolatedPosition ) * ( state[ i ] - interpolatedPosition );
+    }
+    return std::sqrt( squaredError );
+}
+
+}
+
+void setTrajectoryDecimationLevels( const std::vector< TrajectoryDecimationLevel >& decimationLevels )
+{
+    std::lock_guard< std::mutex > lock( trajectoryDecimationLevelsMutex );
+    currentTrajectoryDecimationLevels = decimationLevels;
+}
+
+std::vector< TrajectoryDecimationLevel > getTrajectoryDecimationLevels( )
+{
+    std::lock_guard< std::mutex > lock( trajectoryDecimationLevelsMutex );
+    return currentTrajectoryDecimationLevels;
+}
+
+std::vector< TrajectoryDecimationLevel > getDefaultTrajectoryDecimationLevels( )
+{
+    std::vector< TrajectoryDecimationLevel > decimationLevels;
+    decimationLevels.push_back( { "coarse", 1.0E-3 } );
+    decimationLevels.push_back( { "medium", 1.0E-5 } );
+    return decimationLevels;
+}
+
+std::string getDecimatedFileName( const std::string& textFileName, const std::string& levelName )
+{
+    const std::string textExtension = ".txt";
+    if ( textFileName.size( ) >= textExtension.size( ) &&
+         textFileName.compare( textFileName.size( ) - textExtension.size( ), textExtension.size( ), textExtension ) == 0 ) {
+        return textFileName.substr( 0, textFileName.size( ) - textExtension.size( ) ) + "_" + levelName + textExtension;
+    }
+    return textFileName + "_" + levelName;
+}
+
+std::vector< int > selectStatesWithinPositionTolerance( const TrajectoryView& trajectory, const double positionTolerance )
+{
+    std::vector< int > keptStateNumbers;
+    if ( trajectory.size( ) <= 2 ) {
+        for ( int stateNumber = 0; stateNumber < trajectory.size( ); stateNumber++ ) {
+            keptStateNumbers.push_back( stateNumber );
+        }
+        return keptStateNumbers;
+    }
+
+    // Segments are split on an explicit stack, long trajectories would otherwise recurse deeply
+    std::vector< bool > keepState( trajectory.size( ), false );
+    keepState.front( ) = true;
+    keepState.back( ) = true;
+    std::vector< std::pair< int, int > > segments( 1, std::make_pair( 0, trajectory.size( ) - 1 ) );
+    while ( !segments.empty( ) ) {
+        const std::pair< int, int > segment = segments.back( );
+        segments.pop_back( );
+
+        int largestErrorStateNumber = -1;
+        double largestError = positionTolerance;
+        for ( int stateNumber = segment.first + 1; stateNumber < segment.second; stateNumber++ ) {
+            const double error = getHermiteInterpolationError( trajectory, segment.first, segment.second, stateNumber );
+            if ( error > largestError || std::isnan( error ) ) {
+                largestError = ( std::isnan( error ) ? std::numeric_limits< double >::infinity( ) : error );
+                largestErrorStateNumber = stateNumber;
+            }
+        }
+        if ( largestErrorStateNumber >= 0 ) {
+            keepState.at( largestErrorStateNumber ) = true;
+            segments.push_back( std::make_pair( segment.first, largestErrorStateNumber ) );
+            segments.push_back( std::make_pair( largestErrorStateNumber, segment.second ) );
+        }
+    }
+
+    for ( int stateNumber = 0; stateNumber < trajectory.size( ); stateNumber++ ) {
+        if ( keepState[ stateNumber ] ) {
+            keptStateNumbers.push_back( stateNumber );
+        }
+    }
+    return keptStateNumbers;
+}
+
+DecimatedTrajectoryWriter::DecimatedTrajectoryWriter( const std::string& textFileName, const std::string& archiveKind ):
+    decimationLevels_( getTrajectoryDecimationLevels( ) ), trajectoryArchive_( getTrajectoryArchive( ) )
+{
+    for ( unsigned int levelNumber = 0; levelNumber < decimationLevels_.size( ); levelNumber++ ) {
+        const std::string decimatedFileName = getDecimatedFileName( textFileName, decimationLevels_[ levelNumber ].name );
+        if ( trajectoryArchive_ ) {
+            archiveKinds_.push_back( archiveKind.empty( ) ? getTrajectoryArchiveKind( decimatedFileName )
+                                                          : archiveKind + "_" + decimationLevels_[ levelNumber ].name );
+            continue;
+        }
+
+        // The decimated histories hold time and position/velocity only, also of histories incl. the STM
+        removeDataProductFiles( decimatedFileName );
+        if ( getDataOutputFormat( ) == numpy_data_output ) {
+            numpyFiles_.emplace_back( new NumpyTrajectoryFileWriter( getNumpyFileName( decimatedFileName, ".npz" ) ) );
+        } else {
+            textFiles_.emplace_back( new TextTableWriter( decimatedFileName ) );
+        }
+    }
+}
+
+DecimatedTrajectoryWriter::~DecimatedTrajectoryWriter( )
+{
+    try {
+        close( );
+    } catch ( const std::exception& ) { }
+}
+
+void DecimatedTrajectoryWriter::appendTrajectory( const long long trajectoryId, const TrajectoryView& trajectory )
+{
+    for ( unsigned int levelNumber = 0; levelNumber < decimationLevels_.size( ); levelNumber++ ) {
+        decimatedTrajectory_.clear( );
+        const std::vector< int > keptStateNumbers = selectStatesWithinPositionTolerance( trajectory,
+                                                                                         decimationLevels_[ levelNumber ].positionTolerance );
+        for ( unsigned int keptStateNumber = 0; keptStateNumber < keptStateNumbers.size( ); keptStateNumber++ ) {
+            decimatedTrajectory_.append( trajectory.getTime( keptStateNumbers[ keptStateNumber ] ),
+                                         trajectory.getState( keptStateNumbers[ keptStateNumber ] ).head( 6 ) );
+        }
+
+        if ( trajectoryArchive_ ) {
+            trajectoryArchive_->appendTrajectory( archiveKinds_.at( levelNumber ), trajectoryId, decimatedTrajectory_.getView( ) );
+        } else if ( !numpyFiles_.empty( ) ) {
+            numpyFiles_.at( levelNumber )->appendTrajectory( decimatedTrajectory_.getView( ) );
+        } else {
+            TextTableWriter& textFile = *textFiles_.at( levelNumber );
+            for ( int stateNumber = 0; stateNumber < decimatedTrajectory_.size( ); stateNumber++ ) {
+                textFile.appendValue( decimatedTrajectory_.getTime( stateNumber ) );
+                textFile.appendRow( decimatedTrajectory_.getState( stateNumber ).data( ), 6 );
+            }
+        }
+    }
+}
+
+void DecimatedTrajectoryWriter::close( )
+{
+    for ( unsigned int fileNumber = 0; fileNumber < numpyFiles_.size( ); fileNumber++ ) {
+        numpyFiles_[ fileNumber ]->close( );
+    }
+    for ( unsigned int fileNumber = 0; fileNumber < textFiles_.size( ); fileNumber++ ) {
+        textFiles_[ fileNumber ]->close( );
+    }
+}
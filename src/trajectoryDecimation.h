@@ -0,0 +1,67 @@
+#ifndef TUDATBUNDLE_TRAJECTORYDECIMATION_H
+#define TUDATBUNDLE_TRAJECTORYDECIMATION_H
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "numpyOutput.h"
+#include "textOutput.h"
+#include "trajectoryArchive.h"
+#include "trajectoryBuffer.h"
+
+// Level of the decimated output pyramid: the suffix of its file name and the position tolerance (nondimensional) within
+// which the full trajectory can be reconstructed from the kept states
+struct TrajectoryDecimationLevel
+{
+    std::string name;
+    double positionTolerance;
+};
+
+// Levels written next to the full orbit, manifold and theta state histories; none (the default) disables decimated output
+void setTrajectoryDecimationLevels( const std::vector< TrajectoryDecimationLevel >& decimationLevels );
+
+std::vector< TrajectoryDecimationLevel > getTrajectoryDecimationLevels( );
+
+// coarse (1.0E-3, about 400 km) and medium (1.0E-5, about 4 km); the full data is the third level of the pyramid
+std::vector< TrajectoryDecimationLevel > getDefaultTrajectoryDecimationLevels( );
+
+// L1_horizontal_1_W_S_plus.txt -> L1_horizontal_1_W_S_plus_<levelName>.txt
+std::string getDecimatedFileName( const std::string& textFileName, const std::string& levelName );
+
+// Numbers of the states to keep: the first and last state, and every state that the cubic Hermite interpolation of
+// position and velocity between its kept neighbours would miss by more than positionTolerance. The split points are
+// selected as in Douglas-Peucker, on the state of largest deviation, so every dropped state lies within positionTolerance
+// of the interpolation between the kept states around it.
+std::vector< int > selectStatesWithinPositionTolerance( const TrajectoryView& trajectory, const double positionTolerance );
+
+// Writes every trajectory it is given decimated to each of the configured levels, in the current output format: a text or
+// .npz file per level next to the full file, or the trajectory archive under the kind of the full data with the level
+// name appended. Does nothing if no levels are configured.
+class DecimatedTrajectoryWriter
+{
+public:
+    // archiveKind is the kind of the full data in the archive, by default derived from textFileName
+    DecimatedTrajectoryWriter( const std::string& textFileName, const std::string& archiveKind = "" );
+
+    ~DecimatedTrajectoryWriter( );
+
+    // trajectoryId is only used in the archive, the files hold the trajectories in the order in which they are appended
+    void appendTrajectory( const long long trajectoryId, const TrajectoryView& trajectory );
+
+    void close( );
+
+private:
+    DecimatedTrajectoryWriter( const DecimatedTrajectoryWriter& );
+    DecimatedTrajectoryWriter& operator=( const DecimatedTrajectoryWriter& );
+
+    std::vector< TrajectoryDecimationLevel > decimationLevels_;
+    std::shared_ptr< TrajectoryArchiveWriter > trajectoryArchive_;
+    std::vector< std::string > archiveKinds_;
+    std::vector< std::unique_ptr< NumpyTrajectoryFileWriter > > numpyFiles_;
+    std::vector< std::unique_ptr< TextTableWriter > > textFiles_;
+    TrajectoryBuffer decimatedTrajectory_;
+};
+
+#endif  // TUDATBUNDLE_TRAJECTORYDECIMATION_H
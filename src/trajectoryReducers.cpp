@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include "Tudat/Astrodynamics/Gravitation/jacobiEnergy.h"
+
+#include "numpyOutput.h"
+#include "textOutput.h"
+#include "trajectoryReducers.h"
+
+namespace
+{
+
+std::mutex trajectoryReducersMutex;
+std::vector< std::shared_ptr< const TrajectoryReducer > > currentTrajectoryReducers;
+
+}
+
+std::unique_ptr< TrajectoryReducer > TimeOfFlightReducer::clone( ) const
+{
+    return std::unique_ptr< TrajectoryReducer >( new TimeOfFlightReducer( ) );
+}
+
+void TimeOfFlightReducer::beginTrajectory( const int trajectoryNumber, const double phase )
+{
+    currentTrajectory_.trajectoryNumber  = trajectoryNumber;
+    currentTrajectory_.phase             = phase;
+    currentTrajectory_.timeOfFlight      = 0.0;
+    currentTrajectory_.terminationReason = integration_time_termination;
+}
+
+void TimeOfFlightReducer::addState( const double time, const Eigen::Vector6d& )
+{
+    currentTrajectory_.timeOfFlight = std::abs( time );
+}
+
+void TimeOfFlightReducer::endTrajectory( const ManifoldTerminationReason terminationReason, const int )
+{
+    currentTrajectory_.terminationReason = terminationReason;
+    trajectories_.push_back( currentTrajectory_ );
+}
+
+void TimeOfFlightReducer::merge( const TrajectoryReducer& other )
+{
+    const TimeOfFlightReducer& otherReducer = dynamic_cast< const TimeOfFlightReducer& >( other );
+    trajectories_.insert( trajectories_.end( ), otherReducer.trajectories_.begin( ), otherReducer.trajectories_.end( ) );
+}
+
+void TimeOfFlightReducer::writeSummaryToFile( const std::string& fileName ) const
+{
+    removeDataProductFiles( fileName );
+    TextTableWriter textFile( fileName );
+    for ( unsigned int trajectoryNumber = 0; trajectoryNumber < trajectories_.size( ); trajectoryNumber++ ) {
+        const TrajectoryTimeOfFlight& trajectory = trajectories_[ trajectoryNumber ];
+        const double row[ 4 ] = { static_cast< double >( trajectory.trajectoryNumber ), trajectory.phase, trajectory.timeOfFlight,
+                                  static_cast< double >( trajectory.terminationReason ) };
+        textFile.appendRow( row, 4 );
+    }
+    textFile.close( );
+}
+
+SectionCrossingSpreadReducer::SectionSpread::SectionSpread( ):
+    numberOfCrossings( 0 ), mean( Eigen::Vector6d::Zero( ) ), sumOfSquaredDeviations( Eigen::Vector6d::Zero( ) ),
+    minimum( Eigen::Vector6d::Constant( std::numeric_limits< double >::infinity( ) ) ),
+    maximum( Eigen::Vector6d::Constant( -std::numeric_limits< double >::infinity( ) ) )
+{ }
+
+SectionCrossingSpreadReducer::SectionCrossingSpreadReducer( ):
+    lastState_( Eigen::Vector6d::Zero( ) )
+{ }
+
+std::unique_ptr< TrajectoryReducer > SectionCrossingSpreadReducer::clone( ) const
+{
+    return std::unique_ptr< TrajectoryReducer >( new SectionCrossingSpreadReducer( ) );
+}
+
+void SectionCrossingSpreadReducer::beginTrajectory( const int, const double )
+{
+    lastState_.setZero( );
+}
+
+void SectionCrossingSpreadReducer::addState( const double, const Eigen::Vector6d& state )
+{
+    lastState_ = state;
+}
+
+void SectionCrossingSpreadReducer::endTrajectory( const ManifoldTerminationReason terminationReason, const int sectionNumber )
+{
+    if ( terminationReason != poincare_section_termination || sectionNumber < 0 ) {
+        return;
+    }
+    if ( sectionNumber >= static_cast< int >( sectionSpreads_.size( ) ) ) {
+        sectionSpreads_.resize( sectionNumber + 1 );
+    }
+
+    // Welford update with the crossing state
+    SectionSpread& sectionSpread = sectionSpreads_[ sectionNumber ];
+    sectionSpread.numberOfCrossings++;
+    const Eigen::Vector6d deviation = lastState_ - sectionSpread.mean;
+    sectionSpread.mean += deviation / static_cast< double >( sectionSpread.numberOfCrossings );
+    sectionSpread.sumOfSquaredDeviations += deviation.cwiseProduct( lastState_ - sectionSpread.mean );
+    sectionSpread.minimum = sectionSpread.minimum.cwiseMin( lastState_ );
+    sectionSpread.maximum = sectionSpread.maximum.cwiseMax( lastState_ );
+}
+
+void SectionCrossingSpreadReducer::merge( const TrajectoryReducer& other )
+{
+    const SectionCrossingSpreadReducer& otherReducer = dynamic_cast< const SectionCrossingSpreadReducer& >( other );
+    if ( otherReducer.sectionSpreads_.size( ) > sectionSpreads_.size( ) ) {
+        sectionSpreads_.resize( otherReducer.sectionSpreads_.size( ) );
+    }
+
+    for ( unsigned int sectionNumber = 0; sectionNumber < otherReducer.sectionSpreads_.size( ); sectionNumber++ ) {
+        SectionSpread& sectionSpread            = sectionSpreads_[ sectionNumber ];
+        const SectionSpread& otherSectionSpread = otherReducer.sectionSpreads_[ sectionNumber ];
+        if ( otherSectionSpread.numberOfCrossings == 0 ) {
+            continue;
+        }
+
+        const double numberOfCrossings      = static_cast< double >( sectionSpread.numberOfCrossings );
+        const double otherNumberOfCrossings = static_cast< double >( otherSectionSpread.numberOfCrossings );
+        const double totalNumberOfCrossings = numberOfCrossings + otherNumberOfCrossings;
+        const Eigen::Vector6d deltaMean     = otherSectionSpread.mean - sectionSpread.mean;
+
+        sectionSpread.mean += deltaMean * ( otherNumberOfCrossings / totalNumberOfCrossings );
+        sectionSpread.sumOfSquaredDeviations += otherSectionSpread.sumOfSquaredDeviations +
+                deltaMean.cwiseProduct( deltaMean ) * ( numberOfCrossings * otherNumberOfCrossings / totalNumberOfCrossings );
+        sectionSpread.numberOfCrossings += otherSectionSpread.numberOfCrossings;
+        sectionSpread.minimum = sectionSpread.minimum.cwiseMin( otherSectionSpread.minimum );
+        sectionSpread.maximum = sectionSpread.maximum.cwiseMax( otherSectionSpread.maximum );
+    }
+}
+
+void SectionCrossingSpreadReducer::writeSummaryToFile( const std::string& fileName ) const
+{
+    removeDataProductFiles( fileName );
+    TextTableWriter textFile( fileName );
+    for ( unsigned int sectionNumber = 0; sectionNumber < sectionSpreads_.size( ); sectionNumber++ ) {
+        const SectionSpread& sectionSpread = sectionSpreads_[ sectionNumber ];
+        const long long numberOfCrossings  = sectionSpread.numberOfCrossings;
+        for ( int elementNumber = 0; elementNumber < 6; elementNumber++ ) {
+            // Sample standard deviation, as in pandas; without crossings all statistics are nan
+            const double row[ 6 ] = {
+                static_cast< double >( sectionNumber ),
+                static_cast< double >( numberOfCrossings ),
+                numberOfCrossings > 0 ? sectionSpread.mean( elementNumber ) : std::numeric_limits< double >::quiet_NaN( ),
+                numberOfCrossings > 1 ? std::sqrt( sectionSpread.sumOfSquaredDeviations( elementNumber ) / ( numberOfCrossings - 1 ) )
+                                      : std::numeric_limits< double >::quiet_NaN( ),
+                numberOfCrossings > 0 ? sectionSpread.minimum( elementNumber ) : std::numeric_limits< double >::quiet_NaN( ),
+                numberOfCrossings > 0 ? sectionSpread.maximum( elementNumber ) : std::numeric_limits< double >::quiet_NaN( ) };
+            textFile.appendRow( row, 6 );
+        }
+    }
+    textFile.close( );
+}
+
+std::unique_ptr< TrajectoryReducer > JacobiDriftReducer::clone( ) const
+{
+    return std::unique_ptr< TrajectoryReducer >( new JacobiDriftReducer( massParameter_ ) );
+}
+
+void JacobiDriftReducer::beginTrajectory( const int trajectoryNumber, const double phase )
+{
+    currentTrajectory_.trajectoryNumber    = trajectoryNumber;
+    currentTrajectory_.phase               = phase;
+    currentTrajectory_.numberOfStates      = 0;
+    currentTrajectory_.initialJacobiEnergy = 0.0;
+    currentTrajectory_.maximumDrift        = 0.0;
+    currentTrajectory_.finalDrift          = 0.0;
+}
+
+void JacobiDriftReducer::addState( const double, const Eigen::Vector6d& state )
+{
+    const double jacobiEnergy = tudat::gravitation::computeJacobiEnergy( massParameter_, state );
+    if ( currentTrajectory_.numberOfStates == 0 ) {
+        currentTrajectory_.initialJacobiEnergy = jacobiEnergy;
+    }
+    currentTrajectory_.numberOfStates++;
+    currentTrajectory_.finalDrift   = jacobiEnergy - currentTrajectory_.initialJacobiEnergy;
+    currentTrajectory_.maximumDrift = std::max( currentTrajectory_.maximumDrift, std::abs( currentTrajectory_.finalDrift ) );
+}
+
+void JacobiDriftReducer::endTrajectory( const ManifoldTerminationReason, const int )
+{
+    trajectories_.push_back( currentTrajectory_ );
+}
+
+void JacobiDriftReducer::merge( const TrajectoryReducer& other )
+{
+    const JacobiDriftReducer& otherReducer = dynamic_cast< const JacobiDriftReducer& >( other );
+    trajectories_.insert( trajectories_.end( ), otherReducer.trajectories_.begin( ), otherReducer.trajectories_.end( ) );
+}
+
+void JacobiDriftReducer::writeSummaryToFile( const std::string& fileName ) const
+{
+    removeDataProductFiles( fileName );
+    TextTableWriter textFile( fileName );
+    for ( unsigned int trajectoryNumber = 0; trajectoryNumber < trajectories_.size( ); trajectoryNumber++ ) {
+        const TrajectoryJacobiDrift& trajectory = trajectories_[ trajectoryNumber ];
+        const double row[ 4 ] = { static_cast< double >( trajectory.trajectoryNumber ), trajectory.phase, trajectory.maximumDrift,
+                                  trajectory.finalDrift };
+        textFile.appendRow( row, 4 );
+    }
+    textFile.close( );
+}
+
+std::unique_ptr< TrajectoryReducer > MinimumMoonDistanceReducer::clone( ) const
+{
+    return std::unique_ptr< TrajectoryReducer >( new MinimumMoonDistanceReducer( massParameter_ ) );
+}
+
+void MinimumMoonDistanceReducer::beginTrajectory( const int trajectoryNumber, const double phase )
+{
+    currentTrajectory_.trajectoryNumber      = trajectoryNumber;
+    currentTrajectory_.phase                 = phase;
+    currentTrajectory_.minimumDistance       = std::numeric_limits< double >::infinity( );
+    currentTrajectory_.timeOfMinimumDistance = 0.0;
+}
+
+void MinimumMoonDistanceReducer::addState( const double time, const Eigen::Vector6d& state )
+{
+    const double distance = std::sqrt( ( state( 0 ) - ( 1.0 - massParameter_ ) ) * ( state( 0 ) - ( 1.0 - massParameter_ ) ) +
+                                       state( 1 ) * state( 1 ) + state( 2 ) * state( 2 ) );
+    if ( distance < currentTrajectory_.minimumDistance ) {
+        currentTrajectory_.minimumDistance       = distance;
+        currentTrajectory_.timeOfMinimumDistance = time;
+    }
+}
+
+void MinimumMoonDistanceReducer::endTrajectory( const ManifoldTerminationReason, const int )
+{
+    trajectories_.push_back( currentTrajectory_ );
+}
+
+void MinimumMoonDistanceReducer::merge( const TrajectoryReducer& other )
+{
+    const MinimumMoonDistanceReducer& otherReducer = dynamic_cast< const MinimumMoonDistanceReducer& >( other );
+    trajectories_.insert( trajectories_.end( ), otherReducer.trajectories_.begin( ), otherReducer.trajectories_.end( ) );
+}
+
+void MinimumMoonDistanceReducer::writeSummaryToFile( const std::string& fileName ) const
+{
+    removeDataProductFiles( fileName );
+    TextTableWriter textFile( fileName );
+    for ( unsigned int trajectoryNumber = 0; trajectoryNumber < trajectories_.size( ); trajectoryNumber++ ) {
+        const TrajectoryMoonDistance& trajectory = trajectories_[ trajectoryNumber ];
+        const double row[ 4 ] = { static_cast< double >( trajectory.trajectoryNumber ), trajectory.phase, trajectory.minimumDistance,
+                                  trajectory.timeOfMinimumDistance };
+        textFile.appendRow( row, 4 );
+    }
+    textFile.close( );
+}
+
+TrajectoryReducerList::TrajectoryReducerList( const std::vector< std::shared_ptr< const TrajectoryReducer > >& reducers )
+{
+    for ( unsigned int reducerNumber = 0; reducerNumber < reducers.size( ); reducerNumber++ ) {
+        reducers_.push_back( reducers[ reducerNumber ]->clone( ) );
+    }
+}
+
+TrajectoryReducerList TrajectoryReducerList::clone( ) const
+{
+    TrajectoryReducerList clonedList;
+    for ( unsigned int reducerNumber = 0; reducerNumber < reducers_.size( ); reducerNumber++ ) {
+        clonedList.reducers_.push_back( reducers_[ reducerNumber ]->clone( ) );
+    }
+    return clonedList;
+}
+
+void TrajectoryReducerList::beginTrajectory( const int trajectoryNumber, const double phase )
+{
+    for ( unsigned int reducerNumber = 0; reducerNumber < reducers_.size( ); reducerNumber++ ) {
+        reducers_[ reducerNumber ]->beginTrajectory( trajectoryNumber, phase );
+    }
+}
+
+void TrajectoryReducerList::addState( const double time, const Eigen::Vector6d& state )
+{
+    for ( unsigned int reducerNumber = 0; reducerNumber < reducers_.size( ); reducerNumber++ ) {
+        reducers_[ reducerNumber ]->addState( time, state );
+    }
+}
+
+void TrajectoryReducerList::endTrajectory( const ManifoldTerminationReason terminationReason, const int sectionNumber )
+{
+    for ( unsigned int reducerNumber = 0; reducerNumber < reducers_.size( ); reducerNumber++ ) {
+        reducers_[ reducerNumber ]->endTrajectory( terminationReason, sectionNumber );
+    }
+}
+
+void TrajectoryReducerList::merge( const TrajectoryReducerList& other )
+{
+    for ( unsigned int reducerNumber = 0; reducerNumber < reducers_.size( ); reducerNumber++ ) {
+        reducers_[ reducerNumber ]->merge( *other.reducers_.at( reducerNumber ) );
+    }
+}
+
+void TrajectoryReducerList::writeSummariesToFiles( const std::string& fileNamePrefix ) const
+{
+    for ( unsigned int reducerNumber = 0; reducerNumber < reducers_.size( ); reducerNumber++ ) {
+        reducers_[ reducerNumber ]->writeSummaryToFile( fileNamePrefix + "_" + reducers_[ reducerNumber ]->getName( ) + ".txt" );
+    }
+}
+
+void setTrajectoryReducers( const std::vector< std::shared_ptr< const TrajectoryReducer > >& reducers )
+{
+    std::lock_guard< std::mutex > lock( trajectoryReducersMutex );
+    currentTrajectoryReducers = reducers;
+}
+
+std::vector< std::shared_ptr< const TrajectoryReducer > > getTrajectoryReducers( )
+{
+    std::lock_guard< std::mutex > lock( trajectoryReducersMutex );
+    return currentTrajectoryReducers;
+}
+
+std::vector< std::shared_ptr< const TrajectoryReducer > > getDefaultTrajectoryReducers( const double massParameter )
+{
+    std::vector< std::shared_ptr< const TrajectoryReducer > > reducers;
+    reducers.push_back( std::make_shared< TimeOfFlightReducer >( ) );
+    reducers.push_back( std::make_shared< SectionCrossingSpreadReducer >( ) );
+    reducers.push_back( std::make_shared< JacobiDriftReducer >( massParameter ) );
+    reducers.push_back( std::make_shared< MinimumMoonDistanceReducer >( massParameter ) );
+    return reducers;
+}
@@ -0,0 +1,242 @@
+#ifndef TUDATBUNDLE_TRAJECTORYREDUCERS_H
+#define TUDATBUNDLE_TRAJECTORYREDUCERS_H
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "Tudat/Basics/basicTypedefs.h"
+
+#include "manifoldTermination.h"
+
+// Statistic of a set of manifold trajectories that is accumulated while they are propagated, from every integration step
+// (the states a history with saveFrequency 1 would hold), instead of from the saved state histories afterwards. Every
+// trajectory task feeds its own empty copy, the copies are merged in the order of the trajectories.
+class TrajectoryReducer
+{
+public:
+    virtual ~TrajectoryReducer( ) { }
+
+    // Suffix of the summary file name
+    virtual std::string getName( ) const = 0;
+
+    // Reducer with the same settings and without data
+    virtual std::unique_ptr< TrajectoryReducer > clone( ) const = 0;
+
+    // phase is the position of the start of the trajectory on the periodic orbit, as in the Poincare section files
+    virtual void beginTrajectory( const int trajectoryNumber, const double phase ) = 0;
+
+    // Called in integration order, from the initial state up to the final (refined) state of the trajectory
+    virtual void addState( const double time, const Eigen::Vector6d& state ) = 0;
+
+    // sectionNumber is the index of the Poincare section that was reached, -1 if the trajectory terminated otherwise
+    virtual void endTrajectory( const ManifoldTerminationReason terminationReason, const int sectionNumber ) = 0;
+
+    // Adds the data of other, a reducer of the same type whose trajectories follow those of this reducer
+    virtual void merge( const TrajectoryReducer& other ) = 0;
+
+    virtual void writeSummaryToFile( const std::string& fileName ) const = 0;
+};
+
+// Time of flight and termination reason of every trajectory: one row per trajectory with its number, phase, time of
+// flight (nondimensional, positive for both directions) and termination reason
+class TimeOfFlightReducer: public TrajectoryReducer
+{
+public:
+    TimeOfFlightReducer( ) { }
+
+    std::string getName( ) const { return "time_of_flight"; }
+
+    std::unique_ptr< TrajectoryReducer > clone( ) const;
+
+    void beginTrajectory( const int trajectoryNumber, const double phase );
+
+    void addState( const double time, const Eigen::Vector6d& state );
+
+    void endTrajectory( const ManifoldTerminationReason terminationReason, const int sectionNumber );
+
+    void merge( const TrajectoryReducer& other );
+
+    void writeSummaryToFile( const std::string& fileName ) const;
+
+private:
+    struct TrajectoryTimeOfFlight
+    {
+        int trajectoryNumber;
+        double phase;
+        double timeOfFlight;
+        ManifoldTerminationReason terminationReason;
+    };
+
+    std::vector< TrajectoryTimeOfFlight > trajectories_;
+    TrajectoryTimeOfFlight currentTrajectory_;
+};
+
+// Spread of the states in which the trajectories cross the Poincare sections (those terminated at a section), as
+// plotted by plot_poincare_spread, per section: for every section up to the last one that was crossed, one row per state
+// element (x, y, z, xdot, ydot, zdot) with the section number, number of crossings, mean, standard deviation, minimum and
+// maximum. Means and variances are merged with the pairwise update of Chan et al.
+class SectionCrossingSpreadReducer: public TrajectoryReducer
+{
+public:
+    SectionCrossingSpreadReducer( );
+
+    std::string getName( ) const { return "section_spread"; }
+
+    std::unique_ptr< TrajectoryReducer > clone( ) const;
+
+    void beginTrajectory( const int trajectoryNumber, const double phase );
+
+    void addState( const double time, const Eigen::Vector6d& state );
+
+    void endTrajectory( const ManifoldTerminationReason terminationReason, const int sectionNumber );
+
+    void merge( const TrajectoryReducer& other );
+
+    void writeSummaryToFile( const std::string& fileName ) const;
+
+private:
+    struct SectionSpread
+    {
+        SectionSpread( );
+
+        long long numberOfCrossings;
+        Eigen::Vector6d mean;
+        Eigen::Vector6d sumOfSquaredDeviations;
+        Eigen::Vector6d minimum;
+        Eigen::Vector6d maximum;
+    };
+
+    std::vector< SectionSpread > sectionSpreads_;
+    Eigen::Vector6d lastState_;
+};
+
+// Drift of the Jacobi energy along every trajectory with respect to its initial state: one row per trajectory with its
+// number, phase, largest absolute drift and drift at the final state
+class JacobiDriftReducer: public TrajectoryReducer
+{
+public:
+    explicit JacobiDriftReducer( const double massParameter ): massParameter_( massParameter ) { }
+
+    std::string getName( ) const { return "jacobi_drift"; }
+
+    std::unique_ptr< TrajectoryReducer > clone( ) const;
+
+    void beginTrajectory( const int trajectoryNumber, const double phase );
+
+    void addState( const double time, const Eigen::Vector6d& state );
+
+    void endTrajectory( const ManifoldTerminationReason terminationReason, const int sectionNumber );
+
+    void merge( const TrajectoryReducer& other );
+
+    void writeSummaryToFile( const std::string& fileName ) const;
+
+private:
+    struct TrajectoryJacobiDrift
+    {
+        int trajectoryNumber;
+        double phase;
+        int numberOfStates;
+        double initialJacobiEnergy;
+        double maximumDrift;
+        double finalDrift;
+    };
+
+    const double massParameter_;
+    std::vector< TrajectoryJacobiDrift > trajectories_;
+    TrajectoryJacobiDrift currentTrajectory_;
+};
+
+// Closest approach of every trajectory to the Moon at ( 1 - massParameter, 0, 0 ), over the integration steps: one row per
+// trajectory with its number, phase, minimum distance (nondimensional) and the time at which it is reached
+class MinimumMoonDistanceReducer: public TrajectoryReducer
+{
+public:
+    explicit MinimumMoonDistanceReducer( const double massParameter ): massParameter_( massParameter ) { }
+
+    std::string getName( ) const { return "moon_distance"; }
+
+    std::unique_ptr< TrajectoryReducer > clone( ) const;
+
+    void beginTrajectory( const int trajectoryNumber, const double phase );
+
+    void addState( const double time, const Eigen::Vector6d& state );
+
+    void endTrajectory( const ManifoldTerminationReason terminationReason, const int sectionNumber );
+
+    void merge( const TrajectoryReducer& other );
+
+    void writeSummaryToFile( const std::string& fileName ) const;
+
+private:
+    struct TrajectoryMoonDistance
+    {
+        int trajectoryNumber;
+        double phase;
+        double minimumDistance;
+        double timeOfMinimumDistance;
+    };
+
+    const double massParameter_;
+    std::vector< TrajectoryMoonDistance > trajectories_;
+    TrajectoryMoonDistance currentTrajectory_;
+};
+
+// Empty copies of a set of reducers, fed together by one trajectory task (or holding the merged result of several)
+class TrajectoryReducerList
+{
+public:
+    TrajectoryReducerList( ) { }
+
+    explicit TrajectoryReducerList( const std::vector< std::shared_ptr< const TrajectoryReducer > >& reducers );
+
+    TrajectoryReducerList( TrajectoryReducerList&& other ) noexcept: reducers_( std::move( other.reducers_ ) ) { }
+
+    TrajectoryReducerList& operator=( TrajectoryReducerList&& other ) noexcept
+    {
+        reducers_ = std::move( other.reducers_ );
+        return *this;
+    }
+
+    bool empty( ) const { return reducers_.empty( ); }
+
+    int size( ) const { return static_cast< int >( reducers_.size( ) ); }
+
+    const TrajectoryReducer& getReducer( const int reducerNumber ) const { return *reducers_.at( reducerNumber ); }
+
+    // Empty copies of all reducers in the list
+    TrajectoryReducerList clone( ) const;
+
+    void beginTrajectory( const int trajectoryNumber, const double phase );
+
+    void addState( const double time, const Eigen::Vector6d& state );
+
+    void endTrajectory( const ManifoldTerminationReason terminationReason, const int sectionNumber );
+
+    // other must be a (merged) clone of this list
+    void merge( const TrajectoryReducerList& other );
+
+    // One file per reducer: <fileNamePrefix>_<reducer name>.txt
+    void writeSummariesToFiles( const std::string& fileNamePrefix ) const;
+
+private:
+    TrajectoryReducerList( const TrajectoryReducerList& );
+    TrajectoryReducerList& operator=( const TrajectoryReducerList& );
+
+    std::vector< std::unique_ptr< TrajectoryReducer > > reducers_;
+};
+
+// Reducers whose summaries computeManifolds and connectManifoldsAtTheta write next to their other output; none (the
+// default) disables the summaries and the reducer calls in the propagation loops
+void setTrajectoryReducers( const std::vector< std::shared_ptr< const TrajectoryReducer > >& reducers );
+
+std::vector< std::shared_ptr< const TrajectoryReducer > > getTrajectoryReducers( );
+
+// Time of flight, section spread, Jacobi drift and minimum distance to the Moon
+std::vector< std::shared_ptr< const TrajectoryReducer > > getDefaultTrajectoryReducers( const double massParameter );
+
+#endif  // TUDATBUNDLE_TRAJECTORYREDUCERS_H
@@ -0,0 +1,189 @@
+#define BOOST_TEST_MAIN
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "../initialConditionsTable.h"
+
+namespace
+{
+
+uint64_t getBits( const double value )
+{
+    uint64_t bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+// Parses text, which is copied into a buffer of exactly its length (no terminating zero), and compares value and length
+// with strtod
+void checkParsedAsStrtod( const std::string& text )
+{
+    char* strtodEnd;
+    const double strtodValue = std::strtod( text.c_str( ), &strtodEnd );
+
+    const std::vector< char > buffer( text.begin( ), text.end( ) );
+    const char* begin = buffer.data( );
+    double value = -1.0;
+    const char* numberEnd = parseFloatingPointNumber( begin, begin + buffer.size( ), value );
+
+    BOOST_CHECK_MESSAGE( numberEnd - begin == strtodEnd - text.c_str( ), "number length of \"" << text << "\"" );
+    if ( strtodEnd != text.c_str( ) ) {
+        BOOST_CHECK_MESSAGE( getBits( value ) == getBits( strtodValue ) || ( value != value && strtodValue != strtodValue ),
+                             "value of \"" << text << "\"" );
+    }
+}
+
+// Decimal number with an optional sign, leading zeros, up to 25 digits around an optional decimal point and an optional
+// exponent, followed by the separator
+std::string createDecimalText( std::mt19937& randomNumberGenerator )
+{
+    std::uniform_int_distribution< int > choice( 0, 9 );
+    std::uniform_int_distribution< int > numberOfDigits( 0, 25 );
+    std::uniform_int_distribution< int > exponent( 0, 340 );
+
+    std::string text;
+    const int sign = choice( randomNumberGenerator );
+    if ( sign < 2 ) {
+        text += ( sign == 0 ? '-' : '+' );
+    }
+    const int numberOfLeadingZeros = choice( randomNumberGenerator ) < 3 ? choice( randomNumberGenerator ) : 0;
+    text += std::string( numberOfLeadingZeros, '0' );
+    const int numberOfIntegerDigits = numberOfDigits( randomNumberGenerator );
+    for ( int digitNumber = 0; digitNumber < numberOfIntegerDigits; digitNumber++ ) {
+        text += static_cast< char >( '0' + choice( randomNumberGenerator ) );
+    }
+    if ( choice( randomNumberGenerator ) < 7 ) {
+        text += '.';
+        const int numberOfFractionDigits = numberOfDigits( randomNumberGenerator );
+        for ( int digitNumber = 0; digitNumber < numberOfFractionDigits; digitNumber++ ) {
+            text += static_cast< char >( '0' + choice( randomNumberGenerator ) );
+        }
+    }
+    if ( choice( randomNumberGenerator ) < 6 ) {
+        text += ( choice( randomNumberGenerator ) < 5 ? 'e' : 'E' );
+        const int exponentSign = choice( randomNumberGenerator );
+        if ( exponentSign < 4 ) {
+            text += ( exponentSign < 2 ? '-' : '+' );
+        }
+        // Digitless exponents are not part of the number
+        if ( choice( randomNumberGenerator ) > 0 ) {
+            const int exponentValue = exponent( randomNumberGenerator );
+            text += std::to_string( choice( randomNumberGenerator ) < 5 ? exponentValue / 10 : exponentValue );
+        }
+    }
+    const char separators[ 4 ] = { ' ', '\t', '\n', 'x' };
+    if ( choice( randomNumberGenerator ) < 8 ) {
+        text += separators[ choice( randomNumberGenerator ) % 4 ];
+    }
+    return text;
+}
+
+void writeTextFile( const std::string& fileName, const std::string& text )
+{
+    std::ofstream textFile( fileName.c_str( ), std::ios::binary );
+    textFile << text;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( test_initial_conditions_table )
+
+BOOST_AUTO_TEST_CASE( testRandomDecimalNumbersMatchStrtod )
+{
+    std::mt19937 randomNumberGenerator( 1 );
+    for ( int numberNumber = 0; numberNumber < 100000; numberNumber++ ) {
+        checkParsedAsStrtod( createDecimalText( randomNumberGenerator ) );
+    }
+}
+
+// Values as written by the text writers (precision 14) and with the 17 significant digits that round trip
+BOOST_AUTO_TEST_CASE( testWrittenValuesMatchStrtod )
+{
+    std::mt19937_64 randomNumberGenerator( 2 );
+    char text[ 64 ];
+    for ( int valueNumber = 0; valueNumber < 20000; valueNumber++ ) {
+        const uint64_t bits = randomNumberGenerator( );
+        double value;
+        std::memcpy( &value, &bits, sizeof( value ) );
+        std::snprintf( text, sizeof( text ), valueNumber % 2 == 0 ? "%.14e" : "%.16e", value );
+        checkParsedAsStrtod( text );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( testSpecialNumbersMatchStrtod )
+{
+    const char* texts[ ] = { "0", "-0", "+0.0e0", "0.000000000000000000000000001", "1e", "1e+", "2.5E-", "-.5", "5.",
+                             ".", "-", "+", "-.e1", "e5", "", "x", "nan", "-nan", "NaN", "inf", "-Infinity",
+                             "INF ", "infinite", "0x1p3", "1.7976931348623157e308", "1.7976931348623159e308", "1e309",
+                             "4.9406564584124654e-324", "2.4703282292062328e-324", "1e-400", "1e100000000000",
+                             "1e-100000000000", "9007199254740993", "18446744073709551615", "18446744073709551616",
+                             "1234567890123456789012345", "0.1234567890123456789012345e-5", "000000000000000000000001",
+                             "123456789012345678900000000", "1.00000000000000000000000001" };
+    for ( unsigned int textNumber = 0; textNumber < sizeof( texts ) / sizeof( texts[ 0 ] ); textNumber++ ) {
+        checkParsedAsStrtod( texts[ textNumber ] );
+    }
+}
+
+// The number ends at end even if the characters after it would continue it
+BOOST_AUTO_TEST_CASE( testNumberEndsAtEnd )
+{
+    const std::string text = "-1.25e+3 nan";
+    double value = 0.0;
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ), text.data( ) + 2, value ) == text.data( ) + 2 );
+    BOOST_CHECK_EQUAL( value, -1.0 );
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ), text.data( ) + 5, value ) == text.data( ) + 5 );
+    BOOST_CHECK_EQUAL( value, -1.25 );
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ), text.data( ) + 6, value ) == text.data( ) + 5 );
+    BOOST_CHECK_EQUAL( value, -1.25 );
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ), text.data( ) + 7, value ) == text.data( ) + 5 );
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ), text.data( ) + 8, value ) == text.data( ) + 8 );
+    BOOST_CHECK_EQUAL( value, -1250.0 );
+
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ) + 9, text.data( ) + 11, value ) == text.data( ) + 9 );
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ) + 9, text.data( ) + 12, value ) == text.data( ) + 12 );
+    BOOST_CHECK( value != value );
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ), text.data( ), value ) == text.data( ) );
+
+    // Unlike strtod, no whitespace is skipped: the tokens start at begin
+    BOOST_CHECK( parseFloatingPointNumber( text.data( ) + 8, text.data( ) + 12, value ) == text.data( ) + 8 );
+}
+
+BOOST_AUTO_TEST_CASE( testTableFromTextFile )
+{
+    const std::string fileName = "unitTestInitialConditionsTable_table.txt";
+    writeTextFile( fileName, "3.1 1.0e-1 -2\n\n  3.2\t2.0e-1 -4  \n3.3 3.0e-1 -6" );
+    {
+        const InitialConditionsTable table( fileName );
+        BOOST_REQUIRE_EQUAL( table.getNumberOfOrbits( ), 3 );
+        BOOST_REQUIRE_EQUAL( table.getNumberOfColumns( ), 3 );
+        for ( int orbitId = 0; orbitId < 3; orbitId++ ) {
+            const std::string digit = std::to_string( orbitId + 1 );
+            BOOST_CHECK_EQUAL( table.getValue( orbitId, 0 ), std::strtod( ( "3." + digit ).c_str( ), nullptr ) );
+            BOOST_CHECK_EQUAL( table.getColumn( 1 )[ orbitId ], std::strtod( ( digit + ".0e-1" ).c_str( ), nullptr ) );
+            BOOST_CHECK_EQUAL( table.getRow( orbitId ).at( 2 ), -2.0 * ( orbitId + 1 ) );
+        }
+        BOOST_CHECK_THROW( table.getValue( 3, 0 ), std::out_of_range );
+        BOOST_CHECK_THROW( table.getColumn( 3 ), std::out_of_range );
+    }
+
+    writeTextFile( fileName, "1.0 2.0\n3.0\n" );
+    BOOST_CHECK_THROW( InitialConditionsTable table( fileName ), std::runtime_error );
+    writeTextFile( fileName, "1.0 2.0x\n" );
+    BOOST_CHECK_THROW( InitialConditionsTable table( fileName ), std::runtime_error );
+
+    writeTextFile( fileName, "" );
+    BOOST_CHECK_EQUAL( InitialConditionsTable( fileName ).getNumberOfOrbits( ), 0 );
+    std::remove( fileName.c_str( ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END( )
@@ -0,0 +1,111 @@
+#define BOOST_TEST_MAIN
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "../manifoldConnectionFront.h"
+
+namespace
+{
+
+// Section states around a few clusters, as the manifolds leave them, plus exact duplicates to exercise the tie-breaking
+std::vector< double > createSectionStates( const int numberOfStates, const unsigned int seed )
+{
+    std::mt19937 randomNumberGenerator( seed );
+    std::normal_distribution< double > spread( 0.0, 1.0 );
+    std::vector< double > sectionStates;
+    for ( int stateNumber = 0; stateNumber < numberOfStates; stateNumber++ ) {
+        if ( stateNumber % 17 == 16 ) {
+            sectionStates.insert( sectionStates.end( ), sectionStates.end( ) - 6, sectionStates.end( ) );
+            continue;
+        }
+        const double clusterCenter = 0.1 * ( stateNumber % 3 );
+        for ( int componentNumber = 0; componentNumber < 6; componentNumber++ ) {
+            sectionStates.push_back( clusterCenter + ( componentNumber < 3 ? 1.0E-2 : 1.0E-1 ) * spread( randomNumberGenerator ) );
+        }
+    }
+    return sectionStates;
+}
+
+void checkEqualCandidates( const std::vector< ManifoldConnectionCandidate >& candidates,
+                           const std::vector< ManifoldConnectionCandidate >& referenceCandidates )
+{
+    BOOST_REQUIRE_EQUAL( candidates.size( ), referenceCandidates.size( ) );
+    for ( unsigned int candidateNumber = 0; candidateNumber < candidates.size( ); candidateNumber++ ) {
+        BOOST_CHECK_EQUAL( candidates.at( candidateNumber ).stableTrajectoryNumber,
+                           referenceCandidates.at( candidateNumber ).stableTrajectoryNumber );
+        BOOST_CHECK_EQUAL( candidates.at( candidateNumber ).unstableTrajectoryNumber,
+                           referenceCandidates.at( candidateNumber ).unstableTrajectoryNumber );
+        BOOST_CHECK_EQUAL( candidates.at( candidateNumber ).deltaPosition, referenceCandidates.at( candidateNumber ).deltaPosition );
+        BOOST_CHECK_EQUAL( candidates.at( candidateNumber ).deltaVelocity, referenceCandidates.at( candidateNumber ).deltaVelocity );
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( test_manifold_connection_front )
+
+// The k-d tree only prunes pairs that can not enter the result, so it must select exactly the pairs of the all-pairs search
+BOOST_AUTO_TEST_CASE( testSpatialIndexMatchesAllPairs )
+{
+    const std::vector< double > stableStates   = createSectionStates( 400, 1 );
+    const std::vector< double > unstableStates = createSectionStates( 300, 2 );
+
+    const double maximumVelocityDiscrepancies[ 3 ] = { 0.5, 0.05, 0.0 };
+    for ( int capNumber = 0; capNumber < 3; capNumber++ ) {
+        const ManifoldConnectionFront treeFront = computeManifoldConnectionFront(
+                    stableStates, unstableStates, 10, maximumVelocityDiscrepancies[ capNumber ], true );
+        const ManifoldConnectionFront allPairsFront = computeManifoldConnectionFront(
+                    stableStates, unstableStates, 10, maximumVelocityDiscrepancies[ capNumber ], false );
+
+        BOOST_CHECK( !allPairsFront.paretoFront.empty( ) );
+        checkEqualCandidates( treeFront.paretoFront, allPairsFront.paretoFront );
+        checkEqualCandidates( treeFront.topCandidates, allPairsFront.topCandidates );
+    }
+}
+
+// The first top candidate is the pair with the smallest position difference under the velocity discrepancy cap
+BOOST_AUTO_TEST_CASE( testTopCandidateIsMinimumImpulsePair )
+{
+    const std::vector< double > stableStates   = createSectionStates( 150, 3 );
+    const std::vector< double > unstableStates = createSectionStates( 120, 4 );
+    const double maximumVelocityDiscrepancy = 0.1;
+
+    double minimumDeltaPosition = std::numeric_limits< double >::infinity( );
+    for ( unsigned int stableNumber = 0; stableNumber < stableStates.size( ) / 6; stableNumber++ ) {
+        for ( unsigned int unstableNumber = 0; unstableNumber < unstableStates.size( ) / 6; unstableNumber++ ) {
+            double squaredDeltaPosition = 0.0;
+            double squaredDeltaVelocity = 0.0;
+            for ( int componentNumber = 0; componentNumber < 3; componentNumber++ ) {
+                squaredDeltaPosition += std::pow( stableStates[ 6 * stableNumber + componentNumber ] -
+                                                  unstableStates[ 6 * unstableNumber + componentNumber ], 2 );
+                squaredDeltaVelocity += std::pow( stableStates[ 6 * stableNumber + componentNumber + 3 ] -
+                                                  unstableStates[ 6 * unstableNumber + componentNumber + 3 ], 2 );
+            }
+            if ( std::sqrt( squaredDeltaVelocity ) <= maximumVelocityDiscrepancy ) {
+                minimumDeltaPosition = std::min( minimumDeltaPosition, std::sqrt( squaredDeltaPosition ) );
+            }
+        }
+    }
+
+    const ManifoldConnectionFront connectionFront = computeManifoldConnectionFront( stableStates, unstableStates, 1,
+                                                                                    maximumVelocityDiscrepancy );
+    BOOST_REQUIRE_EQUAL( connectionFront.topCandidates.size( ), 1u );
+    BOOST_CHECK_CLOSE( connectionFront.topCandidates.front( ).deltaPosition, minimumDeltaPosition, 1.0E-12 );
+    BOOST_CHECK( connectionFront.topCandidates.front( ).deltaVelocity <= maximumVelocityDiscrepancy );
+}
+
+BOOST_AUTO_TEST_CASE( testEmptySectionStates )
+{
+    const ManifoldConnectionFront connectionFront = computeManifoldConnectionFront( std::vector< double >( ),
+                                                                                    createSectionStates( 10, 5 ) );
+    BOOST_CHECK( connectionFront.paretoFront.empty( ) );
+    BOOST_CHECK( connectionFront.topCandidates.empty( ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END( )
@@ -0,0 +1,216 @@
+#define BOOST_TEST_MAIN
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "../numpyOutput.h"
+#include "../trajectoryBuffer.h"
+
+namespace
+{
+
+std::string readFileBytes( const std::string& fileName )
+{
+    std::ifstream binaryFile( fileName.c_str( ), std::ios::binary );
+    return std::string( std::istreambuf_iterator< char >( binaryFile ), std::istreambuf_iterator< char >( ) );
+}
+
+uint64_t readLittleEndian( const std::string& bytes, const std::size_t position, const int numberOfBytes )
+{
+    uint64_t value = 0;
+    for ( int byteNumber = 0; byteNumber < numberOfBytes; byteNumber++ ) {
+        value |= static_cast< uint64_t >( static_cast< unsigned char >( bytes.at( position + byteNumber ) ) ) << ( 8 * byteNumber );
+    }
+    return value;
+}
+
+// Bitwise CRC-32 (zip polynomial), independent of the table-driven one of the writer
+uint32_t computeCrc32( const std::string& bytes )
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for ( unsigned int byteNumber = 0; byteNumber < bytes.size( ); byteNumber++ ) {
+        crc ^= static_cast< unsigned char >( bytes[ byteNumber ] );
+        for ( int bitNumber = 0; bitNumber < 8; bitNumber++ ) {
+            crc = ( crc & 1 ) ? 0xEDB88320u ^ ( crc >> 1 ) : crc >> 1;
+        }
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// Members of an uncompressed zip archive, found through the central directory as np.load does; checks the local headers
+// and the CRC of every member
+std::map< std::string, std::string > readZipMembers( const std::string& archiveBytes )
+{
+    std::map< std::string, std::string > members;
+    BOOST_REQUIRE( archiveBytes.size( ) >= 22 );
+    const std::size_t endOfCentralDirectory = archiveBytes.size( ) - 22;
+    BOOST_REQUIRE_EQUAL( readLittleEndian( archiveBytes, endOfCentralDirectory, 4 ), 0x06054b50u );
+    const int numberOfMembers = static_cast< int >( readLittleEndian( archiveBytes, endOfCentralDirectory + 10, 2 ) );
+    std::size_t position = readLittleEndian( archiveBytes, endOfCentralDirectory + 16, 4 );
+
+    for ( int memberNumber = 0; memberNumber < numberOfMembers; memberNumber++ ) {
+        BOOST_REQUIRE_EQUAL( readLittleEndian( archiveBytes, position, 4 ), 0x02014b50u );
+        BOOST_CHECK_EQUAL( readLittleEndian( archiveBytes, position + 10, 2 ), 0u );  // stored
+        const uint32_t crc = static_cast< uint32_t >( readLittleEndian( archiveBytes, position + 16, 4 ) );
+        const std::size_t compressedSize = readLittleEndian( archiveBytes, position + 20, 4 );
+        const std::size_t memberSize = readLittleEndian( archiveBytes, position + 24, 4 );
+        const std::size_t nameLength = readLittleEndian( archiveBytes, position + 28, 2 );
+        const std::size_t extraLength = readLittleEndian( archiveBytes, position + 30, 2 );
+        const std::size_t commentLength = readLittleEndian( archiveBytes, position + 32, 2 );
+        const std::size_t localHeaderOffset = readLittleEndian( archiveBytes, position + 42, 4 );
+        const std::string memberName = archiveBytes.substr( position + 46, nameLength );
+        BOOST_CHECK_EQUAL( compressedSize, memberSize );
+
+        BOOST_REQUIRE_EQUAL( readLittleEndian( archiveBytes, localHeaderOffset, 4 ), 0x04034b50u );
+        BOOST_CHECK_EQUAL( readLittleEndian( archiveBytes, localHeaderOffset + 14, 4 ), crc );
+        BOOST_CHECK_EQUAL( readLittleEndian( archiveBytes, localHeaderOffset + 22, 4 ), memberSize );
+        BOOST_CHECK_EQUAL( archiveBytes.substr( localHeaderOffset + 30, readLittleEndian( archiveBytes, localHeaderOffset + 26, 2 ) ),
+                           memberName );
+        const std::size_t dataOffset = localHeaderOffset + 30 + readLittleEndian( archiveBytes, localHeaderOffset + 26, 2 ) +
+                readLittleEndian( archiveBytes, localHeaderOffset + 28, 2 );
+        BOOST_REQUIRE( dataOffset + memberSize <= archiveBytes.size( ) );
+        members[ memberName ] = archiveBytes.substr( dataOffset, memberSize );
+        BOOST_CHECK_EQUAL( computeCrc32( members[ memberName ] ), crc );
+
+        position += 46 + nameLength + extraLength + commentLength;
+    }
+    return members;
+}
+
+// Header dictionary and data of a version 1.0 .npy file; the data must start at a multiple of 64 bytes
+std::pair< std::string, std::string > readNumpyMember( const std::string& numpyBytes )
+{
+    BOOST_REQUIRE( numpyBytes.size( ) >= 10 );
+    BOOST_REQUIRE_EQUAL( numpyBytes.substr( 0, 8 ), std::string( "\x93NUMPY\x01\x00", 8 ) );
+    const std::size_t headerLength = readLittleEndian( numpyBytes, 8, 2 );
+    BOOST_CHECK_EQUAL( ( 10 + headerLength ) % 64, 0u );
+    BOOST_CHECK_EQUAL( numpyBytes.at( 10 + headerLength - 1 ), '\n' );
+    return std::make_pair( numpyBytes.substr( 10, headerLength ), numpyBytes.substr( 10 + headerLength ) );
+}
+
+template< typename ValueType >
+std::vector< ValueType > getValues( const std::string& dataBytes )
+{
+    std::vector< ValueType > values( dataBytes.size( ) / sizeof( ValueType ) );
+    if ( !values.empty( ) ) {
+        std::memcpy( values.data( ), dataBytes.data( ), dataBytes.size( ) );
+    }
+    return values;
+}
+
+TrajectorySet createTrajectorySet( )
+{
+    TrajectorySet trajectorySet;
+    for ( int trajectoryNumber = 0; trajectoryNumber < 4; trajectoryNumber++ ) {
+        TrajectoryBuffer trajectory;
+        // Trajectory 2 did not reach the section and is kept as an empty trajectory
+        for ( int stateNumber = 0; trajectoryNumber != 2 && stateNumber < 3 + trajectoryNumber; stateNumber++ ) {
+            Eigen::VectorXd state( 6 );
+            for ( int componentNumber = 0; componentNumber < 6; componentNumber++ ) {
+                state( componentNumber ) = trajectoryNumber + 0.1 * stateNumber - 0.01 * componentNumber;
+            }
+            trajectory.append( 0.5 * stateNumber, state );
+        }
+        trajectorySet.appendTrajectory( trajectory.getView( ) );
+    }
+    return trajectorySet;
+}
+
+void checkTrajectoryArchive( const std::string& fileName, const TrajectorySet& trajectorySet )
+{
+    std::map< std::string, std::string > members = readZipMembers( readFileBytes( fileName ) );
+    BOOST_REQUIRE_EQUAL( members.size( ), 2u );
+    BOOST_REQUIRE( members.count( "states.npy" ) == 1 && members.count( "offsets.npy" ) == 1 );
+
+    const std::pair< std::string, std::string > states = readNumpyMember( members[ "states.npy" ] );
+    const std::pair< std::string, std::string > offsets = readNumpyMember( members[ "offsets.npy" ] );
+    BOOST_CHECK( states.first.find( "'descr': '<f8'" ) != std::string::npos );
+    BOOST_CHECK( states.first.find( "'shape': (" + std::to_string( trajectorySet.getTotalNumberOfStates( ) ) + ", 7)" ) !=
+                 std::string::npos );
+    BOOST_CHECK( offsets.first.find( "'descr': '<i8'" ) != std::string::npos );
+    BOOST_CHECK( offsets.first.find( "'shape': (" + std::to_string( trajectorySet.size( ) + 1 ) + ",)" ) != std::string::npos );
+
+    const std::vector< double > stateValues = getValues< double >( states.second );
+    const std::vector< long long > offsetValues = getValues< long long >( offsets.second );
+    BOOST_REQUIRE_EQUAL( offsetValues.size( ), static_cast< unsigned int >( trajectorySet.size( ) + 1 ) );
+    BOOST_REQUIRE_EQUAL( stateValues.size( ), 7u * trajectorySet.getTotalNumberOfStates( ) );
+    for ( int trajectoryNumber = 0; trajectoryNumber < trajectorySet.size( ); trajectoryNumber++ ) {
+        const TrajectoryView trajectory = trajectorySet.getTrajectory( trajectoryNumber );
+        BOOST_REQUIRE_EQUAL( offsetValues.at( trajectoryNumber + 1 ) - offsetValues.at( trajectoryNumber ), trajectory.size( ) );
+        for ( int stateNumber = 0; stateNumber < trajectory.size( ); stateNumber++ ) {
+            const std::size_t rowOffset = 7 * ( offsetValues.at( trajectoryNumber ) + stateNumber );
+            BOOST_CHECK_EQUAL( stateValues.at( rowOffset ), trajectory.getTime( stateNumber ) );
+            for ( int componentNumber = 0; componentNumber < 6; componentNumber++ ) {
+                BOOST_CHECK_EQUAL( stateValues.at( rowOffset + 1 + componentNumber ), trajectory.getState( stateNumber )( componentNumber ) );
+            }
+        }
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( test_numpy_output )
+
+BOOST_AUTO_TEST_CASE( testNumpyArrayRoundTrip )
+{
+    const std::string fileName = "unitTestNumpyOutput_array.npy";
+    std::vector< double > values;
+    for ( int valueNumber = 0; valueNumber < 44 * 5; valueNumber++ ) {
+        values.push_back( 1.0 / ( valueNumber + 1 ) - 0.3 );
+    }
+    values[ 3 ] = -0.0;
+    values[ 7 ] = std::numeric_limits< double >::infinity( );
+    values[ 11 ] = std::numeric_limits< double >::denorm_min( );
+    writeNumpyArrayToFile( fileName, values, 44 );
+
+    const std::pair< std::string, std::string > numpyArray = readNumpyMember( readFileBytes( fileName ) );
+    BOOST_CHECK( numpyArray.first.find( "'fortran_order': False, 'shape': (5, 44)" ) != std::string::npos );
+
+    int numberOfColumns = 0;
+    const std::vector< double > readValues = readNumpyArrayFromFile( fileName, numberOfColumns );
+    BOOST_CHECK_EQUAL( numberOfColumns, 44 );
+    BOOST_REQUIRE_EQUAL( readValues.size( ), values.size( ) );
+    BOOST_CHECK( std::memcmp( readValues.data( ), values.data( ), 8 * values.size( ) ) == 0 );
+    std::remove( fileName.c_str( ) );
+}
+
+// Both the in-memory and the streaming writer produce valid np.savez archives with the same arrays
+BOOST_AUTO_TEST_CASE( testTrajectoryArchives )
+{
+    const TrajectorySet trajectorySet = createTrajectorySet( );
+
+    const std::string fileName = "unitTestNumpyOutput_trajectories.npz";
+    writeTrajectorySetToNumpyFile( fileName, trajectorySet, 0, trajectorySet.size( ) );
+    checkTrajectoryArchive( fileName, trajectorySet );
+
+    const std::string streamedFileName = "unitTestNumpyOutput_streamed.npz";
+    {
+        NumpyTrajectoryFileWriter trajectoryWriter( streamedFileName );
+        for ( int trajectoryNumber = 0; trajectoryNumber < trajectorySet.size( ); trajectoryNumber++ ) {
+            trajectoryWriter.appendTrajectory( trajectorySet.getTrajectory( trajectoryNumber ) );
+        }
+    }
+    checkTrajectoryArchive( streamedFileName, trajectorySet );
+
+    std::remove( fileName.c_str( ) );
+    std::remove( streamedFileName.c_str( ) );
+}
+
+BOOST_AUTO_TEST_CASE( testEmptyTrajectoryArchive )
+{
+    const std::string fileName = "unitTestNumpyOutput_empty.npz";
+    writeTrajectorySetToNumpyFile( fileName, TrajectorySet( ), 0, 0 );
+    checkTrajectoryArchive( fileName, TrajectorySet( ) );
+    std::remove( fileName.c_str( ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END( )
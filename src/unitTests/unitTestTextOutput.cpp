@@ -0,0 +1,155 @@
+#define BOOST_TEST_MAIN
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "../textOutput.h"
+
+namespace
+{
+
+// Column as the iostream writers format it
+std::string formatWithStream( const double value, const int precision, const int columnWidth )
+{
+    std::ostringstream textStream;
+    textStream << std::left << std::scientific << std::setprecision( precision ) << std::setw( columnWidth ) << value;
+    return textStream.str( );
+}
+
+std::string formatColumn( const double value, const int precision, const int columnWidth )
+{
+    std::string text;
+    appendScientificColumn( text, value, precision, columnWidth );
+    return text;
+}
+
+double getValue( const uint64_t bits )
+{
+    double value;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+// Special values and values whose decimal expansion ends in a 5 right after the last printed digit, which must be rounded
+// to even
+std::vector< double > createSpecialValues( )
+{
+    std::vector< double > values;
+    values.push_back( 0.0 );
+    values.push_back( -0.0 );
+    values.push_back( std::numeric_limits< double >::quiet_NaN( ) );
+    values.push_back( std::numeric_limits< double >::infinity( ) );
+    values.push_back( -std::numeric_limits< double >::infinity( ) );
+    values.push_back( std::numeric_limits< double >::denorm_min( ) );
+    values.push_back( -std::numeric_limits< double >::denorm_min( ) );
+    values.push_back( std::numeric_limits< double >::min( ) );
+    values.push_back( std::nextafter( std::numeric_limits< double >::min( ), 0.0 ) );
+    values.push_back( std::numeric_limits< double >::max( ) );
+    values.push_back( -std::numeric_limits< double >::max( ) );
+    values.push_back( std::numeric_limits< double >::epsilon( ) );
+    values.push_back( 1.0 );
+    values.push_back( 9.5 );
+    values.push_back( 0.5 );
+    values.push_back( 2.5 );
+    values.push_back( 1.25 );
+    values.push_back( 1.375 );
+    values.push_back( 9.999999999999999 );
+    values.push_back( 99999999999999995.0 );
+    values.push_back( 1.0E-300 );
+    values.push_back( 1.0E300 );
+    values.push_back( 0.1 );
+    values.push_back( 1.0 / 3.0 );
+    values.push_back( 1.2150584269940356E-2 );
+    return values;
+}
+
+std::string readFileText( const std::string& fileName )
+{
+    std::ifstream textFile( fileName.c_str( ) );
+    return std::string( std::istreambuf_iterator< char >( textFile ), std::istreambuf_iterator< char >( ) );
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( test_text_output )
+
+BOOST_AUTO_TEST_CASE( testSpecialValuesMatchIostream )
+{
+    const std::vector< double > values = createSpecialValues( );
+    for ( int precision = 0; precision <= 20; precision++ ) {
+        for ( unsigned int valueNumber = 0; valueNumber < values.size( ); valueNumber++ ) {
+            BOOST_CHECK_EQUAL( formatColumn( values[ valueNumber ], precision, 25 ),
+                               formatWithStream( values[ valueNumber ], precision, 25 ) );
+        }
+    }
+}
+
+// Random bit patterns cover all exponents, including subnormals, and NaNs with any payload
+BOOST_AUTO_TEST_CASE( testRandomValuesMatchIostream )
+{
+    std::mt19937_64 randomNumberGenerator( 1 );
+    std::uniform_real_distribution< double > mantissa( 1.0, 10.0 );
+    std::uniform_int_distribution< int > decimalExponent( -20, 20 );
+    for ( int valueNumber = 0; valueNumber < 20000; valueNumber++ ) {
+        const double bitPatternValue = getValue( randomNumberGenerator( ) );
+        const double decimalValue = mantissa( randomNumberGenerator ) * std::pow( 10.0, decimalExponent( randomNumberGenerator ) );
+        const int precision = valueNumber % 17;
+        BOOST_CHECK_EQUAL( formatColumn( bitPatternValue, precision, 25 ), formatWithStream( bitPatternValue, precision, 25 ) );
+        BOOST_CHECK_EQUAL( formatColumn( decimalValue, precision, 25 ), formatWithStream( decimalValue, precision, 25 ) );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( testColumnPadding )
+{
+    BOOST_CHECK_EQUAL( formatColumn( -1.5, 14, 25 ), "-1.50000000000000e+00    " );
+    BOOST_CHECK_EQUAL( formatColumn( 1.5, 2, 12 ), "1.50e+00    " );
+    BOOST_CHECK_EQUAL( formatColumn( 1.0E100, 2, 0 ), "1.00e+100" );
+    BOOST_CHECK_EQUAL( formatColumn( -1.0E-100, 14, 10 ), "-1.00000000000000e-100" );
+
+    // Appending keeps the text that is already there
+    std::string text = "a";
+    appendScientificColumn( text, 2.0, 1, 8 );
+    BOOST_CHECK_EQUAL( text, "a2.0e+00 " );
+}
+
+// The writer produces the same file as the iostream writers, also when the rows span several buffer blocks
+BOOST_AUTO_TEST_CASE( testTableWriterMatchesIostream )
+{
+    const std::string fileName = "unitTestTextOutput_table.txt";
+    std::ostringstream textStream;
+    textStream << std::left << std::scientific << std::setprecision( 14 );
+    {
+        TextTableWriter tableWriter( fileName, 14, 25, 64 );
+        for ( int rowNumber = 0; rowNumber < 50; rowNumber++ ) {
+            const double row[ 3 ] = { 0.1 * rowNumber, -1.0 / ( rowNumber + 1 ), std::exp( rowNumber ) };
+            tableWriter.appendText( std::to_string( rowNumber ) );
+            tableWriter.appendText( "label", 8 );
+            tableWriter.appendValue( std::sqrt( rowNumber ) );
+            tableWriter.appendRow( row, 3 );
+            textStream << std::setw( 25 ) << rowNumber << std::setw( 8 ) << "label" << std::setw( 25 ) << std::sqrt( rowNumber );
+            for ( int columnNumber = 0; columnNumber < 3; columnNumber++ ) {
+                textStream << std::setw( 25 ) << row[ columnNumber ];
+            }
+            textStream << std::endl;
+        }
+        tableWriter.appendText( "a text longer than the column width", 5 );
+        tableWriter.endRow( );
+        textStream << std::setw( 5 ) << "a text longer than the column width" << std::endl;
+    }
+    BOOST_CHECK_EQUAL( readFileText( fileName ), textStream.str( ) );
+    std::remove( fileName.c_str( ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END( )
@@ -0,0 +1,152 @@
+#define BOOST_TEST_MAIN
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "../xorFloatCodec.h"
+
+namespace
+{
+
+uint64_t getBits( const double value )
+{
+    uint64_t bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+// Decodes numberOfColumns columns of numberOfValues values into a row-major table
+std::vector< double > decodeColumns( const std::string& encodedColumns, const int numberOfValues, const int numberOfColumns )
+{
+    std::vector< double > values( numberOfValues * numberOfColumns );
+    XorFloatDecoder decoder( encodedColumns.data( ), encodedColumns.size( ) );
+    for ( int columnNumber = 0; columnNumber < numberOfColumns; columnNumber++ ) {
+        decoder.beginColumn( numberOfValues );
+        for ( int valueNumber = 0; valueNumber < numberOfValues; valueNumber++ ) {
+            BOOST_REQUIRE( decoder.hasNextValue( ) );
+            values[ valueNumber * numberOfColumns + columnNumber ] = decoder.decodeNextValue( );
+        }
+        BOOST_CHECK( !decoder.hasNextValue( ) );
+    }
+    return values;
+}
+
+void checkBitwiseEqual( const std::vector< double >& values, const std::vector< double >& referenceValues )
+{
+    BOOST_REQUIRE_EQUAL( values.size( ), referenceValues.size( ) );
+    for ( unsigned int valueNumber = 0; valueNumber < values.size( ); valueNumber++ ) {
+        BOOST_CHECK_EQUAL( getBits( values[ valueNumber ] ), getBits( referenceValues[ valueNumber ] ) );
+    }
+}
+
+// Time and state of a smooth trajectory with some noise in the last bits, as a row-major table with 7 columns
+std::vector< double > createTrajectoryTable( const int numberOfStates, const unsigned int seed )
+{
+    std::mt19937 randomNumberGenerator( seed );
+    std::uniform_real_distribution< double > noise( -1.0E-12, 1.0E-12 );
+    std::vector< double > table;
+    for ( int stateNumber = 0; stateNumber < numberOfStates; stateNumber++ ) {
+        const double time = 1.0E-3 * stateNumber;
+        table.push_back( time );
+        for ( int componentNumber = 0; componentNumber < 6; componentNumber++ ) {
+            table.push_back( std::sin( time + componentNumber ) * ( 1.0 + noise( randomNumberGenerator ) ) );
+        }
+    }
+    return table;
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE( test_xor_float_codec )
+
+BOOST_AUTO_TEST_CASE( testRoundTripOfTableColumns )
+{
+    const int numberOfStates = 1000;
+    const std::vector< double > table = createTrajectoryTable( numberOfStates, 1 );
+
+    XorFloatEncoder encoder;
+    for ( int columnNumber = 0; columnNumber < 7; columnNumber++ ) {
+        encoder.encodeColumn( table.data( ) + columnNumber, numberOfStates, 7 );
+    }
+    const std::string encodedColumns = encoder.finish( );
+    checkBitwiseEqual( decodeColumns( encodedColumns, numberOfStates, 7 ), table );
+
+    // The smooth columns take fewer bits than the raw doubles
+    BOOST_CHECK_LT( encodedColumns.size( ), table.size( ) * sizeof( double ) );
+}
+
+BOOST_AUTO_TEST_CASE( testRoundTripOfSpecialValues )
+{
+    std::vector< double > values;
+    values.push_back( 0.0 );
+    values.push_back( -0.0 );
+    values.push_back( std::numeric_limits< double >::quiet_NaN( ) );
+    values.push_back( -std::numeric_limits< double >::quiet_NaN( ) );
+    values.push_back( std::numeric_limits< double >::infinity( ) );
+    values.push_back( -std::numeric_limits< double >::infinity( ) );
+    values.push_back( std::numeric_limits< double >::denorm_min( ) );
+    values.push_back( -std::numeric_limits< double >::min( ) );
+    values.push_back( std::numeric_limits< double >::max( ) );
+    values.push_back( -std::numeric_limits< double >::max( ) );
+    values.push_back( 1.0 );
+    values.push_back( 1.0 );
+    values.push_back( 1.0 );
+    values.push_back( std::numeric_limits< double >::max( ) );
+
+    // Every value on its own, every pair, and the whole list as one column
+    for ( unsigned int numberOfValues = 1; numberOfValues <= values.size( ); numberOfValues++ ) {
+        for ( unsigned int firstValue = 0; firstValue + numberOfValues <= values.size( ); firstValue++ ) {
+            if ( numberOfValues > 2 && numberOfValues < values.size( ) ) {
+                continue;
+            }
+            const std::vector< double > column( values.begin( ) + firstValue, values.begin( ) + firstValue + numberOfValues );
+            XorFloatEncoder encoder;
+            encoder.encodeColumn( column.data( ), numberOfValues );
+            checkBitwiseEqual( decodeColumns( encoder.finish( ), numberOfValues, 1 ), column );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( testEmptyColumns )
+{
+    const double value = 1.0;
+    XorFloatEncoder encoder;
+    encoder.encodeColumn( &value, 0 );
+    encoder.encodeColumn( &value, 1 );
+    encoder.encodeColumn( &value, 0 );
+    const std::string encodedColumns = encoder.finish( );
+
+    XorFloatDecoder decoder( encodedColumns.data( ), encodedColumns.size( ) );
+    decoder.beginColumn( 0 );
+    BOOST_CHECK( !decoder.hasNextValue( ) );
+    decoder.beginColumn( 1 );
+    BOOST_CHECK_EQUAL( decoder.decodeNextValue( ), value );
+    decoder.beginColumn( 0 );
+    BOOST_CHECK( !decoder.hasNextValue( ) );
+}
+
+// Fixes the bit layout; python/util/test_xor_float_codec.py decodes the same bytes
+BOOST_AUTO_TEST_CASE( testEncodedByteStream )
+{
+    const double columnOne[ 5 ] = { 1.0, 2.0, 3.0, 4.0, 4.5 };
+    const double columnTwo[ 5 ] = { 0.1, 0.1, -0.0, std::numeric_limits< double >::infinity( ), -2.5E-300 };
+    const unsigned char expectedBytes[ 50 ] = {
+        0x9f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x95, 0xff, 0xcc, 0xd0, 0x71, 0xfd, 0xcc, 0xcc,
+        0xcc, 0xcc, 0xcc, 0xcc, 0xd3, 0x03, 0xeb, 0xfb, 0x99, 0x99, 0x99, 0x99, 0x99, 0x99, 0xb7, 0xff, 0x80,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0f, 0xff, 0x92, 0xb2, 0x69, 0xec, 0xed, 0xcc, 0x0b, 0xc0 };
+
+    XorFloatEncoder encoder;
+    encoder.encodeColumn( columnOne, 5 );
+    encoder.encodeColumn( columnTwo, 5 );
+    const std::string encodedColumns = encoder.finish( );
+    BOOST_CHECK_EQUAL( encodedColumns, std::string( reinterpret_cast< const char* >( expectedBytes ), 50 ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END( )
@@ -0,0 +1,191 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "xorFloatCodec.h"
+
+// The leading and trailing zero counts use the bit scan builtins of GCC and Clang
+#if !defined( __GNUC__ )
+#error "xorFloatCodec.cpp requires __builtin_clzll and __builtin_ctzll (GCC or Clang)"
+#endif
+
+namespace
+{
+
+uint64_t getBits( const double value )
+{
+    uint64_t bits;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+double getValue( const uint64_t bits )
+{
+    double value;
+    std::memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+// Multiplying by two is exact, so the prediction is the same in any implementation of the decoder
+double getPrediction( const int predictionOrder, const int numberOfPreviousValues, const double previousValue,
+                      const double secondPreviousValue )
+{
+    if ( predictionOrder == 1 && numberOfPreviousValues >= 2 ) {
+        return 2.0 * previousValue - secondPreviousValue;
+    }
+    return previousValue;
+}
+
+}
+
+void XorFloatEncoder::encodeColumn( const double* values, const int numberOfValues, const int stride )
+{
+    const int predictionOrder = ( encodeColumn( values, numberOfValues, stride, 1, false ) <
+                                  encodeColumn( values, numberOfValues, stride, 0, false ) ? 1 : 0 );
+    encodeColumn( values, numberOfValues, stride, predictionOrder, true );
+}
+
+uint64_t XorFloatEncoder::encodeColumn( const double* values, const int numberOfValues, const int stride,
+                                        const int predictionOrder, const bool writeBits )
+{
+    uint64_t numberOfBits = 1;
+    if ( writeBits ) {
+        this->writeBits( predictionOrder, 1 );
+    }
+
+    int windowLeadingZeros = 0;
+    int windowLength = 0;
+    for ( int valueNumber = 0; valueNumber < numberOfValues; valueNumber++ ) {
+        const double value = values[ valueNumber * stride ];
+        if ( valueNumber == 0 ) {
+            numberOfBits += 64;
+            if ( writeBits ) {
+                this->writeBits( getBits( value ), 64 );
+            }
+            continue;
+        }
+
+        const double prediction = getPrediction( predictionOrder, valueNumber, values[ ( valueNumber - 1 ) * stride ],
+                                                 valueNumber >= 2 ? values[ ( valueNumber - 2 ) * stride ] : 0.0 );
+        const uint64_t xorWithPrediction = getBits( value ) ^ getBits( prediction );
+        if ( xorWithPrediction == 0 ) {
+            numberOfBits += 1;
+            if ( writeBits ) {
+                this->writeBits( 0, 1 );
+            }
+            continue;
+        }
+
+        const int leadingZeros = __builtin_clzll( xorWithPrediction );
+        const int trailingZeros = __builtin_ctzll( xorWithPrediction );
+        if ( windowLength > 0 && leadingZeros >= windowLeadingZeros &&
+             trailingZeros >= 64 - windowLeadingZeros - windowLength ) {
+            numberOfBits += 2 + windowLength;
+            if ( writeBits ) {
+                this->writeBits( 2, 2 );
+                this->writeBits( xorWithPrediction >> ( 64 - windowLeadingZeros - windowLength ), windowLength );
+            }
+        } else {
+            windowLeadingZeros = leadingZeros;
+            windowLength = 64 - leadingZeros - trailingZeros;
+            numberOfBits += 14 + windowLength;
+            if ( writeBits ) {
+                this->writeBits( 3, 2 );
+                this->writeBits( windowLeadingZeros, 6 );
+                this->writeBits( windowLength - 1, 6 );
+                this->writeBits( xorWithPrediction >> trailingZeros, windowLength );
+            }
+        }
+    }
+    return numberOfBits;
+}
+
+void XorFloatEncoder::writeBits( const uint64_t value, const int numberOfBits )
+{
+    if ( numberOfBits > 32 ) {
+        writeBits( value >> 32, numberOfBits - 32 );
+        writeBits( value & 0xFFFFFFFFu, 32 );
+        return;
+    }
+
+    // Fewer than 8 bits are buffered between calls, so at most 39 bits are in the buffer
+    bitBuffer_ = ( bitBuffer_ << numberOfBits ) | ( value & ( ( uint64_t( 1 ) << numberOfBits ) - 1 ) );
+    numberOfBufferedBits_ += numberOfBits;
+    while ( numberOfBufferedBits_ >= 8 ) {
+        numberOfBufferedBits_ -= 8;
+        bytes_.push_back( static_cast< char >( ( bitBuffer_ >> numberOfBufferedBits_ ) & 0xFF ) );
+    }
+    bitBuffer_ &= ( uint64_t( 1 ) << numberOfBufferedBits_ ) - 1;
+}
+
+std::string XorFloatEncoder::finish( )
+{
+    if ( numberOfBufferedBits_ > 0 ) {
+        writeBits( 0, 8 - numberOfBufferedBits_ );
+    }
+    std::string encodedBytes;
+    encodedBytes.swap( bytes_ );
+    return encodedBytes;
+}
+
+XorFloatDecoder::XorFloatDecoder( const char* data, const std::size_t length ):
+    data_( reinterpret_cast< const unsigned char* >( data ) ), length_( length ), bytePosition_( 0 ), bitBuffer_( 0 ),
+    numberOfBufferedBits_( 0 ), numberOfRemainingValues_( 0 ), numberOfDecodedValues_( 0 ), predictionOrder_( 0 ),
+    previousValue_( 0.0 ), secondPreviousValue_( 0.0 ), windowLeadingZeros_( 0 ), windowLength_( 0 ) { }
+
+void XorFloatDecoder::beginColumn( const int numberOfValues )
+{
+    predictionOrder_ = static_cast< int >( readBits( 1 ) );
+    numberOfRemainingValues_ = numberOfValues;
+    numberOfDecodedValues_ = 0;
+    windowLeadingZeros_ = 0;
+    windowLength_ = 0;
+}
+
+double XorFloatDecoder::decodeNextValue( )
+{
+    if ( numberOfRemainingValues_ <= 0 ) {
+        throw std::runtime_error( "Xor float decoder: no values left in the column" );
+    }
+
+    double value;
+    if ( numberOfDecodedValues_ == 0 ) {
+        value = getValue( readBits( 64 ) );
+    } else {
+        const double prediction = getPrediction( predictionOrder_, numberOfDecodedValues_, previousValue_, secondPreviousValue_ );
+        uint64_t xorWithPrediction = 0;
+        if ( readBits( 1 ) == 1 ) {
+            if ( readBits( 1 ) == 1 ) {
+                windowLeadingZeros_ = static_cast< int >( readBits( 6 ) );
+                windowLength_ = static_cast< int >( readBits( 6 ) ) + 1;
+            }
+            xorWithPrediction = readBits( windowLength_ ) << ( 64 - windowLeadingZeros_ - windowLength_ );
+        }
+        value = getValue( getBits( prediction ) ^ xorWithPrediction );
+    }
+
+    secondPreviousValue_ = previousValue_;
+    previousValue_ = value;
+    numberOfDecodedValues_++;
+    numberOfRemainingValues_--;
+    return value;
+}
+
+uint64_t XorFloatDecoder::readBits( const int numberOfBits )
+{
+    if ( numberOfBits > 32 ) {
+        const uint64_t mostSignificantBits = readBits( numberOfBits - 32 );
+        return ( mostSignificantBits << 32 ) | readBits( 32 );
+    }
+
+    while ( numberOfBufferedBits_ < numberOfBits ) {
+        if ( bytePosition_ >= length_ ) {
+            throw std::runtime_error( "Xor float decoder: encoded data ends within a value" );
+        }
+        bitBuffer_ = ( bitBuffer_ << 8 ) | data_[ bytePosition_++ ];
+        numberOfBufferedBits_ += 8;
+    }
+    numberOfBufferedBits_ -= numberOfBits;
+    const uint64_t bits = ( bitBuffer_ >> numberOfBufferedBits_ ) & ( ( uint64_t( 1 ) << numberOfBits ) - 1 );
+    bitBuffer_ &= ( uint64_t( 1 ) << numberOfBufferedBits_ ) - 1;
+    return bits;
+}
@@ -0,0 +1,72 @@
+#ifndef TUDATBUNDLE_XORFLOATCODEC_H
+#define TUDATBUNDLE_XORFLOATCODEC_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Lossless compression of columns of doubles (Gorilla-style). Every value is XORed with a prediction from the preceding
+// values of its column, and only the bits between the leading and trailing zeros of the XOR are stored:
+//   first value of a column           64 bits
+//   value equal to its prediction     '0'
+//   within the previous bit window    '10', the bits of the window
+//   otherwise                         '11', 6 bits leading zeros, 6 bits number of meaningful bits - 1, meaningful bits
+// Per column a single bit selects the prediction: the previous value (0) or the linear extrapolation
+// 2 * previous - second previous (1), whichever takes fewer bits. Bits are written most significant first, the stream
+// is padded with zeros to whole bytes at the end. python/util/xor_float_codec.py decodes the same stream.
+class XorFloatEncoder
+{
+public:
+    XorFloatEncoder( ): bitBuffer_( 0 ), numberOfBufferedBits_( 0 ) { }
+
+    // Encodes numberOfValues values that are stride apart, e.g. a column of a row-major table
+    void encodeColumn( const double* values, const int numberOfValues, const int stride = 1 );
+
+    // Encoded columns; the encoder can not be used afterwards
+    std::string finish( );
+
+private:
+    // Number of bits of the column with the given prediction; the bits are only written if writeBits is true
+    uint64_t encodeColumn( const double* values, const int numberOfValues, const int stride, const int predictionOrder,
+                           const bool writeBits );
+
+    void writeBits( const uint64_t value, const int numberOfBits );
+
+    std::string bytes_;
+    uint64_t bitBuffer_;
+    int numberOfBufferedBits_;
+};
+
+// Streaming decoder of the columns written by XorFloatEncoder, value by value
+class XorFloatDecoder
+{
+public:
+    XorFloatDecoder( const char* data, const std::size_t length );
+
+    // Starts the next column, of numberOfValues values
+    void beginColumn( const int numberOfValues );
+
+    bool hasNextValue( ) const { return numberOfRemainingValues_ > 0; }
+
+    double decodeNextValue( );
+
+private:
+    uint64_t readBits( const int numberOfBits );
+
+    const unsigned char* data_;
+    std::size_t length_;
+    std::size_t bytePosition_;
+    uint64_t bitBuffer_;
+    int numberOfBufferedBits_;
+
+    int numberOfRemainingValues_;
+    int numberOfDecodedValues_;
+    int predictionOrder_;
+    double previousValue_;
+    double secondPreviousValue_;
+    int windowLeadingZeros_;
+    int windowLength_;
+};
+
+#endif  // TUDATBUNDLE_XORFLOATCODEC_H